@@ -0,0 +1,492 @@
+/**
+ * @file SimulatedMeter.cpp
+ * @brief Trace replay behind the MeterTransport interface
+ * @version 2.0
+ * @date 2025-10-02
+ */
+
+#include "SimulatedMeter.h"
+#include <ctype.h>
+#include <string>
+#include "../src/dlms/AXDR.h"
+#include "../src/utils/CRCCalculator.h"
+#include "../src/utils/Logger.h"
+#include "../src/hardware/HardwareManager.h"
+
+SimulatedMeter::SimulatedMeter()
+    : cursor(0), byteUs(10000000UL / DLMS_BAUD_RATE), turnaroundUs(20000),
+      rng(1), txBusyUntil(0), rxBusyUntil(0),
+      sendSequence(0), receiveSequence(0) {
+    faults = MeterFaults();
+    faults.seed = 1;
+    clearStats();
+    requestReader.setBuffer(request, sizeof(request));
+}
+
+void SimulatedMeter::clearStats() {
+    stats = MeterSimStats();
+}
+
+void SimulatedMeter::setBaudRate(uint32_t baudRate) {
+    byteUs = 10000000UL / baudRate;
+}
+
+void SimulatedMeter::setFaults(const MeterFaults& config) {
+    faults = config;
+    rng = config.seed ? config.seed : 1;
+}
+
+// ============================================
+// TRACE
+// ============================================
+
+/**
+ * @brief Append the hex pairs of one dump line
+ * @return false if the dump was cut short ("... +n")
+ */
+static bool parseHex(const char* text, std::vector<uint8_t>& bytes) {
+    while (*text) {
+        if (*text == '.') return false;
+        if (isxdigit((unsigned char)text[0]) && isxdigit((unsigned char)text[1])) {
+            char pair[3] = { text[0], text[1], 0 };
+            bytes.push_back((uint8_t)strtoul(pair, nullptr, 16));
+            text += 2;
+        } else {
+            text++;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Line is an indented continuation of a hex dump
+ */
+static bool isContinuation(const char* text) {
+    if (*text != ' ') return false;
+    while (*text == ' ') text++;
+    return isxdigit((unsigned char)text[0]) && isxdigit((unsigned char)text[1]) &&
+           (text[2] == ' ' || text[2] == '\r' || text[2] == '\n' || text[2] == 0);
+}
+
+bool SimulatedMeter::loadTrace(const char* path) {
+    FILE* file = fopen(path, "r");
+    if (!file) {
+        LOG_ERRORF("Trace %s: cannot open", path);
+        return false;
+    }
+
+    exchanges.clear();
+    attributes.clear();
+    cursor = 0;
+
+    uint32_t skipped = 0;
+    char text[512];
+    bool pending = fgets(text, sizeof(text), file) != nullptr;
+
+    while (pending) {
+        std::string header(text);
+        pending = fgets(text, sizeof(text), file) != nullptr;
+
+        size_t marker = header.find(" bytes]: ");
+        if (marker == std::string::npos) continue;
+        size_t open = header.rfind('[', marker);
+        if (open == std::string::npos || open < 3) continue;
+
+        bool tx = header.compare(open - 3, 3, "TX ") == 0;
+        bool rx = header.compare(open - 3, 3, "RX ") == 0;
+        if (!tx && !rx) continue;
+
+        size_t total = strtoul(header.c_str() + open + 1, nullptr, 10);
+        Frame frame;
+        bool whole = parseHex(header.c_str() + marker + 9, frame);
+        while (pending && isContinuation(text)) {
+            whole = parseHex(text, frame) && whole;
+            pending = fgets(text, sizeof(text), file) != nullptr;
+        }
+
+        if (!whole || frame.size() != total) {
+            skipped++;
+            continue;
+        }
+
+        if (tx) {
+            Exchange exchange;
+            if (!frameKey(frame.data(), frame.size(), exchange.key)) {
+                skipped++;
+                continue;
+            }
+            exchanges.push_back(exchange);
+        } else if (!exchanges.empty()) {
+            exchanges.back().replies.push_back(frame);
+        }
+    }
+    fclose(file);
+
+    for (size_t i = 0; i < exchanges.size(); i++) {
+        learn(exchanges[i]);
+    }
+
+    if (skipped) {
+        LOG_WARNF("Trace %s: %u frames cut short or malformed, skipped", path, skipped);
+    }
+    LOG_INFOF("Trace %s: %u exchanges, %u attributes", path,
+              (unsigned)exchanges.size(), (unsigned)attributes.size());
+    return !exchanges.empty();
+}
+
+uint16_t SimulatedMeter::headerLength(const uint8_t* frame, uint16_t length) {
+    // Flag, format (2), destination and source addresses, control
+    uint16_t i = 3;
+    for (uint8_t field = 0; field < 2; field++) {
+        while (i < length && !(frame[i] & 0x01)) i++;
+        i++;
+    }
+    return i + 1;
+}
+
+bool SimulatedMeter::frameKey(const uint8_t* frame, uint16_t length, Frame& key) {
+    if (length < 9 || frame[0] != HDLC_FLAG) return false;
+    uint16_t header = headerLength(frame, length);
+    if (header + 3 > length) return false;
+
+    uint8_t control = frame[header - 1];
+    uint8_t type;
+    if (!(control & 0x01)) {
+        type = 0x00;                    // I-frame: sequence numbers vary
+    } else if ((control & 0x03) == 0x01) {
+        type = control & 0x0F;          // S-frame: RR, RNR
+    } else {
+        type = control & 0xEF;          // U-frame without P/F
+    }
+
+    key.assign(1, type);
+    if (length > header + 3) {
+        key.insert(key.end(), frame + header + 2, frame + length - 3);
+    }
+    return true;
+}
+
+void SimulatedMeter::reseal(Frame& frame) {
+    uint16_t length = frame.size();
+    uint16_t header = headerLength(frame.data(), length);
+    if (length > header + 3) {
+        CRCCalculator::put(&frame[header], CRCCalculator::calculate(&frame[1], header - 1));
+    }
+    CRCCalculator::put(&frame[length - 3], CRCCalculator::calculate(&frame[1], length - 4));
+}
+
+// ============================================
+// ATTRIBUTE INDEX
+// ============================================
+
+// Key: type, LLC (3), C0, request type, invoke-id, then the descriptors
+static const size_t KEY_DESCRIPTORS = 7;
+static const size_t DESCRIPTOR_SIZE = 9;    // Class (2), OBIS (6), attribute
+static const size_t LIST_ENTRY_SIZE = 10;   // Descriptor + access-selection flag
+
+void SimulatedMeter::learn(const Exchange& exchange) {
+    const Frame& key = exchange.key;
+    if (key.size() < KEY_DESCRIPTORS + 1 || key[0] != 0x00 || key[4] != 0xC0 ||
+        exchange.replies.size() != 1) {
+        return;
+    }
+
+    // One whole (unsegmented) Get-Response of the same type
+    const Frame& reply = exchange.replies[0];
+    if (reply[1] & 0x08) return;
+    uint16_t header = headerLength(reply.data(), reply.size());
+    if (reply.size() < (size_t)header + 2 + 6 + 3) return;
+    const uint8_t* info = &reply[header + 2];
+    const uint8_t* end = reply.data() + reply.size() - 3;
+    if (info[3] != 0xC4 || info[4] != key[5]) return;
+
+    const uint8_t* descriptor;
+    uint16_t count;
+    size_t stride;
+    const uint8_t* p = info + 6;
+    if (key[5] == 0x01) {
+        descriptor = &key[KEY_DESCRIPTORS];
+        count = 1;
+        stride = 0;
+    } else if (key[5] == 0x03) {
+        descriptor = &key[KEY_DESCRIPTORS + 1];
+        count = key[KEY_DESCRIPTORS];
+        stride = LIST_ENTRY_SIZE;
+        uint16_t items;
+        if (count >= 0x80 || !AXDRReader::decodeLength(p, end, items) || items != count) return;
+    } else {
+        return;
+    }
+    if (count == 0 ||
+        key.size() < (size_t)(descriptor - key.data()) + (count - 1) * stride + DESCRIPTOR_SIZE) {
+        return;
+    }
+
+    for (uint16_t i = 0; i < count; i++, descriptor += stride) {
+        // Get-Data-Result: 00 data, or 01 data-access-result
+        const uint8_t* result = p;
+        if (p >= end) return;
+        if (*p++ == 0x00) {
+            if (!AXDRReader::skip(p, end)) return;
+        } else if (p++ >= end) {
+            return;
+        }
+        attributes[Frame(descriptor, descriptor + DESCRIPTOR_SIZE)] = Frame(result, p);
+    }
+}
+
+void SimulatedMeter::addResult(const uint8_t* descriptor, Frame& info) {
+    Frame name(descriptor, descriptor + DESCRIPTOR_SIZE);
+    std::map<Frame, Frame>::const_iterator found = attributes.find(name);
+    if (found != attributes.end()) {
+        info.insert(info.end(), found->second.begin(), found->second.end());
+        return;
+    }
+
+    // Any attribute of the same object recorded
+    name[DESCRIPTOR_SIZE - 1] = 0;
+    found = attributes.lower_bound(name);
+    bool known = found != attributes.end() &&
+                 std::equal(name.begin(), name.end() - 1, found->first.begin());
+
+    if (known && descriptor[DESCRIPTOR_SIZE - 1] == 0x01) {
+        // logical_name: octet-string(6)
+        info.push_back(0x00);
+        info.push_back(0x09);
+        info.push_back(0x06);
+        info.insert(info.end(), descriptor + 2, descriptor + 8);
+    } else {
+        info.push_back(0x01);
+        info.push_back(known ? 0x02 : 0x04);    // temporary-failure, object-undefined
+    }
+}
+
+bool SimulatedMeter::compose(const Frame& key, Frame& info) {
+    if (key.size() < KEY_DESCRIPTORS + 1 || key[0] != 0x00 || key[4] != 0xC0) return false;
+
+    // Get-Response of the same type and invoke-id
+    const uint8_t head[] = { 0xE6, 0xE7, 0x00, 0xC4, key[5], key[6] };
+    info.assign(head, head + sizeof(head));
+
+    if (key[5] == 0x01) {
+        if (key.size() < KEY_DESCRIPTORS + DESCRIPTOR_SIZE) return false;
+        addResult(&key[KEY_DESCRIPTORS], info);
+        return true;
+    }
+    if (key[5] == 0x03) {
+        uint8_t count = key[KEY_DESCRIPTORS];
+        if (count >= 0x80 ||
+            key.size() < KEY_DESCRIPTORS + 1 + (size_t)count * LIST_ENTRY_SIZE) {
+            return false;
+        }
+        info.push_back(count);
+        for (uint8_t i = 0; i < count; i++) {
+            addResult(&key[KEY_DESCRIPTORS + 1 + i * LIST_ENTRY_SIZE], info);
+        }
+        return true;
+    }
+    return false;
+}
+
+// ============================================
+// METER
+// ============================================
+
+const SimulatedMeter::Exchange* SimulatedMeter::match(const Frame& key, bool typeOnly) {
+    for (size_t n = 0; n < exchanges.size(); n++) {
+        size_t i = (cursor + n) % exchanges.size();
+        if (typeOnly ? exchanges[i].key[0] == key[0] : exchanges[i].key == key) {
+            cursor = i + 1;
+            return &exchanges[i];
+        }
+    }
+    return nullptr;
+}
+
+void SimulatedMeter::respond(const uint8_t* frame, uint16_t length, const Frame& info) {
+    // Addresses swap: destination is the meter's (1-4 bytes), source the client's
+    uint16_t destinationEnd = 3;
+    while (destinationEnd < length && !(frame[destinationEnd] & 0x01)) destinationEnd++;
+    destinationEnd++;
+    uint16_t header = headerLength(frame, length);
+
+    Frame reply(1, HDLC_FLAG);
+    reply.push_back(0xA0);
+    reply.push_back(0x00);
+    reply.insert(reply.end(), frame + destinationEnd, frame + header - 1);
+    reply.insert(reply.end(), frame + 3, frame + destinationEnd);
+    reply.push_back(0x10);              // I-frame, final; sequence set on send
+    reply.resize(reply.size() + 2);     // HCS
+    reply.insert(reply.end(), info.begin(), info.end());
+    reply.resize(reply.size() + 2);     // FCS
+    reply.push_back(HDLC_FLAG);
+    reply[2] = reply.size() - 2;
+
+    sendReply(reply);
+}
+
+bool SimulatedMeter::chance(float probability) {
+    if (probability <= 0) return false;
+    // xorshift32
+    rng ^= rng << 13;
+    rng ^= rng >> 17;
+    rng ^= rng << 5;
+    return rng < probability * 4294967296.0f;
+}
+
+void SimulatedMeter::answer(const uint8_t* frame, uint16_t length) {
+    stats.requests++;
+
+    Frame key;
+    if (!frameKey(frame, length, key)) return;
+
+    uint8_t control = frame[headerLength(frame, length) - 1];
+    if ((control & 0xEF) == 0x83) {
+        sendSequence = 0;               // SNRM resets the link
+        receiveSequence = 0;
+    } else if (!(control & 0x01)) {
+        receiveSequence = (((control >> 1) & 0x07) + 1) & 0x07;
+    }
+
+    const Exchange* exchange = match(key, false);
+    if (!exchange && (key[0] & 0x03) == 0x03) {
+        // SNRM without parameters, DISC: the recorded UA/DM will do
+        exchange = match(key, true);
+    }
+    if (!exchange) {
+        Frame info;
+        if (compose(key, info)) {
+            stats.composed++;
+            respond(frame, length, info);
+        } else {
+            stats.unmatched++;
+        }
+        return;
+    }
+    for (size_t i = 0; i < exchange->replies.size(); i++) {
+        sendReply(exchange->replies[i]);
+    }
+}
+
+void SimulatedMeter::sendReply(Frame reply) {
+    uint16_t header = headerLength(reply.data(), reply.size());
+    uint8_t& control = reply[header - 1];
+
+    if (!(control & 0x01)) {
+        control = (receiveSequence << 5) | (control & 0x10) | (sendSequence << 1);
+        sendSequence = (sendSequence + 1) & 0x07;
+    } else if ((control & 0x03) == 0x01) {
+        control = (receiveSequence << 5) | (control & 0x1F);
+    }
+    reseal(reply);
+    stats.replies++;
+
+    if (chance(faults.drop)) {
+        stats.dropped++;
+        return;
+    }
+
+    size_t count = reply.size();
+    if (chance(faults.corrupt)) {
+        reply[reply.size() / 2] ^= 0x5A;
+        stats.corrupted++;
+    } else if (chance(faults.truncate)) {
+        count = reply.size() / 2;
+        stats.truncated++;
+    }
+
+    uint64_t start = max(txBusyUntil + turnaroundUs, rxBusyUntil);
+    if (chance(faults.delay)) {
+        start += (uint64_t)faults.delayMs * 1000;
+        stats.delayed++;
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        LineByte b = { start + (uint64_t)(i + 1) * byteUs, reply[i] };
+        line.push_back(b);
+    }
+    // A cut frame still occupies the line for its full length
+    rxBusyUntil = start + (uint64_t)reply.size() * byteUs;
+}
+
+// ============================================
+// TRANSPORT
+// ============================================
+
+bool SimulatedMeter::open() {
+    // Same DTR wake as UartTransport, so poll times match the device
+    HardwareManager::wakeupMeter();
+    return true;
+}
+
+void SimulatedMeter::close() {
+    HardwareManager::sleepMeter();
+}
+
+size_t SimulatedMeter::write(const uint8_t* data, size_t length) {
+    uint64_t start = max(HostClock::now(), txBusyUntil);
+
+    for (size_t i = 0; i < length; i++) {
+        txBusyUntil = start + (uint64_t)(i + 1) * byteUs;
+        HDLCFrameReader::Result result = requestReader.feed(data[i]);
+        if (result == HDLCFrameReader::Result::COMPLETE) {
+            answer(request, requestReader.frameLength());
+        }
+    }
+    return length;
+}
+
+void SimulatedMeter::flush() {
+    HostClock::advanceTo(txBusyUntil);
+}
+
+HDLCFrameReader::Result SimulatedMeter::receiveFrame(uint8_t* buffer, uint16_t capacity,
+                                                     uint16_t& length, uint32_t timeout) {
+    length = 0;
+    replyReader.setBuffer(buffer, capacity);
+
+    uint64_t deadline = HostClock::now() + (uint64_t)timeout * 1000;
+    uint64_t lastByte = HostClock::now();
+    const uint64_t interchar = (uint64_t)HDLC_INTERCHAR_TIMEOUT * 1000;
+
+    while (true) {
+        uint64_t next = line.empty() ? UINT64_MAX : line.front().at;
+
+        if (replyReader.inFrame() && next > lastByte + interchar &&
+            lastByte + interchar < deadline) {
+            HostClock::advanceTo(lastByte + interchar);
+            replyReader.reset();
+            return HDLCFrameReader::Result::TRUNCATED;
+        }
+        if (next >= deadline) {
+            HostClock::advanceTo(deadline);
+            replyReader.reset();
+            return HDLCFrameReader::Result::TIMEOUT;
+        }
+
+        HostClock::advanceTo(next);
+        lastByte = HostClock::now();
+        uint8_t value = line.front().value;
+        line.pop_front();
+
+        HDLCFrameReader::Result result = replyReader.feed(value);
+        switch (result) {
+            case HDLCFrameReader::Result::COMPLETE:
+            case HDLCFrameReader::Result::BAD_FCS:
+                length = replyReader.frameLength();
+                return result;
+            case HDLCFrameReader::Result::BAD_HCS:
+                return result;
+            default:
+                continue;       // Pending, or hunting for the next flag
+        }
+    }
+}
+
+void SimulatedMeter::clearRxBuffer() {
+    // Bytes still on their way arrive after the clear, as on a real line
+    while (!line.empty() && line.front().at <= HostClock::now()) {
+        line.pop_front();
+    }
+    replyReader.reset();
+}
@@ -0,0 +1,166 @@
+/**
+ * @file SimulatedMeter.h
+ * @brief Meter that replays a captured LOG_HEX trace, for the host build
+ * @version 2.0
+ * @date 2025-10-02
+ *
+ * A trace is the serial log of a real poll at DEBUG level: every
+ * "TX [n bytes]: ..." dump is a request, the "RX" dumps up to the next TX
+ * are the meter's answer. Capture with LOG_HEX_BYTES and LOG_RECORD_MAX
+ * raised above MAX_FRAME_SIZE so no frame is cut short; cut frames are
+ * skipped.
+ *
+ * Requests are matched on frame type and information field, not on
+ * position, so a client that skips, repeats or reorders requests still
+ * gets the recorded answers. HDLC sequence numbers in the replies are
+ * rewritten to follow the live link and HCS/FCS recomputed.
+ *
+ * Every attribute a recorded GET (normal or with-list) returned is also
+ * indexed by descriptor, so a GET the trace has no verbatim answer for -
+ * a list grouped differently, or the single GETs of a list fallback - is
+ * answered from that index. Attribute 1 of a known object is its logical
+ * name; an attribute the trace never returned gets temporary-failure, an
+ * object it never mentioned object-undefined. Any other request with no
+ * recorded answer is counted as unmatched: an unrecorded SNRM or DISC
+ * gets the recorded UA, anything else no answer (the client times out).
+ *
+ * Bytes travel at the configured baud rate (10 bits per byte) on the
+ * HostClock; the meter answers after a fixed turnaround. Faults are drawn
+ * per reply frame from a seeded generator, so runs are reproducible.
+ */
+
+#ifndef SIMULATED_METER_H
+#define SIMULATED_METER_H
+
+#include <Arduino.h>
+#include <deque>
+#include <map>
+#include <vector>
+#include "../src/config/config.h"
+#include "../src/config/pins.h"
+#include "../src/hardware/MeterTransport.h"
+
+/**
+ * @struct MeterFaults
+ * @brief Probability per reply frame of each injected fault
+ */
+struct MeterFaults {
+    float drop;             // Frame never sent
+    float corrupt;          // One byte flipped (HCS/FCS error)
+    float truncate;         // Second half never sent (inter-character timeout)
+    float delay;            // Sent late by delayMs
+    uint16_t delayMs;
+    uint32_t seed;
+};
+
+/**
+ * @struct MeterSimStats
+ * @brief What the simulated meter saw and did
+ */
+struct MeterSimStats {
+    uint32_t requests;
+    uint32_t unmatched;     // No recorded answer
+    uint32_t composed;      // GETs answered from the attribute index
+    uint32_t replies;
+    uint32_t dropped;
+    uint32_t corrupted;
+    uint32_t truncated;
+    uint32_t delayed;
+};
+
+/**
+ * @class SimulatedMeter
+ * @brief MeterTransport backed by a replayed trace
+ */
+class SimulatedMeter : public MeterTransport {
+public:
+    SimulatedMeter();
+
+    /**
+     * @brief Load a trace
+     * @param path Serial log with TX/RX hex dumps
+     * @return true if at least one exchange was read
+     */
+    bool loadTrace(const char* path);
+
+    /**
+     * @brief Recorded request/answer pairs
+     */
+    size_t exchangeCount() const { return exchanges.size(); }
+
+    /**
+     * @brief Line rate (default DLMS_BAUD_RATE)
+     */
+    void setBaudRate(uint32_t baudRate);
+
+    /**
+     * @brief Time from the end of a request to the first reply byte
+     */
+    void setTurnaround(uint16_t ms) { turnaroundUs = (uint32_t)ms * 1000; }
+
+    void setFaults(const MeterFaults& config);
+
+    const MeterSimStats& getStats() const { return stats; }
+    void clearStats();
+
+    // MeterTransport
+    bool open() override;
+    void close() override;
+    size_t write(const uint8_t* data, size_t length) override;
+    void flush() override;
+    HDLCFrameReader::Result receiveFrame(uint8_t* buffer, uint16_t capacity,
+                                         uint16_t& length, uint32_t timeout) override;
+    void clearRxBuffer() override;
+
+private:
+    typedef std::vector<uint8_t> Frame;
+
+    struct Exchange {
+        Frame key;                  // Frame type + information field
+        std::vector<Frame> replies;
+    };
+
+    struct LineByte {
+        uint64_t at;                // Arrival time (us)
+        uint8_t value;
+    };
+
+    std::vector<Exchange> exchanges;
+    size_t cursor;                  // Search starts after the last match
+
+    // Descriptor (class, OBIS, attribute) to Get-Data-Result
+    std::map<Frame, Frame> attributes;
+
+    uint32_t byteUs;
+    uint32_t turnaroundUs;
+
+    MeterFaults faults;
+    uint32_t rng;
+    MeterSimStats stats;
+
+    HDLCFrameReader requestReader;  // Client to meter
+    uint8_t request[MAX_FRAME_SIZE];
+    HDLCFrameReader replyReader;    // Meter to client
+    uint64_t txBusyUntil;
+    uint64_t rxBusyUntil;
+    std::deque<LineByte> line;
+
+    // Meter side of the HDLC link
+    uint8_t sendSequence;
+    uint8_t receiveSequence;
+
+    void answer(const uint8_t* frame, uint16_t length);
+    const Exchange* match(const Frame& key, bool typeOnly);
+    void learn(const Exchange& exchange);
+    bool compose(const Frame& key, Frame& info);
+    void addResult(const uint8_t* descriptor, Frame& info);
+    void respond(const uint8_t* frame, uint16_t length, const Frame& info);
+    void sendReply(Frame reply);
+    bool chance(float probability);
+
+    static bool frameKey(const uint8_t* frame, uint16_t length, Frame& key);
+    static uint16_t headerLength(const uint8_t* frame, uint16_t length);
+    static void reseal(Frame& frame);
+};
+
+#endif // SIMULATED_METER_H
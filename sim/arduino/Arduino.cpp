@@ -0,0 +1,214 @@
+/**
+ * @file Arduino.cpp
+ * @brief Host stand-in for the Arduino-ESP32 core
+ * @version 2.0
+ * @date 2025-10-02
+ */
+
+#include "Arduino.h"
+#include <stdarg.h>
+#include <ctype.h>
+
+// ============================================
+// VIRTUAL CLOCK
+// ============================================
+
+static uint64_t clockMicros = 0;
+
+uint64_t HostClock::now() {
+    return clockMicros;
+}
+
+void HostClock::advance(uint64_t us) {
+    clockMicros += us;
+}
+
+void HostClock::advanceTo(uint64_t us) {
+    if (us > clockMicros) clockMicros = us;
+}
+
+unsigned long millis() {
+    return (unsigned long)(clockMicros / 1000);
+}
+
+unsigned long micros() {
+    return (unsigned long)clockMicros;
+}
+
+void delay(uint32_t ms) {
+    clockMicros += (uint64_t)ms * 1000;
+}
+
+void delayMicroseconds(uint32_t us) {
+    clockMicros += us;
+}
+
+void yield() {}
+
+void pinMode(uint8_t pin, uint8_t mode) {}
+void digitalWrite(uint8_t pin, uint8_t value) {}
+int digitalRead(uint8_t pin) { return LOW; }
+
+// ============================================
+// STRING
+// ============================================
+
+void String::fromInteger(long number, unsigned char base) {
+    if (base != DEC) {
+        // Other bases print the 32-bit two's complement, as on the device
+        fromUnsigned((uint32_t)number, base);
+        return;
+    }
+    char text[24];
+    snprintf(text, sizeof(text), "%ld", number);
+    value = text;
+}
+
+void String::fromUnsigned(unsigned long number, unsigned char base) {
+    static const char DIGITS[] = "0123456789abcdefghijklmnopqrstuvwxyz";
+    if (base < 2 || base > 36) base = DEC;
+
+    char text[72];
+    char* p = text + sizeof(text) - 1;
+    *p = '\0';
+    do {
+        *--p = DIGITS[number % base];
+        number /= base;
+    } while (number);
+    value = p;
+}
+
+void String::fromDouble(double number, unsigned int decimals) {
+    char text[48];
+    snprintf(text, sizeof(text), "%.*f", (int)decimals, number);
+    value = text;
+}
+
+bool String::endsWith(const String& suffix) const {
+    return value.size() >= suffix.value.size() &&
+           value.compare(value.size() - suffix.value.size(), suffix.value.size(), suffix.value) == 0;
+}
+
+String String::substring(unsigned int from, unsigned int to) const {
+    if (from > to) std::swap(from, to);
+    if (from >= value.size()) return String();
+    if (to > value.size()) to = value.size();
+    return String(value.substr(from, to - from).c_str());
+}
+
+void String::replace(const String& find, const String& replacement) {
+    if (find.value.empty()) return;
+    size_t at = 0;
+    while ((at = value.find(find.value, at)) != std::string::npos) {
+        value.replace(at, find.value.size(), replacement.value);
+        at += replacement.value.size();
+    }
+}
+
+void String::trim() {
+    size_t first = 0;
+    while (first < value.size() && isspace((unsigned char)value[first])) first++;
+    size_t last = value.size();
+    while (last > first && isspace((unsigned char)value[last - 1])) last--;
+    value = value.substr(first, last - first);
+}
+
+void String::toUpperCase() {
+    for (size_t i = 0; i < value.size(); i++) value[i] = toupper((unsigned char)value[i]);
+}
+
+void String::toLowerCase() {
+    for (size_t i = 0; i < value.size(); i++) value[i] = tolower((unsigned char)value[i]);
+}
+
+String operator+(const String& left, const String& right) {
+    String sum(left);
+    sum.concat(right);
+    return sum;
+}
+
+String operator+(const String& left, const char* right) {
+    String sum(left);
+    sum.concat(right);
+    return sum;
+}
+
+String operator+(const char* left, const String& right) {
+    String sum(left);
+    sum.concat(right);
+    return sum;
+}
+
+String operator+(const String& left, char right) {
+    String sum(left);
+    sum.concat(right);
+    return sum;
+}
+
+// ============================================
+// SERIAL
+// ============================================
+
+size_t Print::write(const uint8_t* data, size_t length) {
+    size_t written = 0;
+    while (length--) written += write(*data++);
+    return written;
+}
+
+size_t Print::printf(const char* format, ...) {
+    char text[512];
+    va_list args;
+    va_start(args, format);
+    int length = vsnprintf(text, sizeof(text), format, args);
+    va_end(args);
+    if (length < 0) return 0;
+    return write((const uint8_t*)text, min((size_t)length, sizeof(text) - 1));
+}
+
+size_t Stream::readBytes(char* buffer, size_t length) {
+    size_t count = 0;
+    while (count < length) {
+        int c = read();
+        if (c < 0) break;
+        buffer[count++] = (char)c;
+    }
+    return count;
+}
+
+size_t HardwareSerial::write(uint8_t c) {
+    return write(&c, 1);
+}
+
+size_t HardwareSerial::write(const uint8_t* data, size_t length) {
+    if (port == 0) fwrite(data, 1, length, stdout);
+    return length;
+}
+
+void HardwareSerial::flush() {
+    if (port == 0) fflush(stdout);
+}
+
+HardwareSerial Serial(0);
+HardwareSerial Serial1(1);
+HardwareSerial Serial2(2);
+
+// ============================================
+// ESP / FREERTOS
+// ============================================
+
+EspClass ESP;
+
+BaseType_t xTaskCreatePinnedToCore(void (*task)(void*), const char* name, uint32_t stack,
+                                   void* parameter, UBaseType_t priority,
+                                   TaskHandle_t* handle, BaseType_t core) {
+    if (handle) *handle = nullptr;
+    return pdFAIL;
+}
+
+void vTaskDelay(TickType_t ticks) {
+    delay(ticks);
+}
+
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t task) {
+    return 0;
+}
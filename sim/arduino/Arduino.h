@@ -0,0 +1,280 @@
+/**
+ * @file Arduino.h
+ * @brief Host stand-in for the parts of the Arduino-ESP32 core the DLMS stack uses
+ * @version 2.0
+ * @date 2025-10-02
+ *
+ * Only built for [env:native]. Time is virtual: millis()/micros() read
+ * HostClock, and delay() advances it instead of sleeping, so a poll that
+ * takes seconds on a real line runs in microseconds and always yields the
+ * same simulated duration. Serial writes to stdout; GPIO calls are no-ops.
+ * FreeRTOS task creation fails, so the logger renders synchronously.
+ */
+
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <algorithm>
+#include <string>
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+#define HIGH            1
+#define LOW             0
+#define INPUT           0x01
+#define OUTPUT          0x03
+#define INPUT_PULLUP    0x05
+
+#define DEC 10
+#define HEX 16
+
+#define SERIAL_8N1      0x800001c
+#define SERIAL_7E1      0x800001a
+
+#define PROGMEM
+#define IRAM_ATTR
+#define RTC_DATA_ATTR
+#define F(text) (text)
+#define pgm_read_byte(address) (*(const uint8_t*)(address))
+#define pgm_read_word(address) (*(const uint16_t*)(address))
+
+using std::min;
+using std::max;
+
+// ============================================
+// VIRTUAL CLOCK
+// ============================================
+
+/**
+ * @namespace HostClock
+ * @brief Simulated time shared by millis(), delay() and the simulated meter
+ */
+namespace HostClock {
+    uint64_t now();                 // Microseconds since start
+    void advance(uint64_t us);
+    void advanceTo(uint64_t us);    // No-op if already past
+}
+
+unsigned long millis();
+unsigned long micros();
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
+void yield();
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t value);
+int digitalRead(uint8_t pin);
+
+// ============================================
+// STRING
+// ============================================
+
+/**
+ * @class String
+ * @brief Arduino String over std::string
+ */
+class String {
+public:
+    String() {}
+    String(const char* text) : value(text ? text : "") {}
+    String(const String& other) : value(other.value) {}
+    explicit String(char c) : value(1, c) {}
+    explicit String(int number, unsigned char base = DEC) { fromInteger(number, base); }
+    explicit String(unsigned int number, unsigned char base = DEC) { fromUnsigned(number, base); }
+    explicit String(long number, unsigned char base = DEC) { fromInteger(number, base); }
+    explicit String(unsigned long number, unsigned char base = DEC) { fromUnsigned(number, base); }
+    explicit String(unsigned char number, unsigned char base = DEC) { fromUnsigned(number, base); }
+    explicit String(float number, unsigned int decimals = 2) { fromDouble(number, decimals); }
+    explicit String(double number, unsigned int decimals = 2) { fromDouble(number, decimals); }
+
+    String& operator=(const String& other) { value = other.value; return *this; }
+    String& operator=(const char* text) { value = text ? text : ""; return *this; }
+
+    const char* c_str() const { return value.c_str(); }
+    unsigned int length() const { return value.size(); }
+    bool isEmpty() const { return value.empty(); }
+    bool reserve(unsigned int size) { value.reserve(size); return true; }
+
+    bool concat(const String& other) { value += other.value; return true; }
+    bool concat(const char* text) { if (text) value += text; return true; }
+    bool concat(const char* text, unsigned int size) { value.append(text, size); return true; }
+    bool concat(char c) { value += c; return true; }
+    bool concat(int number) { return concat(String(number)); }
+    bool concat(unsigned int number) { return concat(String(number)); }
+    bool concat(long number) { return concat(String(number)); }
+    bool concat(unsigned long number) { return concat(String(number)); }
+    bool concat(float number) { return concat(String(number)); }
+    bool concat(double number) { return concat(String(number)); }
+
+    template <typename T>
+    String& operator+=(const T& other) { concat(other); return *this; }
+
+    bool operator==(const String& other) const { return value == other.value; }
+    bool operator==(const char* text) const { return value == (text ? text : ""); }
+    bool operator!=(const String& other) const { return value != other.value; }
+    bool operator!=(const char* text) const { return !(*this == text); }
+    bool operator<(const String& other) const { return value < other.value; }
+    bool equals(const String& other) const { return value == other.value; }
+
+    char operator[](unsigned int index) const { return index < value.size() ? value[index] : 0; }
+    char& operator[](unsigned int index) { return value[index]; }
+    char charAt(unsigned int index) const { return (*this)[index]; }
+
+    int indexOf(char c, unsigned int from = 0) const { return position(value.find(c, from)); }
+    int indexOf(const char* text, unsigned int from = 0) const { return position(value.find(text, from)); }
+    int indexOf(const String& text, unsigned int from = 0) const { return position(value.find(text.value, from)); }
+    int lastIndexOf(char c) const { return position(value.rfind(c)); }
+    bool startsWith(const String& prefix) const { return value.compare(0, prefix.value.size(), prefix.value) == 0; }
+    bool endsWith(const String& suffix) const;
+    String substring(unsigned int from) const { return substring(from, value.size()); }
+    String substring(unsigned int from, unsigned int to) const;
+
+    void remove(unsigned int index) { if (index < value.size()) value.erase(index); }
+    void remove(unsigned int index, unsigned int count) { if (index < value.size()) value.erase(index, count); }
+    void replace(const String& find, const String& replacement);
+    void trim();
+    void toUpperCase();
+    void toLowerCase();
+
+    long toInt() const { return atol(value.c_str()); }
+    float toFloat() const { return (float)atof(value.c_str()); }
+    double toDouble() const { return atof(value.c_str()); }
+
+private:
+    std::string value;
+
+    static int position(size_t found) { return found == std::string::npos ? -1 : (int)found; }
+    void fromInteger(long number, unsigned char base);
+    void fromUnsigned(unsigned long number, unsigned char base);
+    void fromDouble(double number, unsigned int decimals);
+};
+
+String operator+(const String& left, const String& right);
+String operator+(const String& left, const char* right);
+String operator+(const char* left, const String& right);
+String operator+(const String& left, char right);
+
+// ============================================
+// SERIAL
+// ============================================
+
+/**
+ * @class Print
+ * @brief Formatting front end of Serial
+ */
+class Print {
+public:
+    virtual ~Print() {}
+    virtual size_t write(uint8_t c) = 0;
+    virtual size_t write(const uint8_t* data, size_t length);
+    size_t write(const char* text) { return write((const uint8_t*)text, strlen(text)); }
+
+    size_t print(const char* text) { return write(text); }
+    size_t print(const String& text) { return write(text.c_str()); }
+    size_t print(char c) { return write((uint8_t)c); }
+    size_t print(int number, int base = DEC) { return print(String(number, (unsigned char)base)); }
+    size_t print(unsigned int number, int base = DEC) { return print(String(number, (unsigned char)base)); }
+    size_t print(long number, int base = DEC) { return print(String(number, (unsigned char)base)); }
+    size_t print(unsigned long number, int base = DEC) { return print(String(number, (unsigned char)base)); }
+    size_t print(double number, int decimals = 2) { return print(String(number, (unsigned int)decimals)); }
+
+    size_t println() { return write("\r\n"); }
+    template <typename T>
+    size_t println(const T& value) { return print(value) + println(); }
+    template <typename T>
+    size_t println(const T& value, int format) { return print(value, format) + println(); }
+
+    size_t printf(const char* format, ...) __attribute__((format(printf, 2, 3)));
+    virtual void flush() {}
+};
+
+/**
+ * @class Stream
+ * @brief Readable Print
+ */
+class Stream : public Print {
+public:
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int peek() = 0;
+    void setTimeout(unsigned long ms) {}
+    size_t readBytes(char* buffer, size_t length);
+    size_t readBytes(uint8_t* buffer, size_t length) { return readBytes((char*)buffer, length); }
+};
+
+/**
+ * @class HardwareSerial
+ * @brief Console on stdout; other ports read nothing and discard writes
+ */
+class HardwareSerial : public Stream {
+public:
+    explicit HardwareSerial(int port) : port(port) {}
+
+    void begin(unsigned long baudRate, uint32_t config = SERIAL_8N1,
+               int8_t rxPin = -1, int8_t txPin = -1) {}
+    void end() {}
+    int available() override { return 0; }
+    int read() override { return -1; }
+    int peek() override { return -1; }
+
+    using Print::write;
+    size_t write(uint8_t c) override;
+    size_t write(const uint8_t* data, size_t length) override;
+    void flush() override;
+    operator bool() const { return true; }
+
+private:
+    int port;
+};
+
+extern HardwareSerial Serial;
+extern HardwareSerial Serial1;
+extern HardwareSerial Serial2;
+
+// ============================================
+// ESP / FREERTOS
+// ============================================
+
+class EspClass {
+public:
+    uint32_t getFreeHeap() { return 0; }
+    uint32_t getMinFreeHeap() { return 0; }
+    uint32_t getMaxAllocHeap() { return 0; }
+    uint32_t getHeapSize() { return 0; }
+    uint32_t getCpuFreqMHz() { return 240; }
+    uint32_t getCycleCount() { return (uint32_t)(HostClock::now() * 240); }
+    void restart() { exit(0); }
+};
+
+extern EspClass ESP;
+
+typedef void* TaskHandle_t;
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+
+#define pdTRUE          1
+#define pdFALSE         0
+#define pdPASS          pdTRUE
+#define pdFAIL          pdFALSE
+#define portMAX_DELAY   0xFFFFFFFF
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms))
+
+/**
+ * @brief Always fails: the host build runs single-threaded
+ */
+BaseType_t xTaskCreatePinnedToCore(void (*task)(void*), const char* name, uint32_t stack,
+                                   void* parameter, UBaseType_t priority,
+                                   TaskHandle_t* handle, BaseType_t core);
+void vTaskDelay(TickType_t ticks);
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t task);
+
+#endif // HOST_ARDUINO_H
@@ -0,0 +1,406 @@
+/**
+ * @file bench.cpp
+ * @brief Host benchmark of the DLMS stack against a replayed meter
+ * @version 2.0
+ * @date 2025-10-02
+ *
+ * Built by [env:native]. Runs connect/readMeterData/disconnect polls
+ * through SimulatedMeter and reports, per poll, frames and bytes each
+ * way, link errors, simulated time of readMeterData and of the whole
+ * poll, and heap allocations; then host throughput of CRC, HDLC frame
+ * parsing, A-XDR decoding and payload encoding.
+ *
+ * Simulated times come from the virtual clock and are the same on every
+ * run and machine, so they can be compared across commits. Throughput is
+ * host CPU time and only meaningful relative to another run on the same
+ * machine. Allocations count operator new (String and containers), not
+ * malloc, and only the stack's: the simulated meter's own work is not
+ * counted, so a steady-state poll should show 0.
+ *
+ *   .pio/build/native/program [options]
+ *     --trace FILE       LOG_HEX capture to replay (sim/traces/sample.log)
+ *     --polls N          Polls to run (5)
+ *     --baud RATE        Line rate (the rate the stack opens)
+ *     --turnaround MS    Meter response latency (20)
+ *     --drop P           Probability per reply frame of losing it
+ *     --corrupt P        ... of a flipped byte
+ *     --truncate P       ... of the frame stopping halfway
+ *     --delay P:MS       ... of replying MS late
+ *     --seed N           Fault generator seed (1)
+ *     --verbose          DEBUG logging
+ */
+
+#include <Arduino.h>
+#include <chrono>
+#include <new>
+#include "SimulatedMeter.h"
+#include "../src/config/config.h"
+#include "../src/hardware/HardwareManager.h"
+#include "../src/dlms/DLMSProtocol.h"
+#include "../src/dlms/AXDR.h"
+#include "../src/data/MeterData.h"
+#include "../src/data/PayloadEncoder.h"
+#include "../src/utils/CRCCalculator.h"
+#include "../src/utils/HDLCFrameReader.h"
+#include "../src/utils/Logger.h"
+
+// ============================================
+// ALLOCATION COUNTING
+// ============================================
+
+static uint32_t allocations = 0;
+static uint32_t countingPaused = 0;     // Nesting depth inside the meter
+
+void* operator new(size_t size) {
+    if (countingPaused == 0) allocations++;
+    void* p = malloc(size ? size : 1);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+
+void* operator new[](size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void* p) noexcept { free(p); }
+void operator delete[](void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+void operator delete[](void* p, size_t) noexcept { free(p); }
+
+/**
+ * @class UncountedTransport
+ * @brief Forwards to the simulated meter with allocation counting paused
+ */
+class UncountedTransport : public MeterTransport {
+public:
+    explicit UncountedTransport(MeterTransport& target) : meter(target) {}
+
+    bool open() override { Pause p; return meter.open(); }
+    void close() override { Pause p; meter.close(); }
+    size_t write(const uint8_t* data, size_t length) override {
+        Pause p;
+        return meter.write(data, length);
+    }
+    void flush() override { Pause p; meter.flush(); }
+    HDLCFrameReader::Result receiveFrame(uint8_t* buffer, uint16_t capacity,
+                                         uint16_t& length, uint32_t timeout) override {
+        Pause p;
+        return meter.receiveFrame(buffer, capacity, length, timeout);
+    }
+    void clearRxBuffer() override { Pause p; meter.clearRxBuffer(); }
+
+private:
+    struct Pause {
+        Pause() { countingPaused++; }
+        ~Pause() { countingPaused--; }
+    };
+
+    MeterTransport& meter;
+};
+
+// ============================================
+// OPTIONS
+// ============================================
+
+struct BenchOptions {
+    const char* trace;
+    uint32_t polls;
+    uint32_t baudRate;
+    uint16_t turnaround;
+    MeterFaults faults;
+    bool verbose;
+};
+
+static bool parseOptions(int argc, char** argv, BenchOptions& options) {
+    options.trace = "sim/traces/sample.log";
+    options.polls = 5;
+    options.baudRate = 0;
+    options.turnaround = 20;
+    options.faults = MeterFaults();
+    options.faults.seed = 1;
+    options.verbose = false;
+
+    for (int i = 1; i < argc; i++) {
+        const char* option = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+
+        if (!strcmp(option, "--verbose")) {
+            options.verbose = true;
+            continue;
+        }
+        if (!value) {
+            fprintf(stderr, "%s needs a value\n", option);
+            return false;
+        }
+        i++;
+
+        if (!strcmp(option, "--trace"))           options.trace = value;
+        else if (!strcmp(option, "--polls"))      options.polls = strtoul(value, nullptr, 10);
+        else if (!strcmp(option, "--baud"))       options.baudRate = strtoul(value, nullptr, 10);
+        else if (!strcmp(option, "--turnaround")) options.turnaround = strtoul(value, nullptr, 10);
+        else if (!strcmp(option, "--drop"))       options.faults.drop = atof(value);
+        else if (!strcmp(option, "--corrupt"))    options.faults.corrupt = atof(value);
+        else if (!strcmp(option, "--truncate"))   options.faults.truncate = atof(value);
+        else if (!strcmp(option, "--seed"))       options.faults.seed = strtoul(value, nullptr, 10);
+        else if (!strcmp(option, "--delay")) {
+            options.faults.delay = atof(value);
+            const char* ms = strchr(value, ':');
+            options.faults.delayMs = ms ? strtoul(ms + 1, nullptr, 10) : 2 * COMMAND_TIMEOUT;
+        } else {
+            fprintf(stderr, "Unknown option %s\n", option);
+            return false;
+        }
+    }
+    return true;
+}
+
+// ============================================
+// POLLS
+// ============================================
+
+/**
+ * @struct PollResult
+ * @brief One connect/read/disconnect cycle
+ */
+struct PollResult {
+    bool ok;
+    uint32_t framesTx;
+    uint32_t framesRx;
+    uint32_t bytesTx;
+    uint32_t bytesRx;
+    uint32_t errors;        // Retries, CRC errors, timeouts, framing errors
+    uint32_t readMs;        // readMeterData alone
+    uint32_t pollMs;        // Association to release
+    uint32_t allocations;   // During readMeterData
+    uint32_t unmatched;     // Requests the trace had no answer for
+};
+
+static PollResult runPoll(DLMSProtocol& dlms, SimulatedMeter& meter, MeterData& data) {
+    static LinkMetrics before;
+    before = dlms.getMetrics();
+    uint32_t unmatched = meter.getStats().unmatched;
+
+    PollResult result = PollResult();
+    uint64_t start = HostClock::now();
+
+    result.ok = dlms.connect();
+    if (result.ok) {
+        uint64_t readStart = HostClock::now();
+        uint32_t allocationsBefore = allocations;
+        result.ok = dlms.readMeterData(data);
+        result.allocations = allocations - allocationsBefore;
+        result.readMs = (HostClock::now() - readStart) / 1000;
+    }
+    dlms.disconnect();
+    result.pollMs = (HostClock::now() - start) / 1000;
+
+    const LinkMetrics& after = dlms.getMetrics();
+    result.framesTx = after.framesTx - before.framesTx;
+    result.framesRx = after.framesRx - before.framesRx;
+    result.bytesTx = after.bytesTx - before.bytesTx;
+    result.bytesRx = after.bytesRx - before.bytesRx;
+    result.errors = (after.retries - before.retries) +
+                    (after.crcErrors - before.crcErrors) +
+                    (after.timeouts - before.timeouts) +
+                    (after.frameErrors - before.frameErrors);
+    result.unmatched = meter.getStats().unmatched - unmatched;
+    return result;
+}
+
+// ============================================
+// THROUGHPUT
+// ============================================
+
+static volatile uint32_t sink;
+
+/**
+ * @brief Calls per second of body, timed for about 200 ms of host time
+ */
+template <typename Body>
+static double callsPerSecond(Body body) {
+    typedef std::chrono::steady_clock Clock;
+    Clock::time_point start = Clock::now();
+    uint32_t calls = 0;
+    double elapsed;
+    do {
+        for (uint8_t i = 0; i < 64; i++) body();
+        calls += 64;
+        elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+    } while (elapsed < 0.2);
+    return calls / elapsed;
+}
+
+/**
+ * @brief Valid HDLC frame with a filled information field
+ */
+static uint16_t buildFrame(uint8_t* frame, uint16_t infoLength) {
+    uint16_t header = 8;                        // Flag, format, addresses, control
+    uint16_t length = header + 2 + infoLength + 3;
+    frame[0] = HDLC_FLAG;
+    frame[1] = 0xA0 | (((length - 2) >> 8) & 0x07);
+    frame[2] = (length - 2) & 0xFF;
+    frame[3] = 0x00;
+    frame[4] = 0x02;
+    frame[5] = 0x00;
+    frame[6] = 0x21;
+    frame[7] = 0x13;
+    CRCCalculator::put(&frame[header], CRCCalculator::calculate(&frame[1], header - 1));
+    for (uint16_t i = 0; i < infoLength; i++) {
+        frame[header + 2 + i] = (uint8_t)(i * 37 + 11);
+    }
+    CRCCalculator::put(&frame[length - 3], CRCCalculator::calculate(&frame[1], length - 4));
+    frame[length - 1] = HDLC_FLAG;
+    return length;
+}
+
+/**
+ * @brief Array of profile-like rows: date-time plus four double-long-unsigned
+ */
+static uint16_t buildProfile(uint8_t* data, uint8_t rows) {
+    uint16_t n = 0;
+    data[n++] = AXDRTag::ARRAY;
+    data[n++] = rows;
+    for (uint8_t r = 0; r < rows; r++) {
+        data[n++] = AXDRTag::STRUCTURE;
+        data[n++] = 5;
+        data[n++] = AXDRTag::OCTET_STRING;
+        data[n++] = 12;
+        const uint8_t stamp[12] = { 0x07, 0xE9, 10, 2, 4, 12, (uint8_t)(r % 4 * 15), 0, 0xFF, 0x80, 0x00, 0x00 };
+        memcpy(&data[n], stamp, sizeof(stamp));
+        n += sizeof(stamp);
+        for (uint8_t v = 0; v < 4; v++) {
+            uint32_t value = 100000UL * v + r;
+            data[n++] = AXDRTag::UINT32;
+            data[n++] = value >> 24;
+            data[n++] = value >> 16;
+            data[n++] = value >> 8;
+            data[n++] = value;
+        }
+    }
+    return n;
+}
+
+static void reportThroughput(const MeterData& data) {
+    static uint8_t frame[MAX_FRAME_SIZE];
+    static uint8_t parsed[MAX_FRAME_SIZE];
+    static uint8_t profile[48 * 36 + 2];
+    static uint8_t payload[2048];
+
+    uint16_t frameLength = buildFrame(frame, HDLC_MAX_INFO_RX - 16);
+    uint16_t profileLength = buildProfile(profile, 48);
+
+    double crc = callsPerSecond([&]() {
+        sink = CRCCalculator::calculate(frame, frameLength);
+    });
+
+    HDLCFrameReader reader;
+    double frames = callsPerSecond([&]() {
+        reader.setBuffer(parsed, sizeof(parsed));
+        for (uint16_t i = 0; i < frameLength; i++) {
+            if (reader.feed(frame[i]) == HDLCFrameReader::Result::COMPLETE) sink = i;
+        }
+    });
+
+    double decodes = callsPerSecond([&]() {
+        AXDRReader top(profile, profile + profileLength);
+        AXDRValue array, row, field;
+        if (!top.next(array, AXDRTag::ARRAY)) return;
+        AXDRReader rows = array.elements();
+        while (rows.next(row)) {
+            AXDRReader fields = row.elements();
+            while (fields.next(field)) {
+                float value;
+                if (field.toFloat(value)) sink = (uint32_t)value;
+            }
+        }
+    });
+
+    size_t payloadLength = 0;
+    double encodes = callsPerSecond([&]() {
+        payloadLength = PayloadEncoder::encodeMeterData(data, true, payload, sizeof(payload));
+    });
+
+    // Into a buffer as the uplinks do: stack document, no heap
+    size_t jsonLength = 0;
+    double jsons = callsPerSecond([&]() {
+        StaticJsonDocument<MeterData::JSON_CAPACITY> doc;
+        data.toJson(doc, true);
+        jsonLength = serializeJson(doc, (char*)payload, sizeof(payload));
+    });
+
+    printf("\nThroughput (host CPU)\n");
+    printf("  CRC-16          %8.1f MB/s   (%u byte frame)\n",
+           crc * frameLength / 1e6, frameLength);
+    printf("  HDLC frame read %8.1f MB/s\n", frames * frameLength / 1e6);
+    printf("  A-XDR decode    %8.1f MB/s   (48 profile rows, %u bytes)\n",
+           decodes * profileLength / 1e6, profileLength);
+    printf("  Binary encode   %8.0f /s     (%u bytes)\n", encodes, (unsigned)payloadLength);
+    printf("  JSON encode     %8.0f /s     (%u bytes)\n", jsons, (unsigned)jsonLength);
+}
+
+// ============================================
+// MAIN
+// ============================================
+
+int main(int argc, char** argv) {
+    BenchOptions options;
+    if (!parseOptions(argc, argv, options)) return 2;
+
+    Logger::begin(options.verbose ? Logger::DEBUG : Logger::ERROR);
+    Logger::enableColors(false);
+
+    static SimulatedMeter meter;
+    if (!meter.loadTrace(options.trace)) return 1;
+    if (options.baudRate) meter.setBaudRate(options.baudRate);
+    meter.setTurnaround(options.turnaround);
+    meter.setFaults(options.faults);
+
+    HardwareManager::begin();
+
+    static DLMSProtocol dlms;
+    static MeterData data;
+    static UncountedTransport transport(meter);
+    dlms.setTransport(&transport);
+    dlms.begin();
+
+    printf("\nTrace %s: %u exchanges\n\n", options.trace, (unsigned)meter.exchangeCount());
+    printf("poll ok frames_tx frames_rx bytes_tx bytes_rx errors read_ms poll_ms allocs unmatched\n");
+
+    PollResult total = PollResult();
+    uint32_t okCount = 0;
+    for (uint32_t i = 0; i < options.polls; i++) {
+        PollResult r = runPoll(dlms, meter, data);
+        printf("%4u %2u %9u %9u %8u %8u %6u %7u %7u %6u %9u\n",
+               i, r.ok, r.framesTx, r.framesRx, r.bytesTx, r.bytesRx, r.errors,
+               r.readMs, r.pollMs, r.allocations, r.unmatched);
+
+        okCount += r.ok;
+        total.framesTx += r.framesTx;
+        total.framesRx += r.framesRx;
+        total.bytesTx += r.bytesTx;
+        total.bytesRx += r.bytesRx;
+        total.errors += r.errors;
+        total.readMs += r.readMs;
+        total.pollMs += r.pollMs;
+        total.allocations += r.allocations;
+        total.unmatched += r.unmatched;
+    }
+
+    if (options.polls) {
+        float n = options.polls;
+        printf("mean %2.0f%% %9.1f %9.1f %8.0f %8.0f %6.1f %7.0f %7.0f %6.0f %9.1f\n",
+               100.0f * okCount / n, total.framesTx / n, total.framesRx / n,
+               total.bytesTx / n, total.bytesRx / n, total.errors / n,
+               total.readMs / n, total.pollMs / n, total.allocations / n,
+               total.unmatched / n);
+    }
+
+    const MeterSimStats& stats = meter.getStats();
+    printf("\nMeter: %u requests (%u composed), %u replies; injected %u dropped, "
+           "%u corrupted, %u truncated, %u delayed\n",
+           stats.requests, stats.composed, stats.replies, stats.dropped,
+           stats.corrupted, stats.truncated, stats.delayed);
+
+    reportThroughput(data);
+    return okCount == options.polls ? 0 : 1;
+}
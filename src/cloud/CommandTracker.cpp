@@ -0,0 +1,228 @@
+/**
+ * @file CommandTracker.cpp
+ * @brief Implementation of command decoding and coalescing
+ * @version 2.0
+ * @date 2025-10-02
+ */
+
+#include "CommandTracker.h"
+#include "../dlms/ReadPlan.h"
+#include <ArduinoJson.h>
+#include <strings.h>
+
+static const struct {
+    const char* name;
+    CommandType type;
+} COMMAND_NAMES[] = {
+    { "read",        CommandType::READ },
+    { "status",      CommandType::STATUS },
+    { "clear_cache", CommandType::CLEAR_CACHE },
+    { "restart",     CommandType::RESTART }
+};
+
+static const uint8_t COMMAND_COUNT = sizeof(COMMAND_NAMES) / sizeof(COMMAND_NAMES[0]);
+
+/**
+ * @brief Command by name, any case
+ */
+static bool lookupCommand(const char* name, size_t length, CommandType& type) {
+    for (uint8_t i = 0; i < COMMAND_COUNT; i++) {
+        if (strlen(COMMAND_NAMES[i].name) == length &&
+            strncasecmp(COMMAND_NAMES[i].name, name, length) == 0) {
+            type = COMMAND_NAMES[i].type;
+            return true;
+        }
+    }
+    return false;
+}
+
+// ============================================
+// REQUEST
+// ============================================
+
+bool CommandRequest::sameAs(const CommandRequest& other) const {
+    return type == other.type && meter == other.meter && count == other.count &&
+           memcmp(registers, other.registers, count) == 0;
+}
+
+// ============================================
+// DECODING
+// ============================================
+
+bool CommandTracker::parse(const uint8_t* payload, unsigned int length,
+                           CommandRequest& request, const char*& error) {
+    memset(&request, 0, sizeof(request));
+    error = nullptr;
+
+    // Skip surrounding whitespace of plain-text commands
+    while (length > 0 && isspace(payload[length - 1])) length--;
+    while (length > 0 && isspace(payload[0])) {
+        payload++;
+        length--;
+    }
+
+    if (length == 0) {
+        error = "empty command";
+        return false;
+    }
+
+    if (payload[0] != '{') {
+        if (!lookupCommand((const char*)payload, length, request.type)) {
+            error = "unknown command";
+            return false;
+        }
+        return true;
+    }
+
+    // id, cmd, meter and COMMAND_MAX_REGISTERS register names
+    StaticJsonDocument<512> doc;
+    if (deserializeJson(doc, payload, length)) {
+        error = "invalid JSON";
+        return false;
+    }
+
+    JsonVariantConst id = doc["id"].as<JsonVariantConst>();
+    if (id.is<const char*>()) {
+        strncpy(request.id, id.as<const char*>(), sizeof(request.id) - 1);
+    } else if (id.is<long>()) {
+        snprintf(request.id, sizeof(request.id), "%ld", id.as<long>());
+    }
+
+    const char* cmd = doc["cmd"] | "";
+    if (!lookupCommand(cmd, strlen(cmd), request.type)) {
+        error = "unknown command";
+        return false;
+    }
+
+    int meter = doc["meter"] | 0;
+    if (meter < 0 || meter >= (METER_BUS_SIZE > 0 ? METER_BUS_SIZE : 1)) {
+        error = "unknown meter";
+        return false;
+    }
+    request.meter = meter;
+
+    JsonArrayConst registers = doc["registers"].as<JsonArrayConst>();
+    if (registers.size() > 0 && request.type != CommandType::READ) {
+        error = "registers only apply to read";
+        return false;
+    }
+    if (registers.size() > COMMAND_MAX_REGISTERS) {
+        error = "too many registers";
+        return false;
+    }
+
+    for (JsonVariantConst name : registers) {
+        const char* text = name.as<const char*>();
+        int index = text ? resolveRegister(text) : -1;
+        if (index < 0) {
+            error = "unknown register";
+            return false;
+        }
+
+        // Duplicates would read the same register twice
+        bool listed = false;
+        for (uint8_t i = 0; i < request.count; i++) {
+            if (request.registers[i] == index) listed = true;
+        }
+        if (!listed) request.registers[request.count++] = index;
+    }
+
+    return true;
+}
+
+int CommandTracker::resolveRegister(const char* name) {
+    int index = ReadPlan::find(name);
+    if (index >= 0 || !isdigit((uint8_t)name[0])) return index;
+
+    // Six decimal groups, any of the usual separators between them
+    uint8_t bytes[6];
+    uint8_t group = 0;
+    const char* p = name;
+    while (group < 6) {
+        if (!isdigit((uint8_t)*p)) return -1;
+        unsigned value = 0;
+        while (isdigit((uint8_t)*p)) {
+            value = value * 10 + (*p++ - '0');
+            if (value > 255) return -1;
+        }
+        bytes[group++] = value;
+
+        if (group < 6) {
+            if (*p != '.' && *p != '-' && *p != ':' && *p != '*') return -1;
+            p++;
+        }
+    }
+    if (*p != '\0') return -1;
+
+    for (uint8_t i = 0; i < ReadPlan::size(); i++) {
+        if (memcmp(ReadPlan::entry(i).obis->bytes, bytes, sizeof(bytes)) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+const char* CommandTracker::typeName(CommandType type) {
+    for (uint8_t i = 0; i < COMMAND_COUNT; i++) {
+        if (COMMAND_NAMES[i].type == type) return COMMAND_NAMES[i].name;
+    }
+    return "unknown";
+}
+
+// ============================================
+// SLOTS
+// ============================================
+
+CommandTracker::CommandTracker() {
+    memset(slots, 0, sizeof(slots));
+}
+
+int CommandTracker::open(const CommandRequest& request, bool& joined) {
+    joined = false;
+    int free = -1;
+
+    for (uint8_t i = 0; i < SLOTS; i++) {
+        Slot& slot = slots[i];
+        if (!slot.used) {
+            if (free < 0) free = i;
+            continue;
+        }
+        if (!slot.request.sameAs(request)) continue;
+
+        // Identical work already pending: wait for its result
+        if (slot.waiters >= COMMAND_MAX_WAITERS) return -1;
+        memcpy(slot.ids[slot.waiters++], request.id, COMMAND_ID_SIZE);
+        joined = true;
+        return i;
+    }
+
+    if (free < 0) return -1;
+
+    Slot& slot = slots[free];
+    slot.used = true;
+    slot.request = request;
+    slot.waiters = 1;
+    memcpy(slot.ids[0], request.id, COMMAND_ID_SIZE);
+    return free;
+}
+
+void CommandTracker::close(uint8_t slot) {
+    if (slot < SLOTS) {
+        slots[slot].used = false;
+        slots[slot].waiters = 0;
+    }
+}
+
+int CommandTracker::find(CommandType type) const {
+    for (uint8_t i = 0; i < SLOTS; i++) {
+        if (slots[i].used && slots[i].request.type == type) return i;
+    }
+    return -1;
+}
+
+bool CommandTracker::busy() const {
+    for (uint8_t i = 0; i < SLOTS; i++) {
+        if (slots[i].used) return true;
+    }
+    return false;
+}
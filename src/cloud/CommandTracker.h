@@ -0,0 +1,141 @@
+/**
+ * @file CommandTracker.h
+ * @brief Remote command decoding and coalescing of duplicate requests
+ * @version 2.0
+ * @date 2025-10-02
+ *
+ * Commands arrive on the command topic either as plain text ("READ",
+ * "STATUS", "CLEAR_CACHE", "RESTART") or as JSON:
+ *
+ *   { "id": "42", "cmd": "read", "meter": 1, "registers": ["kwh_import", "1.0.32.7.0.255"] }
+ *
+ * "meter" is the bus index (default 0), "registers" names read plan keys
+ * or OBIS codes of the register table and makes the read a targeted
+ * one; without it every tier is read. The id is echoed in the response.
+ *
+ * Every request that needs an answer occupies a slot until its result
+ * is in. A request identical to one still in a slot does not run again:
+ * it joins the slot and is answered by the same result.
+ */
+
+#ifndef COMMAND_TRACKER_H
+#define COMMAND_TRACKER_H
+
+#include <Arduino.h>
+#include "../config/config.h"
+
+/**
+ * @enum CommandType
+ * @brief Remote commands
+ */
+enum class CommandType : uint8_t {
+    READ,           // Metering task: full or targeted read
+    STATUS,         // Network task: status and last reading
+    CLEAR_CACHE,    // Metering task: drop the scaler cache
+    RESTART
+};
+
+/**
+ * @struct CommandRequest
+ * @brief A decoded command
+ */
+struct CommandRequest {
+    CommandType type;
+    uint8_t meter;                              // Bus index (0 without a bus)
+    uint8_t count;                              // Targeted registers, 0 = full read
+    uint8_t registers[COMMAND_MAX_REGISTERS];   // ReadPlan table indices
+    char id[COMMAND_ID_SIZE];                   // Correlation id ("" if none)
+
+    /**
+     * @brief Same work as another request (ids aside)
+     */
+    bool sameAs(const CommandRequest& other) const;
+};
+
+/**
+ * @class CommandTracker
+ * @brief Requests waiting for their result (network task only)
+ */
+class CommandTracker {
+public:
+    static const uint8_t SLOTS = COMMAND_QUEUE_DEPTH;
+
+    /**
+     * @brief Constructor - no request pending
+     */
+    CommandTracker();
+
+    /**
+     * @brief Decode a command message
+     * @param payload Message bytes (not terminated)
+     * @param length Message length
+     * @param request Output
+     * @param error Output: reason when decoding fails
+     * @return true if request holds a valid command
+     */
+    static bool parse(const uint8_t* payload, unsigned int length,
+                      CommandRequest& request, const char*& error);
+
+    /**
+     * @brief Command name for responses ("read", "status", ...)
+     */
+    static const char* typeName(CommandType type);
+
+    /**
+     * @brief Take a request
+     * @param request Decoded request
+     * @param joined Output: an identical request was pending and now
+     *        answers this one too (nothing new to run)
+     * @return Slot, or -1 if no slot (or no room among the waiters) is free
+     */
+    int open(const CommandRequest& request, bool& joined);
+
+    /**
+     * @brief Release a slot once its waiters are answered
+     */
+    void close(uint8_t slot);
+
+    /**
+     * @brief Pending slot of a type, or -1
+     */
+    int find(CommandType type) const;
+
+    /**
+     * @brief Request of a pending slot
+     */
+    const CommandRequest& request(uint8_t slot) const { return slots[slot].request; }
+
+    /**
+     * @brief Requests answered by a slot (the first one included)
+     */
+    uint8_t waiters(uint8_t slot) const { return slots[slot].waiters; }
+
+    /**
+     * @brief Correlation id of one waiter
+     */
+    const char* waiterId(uint8_t slot, uint8_t index) const { return slots[slot].ids[index]; }
+
+    /**
+     * @brief Any request pending
+     */
+    bool busy() const;
+
+private:
+    struct Slot {
+        bool used;
+        CommandRequest request;
+        uint8_t waiters;
+        char ids[COMMAND_MAX_WAITERS][COMMAND_ID_SIZE];
+    };
+
+    Slot slots[SLOTS];
+
+    /**
+     * @brief Table index of a read plan key or OBIS code ("1.0.1.8.0.255",
+     *        "1-0:1.8.0*255")
+     * @return Index or -1
+     */
+    static int resolveRegister(const char* name);
+};
+
+#endif // COMMAND_TRACKER_H
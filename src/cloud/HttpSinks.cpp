@@ -0,0 +1,196 @@
+/**
+ * @file HttpSinks.cpp
+ * @brief Implementation of the REST API and ThingSpeak backends
+ * @version 2.0
+ * @date 2025-10-02
+ */
+
+// Host build ([env:native]) has no HTTP client
+#ifndef NATIVE_BUILD
+
+#include "HttpSinks.h"
+#include "../utils/Logger.h"
+#include <ArduinoJson.h>
+
+// ============================================
+// REST API
+// ============================================
+
+/**
+ * @class JsonBodyStream
+ * @brief Request body read straight out of a JSON document
+ *
+ * HTTPClient pulls the body through Stream::read. Each refill serializes
+ * the document again into a JSON_STREAM_CHUNK window, skipping what was
+ * already handed out, so no copy of the whole body is ever held.
+ */
+class JsonBodyStream : public Stream {
+public:
+    JsonBodyStream(const JsonDocument& doc, size_t length)
+        : doc(doc), length(length), position(0), head(0), tail(0) {}
+
+    using Print::write;
+
+    int available() override { return (int)(length - position); }
+
+    int read() override {
+        if (!fill()) return -1;
+        position++;
+        return window[head++];
+    }
+
+    int peek() override { return fill() ? window[head] : -1; }
+
+    size_t write(uint8_t) override { return 0; }
+
+private:
+    /**
+     * @brief Print that drops the first `skip` bytes and keeps what fits
+     */
+    class Window : public Print {
+    public:
+        Window(uint8_t* buffer, size_t size, size_t skip)
+            : buffer(buffer), size(size), skip(skip), used(0) {}
+
+        using Print::write;
+
+        size_t write(uint8_t c) override {
+            if (skip > 0) {
+                skip--;
+            } else if (used < size) {
+                buffer[used++] = c;
+            }
+            return 1;
+        }
+
+        size_t kept() const { return used; }
+
+    private:
+        uint8_t* buffer;
+        size_t size;
+        size_t skip;
+        size_t used;
+    };
+
+    bool fill() {
+        if (head < tail) return true;
+        if (position >= length) return false;
+
+        Window out(window, sizeof(window), position);
+        serializeJson(doc, out);
+        head = 0;
+        tail = out.kept();
+        return tail > 0;
+    }
+
+    const JsonDocument& doc;
+    size_t length;
+    size_t position;
+    uint8_t window[JSON_STREAM_CHUNK];
+    size_t head;
+    size_t tail;
+};
+
+HttpSink::HttpSink()
+    : UplinkSink("HTTP", LogCursor::HTTP, HTTP_MIN_INTERVAL) {
+    http.setReuse(true);
+}
+
+bool HttpSink::deliver(const MeterData& data) {
+    StaticJsonDocument<MeterData::JSON_CAPACITY> doc;
+    data.toJson(doc, false);
+
+    if (!http.begin(client, API_ENDPOINT)) {
+        LOG_ERROR("HTTP endpoint invalid");
+        return false;
+    }
+    http.addHeader("Content-Type", "application/json");
+    http.addHeader("X-API-Key", API_KEY);
+    http.setTimeout(HTTP_TIMEOUT);
+
+    // Content-Length up front, body serialized as the client sends it
+    size_t length = measureJson(doc);
+    JsonBodyStream body(doc, length);
+    int httpCode = http.sendRequest("POST", &body, length);
+    bool ok = httpCode == HTTP_CODE_OK || httpCode == HTTP_CODE_CREATED;
+    if (httpCode > 0) {
+        LOG_DEBUGF("HTTP response code %d", httpCode);
+    } else {
+        LOG_ERROR("HTTP POST failed: " + http.errorToString(httpCode));
+    }
+
+    // Keeps the connection for the next reading when the server allows it
+    http.end();
+    return ok;
+}
+
+// ============================================
+// THINGSPEAK
+// ============================================
+
+/**
+ * @class ReplyText
+ * @brief Keeps the start of a response body, discards the rest
+ *
+ * writeToStream undoes chunked transfer encoding and drains the body, so
+ * the kept-alive connection is clean for the next update.
+ */
+class ReplyText : public Stream {
+public:
+    ReplyText() : used(0) { text[0] = '\0'; }
+
+    using Print::write;
+
+    int available() override { return 0; }
+    int read() override { return -1; }
+    int peek() override { return -1; }
+
+    size_t write(uint8_t c) override {
+        if (used < sizeof(text) - 1) {
+            text[used++] = (char)c;
+            text[used] = '\0';
+        }
+        return 1;
+    }
+
+    char text[16];
+
+private:
+    size_t used;
+};
+
+ThingSpeakSink::ThingSpeakSink()
+    : UplinkSink("ThingSpeak", LogCursor::THINGSPEAK, THINGSPEAK_MIN_INTERVAL) {
+    http.setReuse(true);
+}
+
+bool ThingSpeakSink::deliver(const MeterData& data) {
+    char url[256];
+    snprintf(url, sizeof(url),
+             "http://api.thingspeak.com/update?api_key=%s"
+             "&field1=%.3f&field2=%.2f&field3=%.3f&field4=%.3f&field5=%.2f&field6=%.3f",
+             THINGSPEAK_API_KEY, data.kwhImport, data.voltageR, data.currentR,
+             data.powerFactor, data.frequency, data.mdKWImport.value);
+
+    if (!http.begin(client, url)) {
+        LOG_ERROR("ThingSpeak URL invalid");
+        return false;
+    }
+    http.setTimeout(HTTP_TIMEOUT);
+
+    // ThingSpeak answers 200 with entry id "0" when it drops an update
+    int httpCode = http.GET();
+    bool ok = httpCode == HTTP_CODE_OK;
+    if (ok) {
+        ReplyText reply;
+        ok = http.writeToStream(&reply) > 0 && strcmp(reply.text, "0") != 0;
+    }
+    if (!ok) {
+        LOG_ERRORF("ThingSpeak update rejected (%d)", httpCode);
+    }
+
+    http.end();
+    return ok;
+}
+
+#endif // NATIVE_BUILD
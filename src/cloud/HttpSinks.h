@@ -0,0 +1,54 @@
+/**
+ * @file HttpSinks.h
+ * @brief REST API and ThingSpeak uplink backends
+ * @version 2.0
+ * @date 2025-10-02
+ *
+ * Both keep their TCP connection open between requests (HTTP/1.1
+ * keep-alive), so a burst of stored readings costs one handshake.
+ */
+
+#ifndef HTTP_SINKS_H
+#define HTTP_SINKS_H
+
+#include "UplinkSink.h"
+
+#ifndef NATIVE_BUILD
+#include <WiFiClient.h>
+#include <HTTPClient.h>
+
+/**
+ * @class HttpSink
+ * @brief POSTs each reading as JSON to API_ENDPOINT
+ */
+class HttpSink : public UplinkSink {
+public:
+    HttpSink();
+
+protected:
+    bool deliver(const MeterData& data) override;
+
+private:
+    WiFiClient client;
+    HTTPClient http;
+};
+
+/**
+ * @class ThingSpeakSink
+ * @brief Channel update per reading, at most one per THINGSPEAK_MIN_INTERVAL
+ */
+class ThingSpeakSink : public UplinkSink {
+public:
+    ThingSpeakSink();
+
+protected:
+    bool deliver(const MeterData& data) override;
+
+private:
+    WiFiClient client;
+    HTTPClient http;
+};
+
+#endif // NATIVE_BUILD
+
+#endif // HTTP_SINKS_H
@@ -0,0 +1,60 @@
+/**
+ * @file UplinkSink.cpp
+ * @brief Implementation of the log-draining uplink backend
+ * @version 2.0
+ * @date 2025-10-02
+ */
+
+#include "UplinkSink.h"
+#include "../data/PayloadEncoder.h"
+#include "../utils/Logger.h"
+
+UplinkSink::UplinkSink(const char* name, uint8_t cursor, uint32_t minInterval)
+    : name(name), cursor(cursor), minInterval(minInterval), nextAttempt(0),
+      retryDelay(UPLINK_RETRY_MIN), sent(0), failures(0), failed(false) {
+}
+
+uint16_t UplinkSink::service(OfflineLog& log, unsigned long now) {
+    if ((long)(now - nextAttempt) < 0 || log.pending(cursor) == 0) return 0;
+
+    failed = false;
+    uint16_t count = log.drain(cursor, minInterval > 0 ? 1 : OFFLINE_DRAIN_BATCH, *this);
+
+    if (failed) {
+        nextAttempt = millis() + retryDelay;
+        LOG_WARNF("%s uplink failed - retry in %u s", name, (unsigned)(retryDelay / 1000));
+        retryDelay = retryDelay * 2 < UPLINK_RETRY_MAX ? retryDelay * 2 : UPLINK_RETRY_MAX;
+    } else {
+        nextAttempt = millis() + minInterval;
+        retryDelay = UPLINK_RETRY_MIN;
+    }
+    return count;
+}
+
+uint32_t UplinkSink::waitTime(const OfflineLog& log, unsigned long now, uint32_t cap) const {
+    if (log.pending(cursor) == 0) return cap;
+
+    long wait = (long)(nextAttempt - now);
+    if (wait <= 0) return 0;
+    return (uint32_t)wait < cap ? wait : cap;
+}
+
+bool UplinkSink::busy(const OfflineLog& log) const {
+    // A failing backend must not keep the device awake
+    return log.pending(cursor) > 0 && !backingOff();
+}
+
+bool UplinkSink::onRecord(const uint8_t* payload, size_t length) {
+    if (!PayloadEncoder::decodeMeterData(payload, length, reading)) {
+        LOG_WARNF("%s uplink: stored record not a reading - skipped", name);
+        return true;
+    }
+
+    if (!deliver(reading)) {
+        failed = true;
+        failures++;
+        return false;
+    }
+    sent++;
+    return true;
+}
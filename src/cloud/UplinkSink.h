@@ -0,0 +1,90 @@
+/**
+ * @file UplinkSink.h
+ * @brief Uplink backend that replays the offline log at its own pace
+ * @version 2.0
+ * @date 2025-10-02
+ *
+ * Readings are stored once in the offline log; every backend other than
+ * MQTT (which publishes live from the network task) reads them back
+ * through a LogCursor of its own. A sink keeps its own rate limit and
+ * retry backoff and runs on a task of its own, so a backend that times
+ * out or refuses data delays nothing but itself.
+ */
+
+#ifndef UPLINK_SINK_H
+#define UPLINK_SINK_H
+
+#include <Arduino.h>
+#include "../config/config.h"
+#include "../data/MeterData.h"
+#include "../data/OfflineLog.h"
+
+/**
+ * @class UplinkSink
+ * @brief One backend draining the offline log through its cursor
+ *
+ * After a failed delivery the sink waits UPLINK_RETRY_MIN, doubling per
+ * further failure up to UPLINK_RETRY_MAX. With a minimum interval it
+ * sends one reading per interval, otherwise bursts of OFFLINE_DRAIN_BATCH.
+ */
+class UplinkSink : public OfflineRecordSink {
+public:
+    /**
+     * @brief Constructor
+     * @param name Backend name for logs
+     * @param cursor LogCursor of the backend
+     * @param minInterval ms between deliveries (0 = no limit)
+     */
+    UplinkSink(const char* name, uint8_t cursor, uint32_t minInterval);
+
+    /**
+     * @brief Deliver what is pending, if the sink is due
+     * @param log Shared reading store
+     * @param now Current millis()
+     * @return Readings delivered
+     */
+    uint16_t service(OfflineLog& log, unsigned long now);
+
+    /**
+     * @brief ms until service() has work (0 = now)
+     * @param cap Upper bound, also returned when nothing is pending
+     */
+    uint32_t waitTime(const OfflineLog& log, unsigned long now, uint32_t cap) const;
+
+    /**
+     * @brief Readings pending and the backend not failing
+     */
+    bool busy(const OfflineLog& log) const;
+
+    /**
+     * @brief Last delivery failed; waiting out the retry delay
+     */
+    bool backingOff() const { return retryDelay > UPLINK_RETRY_MIN; }
+
+    const char* getName() const { return name; }
+    uint8_t getCursor() const { return cursor; }
+    uint32_t getSent() const { return sent; }
+    uint32_t getFailures() const { return failures; }
+
+    bool onRecord(const uint8_t* payload, size_t length) override;
+
+protected:
+    /**
+     * @brief Send one reading to the backend
+     * @return true once the backend accepted it
+     */
+    virtual bool deliver(const MeterData& data) = 0;
+
+private:
+    const char* name;
+    uint8_t cursor;
+    uint32_t minInterval;
+    unsigned long nextAttempt;      // millis() the sink is due again
+    uint32_t retryDelay;            // Next backoff step
+    uint32_t sent;
+    uint32_t failures;
+    bool failed;                    // Last delivery of this service() failed
+    MeterData reading;              // Decoded record being delivered
+};
+
+#endif // UPLINK_SINK_H
@@ -0,0 +1,144 @@
+/**
+ * @file WiFiLink.cpp
+ * @brief Implementation of the cached WiFi reconnect
+ * @version 2.0
+ * @date 2025-10-02
+ */
+
+// Host build ([env:native]) has no WiFi stack
+#ifndef NATIVE_BUILD
+
+#include "WiFiLink.h"
+#include "../utils/CRCCalculator.h"
+#include "../utils/Logger.h"
+
+#if PREFERENCES_ENABLED
+#include <Preferences.h>
+#endif
+
+static const uint32_t LEASE_MAGIC = 0x574C5331;     // "WLS1"
+
+// Survives resets and deep sleep, not power-off; checked by magic and CRC
+RTC_NOINIT_ATTR static WiFiLink::Lease rtcLease;
+
+uint32_t WiFiLink::connectTime = 0;
+bool WiFiLink::cached = false;
+
+bool WiFiLink::connect() {
+    uint32_t start = millis();
+    cached = false;
+
+    // No flash write of the station config on every begin()
+    WiFi.persistent(false);
+    WiFi.mode(WIFI_STA);
+
+    Lease lease;
+    if (FAST_BOOT_ENABLED && load(lease) && lease.uses < WIFI_LEASE_MAX_USES) {
+        WiFi.config(IPAddress(lease.ip), IPAddress(lease.gateway),
+                    IPAddress(lease.subnet), IPAddress(lease.dns));
+        WiFi.begin(WIFI_SSID, WIFI_PASSWORD, lease.channel, lease.bssid, true);
+
+        if (waitConnected(WIFI_FAST_TIMEOUT)) {
+            cached = true;
+            lease.uses++;
+            store(lease, false);
+        } else {
+            LOG_WARN("Cached WiFi reconnect failed - scanning");
+            WiFi.disconnect();
+            // 0.0.0.0 hands addressing back to DHCP
+            WiFi.config(IPAddress((uint32_t)0), IPAddress((uint32_t)0), IPAddress((uint32_t)0));
+        }
+    }
+
+    if (!cached) {
+        WiFi.begin(WIFI_SSID, WIFI_PASSWORD);
+        if (!waitConnected(WIFI_TIMEOUT)) {
+            connectTime = millis() - start;
+            LOG_ERROR("WiFi connection timeout");
+            return false;
+        }
+        capture(lease);
+        store(lease, true);
+    }
+
+    connectTime = millis() - start;
+    LOG_INFOF("WiFi up in %u ms (%s)", (unsigned)connectTime,
+              cached ? "cached AP and lease" : "scan and DHCP");
+    return true;
+}
+
+bool WiFiLink::waitConnected(uint32_t timeout) {
+    uint32_t start = millis();
+    while (WiFi.status() != WL_CONNECTED) {
+        if (millis() - start > timeout) {
+            return false;
+        }
+        delay(20);
+    }
+    return true;
+}
+
+// ============================================
+// LEASE CACHE
+// ============================================
+
+uint16_t WiFiLink::checksum(const Lease& lease) {
+    return CRCCalculator::calculate((const uint8_t*)&lease, offsetof(Lease, crc));
+}
+
+bool WiFiLink::load(Lease& lease) {
+    if (rtcLease.magic == LEASE_MAGIC && rtcLease.crc == checksum(rtcLease) &&
+        strcmp(rtcLease.ssid, WIFI_SSID) == 0) {
+        lease = rtcLease;
+        return true;
+    }
+
+#if PREFERENCES_ENABLED
+    Preferences prefs;
+    if (!prefs.begin(WIFI_CACHE_NAMESPACE, true)) return false;
+    size_t length = prefs.getBytes("lease", &lease, sizeof(lease));
+    prefs.end();
+
+    if (length == sizeof(lease) && lease.magic == LEASE_MAGIC &&
+        lease.crc == checksum(lease) && strcmp(lease.ssid, WIFI_SSID) == 0) {
+        rtcLease = lease;
+        return true;
+    }
+#endif
+    return false;
+}
+
+void WiFiLink::store(Lease& lease, bool persist) {
+    lease.crc = checksum(lease);
+    rtcLease = lease;
+
+#if PREFERENCES_ENABLED
+    if (!persist) return;
+
+    // Flash is only written when the AP or the address changed
+    Preferences prefs;
+    if (!prefs.begin(WIFI_CACHE_NAMESPACE, false)) return;
+    Lease stored;
+    if (prefs.getBytes("lease", &stored, sizeof(stored)) != sizeof(stored) ||
+        memcmp(&stored, &lease, sizeof(lease)) != 0) {
+        prefs.putBytes("lease", &lease, sizeof(lease));
+    }
+    prefs.end();
+#endif
+}
+
+void WiFiLink::capture(Lease& lease) {
+    // Zeroed first so the SSID tail compares and checksums the same every time
+    memset(&lease, 0, sizeof(lease));
+    lease.magic = LEASE_MAGIC;
+    strncpy(lease.ssid, WIFI_SSID, sizeof(lease.ssid) - 1);
+    memcpy(lease.bssid, WiFi.BSSID(), sizeof(lease.bssid));
+    lease.channel = WiFi.channel();
+    lease.uses = 0;
+    lease.ip = WiFi.localIP();
+    lease.gateway = WiFi.gatewayIP();
+    lease.subnet = WiFi.subnetMask();
+    lease.dns = WiFi.dnsIP(0);
+}
+
+#endif // NATIVE_BUILD
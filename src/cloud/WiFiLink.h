@@ -0,0 +1,90 @@
+/**
+ * @file WiFiLink.h
+ * @brief WiFi station bring-up with a cached fast reconnect
+ * @version 2.0
+ * @date 2025-10-02
+ *
+ * A full connect scans every channel and waits for DHCP. After one has
+ * succeeded, the access point's channel and BSSID and the DHCP lease
+ * are kept in RTC memory (lost on power-off) and Preferences (kept), and
+ * the next connect joins that AP directly with the lease as static IP.
+ * A failed fast attempt falls back to the full connect, and the lease is
+ * renewed through DHCP after WIFI_LEASE_MAX_USES fast connects.
+ */
+
+#ifndef WIFI_LINK_H
+#define WIFI_LINK_H
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include "../config/config.h"
+
+/**
+ * @class WiFiLink
+ * @brief Station connect for the network task
+ */
+class WiFiLink {
+public:
+    /**
+     * @struct Lease
+     * @brief Access point and IP configuration of the last full connect
+     */
+    struct Lease {
+        uint32_t magic;
+        uint32_t ip;
+        uint32_t gateway;
+        uint32_t subnet;
+        uint32_t dns;
+        char ssid[33];
+        uint8_t bssid[6];
+        uint8_t channel;
+        uint8_t uses;               // Fast connects since DHCP was last asked
+        uint8_t reserved;           // Keeps the layout free of padding
+        uint16_t crc;               // Over the fields above
+    };
+
+    /**
+     * @brief Connect to WIFI_SSID, cached AP and lease first
+     * @return true once associated with an IP
+     */
+    static bool connect();
+
+    /**
+     * @brief Duration of the last connect() in ms
+     */
+    static uint32_t getConnectTime() { return connectTime; }
+
+    /**
+     * @brief Last connect() used the cached AP and lease
+     */
+    static bool usedCache() { return cached; }
+
+private:
+    static uint32_t connectTime;
+    static bool cached;
+
+    /**
+     * @brief Wait for WL_CONNECTED
+     * @return false on timeout
+     */
+    static bool waitConnected(uint32_t timeout);
+
+    /**
+     * @brief Cached lease for WIFI_SSID, RTC copy first
+     */
+    static bool load(Lease& lease);
+
+    /**
+     * @brief Keep a lease: RTC always, Preferences when the AP or IP changed
+     */
+    static void store(Lease& lease, bool persist);
+
+    /**
+     * @brief Lease from the current connection
+     */
+    static void capture(Lease& lease);
+
+    static uint16_t checksum(const Lease& lease);
+};
+
+#endif // WIFI_LINK_H
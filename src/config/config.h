@@ -23,10 +23,67 @@
 #define DLMS_PASSWORD       "1111111111111111"  // 16-byte LL password (HPL)
 #define DLMS_CLIENT_SAP     0x41                // Client Service Access Point
 #define DLMS_SERVER_SAP     0x03                // Server Service Access Point
+#define DLMS_LOGICAL_DEVICE 1                   // Upper HDLC address with physical addressing
+
+// Batched reads (GET-Request-With-List)
+#define DLMS_GET_LIST_ENABLED   true            // Use list reads if meter supports them
+#define DLMS_GET_LIST_MAX_ITEMS 32              // Attribute descriptors per list request
+#define DLMS_MAX_PDU_SIZE       2048            // Reassembled APDU (client max receive PDU)
+
+// HDLC link parameters (proposed in SNRM, meter may lower them in UA)
+#define HDLC_MAX_INFO_TX    512     // Max information field we transmit
+#define HDLC_MAX_INFO_RX    1024    // Max information field we can receive
+#define HDLC_WINDOW_TX      1       // I-frames we send before waiting for RR
+#define HDLC_WINDOW_RX      7       // I-frames meter may send before our RR
+
+// RS-485 multi-drop bus: meters at consecutive HDLC physical addresses,
+// read round-robin (0 = one meter on DLMS_SERVER_SAP)
+#define METER_BUS_SIZE          0       // Meters on the bus (max 16)
+#define METER_BUS_FIRST_ADDRESS 0x10    // Physical address of the first meter
+#define METER_BUS_BACKOFF_MAX   16      // Max rounds a failing meter is skipped
+
+// Held association: keep HDLC link and AA open between polls
+#define DLMS_HOLD_ASSOCIATION   false
+#define HDLC_KEEPALIVE_INTERVAL 30000   // ms idle before RR keep-alive
+#define HDLC_INACTIVITY_TIMEOUT 120000  // ms meter drops an idle link
+
+// Inter-frame pacing, learned per meter (ms)
+#define PACING_DEFAULT_GAP      50      // Gap before first learned value
+#define PACING_MIN_GAP          0
+#define PACING_MAX_GAP          500
+#define PACING_BACKOFF_STEP     10      // Floor margin above a failing gap
+#define PACING_SHRINK_AFTER     8       // Clean responses before shrinking
+#define PACING_FLOOR_DECAY_AFTER 32     // Clean responses at the floor before lowering it
+
+// UART receive: ESP-IDF driver events (pattern detect on 0x7E) feed
+// complete frames to the protocol through a queue; false polls Serial2
+#define DLMS_UART_EVENT_DRIVEN  true
+#define DLMS_UART_RX_BUFFER     2048    // Driver ring buffer (bytes)
+#define DLMS_RX_FRAME_SLOTS     4       // Received frames buffered for protocol
+#define DLMS_UART_TASK_PRIORITY 12
+
+// Meter link: HDLC on UART2 at DLMS_BAUD_RATE, HDLC through the optical
+// port after an IEC 62056-21 sign-on, or the IEC 62056-47 TCP wrapper
+#define METER_TRANSPORT_UART    0
+#define METER_TRANSPORT_OPTICAL 1
+#define METER_TRANSPORT_TCP     2
+#define METER_TRANSPORT         METER_TRANSPORT_UART
+
+// Optical port, mode E: sign-on at 300 baud 7E1, then HDLC at the highest
+// rate both sides support (IEC 62056-21 baud characters 0-6, 300-19200)
+#define OPTICAL_DEVICE_ADDRESS  ""      // "/?<address>!" when several share a probe
+#define OPTICAL_MAX_BAUD        19200   // Our limit for the negotiated rate
+#define OPTICAL_IDENT_TIMEOUT   1500    // ms for the identification message
+#define OPTICAL_SWITCH_DELAY    300     // ms after option select before HDLC
+
+// TCP wrapper: meter (or its GPRS modem) listening as a TCP server
+#define WRAPPER_HOST            "192.168.1.50"
+#define WRAPPER_PORT            4059
+#define WRAPPER_CONNECT_TIMEOUT 10000   // ms
 
 // Frame configuration
 #define HDLC_FLAG           0x7E
-#define MAX_FRAME_SIZE      256
+#define MAX_FRAME_SIZE      (HDLC_MAX_INFO_RX + 16)  // One physical HDLC frame
 #define MAX_RETRY_COUNT     3
 
 // ============================================
@@ -38,6 +95,11 @@
 #define WIFI_TIMEOUT        30000  // 30 seconds
 #define WIFI_RETRY_DELAY    5000   // 5 seconds between retries
 
+// Fast boot: cached AP channel/BSSID and DHCP lease, no startup delays
+#define FAST_BOOT_ENABLED   true
+#define WIFI_FAST_TIMEOUT   3000   // Cached reconnect before falling back to a scan
+#define WIFI_LEASE_MAX_USES 20     // Fast connects before the lease is renewed by DHCP
+
 // MQTT Settings
 #define MQTT_ENABLED        true
 #define MQTT_BROKER         "broker.hivemq.com"  // Change to your broker
@@ -46,6 +108,15 @@
 #define MQTT_PASSWORD       ""                    // If required
 #define MQTT_CLIENT_ID      "DLMS_Meter_"        // Will append MAC address
 #define MQTT_KEEPALIVE      60
+#define MQTT_BUFFER_SIZE    1280                 // Packet buffer (topic + payload)
+#define JSON_STREAM_CHUNK   256                  // Socket write size when streaming JSON
+
+// Payload encoding per topic; binary layouts in src/data/PayloadEncoder.h
+#define PAYLOAD_JSON        0
+#define PAYLOAD_BINARY      1
+#define MQTT_DATA_ENCODING      PAYLOAD_JSON
+#define MQTT_PROFILE_ENCODING   PAYLOAD_JSON
+#define MQTT_PQ_ENCODING        PAYLOAD_BINARY
 
 // MQTT Topics
 #define MQTT_TOPIC_BASE     "dlms/meter/"        // Will append meter ID
@@ -53,27 +124,171 @@
 #define MQTT_TOPIC_STATUS   "status"
 #define MQTT_TOPIC_ERROR    "error"
 #define MQTT_TOPIC_CMD      "command"
+#define MQTT_TOPIC_PROFILE  "profile"
+#define MQTT_TOPIC_BACKLOG  "backlog"            // Replayed readings (binary, schema 0x01)
+#define MQTT_TOPIC_BATCH    "batch"              // Batched readings (binary, schema 0x03)
+#define MQTT_TOPIC_DELTA    "delta"              // Changed fields (schema 0x06)
+#define MQTT_TOPIC_PQ       "pq"                 // Power-quality windows (schema 0x04)
+#define MQTT_TOPIC_EVENT    "event"              // Limit crossings (schema 0x05)
+#define MQTT_TOPIC_RESPONSE "response"           // Command results (JSON, request id echoed)
+
+// Remote commands: "READ" or {"id":"42","cmd":"read","meter":1,"registers":["kwh_import"]}
+#define COMMAND_MAX_REGISTERS   8       // Registers in one targeted read
+#define COMMAND_MAX_WAITERS     4       // Duplicate requests answered by one read
+#define COMMAND_ID_SIZE         24      // Correlation id, terminator included
+#define COMMAND_RESPONSE_SIZE   512     // JSON document of one response
 
 // HTTP/REST API Settings
 #define HTTP_ENABLED        false
 #define API_ENDPOINT        "http://your-api.com/meter/data"
 #define API_KEY             "your-api-key-here"
+#define HTTP_TIMEOUT        5000    // ms per request
+#define HTTP_MIN_INTERVAL   0       // ms between posts (0 = as fast as accepted)
 
 // ThingSpeak Settings (Optional)
 #define THINGSPEAK_ENABLED  false
 #define THINGSPEAK_API_KEY  "YOUR_WRITE_API_KEY"
 #define THINGSPEAK_CHANNEL  123456
+#define THINGSPEAK_MIN_INTERVAL 15000   // ms, free-tier channel update limit
+
+// HTTP and ThingSpeak replay the offline log on tasks of their own, each
+// through its own cursor; a failing backend backs off without holding the rest
+#define UPLINK_RETRY_MIN    5000    // ms after the first failure
+#define UPLINK_RETRY_MAX    300000  // ms, backoff doubles up to this
 
 // ============================================
 // DATA COLLECTION CONFIGURATION
 // ============================================
-#define READ_INTERVAL       60000   // ms between readings (60 seconds)
+#define READ_INTERVAL       10000   // ms between polls (fastest tier, 10 seconds)
 #define UPLOAD_INTERVAL     300000  // ms between cloud uploads (5 minutes)
 #define MAX_OFFLINE_BUFFER  100     // Maximum readings to store offline
 
+// Tiered polling: each poll reads only the ReadPlan tiers that are due;
+// identification is read once per association
+#define TIER_FAST_INTERVAL      READ_INTERVAL   // ms, V/I/PF/Hz
+#define TIER_NORMAL_INTERVAL    300000  // ms, energy counters (5 minutes)
+#define TIER_SLOW_INTERVAL      3600000 // ms, MD and TOD (1 hour)
+
+// Batched uplink: readings are queued and published several per message
+// (binary schema 0x03) instead of one snapshot per UPLOAD_INTERVAL
+#define MQTT_BATCH_ENABLED      false
+#define BATCH_MAX_READINGS      12      // Flush when this many readings queued
+#define BATCH_MAX_AGE           UPLOAD_INTERVAL // Flush when oldest reading this old (ms)
+
+// Report-by-exception: each reading publishes only the fields that moved
+// past their deadband, max(ABS, REL x |last published|), and a full
+// snapshot goes out every REPORT_KEYFRAME_INTERVAL instead of every
+// UPLOAD_INTERVAL (not combined with MQTT_BATCH_ENABLED)
+#define MQTT_REPORT_BY_EXCEPTION false
+#define REPORT_KEYFRAME_INTERVAL 900000 // ms between full snapshots (15 minutes)
+#define RBE_ENERGY_ABS          0.1f    // kWh, kVAh, kvarh (also TOD)
+#define RBE_ENERGY_REL          0.0f
+#define RBE_DEMAND_ABS          0.05f   // kW, kVA; a new capture time always reports
+#define RBE_DEMAND_REL          0.0f
+#define RBE_VOLTAGE_ABS         1.0f    // V
+#define RBE_VOLTAGE_REL         0.0f
+#define RBE_CURRENT_ABS         0.1f    // A
+#define RBE_CURRENT_REL         0.05f
+#define RBE_POWER_FACTOR_ABS    0.02f
+#define RBE_POWER_FACTOR_REL    0.0f
+#define RBE_FREQUENCY_ABS       0.05f   // Hz
+#define RBE_FREQUENCY_REL       0.0f
+
+// Offline ring log (readings MQTT could not take, replayed on reconnect)
+#define OFFLINE_LOG_FILE        "/offline.log"
+#define OFFLINE_RECORD_SIZE     192     // Slot size incl. 12-byte header
+#define OFFLINE_DRAIN_BATCH     10      // Records per replay burst
+#define OFFLINE_DRAIN_INTERVAL  2000    // ms between replay bursts
+
+// Power quality: instantaneous values summarized on the device, only
+// window statistics and limit crossings are published
+#define PQ_ENABLED              true
+#define PQ_WINDOW_SHORT         60      // s, windows aligned to the clock
+#define PQ_WINDOW_MEDIUM        300
+#define PQ_WINDOW_LONG          900
+#define PQ_HISTOGRAM_BINS       32      // Per channel and window, for percentiles
+#define PQ_VOLTAGE_RANGE_LOW    160.0f  // Histogram spans
+#define PQ_VOLTAGE_RANGE_HIGH   300.0f
+#define PQ_CURRENT_RANGE_HIGH   100.0f
+#define PQ_FREQUENCY_RANGE_LOW  48.0f
+#define PQ_FREQUENCY_RANGE_HIGH 52.0f
+#define PQ_VOLTAGE_LOW          207.0f  // Event limits (230 V -10% / +10%)
+#define PQ_VOLTAGE_HIGH         253.0f
+#define PQ_CURRENT_HIGH         80.0f
+#define PQ_POWER_FACTOR_LOW     0.8f
+#define PQ_FREQUENCY_LOW        49.5f
+#define PQ_FREQUENCY_HIGH       50.5f
+#define PQ_HYSTERESIS           0.01f   // Fraction of a limit to re-arm
+
+// Load profile (Profile Generic, class 7)
+#define PROFILE_ENABLED         true
+#define PROFILE_READ_INTERVAL   3600000 // ms between catch-up reads (1 hour)
+#define PROFILE_INITIAL_SPAN    86400   // s of history fetched on first read
+#define PROFILE_MAX_COLUMNS     12      // Capture objects decoded per row
+#define PROFILE_MAX_ROW_SIZE    128     // Bytes of one row held across blocks
+#define PROFILE_PUBLISH_ROWS    16      // Rows per uplink message
+
 // Time-of-Day (TOD) Configuration
 #define TOD_ZONES           8       // Number of TOD billing zones
 
+// ============================================
+// TASKS (FreeRTOS)
+// ============================================
+// Metering owns the DLMS link on core 1; WiFi, MQTT and HTTP run on
+// core 0 so network stalls never delay a poll
+#define METERING_TASK_CORE      1
+#define METERING_TASK_PRIORITY  3
+#define METERING_TASK_STACK     8192
+#define METERING_IDLE_WAIT      1000    // ms max sleep between schedule checks
+#define NETWORK_TASK_CORE       0
+#define NETWORK_TASK_PRIORITY   2
+#define NETWORK_TASK_STACK      12288   // JSON documents are built on this stack
+#define NETWORK_TASK_TICK       20      // ms between network service passes
+#define UPLINK_TASK_CORE        0       // One task per HTTP/ThingSpeak backend
+#define UPLINK_TASK_PRIORITY    1       // Below the network task
+#define UPLINK_TASK_STACK       8192
+#define UPLINK_IDLE_WAIT        1000    // ms max sleep between log checks
+
+// Inter-task queues (capacity must be a power of two)
+#define READING_QUEUE_DEPTH     4       // Readings metering -> network
+#define PROFILE_QUEUE_DEPTH     2       // Profile chunks metering -> network
+#define COMMAND_QUEUE_DEPTH     4       // Commands network -> metering, results back
+#define METRICS_QUEUE_DEPTH     2       // Link metrics metering -> network
+#define PROFILE_QUEUE_WAIT      5000    // ms a profile read waits for the uplink
+
+// ============================================
+// POWER MANAGEMENT
+// ============================================
+// Battery/solar sites: sleep between polls and bring WiFi up only for an
+// uplink session. Deep sleep reboots on every wake; the poll schedule and
+// last readings are kept in RTC memory, batches only while RAM is kept
+// (a deep sleep waits for them to be published, or light-sleeps instead)
+#define POWER_ALWAYS_ON         0       // WiFi associated, no sleep (mains powered)
+#define POWER_LIGHT_SLEEP       1       // Light sleep between polls, RAM kept
+#define POWER_DEEP_SLEEP        2       // Deep sleep between long gaps, light sleep otherwise
+#define POWER_MODE              POWER_ALWAYS_ON
+
+#define POWER_MIN_SLEEP         2000    // ms; shorter gaps are waited out awake
+#define POWER_DEEP_MIN_SLEEP    20000   // ms; a reboot costs about a second awake
+#define POWER_RX_WAKEUP         false   // Meter RX line wakes light sleep (line must idle high)
+#define POWER_UPLINK_INTERVAL   900000  // ms between WiFi sessions (commands, status)
+#define POWER_UPLINK_BACKLOG    8       // Offline readings that start a session early
+#define POWER_UPLINK_RETRY      300000  // ms before a failed session is retried
+#define POWER_SESSION_TIMEOUT   60000   // ms a session may take to get its data out
+#define POWER_WIFI_IDLE_TIMEOUT 3000    // ms WiFi stays up once nothing is left to send
+
+// Energy model: currents per state, from the board's measurements
+// (defaults are typical ESP32-WROOM figures plus the meter interface)
+#define POWER_SUPPLY_VOLTAGE    3.3f    // V
+#define POWER_ACTIVE_MA         45.0f   // CPU awake, radio off
+#define POWER_WIFI_MA           80.0f   // Radio on, in addition to POWER_ACTIVE_MA
+#define POWER_LIGHT_SLEEP_MA    1.5f
+#define POWER_DEEP_SLEEP_MA     0.2f
+
+#if POWER_MODE != POWER_ALWAYS_ON && METER_TRANSPORT == METER_TRANSPORT_TCP
+#error "Sleep modes switch WiFi off between sessions; the TCP meter link needs POWER_ALWAYS_ON"
+#endif
+
 // ============================================
 // LOGGING CONFIGURATION
 // ============================================
@@ -84,6 +299,27 @@
 #define LOG_LEVEL_DEBUG     3
 #define LOG_LEVEL           LOG_LEVEL_DEBUG
 
+// Records go through a lock-free ring and are formatted by a low-priority
+// task; a full ring drops (and counts) records instead of blocking
+#define LOG_ASYNC           true
+#define LOG_RING_SLOTS      256     // 32-byte slots (power of two), 8 KB
+#define LOG_RECORD_MAX      256     // Bytes of one record, longer text is cut
+#define LOG_HEX_BYTES       128     // Bytes kept per hex dump
+#define LOG_TASK_CORE       0
+#define LOG_TASK_PRIORITY   1       // Above idle, below the network task
+#define LOG_TASK_STACK      3072
+#define LOG_DRAIN_TICK      20      // ms between drain passes
+
+// ============================================
+// METRICS
+// ============================================
+// Link counters and round-trip histograms per meter, in the status
+// message and at /metrics on the web server
+#define METRICS_REGISTER_SLOTS  64      // OBIS/attribute pairs timed per meter
+#define METRICS_TOP_REGISTERS   3       // Slowest registers in the metrics message
+#define METRICS_PUBLISH_INTERVAL 60000  // ms between <status>/metrics messages
+#define METRICS_JSON_SIZE       2560    // Document for one meter's metrics
+
 // ============================================
 // NTP TIME SYNC
 // ============================================
@@ -95,19 +331,36 @@
 // ============================================
 // STORAGE CONFIGURATION
 // ============================================
+#ifdef NATIVE_BUILD
+// Host build ([env:native]) has no flash filesystem or NVS
+#define SPIFFS_ENABLED      false
+#define PREFERENCES_ENABLED false
+#else
 #define SPIFFS_ENABLED      true
 #define PREFERENCES_ENABLED true
+#endif
 #define CONFIG_FILE         "/config.json"
+#define READ_PLAN_JSON_SIZE 3072    // Parse buffer for the "read_plan" section
 #define DATA_FILE           "/meter_data.json"
 
+// Register scaler/class-check cache (persisted in Preferences)
+#define SCALER_CACHE_SIZE       80
+#define SCALER_CACHE_NAMESPACE  "dlms_scaler"
+#define PROFILE_NAMESPACE       "dlms_profile"
+#define PACING_NAMESPACE        "dlms_pacing"
+#define OFFLINE_NAMESPACE       "dlms_offline"
+#define WIFI_CACHE_NAMESPACE    "wifi_cache"
+
 // ============================================
 // FEATURE FLAGS
 // ============================================
 #define ENABLE_OTA_UPDATE   true
 #define ENABLE_WEB_SERVER   true
 #define ENABLE_DISPLAY      false
+#define LED_PATTERN_QUEUE   4       // Status LED patterns waiting to play (more are dropped)
 #define ENABLE_AUTO_RESTART true
 #define AUTO_RESTART_HOURS  24      // Restart every 24 hours
+#define CRC_BENCHMARK_ENABLED false  // Log table vs bitwise CRC timing at boot
 
 // ============================================
 // ERROR HANDLING
@@ -19,6 +19,7 @@
 // CONTROL PINS
 // ============================================
 #define DTR_PIN             4     // Data Terminal Ready - Wake up meter
+#define RS485_DE_PIN        -1    // RS-485 driver enable (-1: point-to-point link)
 #define RST_PIN             5     // Optional: Meter Reset Pin
 
 // ============================================
@@ -54,5 +55,6 @@
 #define DTR_WAKE_DELAY      500   // ms to wait after DTR activation
 #define LED_BLINK_DELAY     100   // ms for LED blink duration
 #define COMMAND_TIMEOUT     2000  // ms to wait for meter response
+#define HDLC_INTERCHAR_TIMEOUT 50 // ms silence that aborts a partial frame
 
 #endif // PINS_H
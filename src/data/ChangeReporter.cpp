@@ -0,0 +1,159 @@
+/**
+ * @file ChangeReporter.cpp
+ * @brief Implementation of per-field deadbands
+ * @version 2.0
+ * @date 2025-10-02
+ */
+
+#include "ChangeReporter.h"
+#include <math.h>
+#include <stddef.h>
+
+// ============================================
+// FIELDS
+// ============================================
+
+/**
+ * @struct FieldSpec
+ * @brief Source, name and deadband of one field
+ */
+struct FieldSpec {
+    const char* name;
+    uint16_t value;         // offsetof(MeterData, <float>)
+    uint16_t time;          // offsetof(MeterData, <uint32_t>) or NO_TIME
+    float absolute;         // Deadband = max(absolute, relative x |last|)
+    float relative;
+};
+
+static const uint16_t NO_TIME = 0xFFFF;
+
+#define FIELD(member) ((uint16_t)offsetof(MeterData, member))
+
+#define VALUE(name, member, band) \
+    { name, FIELD(member), NO_TIME, RBE_##band##_ABS, RBE_##band##_REL }
+
+#define DEMAND(name, member) \
+    { name, FIELD(member.value), FIELD(member.timestamp), RBE_DEMAND_ABS, RBE_DEMAND_REL }
+
+#define TOD_ZONE(n) \
+    { "tod" #n "_kwh", FIELD(todZones[n - 1].kwh), NO_TIME, RBE_ENERGY_ABS, RBE_ENERGY_REL }, \
+    { "tod" #n "_kvah", FIELD(todZones[n - 1].kvah), NO_TIME, RBE_ENERGY_ABS, RBE_ENERGY_REL }, \
+    { "tod" #n "_md_kw", FIELD(todZones[n - 1].mdKW), FIELD(todZones[n - 1].mdKWTimestamp), \
+      RBE_DEMAND_ABS, RBE_DEMAND_REL }, \
+    { "tod" #n "_md_kva", FIELD(todZones[n - 1].mdKVA), FIELD(todZones[n - 1].mdKVATimestamp), \
+      RBE_DEMAND_ABS, RBE_DEMAND_REL }
+
+// Index = field ID on the wire: append only, never reorder
+static const FieldSpec FIELD_TABLE[] = {
+    { "mf", FIELD(multiplicationFactor), NO_TIME, 0.0f, 0.0f },
+    VALUE("kwh_import",   kwhImport,      ENERGY),
+    VALUE("kvah_import",  kvahImport,     ENERGY),
+    VALUE("kwh_export",   kwhExport,      ENERGY),
+    VALUE("kvah_export",  kvahExport,     ENERGY),
+    VALUE("kvarh_lag",    kvarhLag,       ENERGY),
+    VALUE("kvarh_lead",   kvarhLead,      ENERGY),
+    DEMAND("md_kw_import",  mdKWImport),
+    DEMAND("md_kva_import", mdKVAImport),
+    DEMAND("md_kw_export",  mdKWExport),
+    DEMAND("md_kva_export", mdKVAExport),
+    VALUE("voltage_r",    voltageR,       VOLTAGE),
+    VALUE("voltage_y",    voltageY,       VOLTAGE),
+    VALUE("voltage_b",    voltageB,       VOLTAGE),
+    VALUE("current_r",    currentR,       CURRENT),
+    VALUE("current_y",    currentY,       CURRENT),
+    VALUE("current_b",    currentB,       CURRENT),
+    VALUE("current_n",    currentNeutral, CURRENT),
+    VALUE("power_factor", powerFactor,    POWER_FACTOR),
+    VALUE("frequency",    frequency,      FREQUENCY),
+    TOD_ZONE(1),
+    TOD_ZONE(2),
+    TOD_ZONE(3),
+    TOD_ZONE(4),
+    TOD_ZONE(5),
+    TOD_ZONE(6),
+    TOD_ZONE(7),
+    TOD_ZONE(8)
+};
+
+#undef TOD_ZONE
+#undef DEMAND
+#undef VALUE
+#undef FIELD
+
+static_assert(sizeof(FIELD_TABLE) / sizeof(FIELD_TABLE[0]) == ChangeReporter::FIELDS,
+              "ChangeReporter::FIELDS must match the field table");
+
+const char* ChangeReporter::fieldName(uint8_t id) {
+    return id < FIELDS ? FIELD_TABLE[id].name : "";
+}
+
+bool ChangeReporter::hasTime(uint8_t id) {
+    return id < FIELDS && FIELD_TABLE[id].time != NO_TIME;
+}
+
+// ============================================
+// DEADBANDS
+// ============================================
+
+ChangeReporter::ChangeReporter() : hasBaseline(false), lastKeyframe(0) {
+    memset(value, 0, sizeof(value));
+    memset(time, 0, sizeof(time));
+}
+
+bool ChangeReporter::keyframeDue(unsigned long now) const {
+    return !hasBaseline || now - lastKeyframe >= REPORT_KEYFRAME_INTERVAL;
+}
+
+void ChangeReporter::keyframeSent(const MeterData& data, unsigned long now) {
+    const uint8_t* base = reinterpret_cast<const uint8_t*>(&data);
+
+    for (uint8_t i = 0; i < FIELDS; i++) {
+        memcpy(&value[i], base + FIELD_TABLE[i].value, sizeof(float));
+        time[i] = 0;
+        if (FIELD_TABLE[i].time != NO_TIME) {
+            memcpy(&time[i], base + FIELD_TABLE[i].time, sizeof(uint32_t));
+        }
+    }
+
+    hasBaseline = true;
+    lastKeyframe = now;
+}
+
+uint8_t ChangeReporter::changes(const MeterData& data, FieldChange* out) const {
+    if (!hasBaseline) return 0;
+
+    const uint8_t* base = reinterpret_cast<const uint8_t*>(&data);
+    uint8_t count = 0;
+
+    for (uint8_t i = 0; i < FIELDS; i++) {
+        const FieldSpec& spec = FIELD_TABLE[i];
+
+        float current;
+        memcpy(&current, base + spec.value, sizeof(float));
+        if (isnan(current)) continue;
+
+        uint32_t captured = 0;
+        if (spec.time != NO_TIME) {
+            memcpy(&captured, base + spec.time, sizeof(uint32_t));
+        }
+
+        float band = spec.relative * fabsf(value[i]);
+        if (band < spec.absolute) band = spec.absolute;
+
+        if (fabsf(current - value[i]) > band || captured != time[i]) {
+            FieldChange& change = out[count++];
+            change.id = i;
+            change.value = current;
+            change.time = captured;
+        }
+    }
+    return count;
+}
+
+void ChangeReporter::commit(const FieldChange* published, uint8_t count) {
+    for (uint8_t i = 0; i < count; i++) {
+        if (published[i].id >= FIELDS) continue;
+        value[published[i].id] = published[i].value;
+        time[published[i].id] = published[i].time;
+    }
+}
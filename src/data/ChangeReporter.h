@@ -0,0 +1,94 @@
+/**
+ * @file ChangeReporter.h
+ * @brief Report-by-exception: which MeterData fields moved past their deadband
+ * @version 2.0
+ * @date 2025-10-02
+ *
+ * Every numeric MeterData field has a stable field ID (the wire key of
+ * PayloadEncoder schema 0x06) and a deadband of max(absolute, relative x
+ * |last published|). A reading is compared against the values last
+ * published, not the previous reading, so slow drift is still reported
+ * once it adds up. Changes carry absolute values, so a consumer that
+ * missed one is corrected by the next change or keyframe. A keyframe
+ * (the full snapshot) is due every REPORT_KEYFRAME_INTERVAL.
+ */
+
+#ifndef CHANGE_REPORTER_H
+#define CHANGE_REPORTER_H
+
+#include <Arduino.h>
+#include "../config/config.h"
+#include "MeterData.h"
+
+/**
+ * @struct FieldChange
+ * @brief New value of one field
+ */
+struct FieldChange {
+    uint8_t id;             // ChangeReporter field ID
+    float value;
+    uint32_t time;          // Capture time for demand fields, else 0
+};
+
+/**
+ * @class ChangeReporter
+ * @brief Deadband state of one meter
+ */
+class ChangeReporter {
+public:
+    static const uint8_t FIELDS = 52;
+
+    /**
+     * @brief Constructor - first reading goes out as a keyframe
+     */
+    ChangeReporter();
+
+    /**
+     * @brief Full snapshot due (first reading or interval elapsed)
+     * @param now Current millis()
+     */
+    bool keyframeDue(unsigned long now) const;
+
+    /**
+     * @brief Take a published snapshot as the new baseline
+     * @param data Snapshot that went out
+     * @param now Current millis()
+     */
+    void keyframeSent(const MeterData& data, unsigned long now);
+
+    /**
+     * @brief Fields outside their deadband
+     * @param data Latest reading
+     * @param out Output, room for FIELDS entries
+     * @return Number of changed fields
+     */
+    uint8_t changes(const MeterData& data, FieldChange* out) const;
+
+    /**
+     * @brief Record published changes in the baseline
+     */
+    void commit(const FieldChange* published, uint8_t count);
+
+    /**
+     * @brief Force a keyframe with the next reading
+     */
+    void reset() { hasBaseline = false; }
+
+    /**
+     * @brief Field name for JSON ("kwh_import", "tod3_md_kw", ...)
+     */
+    static const char* fieldName(uint8_t id);
+
+    /**
+     * @brief Field carries a capture time (maximum demand)
+     */
+    static bool hasTime(uint8_t id);
+
+private:
+    float value[FIELDS];            // Last published values
+    uint32_t time[FIELDS];
+    bool hasBaseline;
+    unsigned long lastKeyframe;
+};
+
+#endif // CHANGE_REPORTER_H
@@ -0,0 +1,234 @@
+/**
+ * @file EdgeAggregator.cpp
+ * @brief Implementation of power-quality windows
+ * @version 2.0
+ * @date 2025-10-02
+ */
+
+#include "EdgeAggregator.h"
+#include <math.h>
+#include <stddef.h>
+
+// ============================================
+// CHANNELS
+// ============================================
+
+/**
+ * @struct ChannelSpec
+ * @brief Source field, histogram span and event limits of a channel
+ */
+struct ChannelSpec {
+    const char* name;
+    uint16_t field;         // offsetof(MeterData, <float>)
+    float low;              // Histogram span
+    float high;
+    float limitLow;         // NAN = no limit
+    float limitHigh;
+};
+
+#define FIELD(member) ((uint16_t)offsetof(MeterData, member))
+
+static const ChannelSpec CHANNELS[PQChannel::COUNT] = {
+    { "v_r", FIELD(voltageR), PQ_VOLTAGE_RANGE_LOW, PQ_VOLTAGE_RANGE_HIGH,
+      PQ_VOLTAGE_LOW, PQ_VOLTAGE_HIGH },
+    { "v_y", FIELD(voltageY), PQ_VOLTAGE_RANGE_LOW, PQ_VOLTAGE_RANGE_HIGH,
+      PQ_VOLTAGE_LOW, PQ_VOLTAGE_HIGH },
+    { "v_b", FIELD(voltageB), PQ_VOLTAGE_RANGE_LOW, PQ_VOLTAGE_RANGE_HIGH,
+      PQ_VOLTAGE_LOW, PQ_VOLTAGE_HIGH },
+    { "i_r", FIELD(currentR), 0.0f, PQ_CURRENT_RANGE_HIGH, NAN, PQ_CURRENT_HIGH },
+    { "i_y", FIELD(currentY), 0.0f, PQ_CURRENT_RANGE_HIGH, NAN, PQ_CURRENT_HIGH },
+    { "i_b", FIELD(currentB), 0.0f, PQ_CURRENT_RANGE_HIGH, NAN, PQ_CURRENT_HIGH },
+    { "i_n", FIELD(currentNeutral), 0.0f, PQ_CURRENT_RANGE_HIGH, NAN, PQ_CURRENT_HIGH },
+    { "pf", FIELD(powerFactor), 0.0f, 1.0f, PQ_POWER_FACTOR_LOW, NAN },
+    { "hz", FIELD(frequency), PQ_FREQUENCY_RANGE_LOW, PQ_FREQUENCY_RANGE_HIGH,
+      PQ_FREQUENCY_LOW, PQ_FREQUENCY_HIGH }
+};
+
+#undef FIELD
+
+static const uint16_t WINDOW_LENGTHS[EdgeAggregator::WINDOWS] = {
+    PQ_WINDOW_SHORT, PQ_WINDOW_MEDIUM, PQ_WINDOW_LONG
+};
+
+const char* PQChannel::name(uint8_t channel) {
+    return channel < COUNT ? CHANNELS[channel].name : "";
+}
+
+/**
+ * @brief Histogram bin of a value, clamped to the span
+ */
+static uint8_t binOf(const ChannelSpec& spec, float value) {
+    float position = (value - spec.low) / (spec.high - spec.low) * PQ_HISTOGRAM_BINS;
+    if (!(position > 0.0f)) return 0;       // Also NAN
+    if (position >= PQ_HISTOGRAM_BINS) return PQ_HISTOGRAM_BINS - 1;
+    return (uint8_t)position;
+}
+
+// ============================================
+// ACCUMULATOR
+// ============================================
+
+void EdgeAggregator::Accumulator::clear() {
+    count = 0;
+    min = max = 0.0f;
+    sum = sumSquares = 0.0;
+    memset(bins, 0, sizeof(bins));
+}
+
+void EdgeAggregator::Accumulator::add(float value, uint8_t bin) {
+    if (count == 0 || value < min) min = value;
+    if (count == 0 || value > max) max = value;
+    sum += value;
+    sumSquares += (double)value * value;
+    if (bins[bin] < 0xFFFF) bins[bin]++;
+    if (count < 0xFFFF) count++;
+}
+
+float EdgeAggregator::Accumulator::percentile(float fraction, float low, float high) const {
+    if (count == 0) return 0.0f;
+
+    // Walk to the bin holding the rank, interpolate linearly inside it
+    float rank = fraction * count;
+    float width = (high - low) / PQ_HISTOGRAM_BINS;
+    uint32_t below = 0;
+    float value = max;
+
+    for (uint8_t i = 0; i < PQ_HISTOGRAM_BINS; i++) {
+        if (below + bins[i] >= rank && bins[i] > 0) {
+            value = low + width * (i + (rank - below) / bins[i]);
+            break;
+        }
+        below += bins[i];
+    }
+
+    // Edge bins also hold everything outside the span
+    if (value < min) value = min;
+    if (value > max) value = max;
+    return value;
+}
+
+// ============================================
+// AGGREGATOR
+// ============================================
+
+EdgeAggregator::EdgeAggregator() {
+    clear();
+}
+
+uint16_t EdgeAggregator::windowLength(uint8_t window) {
+    return WINDOW_LENGTHS[window];
+}
+
+void EdgeAggregator::clear() {
+    for (uint8_t w = 0; w < WINDOWS; w++) {
+        windows[w].open = false;
+        windows[w].start = 0;
+        for (uint8_t c = 0; c < PQChannel::COUNT; c++) {
+            windows[w].channels[c].clear();
+        }
+    }
+    memset(limitState, 0, sizeof(limitState));
+}
+
+void EdgeAggregator::add(const MeterData& data, AggregateSink& sink) {
+    // Wall clock when NTP has set it, otherwise uptime
+    uint32_t now = data.lastReadTimestamp != 0 ? data.lastReadTimestamp : millis() / 1000;
+    const uint8_t* base = reinterpret_cast<const uint8_t*>(&data);
+
+    float values[PQChannel::COUNT];
+    uint8_t bins[PQChannel::COUNT];
+    for (uint8_t c = 0; c < PQChannel::COUNT; c++) {
+        memcpy(&values[c], base + CHANNELS[c].field, sizeof(float));
+        bins[c] = binOf(CHANNELS[c], values[c]);
+    }
+
+    for (uint8_t w = 0; w < WINDOWS; w++) {
+        Window& window = windows[w];
+        uint32_t start = now - now % WINDOW_LENGTHS[w];
+
+        // Later window (or clock stepped back): summarize and restart
+        if (window.open && window.start != start) {
+            close(window, w, data.serialNumber, sink);
+        }
+        if (!window.open) {
+            window.open = true;
+            window.start = start;
+        }
+
+        for (uint8_t c = 0; c < PQChannel::COUNT; c++) {
+            window.channels[c].add(values[c], bins[c]);
+        }
+    }
+
+    for (uint8_t c = 0; c < PQChannel::COUNT; c++) {
+        checkLimits(c, values[c], now, data.serialNumber, sink);
+    }
+}
+
+void EdgeAggregator::close(Window& window, uint8_t index, const char* serial,
+                           AggregateSink& sink) {
+    WindowSummary summary;
+    summary.serial = serial;
+    summary.start = window.start;
+    summary.length = WINDOW_LENGTHS[index];
+    summary.samples = window.channels[0].count;
+
+    for (uint8_t c = 0; c < PQChannel::COUNT; c++) {
+        const Accumulator& a = window.channels[c];
+        const ChannelSpec& spec = CHANNELS[c];
+        ChannelSummary& s = summary.channels[c];
+
+        double mean = a.count ? a.sum / a.count : 0.0;
+        double variance = a.count ? a.sumSquares / a.count - mean * mean : 0.0;
+
+        s.min = a.min;
+        s.max = a.max;
+        s.mean = mean;
+        s.stddev = variance > 0.0 ? sqrt(variance) : 0.0f;
+        s.p5 = a.percentile(0.05f, spec.low, spec.high);
+        s.p50 = a.percentile(0.50f, spec.low, spec.high);
+        s.p95 = a.percentile(0.95f, spec.low, spec.high);
+    }
+
+    sink.onWindow(summary);
+
+    window.open = false;
+    for (uint8_t c = 0; c < PQChannel::COUNT; c++) {
+        window.channels[c].clear();
+    }
+}
+
+void EdgeAggregator::checkLimits(uint8_t channel, float value, uint32_t time,
+                                 const char* serial, AggregateSink& sink) {
+    const ChannelSpec& spec = CHANNELS[channel];
+    int8_t state = limitState[channel];
+    int8_t next = state;
+    float limit = 0.0f;
+
+    // NAN limits compare false and never trigger
+    if (value > spec.limitHigh) {
+        next = 1;
+        limit = spec.limitHigh;
+    } else if (value < spec.limitLow) {
+        next = -1;
+        limit = spec.limitLow;
+    } else if (state == 1 && value < spec.limitHigh - fabsf(spec.limitHigh) * PQ_HYSTERESIS) {
+        next = 0;
+        limit = spec.limitHigh;
+    } else if (state == -1 && value > spec.limitLow + fabsf(spec.limitLow) * PQ_HYSTERESIS) {
+        next = 0;
+        limit = spec.limitLow;
+    }
+
+    if (next == state) return;
+    limitState[channel] = next;
+
+    ThresholdEvent event;
+    event.serial = serial;
+    event.time = time;
+    event.channel = channel;
+    event.state = next;
+    event.value = value;
+    event.limit = limit;
+    sink.onEvent(event);
+}
@@ -0,0 +1,164 @@
+/**
+ * @file EdgeAggregator.h
+ * @brief On-device power-quality statistics over the instantaneous values
+ * @version 2.0
+ * @date 2025-10-02
+ *
+ * Every reading feeds the nine instantaneous channels (voltage r/y/b,
+ * current r/y/b/n, power factor, frequency) into three clock-aligned
+ * windows (PQ_WINDOW_SHORT/MEDIUM/LONG). Each channel and window keeps
+ * count, min, max, sum, sum of squares and a PQ_HISTOGRAM_BINS histogram
+ * over a fixed span, so memory does not depend on the sampling rate.
+ * When a sample lands past the end of a window the window is summarized
+ * (mean, standard deviation, approximate p5/p50/p95 from the histogram,
+ * clamped to the exact min/max) and handed to an AggregateSink. Limit
+ * crossings are reported as they happen, with hysteresis so a value
+ * sitting on a limit does not flap.
+ */
+
+#ifndef EDGE_AGGREGATOR_H
+#define EDGE_AGGREGATOR_H
+
+#include <Arduino.h>
+#include "../config/config.h"
+#include "MeterData.h"
+
+/**
+ * @namespace PQChannel
+ * @brief Instantaneous channels, in payload order
+ */
+namespace PQChannel {
+    const uint8_t VOLTAGE_R = 0;
+    const uint8_t VOLTAGE_Y = 1;
+    const uint8_t VOLTAGE_B = 2;
+    const uint8_t CURRENT_R = 3;
+    const uint8_t CURRENT_Y = 4;
+    const uint8_t CURRENT_B = 5;
+    const uint8_t CURRENT_N = 6;
+    const uint8_t POWER_FACTOR = 7;
+    const uint8_t FREQUENCY = 8;
+    const uint8_t COUNT = 9;
+
+    /**
+     * @brief Short channel name ("v_r", "pf", ...)
+     */
+    const char* name(uint8_t channel);
+}
+
+/**
+ * @struct ChannelSummary
+ * @brief Statistics of one channel over one window
+ */
+struct ChannelSummary {
+    float min;
+    float max;
+    float mean;
+    float stddev;
+    float p5;
+    float p50;
+    float p95;
+};
+
+/**
+ * @struct WindowSummary
+ * @brief Closed window, all channels
+ */
+struct WindowSummary {
+    const char* serial;
+    uint32_t start;         // Window start, meter local epoch (or uptime s)
+    uint16_t length;        // Window length in s
+    uint16_t samples;
+    ChannelSummary channels[PQChannel::COUNT];
+};
+
+/**
+ * @struct ThresholdEvent
+ * @brief Channel left or returned within its limits
+ */
+struct ThresholdEvent {
+    const char* serial;
+    uint32_t time;
+    uint8_t channel;
+    int8_t state;           // +1 above high limit, -1 below low limit, 0 back in range
+    float value;
+    float limit;            // Limit crossed (for state 0, the one re-armed)
+};
+
+/**
+ * @class AggregateSink
+ * @brief Receives window summaries and threshold events
+ */
+class AggregateSink {
+public:
+    virtual ~AggregateSink() {}
+    virtual void onWindow(const WindowSummary& summary) = 0;
+    virtual void onEvent(const ThresholdEvent& event) = 0;
+};
+
+/**
+ * @class EdgeAggregator
+ * @brief Fixed-memory windows and limit tracking for one meter
+ */
+class EdgeAggregator {
+public:
+    static const uint8_t WINDOWS = 3;
+
+    /**
+     * @brief Constructor
+     */
+    EdgeAggregator();
+
+    /**
+     * @brief Feed one reading
+     * @param data Valid meter data (instantaneous fields are sampled)
+     * @param sink Receives windows closed and limits crossed by this sample
+     */
+    void add(const MeterData& data, AggregateSink& sink);
+
+    /**
+     * @brief Drop all open windows and limit states
+     */
+    void clear();
+
+    /**
+     * @brief Length of window index in s
+     */
+    static uint16_t windowLength(uint8_t window);
+
+private:
+    /**
+     * @struct Accumulator
+     * @brief Running statistics of one channel in one window
+     */
+    struct Accumulator {
+        uint16_t count;
+        float min;
+        float max;
+        double sum;
+        double sumSquares;
+        uint16_t bins[PQ_HISTOGRAM_BINS];
+
+        void clear();
+        void add(float value, uint8_t bin);
+        float percentile(float fraction, float low, float high) const;
+    };
+
+    /**
+     * @struct Window
+     * @brief One open window over every channel
+     */
+    struct Window {
+        uint32_t start;
+        bool open;
+        Accumulator channels[PQChannel::COUNT];
+    };
+
+    Window windows[WINDOWS];
+    int8_t limitState[PQChannel::COUNT];    // Last ThresholdEvent state
+
+    void close(Window& window, uint8_t index, const char* serial, AggregateSink& sink);
+    void checkLimits(uint8_t channel, float value, uint32_t time, const char* serial,
+                     AggregateSink& sink);
+};
+
+#endif // EDGE_AGGREGATOR_H
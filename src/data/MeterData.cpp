@@ -6,6 +6,36 @@
  */
 
 #include "MeterData.h"
+#include "../utils/DLMSDateTime.h"
+#include "../utils/Logger.h"
+
+/**
+ * @brief Add epoch as "YYYY-MM-DD HH:MM:SS" ("" if not available)
+ */
+static void putTime(JsonObject object, const char* key, uint32_t epoch) {
+    char text[20] = "";
+    if (epoch != 0) {
+        DLMSDateTime::format(epoch, text);
+    }
+    object[key] = text;     // Non-const char* is copied into the document
+}
+
+/**
+ * @brief Copy into a fixed text field, truncating
+ */
+static void copyText(char* dest, const char* src) {
+    strncpy(dest, src, MeterData::TEXT_SIZE - 1);
+    dest[MeterData::TEXT_SIZE - 1] = '\0';
+}
+
+/**
+ * @brief Format epoch for print ("-" if not available)
+ */
+static const char* timeText(uint32_t epoch, char* text) {
+    if (epoch == 0) return "-";
+    DLMSDateTime::format(epoch, text);
+    return text;
+}
 
 /**
  * @brief Constructor - initialize all values
@@ -18,9 +48,9 @@ MeterData::MeterData() {
  * @brief Clear all meter data
  */
 void MeterData::clear() {
-    serialNumber = "";
-    manufacturer = "";
-    meterType = "";
+    serialNumber[0] = '\0';
+    manufacturer[0] = '\0';
+    meterType[0] = '\0';
     multiplicationFactor = 1.0;
     
     kwhImport = kvahImport = kvarhLag = kvarhLead = 0.0;
@@ -40,7 +70,7 @@ void MeterData::clear() {
     }
     
     lastReadTime = 0;
-    lastReadTimestamp = "";
+    lastReadTimestamp = 0;
     dataValid = false;
     errorCount = 0;
 }
@@ -50,7 +80,7 @@ void MeterData::clear() {
  */
 bool MeterData::isValid() const {
     return dataValid && 
-           !serialNumber.isEmpty() && 
+           serialNumber[0] != '\0' && 
            (kwhImport > 0 || kvahImport > 0);
 }
 
@@ -79,13 +109,13 @@ bool MeterData::toJson(JsonDocument& doc, bool includeTOD) const {
     // Maximum Demand
     JsonObject md = doc.createNestedObject("maximum_demand");
     md["kw_import"] = mdKWImport.value;
-    md["kw_import_time"] = mdKWImport.timestamp;
+    putTime(md, "kw_import_time", mdKWImport.timestamp);
     md["kva_import"] = mdKVAImport.value;
-    md["kva_import_time"] = mdKVAImport.timestamp;
+    putTime(md, "kva_import_time", mdKVAImport.timestamp);
     md["kw_export"] = mdKWExport.value;
-    md["kw_export_time"] = mdKWExport.timestamp;
+    putTime(md, "kw_export_time", mdKWExport.timestamp);
     md["kva_export"] = mdKVAExport.value;
-    md["kva_export_time"] = mdKVAExport.timestamp;
+    putTime(md, "kva_export_time", mdKVAExport.timestamp);
     
     // Instantaneous values
     JsonObject instant = doc.createNestedObject("instantaneous");
@@ -113,17 +143,17 @@ bool MeterData::toJson(JsonDocument& doc, bool includeTOD) const {
             zone["kvah"] = todZones[i].kvah;
             zone["md_kw"] = todZones[i].mdKW;
             zone["md_kva"] = todZones[i].mdKVA;
-            if (!todZones[i].mdKWTimestamp.isEmpty()) {
-                zone["md_kw_time"] = todZones[i].mdKWTimestamp;
+            if (todZones[i].mdKWTimestamp != 0) {
+                putTime(zone, "md_kw_time", todZones[i].mdKWTimestamp);
             }
-            if (!todZones[i].mdKVATimestamp.isEmpty()) {
-                zone["md_kva_time"] = todZones[i].mdKVATimestamp;
+            if (todZones[i].mdKVATimestamp != 0) {
+                putTime(zone, "md_kva_time", todZones[i].mdKVATimestamp);
             }
         }
     }
     
     // Metadata
-    doc["timestamp"] = lastReadTimestamp;
+    putTime(doc.as<JsonObject>(), "timestamp", lastReadTimestamp);
     doc["valid"] = dataValid;
     doc["error_count"] = errorCount;
     
@@ -131,15 +161,12 @@ bool MeterData::toJson(JsonDocument& doc, bool includeTOD) const {
 }
 
 /**
- * @brief Convert to JSON string
+ * @brief Serialize to a Print without a heap document
  */
-String MeterData::toJsonString(bool includeTOD) const {
-    DynamicJsonDocument doc(4096);
+size_t MeterData::toJson(Print& out, bool includeTOD) const {
+    StaticJsonDocument<JSON_CAPACITY> doc;
     toJson(doc, includeTOD);
-    
-    String output;
-    serializeJson(doc, output);
-    return output;
+    return serializeJson(doc, out);
 }
 
 /**
@@ -148,9 +175,9 @@ String MeterData::toJsonString(bool includeTOD) const {
 bool MeterData::fromJson(const JsonDocument& doc) {
     try {
         if (doc.containsKey("meter")) {
-            serialNumber = doc["meter"]["serial"].as<String>();
-            manufacturer = doc["meter"]["manufacturer"].as<String>();
-            meterType = doc["meter"]["type"].as<String>();
+            copyText(serialNumber, doc["meter"]["serial"] | "");
+            copyText(manufacturer, doc["meter"]["manufacturer"] | "");
+            copyText(meterType, doc["meter"]["type"] | "");
             multiplicationFactor = doc["meter"]["mf"] | 1.0;
         }
         
@@ -165,7 +192,7 @@ bool MeterData::fromJson(const JsonDocument& doc) {
         
         // Add more parsing as needed
         
-        lastReadTimestamp = doc["timestamp"].as<String>();
+        lastReadTimestamp = DLMSDateTime::parse(doc["timestamp"] | "");
         dataValid = doc["valid"] | false;
         errorCount = doc["error_count"] | 0;
         
@@ -179,53 +206,53 @@ bool MeterData::fromJson(const JsonDocument& doc) {
  * @brief Print detailed meter data
  */
 void MeterData::print() const {
-    Serial.println("\n========== METER DATA ==========");
-    Serial.println("Serial Number: " + serialNumber);
-    Serial.println("Manufacturer: " + manufacturer);
-    Serial.println("MF: " + String(multiplicationFactor));
-    Serial.println("\n--- Energy ---");
-    Serial.println("kWh Import: " + String(kwhImport, 3));
-    Serial.println("kVAh Import: " + String(kvahImport, 3));
-    Serial.println("kWh Export: " + String(kwhExport, 3));
-    Serial.println("kVAh Export: " + String(kvahExport, 3));
-    Serial.println("kVArh Lag: " + String(kvarhLag, 3));
-    Serial.println("kVArh Lead: " + String(kvarhLead, 3));
-    
-    Serial.println("\n--- Maximum Demand ---");
-    Serial.println("MD kW Import: " + String(mdKWImport.value, 3) + " @ " + mdKWImport.timestamp);
-    Serial.println("MD kVA Import: " + String(mdKVAImport.value, 3) + " @ " + mdKVAImport.timestamp);
-    
-    Serial.println("\n--- Instantaneous Values ---");
-    Serial.println("Voltage R/Y/B: " + String(voltageR, 1) + "/" + 
-                   String(voltageY, 1) + "/" + String(voltageB, 1) + " V");
-    Serial.println("Current R/Y/B: " + String(currentR, 2) + "/" + 
-                   String(currentY, 2) + "/" + String(currentB, 2) + " A");
-    Serial.println("Power Factor: " + String(powerFactor, 3));
-    Serial.println("Frequency: " + String(frequency, 2) + " Hz");
-    
-    Serial.println("\n--- TOD Zones ---");
+    char text[20];
+    
+    LOG_INFO("========== METER DATA ==========");
+    LOG_INFOF("Serial Number: %s", serialNumber);
+    LOG_INFOF("Manufacturer: %s", manufacturer);
+    LOG_INFOF("MF: %.2f", multiplicationFactor);
+    LOG_INFO("--- Energy ---");
+    LOG_INFOF("kWh Import: %.3f", kwhImport);
+    LOG_INFOF("kVAh Import: %.3f", kvahImport);
+    LOG_INFOF("kWh Export: %.3f", kwhExport);
+    LOG_INFOF("kVAh Export: %.3f", kvahExport);
+    LOG_INFOF("kVArh Lag: %.3f", kvarhLag);
+    LOG_INFOF("kVArh Lead: %.3f", kvarhLead);
+    
+    LOG_INFO("--- Maximum Demand ---");
+    LOG_INFOF("MD kW Import: %.3f @ %s", mdKWImport.value, timeText(mdKWImport.timestamp, text));
+    LOG_INFOF("MD kVA Import: %.3f @ %s", mdKVAImport.value, timeText(mdKVAImport.timestamp, text));
+    
+    LOG_INFO("--- Instantaneous Values ---");
+    LOG_INFOF("Voltage R/Y/B: %.1f/%.1f/%.1f V", voltageR, voltageY, voltageB);
+    LOG_INFOF("Current R/Y/B: %.2f/%.2f/%.2f A", currentR, currentY, currentB);
+    LOG_INFOF("Power Factor: %.3f", powerFactor);
+    LOG_INFOF("Frequency: %.2f Hz", frequency);
+    
+    LOG_INFO("--- TOD Zones ---");
     for (int i = 0; i < 8; i++) {
         if (todZones[i].kwh > 0 || todZones[i].kvah > 0) {
-            Serial.println("Zone " + String(i + 1) + ": kWh=" + String(todZones[i].kwh, 3) + 
-                          ", kVAh=" + String(todZones[i].kvah, 3));
+            LOG_INFOF("Zone %d: kWh=%.3f, kVAh=%.3f", i + 1, todZones[i].kwh, todZones[i].kvah);
         }
     }
     
-    Serial.println("\nTimestamp: " + lastReadTimestamp);
-    Serial.println("Valid: " + String(dataValid ? "Yes" : "No"));
-    Serial.println("================================\n");
+    LOG_INFOF("Timestamp: %s", timeText(lastReadTimestamp, text));
+    LOG_INFOF("Valid: %s", dataValid ? "Yes" : "No");
+    LOG_INFO("================================");
 }
 
 /**
  * @brief Print compact summary
+ * 
+ * Runs every poll, so it goes through the deferred logger: no String,
+ * no blocking UART write on the metering task.
  */
 void MeterData::printSummary() const {
-    Serial.println("\n--- Meter Summary ---");
-    Serial.println("S/N: " + serialNumber + " | " + manufacturer);
-    Serial.println("kWh: " + String(kwhImport, 2) + " | MD: " + String(mdKWImport.value, 2) + " kW");
-    Serial.println("V(R/Y/B): " + String(voltageR, 0) + "/" + String(voltageY, 0) + "/" + String(voltageB, 0));
-    Serial.println("PF: " + String(powerFactor, 2) + " | Freq: " + String(frequency, 1) + " Hz");
-    Serial.println("---------------------\n");
+    LOG_INFOF("S/N: %s | %s", serialNumber, manufacturer);
+    LOG_INFOF("kWh: %.2f | MD: %.2f kW", kwhImport, mdKWImport.value);
+    LOG_INFOF("V(R/Y/B): %.0f/%.0f/%.0f", voltageR, voltageY, voltageB);
+    LOG_INFOF("PF: %.2f | Freq: %.1f Hz", powerFactor, frequency);
 }
 
 /**
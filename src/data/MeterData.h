@@ -17,13 +17,13 @@
  */
 struct MaximumDemand {
     float value;
-    String timestamp;
+    uint32_t timestamp;     // Meter local epoch, 0 = not available
     
-    MaximumDemand() : value(0.0), timestamp("") {}
+    MaximumDemand() : value(0.0), timestamp(0) {}
     
     void clear() {
         value = 0.0;
-        timestamp = "";
+        timestamp = 0;
     }
 };
 
@@ -36,29 +36,47 @@ struct TODData {
     float kvah;
     float mdKW;
     float mdKVA;
-    String kwhTimestamp;
-    String kvahTimestamp;
-    String mdKWTimestamp;
-    String mdKVATimestamp;
+    uint32_t kwhTimestamp;      // Meter local epoch, 0 = not available
+    uint32_t kvahTimestamp;
+    uint32_t mdKWTimestamp;
+    uint32_t mdKVATimestamp;
     
-    TODData() : kwh(0), kvah(0), mdKW(0), mdKVA(0) {}
+    TODData() { clear(); }
     
     void clear() {
         kwh = kvah = mdKW = mdKVA = 0;
-        kwhTimestamp = kvahTimestamp = mdKWTimestamp = mdKVATimestamp = "";
+        kwhTimestamp = kvahTimestamp = mdKWTimestamp = mdKVATimestamp = 0;
     }
 };
 
 /**
  * @class MeterData
  * @brief Complete meter data storage and management
+ *
+ * Fixed layout without heap members: text is held in inline buffers and
+ * times as meter local epoch seconds, formatted only by toJson/print.
  */
 class MeterData {
 public:
+    static const uint8_t TEXT_SIZE = 24;    // Identification strings incl. terminator
+    
+    /**
+     * @brief JsonDocument capacity of toJson with TOD zones
+     *
+     * Root, meter, energy, maximum_demand, instantaneous with voltage and
+     * current, tod_zones with 8 zones; plus copied strings: 21 formatted
+     * times and (if copied) the identification texts.
+     */
+    static const size_t JSON_CAPACITY =
+        JSON_OBJECT_SIZE(8) + JSON_OBJECT_SIZE(4) + JSON_OBJECT_SIZE(6) +
+        JSON_OBJECT_SIZE(8) + JSON_OBJECT_SIZE(4) + JSON_OBJECT_SIZE(3) +
+        JSON_OBJECT_SIZE(4) + JSON_ARRAY_SIZE(8) + 8 * JSON_OBJECT_SIZE(7) +
+        21 * 20 + 3 * TEXT_SIZE;
+    
     // Meter identification
-    String serialNumber;
-    String manufacturer;
-    String meterType;
+    char serialNumber[TEXT_SIZE];
+    char manufacturer[TEXT_SIZE];
+    char meterType[TEXT_SIZE];
     float multiplicationFactor;
     
     // Energy counters - Import
@@ -99,7 +117,7 @@ public:
     
     // Metadata
     unsigned long lastReadTime;
-    String lastReadTimestamp;
+    uint32_t lastReadTimestamp;     // Meter local epoch, 0 = clock not set
     bool dataValid;
     uint8_t errorCount;
     
@@ -128,11 +146,16 @@ public:
     bool toJson(JsonDocument& doc, bool includeTOD = true) const;
     
     /**
-     * @brief Create JSON string
+     * @brief Serialize as JSON straight into a Print (socket, buffer)
+     *
+     * The document lives on the caller's stack for the duration of the
+     * call (JSON_CAPACITY bytes); nothing touches the heap.
+     *
+     * @param out Destination
      * @param includeTOD Include TOD data
-     * @return JSON string
+     * @return Bytes written
      */
-    String toJsonString(bool includeTOD = true) const;
+    size_t toJson(Print& out, bool includeTOD = true) const;
     
     /**
      * @brief Load from JSON document
@@ -142,12 +165,12 @@ public:
     bool fromJson(const JsonDocument& doc);
     
     /**
-     * @brief Print formatted data to Serial
+     * @brief Log formatted data (INFO)
      */
     void print() const;
     
     /**
-     * @brief Print compact summary
+     * @brief Log compact summary (INFO)
      */
     void printSummary() const;
     
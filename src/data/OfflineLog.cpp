@@ -0,0 +1,274 @@
+/**
+ * @file OfflineLog.cpp
+ * @brief Implementation of flash ring log
+ * @version 2.0
+ * @date 2025-10-02
+ */
+
+#include "OfflineLog.h"
+#include "../utils/CRCCalculator.h"
+#include "../utils/Logger.h"
+
+#if SPIFFS_ENABLED
+#include <SPIFFS.h>
+#endif
+
+#if PREFERENCES_ENABLED
+#include <Preferences.h>
+#endif
+
+// Cursor never stored in Preferences
+static const uint32_t UNSET = 0xFFFFFFFF;
+
+OfflineLog::OfflineLog() : ready(false), nextSequence(1) {
+    memset(delivered, 0, sizeof(delivered));
+#ifdef ARDUINO_ARCH_ESP32
+    mutex = nullptr;
+#endif
+}
+
+bool OfflineLog::begin() {
+#if SPIFFS_ENABLED
+#ifdef ARDUINO_ARCH_ESP32
+    if (!mutex) mutex = xSemaphoreCreateMutex();
+#endif
+    
+    if (!SPIFFS.begin(true)) {
+        LOG_ERROR("SPIFFS mount failed - offline log disabled");
+        return false;
+    }
+
+    const size_t fileSize = (size_t)MAX_OFFLINE_BUFFER * OFFLINE_RECORD_SIZE;
+
+    // Preallocate every slot once so appends never grow the file
+    File file = SPIFFS.open(OFFLINE_LOG_FILE, "r");
+    bool allocated = file && file.size() == fileSize;
+    if (file) file.close();
+
+    if (!allocated) {
+        file = SPIFFS.open(OFFLINE_LOG_FILE, "w");
+        if (!file) {
+            LOG_ERROR("Cannot create offline log");
+            return false;
+        }
+        uint8_t blank[OFFLINE_RECORD_SIZE];
+        memset(blank, 0xFF, sizeof(blank));
+        for (uint16_t i = 0; i < MAX_OFFLINE_BUFFER; i++) {
+            file.write(blank, sizeof(blank));
+        }
+        file.close();
+        LOG_INFO("Offline log created (" + String(fileSize) + " bytes)");
+    }
+
+#if PREFERENCES_ENABLED
+    Preferences prefs;
+    if (prefs.begin(OFFLINE_NAMESPACE, true)) {
+        char key[8];
+        for (uint8_t c = 0; c < LogCursor::COUNT; c++) {
+            cursorKey(c, key);
+            delivered[c] = prefs.getUInt(key, UNSET);
+        }
+        prefs.end();
+    }
+#endif
+
+    // Newest valid record decides where the next append goes
+    Header header;
+    uint8_t payload[MAX_PAYLOAD];
+    uint32_t newest = 0;
+    file = SPIFFS.open(OFFLINE_LOG_FILE, "r");
+    for (uint16_t slot = 0; file && slot < MAX_OFFLINE_BUFFER; slot++) {
+        if (readSlot(file, slot, header, payload) && header.sequence > newest) {
+            newest = header.sequence;
+        }
+    }
+    if (file) file.close();
+
+    for (uint8_t c = 0; c < LogCursor::COUNT; c++) {
+        if (delivered[c] != UNSET && newest < delivered[c]) newest = delivered[c];
+    }
+    nextSequence = newest + 1;
+    for (uint8_t c = 0; c < LogCursor::COUNT; c++) {
+        if (delivered[c] == UNSET) {
+            // A backend new to this log starts at its end, the MQTT one
+            // (always stored) at its start
+            delivered[c] = c == LogCursor::MQTT ? 0 : newest;
+            saveDelivered(c);
+        }
+        if (newest - delivered[c] > MAX_OFFLINE_BUFFER) {
+            delivered[c] = newest - MAX_OFFLINE_BUFFER;
+        }
+    }
+
+    ready = true;
+    if (pending(LogCursor::MQTT) > 0) {
+        LOG_INFO("Offline log: " + String(pending(LogCursor::MQTT)) + " readings pending");
+    }
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool OfflineLog::append(const uint8_t* payload, size_t length, uint8_t taken) {
+    if (!ready || length == 0 || length > MAX_PAYLOAD) return false;
+
+#if SPIFFS_ENABLED
+    lock();
+    
+    Header header;
+    header.magic = MAGIC;
+    header.length = length;
+    header.sequence = nextSequence;
+    header.taken = taken;
+    header.reserved = 0;
+    header.crc = recordCRC(header, payload);
+
+    File file = SPIFFS.open(OFFLINE_LOG_FILE, "r+");
+    if (!file) {
+        unlock();
+        LOG_ERROR("Cannot open offline log");
+        return false;
+    }
+
+    uint16_t slot = nextSequence % MAX_OFFLINE_BUFFER;
+    bool ok = file.seek((uint32_t)slot * OFFLINE_RECORD_SIZE, SeekSet) &&
+              file.write((const uint8_t*)&header, sizeof(header)) == sizeof(header) &&
+              file.write(payload, length) == length;
+    file.close();
+
+    if (!ok) {
+        unlock();
+        LOG_ERROR("Offline log write failed");
+        return false;
+    }
+
+    nextSequence++;
+
+    bool dropped = false;
+    for (uint8_t c = 0; c < LogCursor::COUNT; c++) {
+        // Caught-up cursors that have the record already need not read it
+        if ((taken & LogCursor::bit(c)) && delivered[c] == header.sequence - 1) {
+            delivered[c] = header.sequence;
+        }
+        // Full ring: the record just written replaced the oldest pending one
+        if (pending(c) > MAX_OFFLINE_BUFFER) {
+            delivered[c] = nextSequence - 1 - MAX_OFFLINE_BUFFER;
+            dropped = true;
+        }
+    }
+    unlock();
+
+    if (dropped) {
+        LOG_WARN("Offline log full - oldest reading dropped");
+    }
+    return true;
+#else
+    return false;
+#endif
+}
+
+uint16_t OfflineLog::drain(uint8_t cursor, uint16_t maxRecords, OfflineRecordSink& sink) {
+    if (!ready || pending(cursor) == 0) return 0;
+
+#if SPIFFS_ENABLED
+    Header header;
+    uint8_t payload[MAX_PAYLOAD];
+    uint16_t sent = 0;
+    uint32_t start = delivered[cursor];
+
+    while (sent < maxRecords) {
+        // Locked for the slot read only: delivery may take seconds
+        lock();
+        if (pending(cursor) == 0) {
+            unlock();
+            break;
+        }
+        uint32_t sequence = delivered[cursor] + 1;
+        File file = SPIFFS.open(OFFLINE_LOG_FILE, "r");
+        if (!file) {
+            unlock();
+            break;
+        }
+        bool valid = readSlot(file, sequence % MAX_OFFLINE_BUFFER, header, payload) &&
+                     header.sequence == sequence;
+        file.close();
+        unlock();
+
+        if (!valid) {
+            LOG_WARN("Offline record " + String(sequence) + " unreadable - skipped");
+        } else if (!(header.taken & LogCursor::bit(cursor))) {
+            if (!sink.onRecord(payload, header.length)) break;
+            sent++;
+        }
+
+        // A full ring may have moved the cursor past this record meanwhile
+        lock();
+        if (delivered[cursor] < sequence) delivered[cursor] = sequence;
+        unlock();
+    }
+
+    if (delivered[cursor] != start) {
+        saveDelivered(cursor);
+    }
+
+    if (sent > 0) {
+        LOG_INFO("Offline log: sent " + String(sent) + ", " +
+                 String(pending(cursor)) + " pending");
+    }
+    return sent;
+#else
+    return 0;
+#endif
+}
+
+#if SPIFFS_ENABLED
+bool OfflineLog::readSlot(File& file, uint16_t slot, Header& header, uint8_t* payload) {
+    return file.seek((uint32_t)slot * OFFLINE_RECORD_SIZE, SeekSet) &&
+           file.read((uint8_t*)&header, sizeof(header)) == sizeof(header) &&
+           header.magic == MAGIC && header.length <= MAX_PAYLOAD &&
+           file.read(payload, header.length) == header.length &&
+           header.crc == recordCRC(header, payload);
+}
+#endif
+
+uint16_t OfflineLog::recordCRC(const Header& header, const uint8_t* payload) {
+    uint16_t crc = CRCCalculator::INITIAL_VALUE;
+    crc = CRCCalculator::update(crc, (const uint8_t*)&header.length, sizeof(header.length));
+    crc = CRCCalculator::update(crc, (const uint8_t*)&header.sequence, sizeof(header.sequence));
+    crc = CRCCalculator::update(crc, payload, header.length);
+    return ~crc;
+}
+
+void OfflineLog::saveDelivered(uint8_t cursor) {
+#if PREFERENCES_ENABLED
+    Preferences prefs;
+    if (prefs.begin(OFFLINE_NAMESPACE, false)) {
+        char key[8];
+        cursorKey(cursor, key);
+        prefs.putUInt(key, delivered[cursor]);
+        prefs.end();
+    }
+#endif
+}
+
+void OfflineLog::cursorKey(uint8_t cursor, char* key) {
+    // The MQTT cursor keeps the key of the single-cursor log
+    if (cursor == LogCursor::MQTT) {
+        strcpy(key, "sent");
+    } else {
+        snprintf(key, 8, "sent%u", cursor);
+    }
+}
+
+void OfflineLog::lock() {
+#ifdef ARDUINO_ARCH_ESP32
+    if (mutex) xSemaphoreTake(mutex, portMAX_DELAY);
+#endif
+}
+
+void OfflineLog::unlock() {
+#ifdef ARDUINO_ARCH_ESP32
+    if (mutex) xSemaphoreGive(mutex);
+#endif
+}
@@ -0,0 +1,167 @@
+/**
+ * @file OfflineLog.h
+ * @brief Ring log in flash for readings the uplink could not take
+ * @version 2.0
+ * @date 2025-10-02
+ *
+ * A preallocated file of MAX_OFFLINE_BUFFER fixed-size slots. Record n
+ * lives in slot n % MAX_OFFLINE_BUFFER, so an append is one seek and one
+ * write and consecutive appends walk the whole file, spreading flash
+ * wear. Each slot holds a header (magic, length, sequence, CRC16 over
+ * sequence, length and payload) followed by a binary payload
+ * (PayloadEncoder schema). A slot torn by a power cut fails its CRC and
+ * is skipped.
+ *
+ * The newest sequence is found by scanning headers at boot. Only the
+ * last sequence delivered per cursor is persisted (Preferences), once
+ * per drained batch. When the ring is full the oldest records are overwritten.
+ *
+ * Every uplink backend reads the log through a cursor of its own
+ * (LogCursor), so one that is down or slow keeps its backlog without
+ * holding back the others. A record can be marked as already taken by
+ * some backends when it is appended (they sent it live); their cursors
+ * step over it. Cursors drain from different tasks: the log state is
+ * locked only while a slot is read, never while a record is delivered.
+ */
+
+#ifndef OFFLINE_LOG_H
+#define OFFLINE_LOG_H
+
+#include <Arduino.h>
+#include "../config/config.h"
+
+#if SPIFFS_ENABLED
+#include <FS.h>
+#endif
+
+/**
+ * @namespace LogCursor
+ * @brief Offline log cursors, one per uplink backend
+ */
+namespace LogCursor {
+    const uint8_t MQTT       = 0;
+    const uint8_t HTTP       = 1;
+    const uint8_t THINGSPEAK = 2;
+    const uint8_t COUNT      = 3;
+
+    inline uint8_t bit(uint8_t cursor) { return 1 << cursor; }
+}
+
+/**
+ * @class OfflineRecordSink
+ * @brief Receives records replayed from the offline log
+ */
+class OfflineRecordSink {
+public:
+    virtual ~OfflineRecordSink() {}
+
+    /**
+     * @brief Deliver one record
+     * @param payload Record payload
+     * @param length Payload length
+     * @return false to stop replay (record stays pending)
+     */
+    virtual bool onRecord(const uint8_t* payload, size_t length) = 0;
+};
+
+/**
+ * @class OfflineLog
+ * @brief Append-only ring of binary readings in SPIFFS
+ */
+class OfflineLog {
+public:
+    static const uint16_t MAX_PAYLOAD = OFFLINE_RECORD_SIZE - 12;
+
+    /**
+     * @brief Constructor
+     */
+    OfflineLog();
+
+    /**
+     * @brief Mount filesystem, create log file if needed and find head
+     * @return true if the log is usable
+     */
+    bool begin();
+
+    /**
+     * @brief Append one record (overwrites the oldest if full)
+     * @param payload Record payload
+     * @param length Payload length (at most MAX_PAYLOAD)
+     * @param taken LogCursor bits of backends that already have it
+     * @return true if written
+     */
+    bool append(const uint8_t* payload, size_t length, uint8_t taken = 0);
+
+    /**
+     * @brief Replay up to maxRecords pending records of one cursor, oldest first
+     * @param cursor LogCursor
+     * @param maxRecords Burst limit
+     * @param sink Receives each record
+     * @return Number of records delivered
+     */
+    uint16_t drain(uint8_t cursor, uint16_t maxRecords, OfflineRecordSink& sink);
+
+    /**
+     * @brief Records a cursor has not delivered yet
+     *
+     * Counts records it will step over as taken, if one it had not yet
+     * reached was marked so.
+     */
+    uint16_t pending(uint8_t cursor) const { return nextSequence - 1 - delivered[cursor]; }
+
+private:
+    /**
+     * @struct Header
+     * @brief Slot header
+     */
+    struct Header {
+        uint16_t magic;
+        uint16_t length;
+        uint32_t sequence;
+        uint16_t crc;
+        uint8_t taken;          // LogCursor bits sent live (not in the CRC)
+        uint8_t reserved;
+    };
+
+    static const uint16_t MAGIC = 0xD1A5;
+
+    bool ready;
+    uint32_t nextSequence;                  // Sequence of next append (first = 1)
+    uint32_t delivered[LogCursor::COUNT];   // Per cursor: last sequence handed on
+
+#ifdef ARDUINO_ARCH_ESP32
+    SemaphoreHandle_t mutex;
+#endif
+
+    void lock();
+    void unlock();
+
+#if SPIFFS_ENABLED
+    /**
+     * @brief Read and validate the record of one slot
+     * @param file Open log file
+     * @param slot Slot index
+     * @param header Output header
+     * @param payload Output payload (MAX_PAYLOAD bytes)
+     * @return true if the slot holds a valid record
+     */
+    static bool readSlot(File& file, uint16_t slot, Header& header, uint8_t* payload);
+#endif
+
+    /**
+     * @brief CRC over sequence, length and payload
+     */
+    static uint16_t recordCRC(const Header& header, const uint8_t* payload);
+
+    /**
+     * @brief Persist the delivered sequence of one cursor
+     */
+    void saveDelivered(uint8_t cursor);
+
+    /**
+     * @brief Preferences key of a cursor ("sent", "sent1", ...)
+     */
+    static void cursorKey(uint8_t cursor, char* key);
+};
+
+#endif // OFFLINE_LOG_H
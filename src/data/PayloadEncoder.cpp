@@ -0,0 +1,324 @@
+/**
+ * @file PayloadEncoder.cpp
+ * @brief Implementation of binary uplink payloads
+ * @version 2.0
+ * @date 2025-10-02
+ */
+
+#include "PayloadEncoder.h"
+
+// ============================================
+// WRITER
+// ============================================
+
+void PayloadEncoder::Writer::u8(uint8_t v) {
+    if (p >= end) {
+        overflow = true;
+        return;
+    }
+    *p++ = v;
+}
+
+void PayloadEncoder::Writer::u16(uint16_t v) {
+    u8(v & 0xFF);
+    u8((v >> 8) & 0xFF);
+}
+
+void PayloadEncoder::Writer::u32(uint32_t v) {
+    u8(v & 0xFF);
+    u8((v >> 8) & 0xFF);
+    u8((v >> 16) & 0xFF);
+    u8((v >> 24) & 0xFF);
+}
+
+void PayloadEncoder::Writer::f32(float v) {
+    uint32_t bits;
+    memcpy(&bits, &v, sizeof(bits));
+    u32(bits);
+}
+
+void PayloadEncoder::Writer::text(const char* s) {
+    size_t length = strlen(s);
+    if (length > 255) length = 255;
+    u8(length);
+    for (size_t i = 0; i < length; i++) {
+        u8(s[i]);
+    }
+}
+
+void PayloadEncoder::Writer::varint(int64_t v) {
+    // Zigzag keeps small negative deltas short
+    uint64_t z = ((uint64_t)v << 1) ^ (uint64_t)(v >> 63);
+    while (z >= 0x80) {
+        u8((z & 0x7F) | 0x80);
+        z >>= 7;
+    }
+    u8(z);
+}
+
+// ============================================
+// READER
+// ============================================
+
+uint8_t PayloadEncoder::Reader::u8() {
+    if (p >= end) {
+        underflow = true;
+        return 0;
+    }
+    return *p++;
+}
+
+uint32_t PayloadEncoder::Reader::u32() {
+    uint32_t v = u8();
+    v |= (uint32_t)u8() << 8;
+    v |= (uint32_t)u8() << 16;
+    v |= (uint32_t)u8() << 24;
+    return v;
+}
+
+float PayloadEncoder::Reader::f32() {
+    uint32_t bits = u32();
+    float v;
+    memcpy(&v, &bits, sizeof(v));
+    return v;
+}
+
+void PayloadEncoder::Reader::text(char* out, size_t size) {
+    uint8_t length = u8();
+    size_t kept = 0;
+    for (uint8_t i = 0; i < length; i++) {
+        char c = u8();
+        if (kept + 1 < size) out[kept++] = c;
+    }
+    out[kept] = '\0';
+}
+
+// ============================================
+// PAYLOADS
+// ============================================
+
+size_t PayloadEncoder::encodeMeterData(const MeterData& data, bool includeTOD,
+                                       uint8_t* buffer, size_t capacity) {
+    Writer w(buffer, capacity);
+
+    w.u8(SCHEMA_METER_DATA);
+    w.u8(VERSION);
+    w.u8((data.dataValid ? 0x01 : 0) | (includeTOD ? 0x02 : 0));
+    w.u8(data.errorCount);
+    w.u32(data.lastReadTimestamp);
+
+    w.f32(data.multiplicationFactor);
+    w.f32(data.kwhImport);
+    w.f32(data.kvahImport);
+    w.f32(data.kwhExport);
+    w.f32(data.kvahExport);
+    w.f32(data.kvarhLag);
+    w.f32(data.kvarhLead);
+
+    const MaximumDemand* md[] = {
+        &data.mdKWImport, &data.mdKVAImport, &data.mdKWExport, &data.mdKVAExport
+    };
+    for (uint8_t i = 0; i < 4; i++) {
+        w.f32(md[i]->value);
+        w.u32(md[i]->timestamp);
+    }
+
+    w.f32(data.voltageR);
+    w.f32(data.voltageY);
+    w.f32(data.voltageB);
+    w.f32(data.currentR);
+    w.f32(data.currentY);
+    w.f32(data.currentB);
+    w.f32(data.currentNeutral);
+    w.f32(data.powerFactor);
+    w.f32(data.frequency);
+
+    if (includeTOD) {
+        for (uint8_t i = 0; i < TOD_ZONES; i++) {
+            const TODData& zone = data.todZones[i];
+            w.f32(zone.kwh);
+            w.f32(zone.kvah);
+            w.f32(zone.mdKW);
+            w.f32(zone.mdKVA);
+            w.u32(zone.mdKWTimestamp);
+            w.u32(zone.mdKVATimestamp);
+        }
+    }
+
+    w.text(data.serialNumber);
+    w.text(data.manufacturer);
+    w.text(data.meterType);
+
+    return w.overflow ? 0 : w.p - buffer;
+}
+
+bool PayloadEncoder::decodeMeterData(const uint8_t* payload, size_t length, MeterData& data) {
+    Reader r(payload, length);
+
+    // Fields are only appended, so any version of schema 0x01 will do
+    if (r.u8() != SCHEMA_METER_DATA) return false;
+    r.u8();
+
+    data.clear();
+    uint8_t flags = r.u8();
+    data.dataValid = flags & 0x01;
+    data.errorCount = r.u8();
+    data.lastReadTimestamp = r.u32();
+
+    data.multiplicationFactor = r.f32();
+    data.kwhImport = r.f32();
+    data.kvahImport = r.f32();
+    data.kwhExport = r.f32();
+    data.kvahExport = r.f32();
+    data.kvarhLag = r.f32();
+    data.kvarhLead = r.f32();
+
+    MaximumDemand* md[] = {
+        &data.mdKWImport, &data.mdKVAImport, &data.mdKWExport, &data.mdKVAExport
+    };
+    for (uint8_t i = 0; i < 4; i++) {
+        md[i]->value = r.f32();
+        md[i]->timestamp = r.u32();
+    }
+
+    data.voltageR = r.f32();
+    data.voltageY = r.f32();
+    data.voltageB = r.f32();
+    data.currentR = r.f32();
+    data.currentY = r.f32();
+    data.currentB = r.f32();
+    data.currentNeutral = r.f32();
+    data.powerFactor = r.f32();
+    data.frequency = r.f32();
+
+    if (flags & 0x02) {
+        for (uint8_t i = 0; i < TOD_ZONES; i++) {
+            TODData& zone = data.todZones[i];
+            zone.kwh = r.f32();
+            zone.kvah = r.f32();
+            zone.mdKW = r.f32();
+            zone.mdKVA = r.f32();
+            zone.mdKWTimestamp = r.u32();
+            zone.mdKVATimestamp = r.u32();
+        }
+    }
+
+    r.text(data.serialNumber, sizeof(data.serialNumber));
+    r.text(data.manufacturer, sizeof(data.manufacturer));
+    r.text(data.meterType, sizeof(data.meterType));
+
+    return !r.underflow;
+}
+
+size_t PayloadEncoder::encodeProfile(const char* serial, const ProfileRecord* rows,
+                                     uint8_t count, uint8_t* buffer, size_t capacity) {
+    Writer w(buffer, capacity);
+
+    w.u8(SCHEMA_PROFILE);
+    w.u8(VERSION);
+    w.u8(count);
+    w.text(serial);
+
+    for (uint8_t i = 0; i < count; i++) {
+        w.u32(rows[i].captureTime);
+        w.u8(rows[i].valueCount);
+        for (uint8_t v = 0; v < rows[i].valueCount; v++) {
+            w.f32(rows[i].values[v]);
+        }
+    }
+
+    return w.overflow ? 0 : w.p - buffer;
+}
+
+size_t PayloadEncoder::encodeBatch(const ReadingBatch& batch, uint8_t* buffer, size_t capacity) {
+    if (batch.empty()) return 0;
+
+    Writer w(buffer, capacity);
+
+    w.u8(SCHEMA_BATCH);
+    w.u8(VERSION);
+    w.u8(batch.size());
+    w.text(batch.serial());
+    w.f32(batch.multiplier());
+
+    const ReadingBatch::Sample& first = batch.sample(0);
+    for (uint8_t i = 0; i < batch.size(); i++) {
+        const ReadingBatch::Sample& s = batch.sample(i);
+
+        if (i == 0) {
+            w.u32(s.time);
+        } else {
+            w.varint((int64_t)s.time - first.time);
+        }
+        for (uint8_t r = 0; r < ReadingBatch::ENERGY_REGISTERS; r++) {
+            w.varint(i == 0 ? s.energy[r] : s.energy[r] - first.energy[r]);
+        }
+        for (uint8_t v = 0; v < ReadingBatch::INSTANT_VALUES; v++) {
+            w.varint(s.instant[v]);
+        }
+    }
+
+    return w.overflow ? 0 : w.p - buffer;
+}
+
+size_t PayloadEncoder::encodeWindow(const WindowSummary& summary, uint8_t* buffer,
+                                    size_t capacity) {
+    Writer w(buffer, capacity);
+
+    w.u8(SCHEMA_PQ_WINDOW);
+    w.u8(VERSION);
+    w.u32(summary.start);
+    w.u16(summary.length);
+    w.u16(summary.samples);
+    w.text(summary.serial);
+
+    for (uint8_t c = 0; c < PQChannel::COUNT; c++) {
+        const ChannelSummary& s = summary.channels[c];
+        w.f32(s.min);
+        w.f32(s.max);
+        w.f32(s.mean);
+        w.f32(s.stddev);
+        w.f32(s.p5);
+        w.f32(s.p50);
+        w.f32(s.p95);
+    }
+
+    return w.overflow ? 0 : w.p - buffer;
+}
+
+size_t PayloadEncoder::encodeEvent(const ThresholdEvent& event, uint8_t* buffer,
+                                   size_t capacity) {
+    Writer w(buffer, capacity);
+
+    w.u8(SCHEMA_PQ_EVENT);
+    w.u8(VERSION);
+    w.u32(event.time);
+    w.u8(event.channel);
+    w.u8((uint8_t)event.state);
+    w.f32(event.value);
+    w.f32(event.limit);
+    w.text(event.serial);
+
+    return w.overflow ? 0 : w.p - buffer;
+}
+
+size_t PayloadEncoder::encodeChanges(const MeterData& data, const FieldChange* changes,
+                                     uint8_t count, uint8_t* buffer, size_t capacity) {
+    Writer w(buffer, capacity);
+
+    w.u8(SCHEMA_CHANGES);
+    w.u8(VERSION);
+    w.u32(data.lastReadTimestamp);
+    w.text(data.serialNumber);
+    w.u8(count);
+
+    for (uint8_t i = 0; i < count; i++) {
+        w.u8(changes[i].id);
+        w.f32(changes[i].value);
+        if (ChangeReporter::hasTime(changes[i].id)) {
+            w.u32(changes[i].time);
+        }
+    }
+
+    return w.overflow ? 0 : w.p - buffer;
+}
@@ -0,0 +1,235 @@
+/**
+ * @file PayloadEncoder.h
+ * @brief Compact binary uplink payloads (alternative to JSON)
+ * @version 2.0
+ * @date 2025-10-02
+ *
+ * All fields little-endian, floats IEEE-754 single precision, times are
+ * meter local epoch seconds (u32, 0 = not available). Every payload
+ * starts with a schema ID and a version; decoders must reject unknown
+ * schemas and may read newer versions of a schema up to the length
+ * they understand, since fields are only ever appended.
+ *
+ * Schema 0x01 - meter data (topic MQTT_TOPIC_DATA), version 1:
+ *
+ *   off  type     field
+ *   0    u8       schema (0x01)
+ *   1    u8       version (1)
+ *   2    u8       flags: bit 0 data valid, bit 1 TOD block present
+ *   3    u8       error count
+ *   4    u32      read time
+ *   8    f32 x7   mf, kwh_import, kvah_import, kwh_export, kvah_export,
+ *                 kvarh_lag, kvarh_lead
+ *   36   4 x {f32 value, u32 time}
+ *                 md kw_import, kva_import, kw_export, kva_export
+ *   68   f32 x9   voltage r/y/b, current r/y/b/n, power_factor, frequency
+ *   104  TOD_ZONES x {f32 kwh, f32 kvah, f32 md_kw, f32 md_kva,
+ *                     u32 md_kw_time, u32 md_kva_time}      (if flag bit 1)
+ *   ...  3 x {u8 length, ASCII}   serial, manufacturer, type
+ *
+ * Schema 0x02 - load profile rows (topic MQTT_TOPIC_PROFILE), version 1:
+ *
+ *   off  type     field
+ *   0    u8       schema (0x02)
+ *   1    u8       version (1)
+ *   2    u8       row count
+ *   3    u8       length of serial
+ *   4    ASCII    serial
+ *   ...  row count x {u32 capture time, u8 n, f32 x n values}
+ *
+ * Schema 0x03 - batched readings (topic MQTT_TOPIC_BATCH), version 1.
+ * vint = zigzag signed LEB128 varint. Energy in milli-units
+ * (kwh_import, kvah_import, kwh_export, kvah_export, kvarh_lag,
+ * kvarh_lead), instantaneous values in centi-units (voltage r/y/b,
+ * current r/y/b/n, power_factor, frequency):
+ *
+ *   off  type     field
+ *   0    u8       schema (0x03)
+ *   1    u8       version (1)
+ *   2    u8       reading count n
+ *   3    u8       length of serial
+ *   4    ASCII    serial
+ *   ...  f32      mf
+ *   ...  u32      time of reading 0
+ *   ...  vint x6  energy of reading 0
+ *   ...  vint x9  instantaneous values of reading 0
+ *   ...  (n - 1) x {vint time - time 0, vint x6 energy - energy 0,
+ *                   vint x9 instantaneous values}
+ *
+ * Schema 0x04 - power-quality window (topic MQTT_TOPIC_PQ), version 1.
+ * Channels in PQChannel order: voltage r/y/b, current r/y/b/n,
+ * power_factor, frequency:
+ *
+ *   off  type     field
+ *   0    u8       schema (0x04)
+ *   1    u8       version (1)
+ *   2    u32      window start
+ *   6    u16      window length (s)
+ *   8    u16      sample count
+ *   10   u8       length of serial
+ *   11   ASCII    serial
+ *   ...  9 x {f32 min, max, mean, stddev, p5, p50, p95}
+ *
+ * Schema 0x05 - limit crossing (topic MQTT_TOPIC_EVENT), version 1:
+ *
+ *   off  type     field
+ *   0    u8       schema (0x05)
+ *   1    u8       version (1)
+ *   2    u32      time
+ *   6    u8       channel (PQChannel)
+ *   7    i8       state: +1 above high limit, -1 below low, 0 back in range
+ *   8    f32      value
+ *   12   f32      limit
+ *   16   u8       length of serial
+ *   17   ASCII    serial
+ *
+ * Schema 0x06 - changed fields (topic MQTT_TOPIC_DELTA), version 1.
+ * Field IDs and names are listed in ChangeReporter.cpp; values are
+ * absolute, not differences:
+ *
+ *   off  type     field
+ *   0    u8       schema (0x06)
+ *   1    u8       version (1)
+ *   2    u32      read time
+ *   6    u8       length of serial
+ *   7    ASCII    serial
+ *   ...  u8       change count n
+ *   ...  n x {u8 field ID, f32 value, u32 capture time (demand fields only)}
+ */
+
+#ifndef PAYLOAD_ENCODER_H
+#define PAYLOAD_ENCODER_H
+
+#include <Arduino.h>
+#include "../config/config.h"
+#include "MeterData.h"
+#include "ReadingBatch.h"
+#include "EdgeAggregator.h"
+#include "ChangeReporter.h"
+#include "../dlms/ProfileGeneric.h"
+
+/**
+ * @class PayloadEncoder
+ * @brief Writes binary payloads straight into a caller-owned buffer
+ */
+class PayloadEncoder {
+public:
+    static const uint8_t SCHEMA_METER_DATA = 0x01;
+    static const uint8_t SCHEMA_PROFILE = 0x02;
+    static const uint8_t SCHEMA_BATCH = 0x03;
+    static const uint8_t SCHEMA_PQ_WINDOW = 0x04;
+    static const uint8_t SCHEMA_PQ_EVENT = 0x05;
+    static const uint8_t SCHEMA_CHANGES = 0x06;
+    static const uint8_t VERSION = 1;
+
+    // Largest schema 0x01 payload without the TOD block: header and
+    // values (104) plus three identification strings (length + text)
+    static const size_t METER_DATA_MAX = 104 + 3 * MeterData::TEXT_SIZE;
+
+    /**
+     * @brief Encode meter data (schema 0x01)
+     * @param data Meter data
+     * @param includeTOD Append TOD block
+     * @param buffer Output buffer
+     * @param capacity Buffer size
+     * @return Payload length (0 if buffer too small)
+     */
+    static size_t encodeMeterData(const MeterData& data, bool includeTOD,
+                                  uint8_t* buffer, size_t capacity);
+
+    /**
+     * @brief Decode meter data (schema 0x01) back into a reading
+     *
+     * Used by uplinks that replay stored records in another format.
+     *
+     * @param payload Encoded reading
+     * @param length Payload length
+     * @param data Output (TOD zones cleared when the block is absent)
+     * @return false on another schema or a truncated payload
+     */
+    static bool decodeMeterData(const uint8_t* payload, size_t length, MeterData& data);
+
+    /**
+     * @brief Encode load profile rows (schema 0x02)
+     * @param serial Meter serial number
+     * @param rows Profile rows
+     * @param count Number of rows
+     * @param buffer Output buffer
+     * @param capacity Buffer size
+     * @return Payload length (0 if buffer too small)
+     */
+    static size_t encodeProfile(const char* serial, const ProfileRecord* rows,
+                                uint8_t count, uint8_t* buffer, size_t capacity);
+
+    /**
+     * @brief Encode a batch of readings, deltas against the first (schema 0x03)
+     * @param batch Queued readings (not empty)
+     * @param buffer Output buffer
+     * @param capacity Buffer size
+     * @return Payload length (0 if buffer too small)
+     */
+    static size_t encodeBatch(const ReadingBatch& batch, uint8_t* buffer, size_t capacity);
+
+    /**
+     * @brief Encode a power-quality window summary (schema 0x04)
+     * @return Payload length (0 if buffer too small)
+     */
+    static size_t encodeWindow(const WindowSummary& summary, uint8_t* buffer, size_t capacity);
+
+    /**
+     * @brief Encode a limit crossing (schema 0x05)
+     * @return Payload length (0 if buffer too small)
+     */
+    static size_t encodeEvent(const ThresholdEvent& event, uint8_t* buffer, size_t capacity);
+
+    /**
+     * @brief Encode changed fields of a reading (schema 0x06)
+     * @param data Reading (serial and time)
+     * @param changes Fields from ChangeReporter::changes()
+     * @param count Number of changes
+     * @return Payload length (0 if buffer too small)
+     */
+    static size_t encodeChanges(const MeterData& data, const FieldChange* changes,
+                                uint8_t count, uint8_t* buffer, size_t capacity);
+
+private:
+    /**
+     * @struct Writer
+     * @brief Bounds-checked little-endian cursor
+     */
+    struct Writer {
+        uint8_t* p;
+        uint8_t* end;
+        bool overflow;
+
+        Writer(uint8_t* buffer, size_t capacity)
+            : p(buffer), end(buffer + capacity), overflow(false) {}
+
+        void u8(uint8_t v);
+        void u16(uint16_t v);
+        void u32(uint32_t v);
+        void f32(float v);
+        void text(const char* s);
+        void varint(int64_t v);
+    };
+
+    /**
+     * @struct Reader
+     * @brief Bounds-checked little-endian cursor over a payload
+     */
+    struct Reader {
+        const uint8_t* p;
+        const uint8_t* end;
+        bool underflow;
+
+        Reader(const uint8_t* payload, size_t length)
+            : p(payload), end(payload + length), underflow(false) {}
+
+        uint8_t u8();
+        uint32_t u32();
+        float f32();
+        void text(char* out, size_t size);
+    };
+};
+
+#endif // PAYLOAD_ENCODER_H
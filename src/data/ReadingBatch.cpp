@@ -0,0 +1,57 @@
+/**
+ * @file ReadingBatch.cpp
+ * @brief Implementation of reading batch
+ * @version 2.0
+ * @date 2025-10-02
+ */
+
+#include "ReadingBatch.h"
+#include <math.h>
+
+ReadingBatch::ReadingBatch() : count(0), firstAdded(0), multiplicationFactor(1.0f) {
+    serialNumber[0] = '\0';
+}
+
+bool ReadingBatch::add(const MeterData& data) {
+    if (full()) return false;
+
+    if (count == 0) {
+        strncpy(serialNumber, data.serialNumber, sizeof(serialNumber) - 1);
+        serialNumber[sizeof(serialNumber) - 1] = '\0';
+        multiplicationFactor = data.multiplicationFactor;
+        firstAdded = millis();
+    } else if (strcmp(serialNumber, data.serialNumber) != 0) {
+        return false;
+    }
+
+    Sample& s = samples[count++];
+    s.time = data.lastReadTimestamp;
+
+    const float energy[ENERGY_REGISTERS] = {
+        data.kwhImport, data.kvahImport, data.kwhExport,
+        data.kvahExport, data.kvarhLag, data.kvarhLead
+    };
+    for (uint8_t i = 0; i < ENERGY_REGISTERS; i++) {
+        s.energy[i] = llround((double)energy[i] * 1000.0);
+    }
+
+    const float instant[INSTANT_VALUES] = {
+        data.voltageR, data.voltageY, data.voltageB,
+        data.currentR, data.currentY, data.currentB, data.currentNeutral,
+        data.powerFactor, data.frequency
+    };
+    for (uint8_t i = 0; i < INSTANT_VALUES; i++) {
+        s.instant[i] = lroundf(instant[i] * 100.0f);
+    }
+
+    return true;
+}
+
+bool ReadingBatch::due(unsigned long now) const {
+    return count > 0 && (full() || now - firstAdded >= BATCH_MAX_AGE);
+}
+
+void ReadingBatch::clear() {
+    count = 0;
+    serialNumber[0] = '\0';
+}
@@ -0,0 +1,77 @@
+/**
+ * @file ReadingBatch.h
+ * @brief Queue of readings published together as one uplink message
+ * @version 2.0
+ * @date 2025-10-02
+ *
+ * Readings are quantized on entry so the batch stays small in RAM and
+ * encodes to exact integer deltas: cumulative registers in milli-units
+ * (Wh, VAh, varh), instantaneous values in centi-units. The encoded
+ * layout is PayloadEncoder schema 0x03.
+ */
+
+#ifndef READING_BATCH_H
+#define READING_BATCH_H
+
+#include <Arduino.h>
+#include "../config/config.h"
+#include "MeterData.h"
+
+/**
+ * @class ReadingBatch
+ * @brief Fixed-capacity batch of quantized readings from one meter
+ */
+class ReadingBatch {
+public:
+    static const uint8_t ENERGY_REGISTERS = 6;   // kwh/kvah import/export, kvarh lag/lead
+    static const uint8_t INSTANT_VALUES = 9;     // V r/y/b, I r/y/b/n, PF, Hz
+
+    /**
+     * @struct Sample
+     * @brief One quantized reading
+     */
+    struct Sample {
+        uint32_t time;                          // Meter local epoch
+        int64_t energy[ENERGY_REGISTERS];       // Milli-units
+        int32_t instant[INSTANT_VALUES];        // Centi-units
+    };
+
+    /**
+     * @brief Constructor
+     */
+    ReadingBatch();
+
+    /**
+     * @brief Queue a reading
+     * @param data Valid meter data
+     * @return false if full or from another meter (flush first)
+     */
+    bool add(const MeterData& data);
+
+    /**
+     * @brief Size or age threshold reached
+     * @param now Current millis()
+     */
+    bool due(unsigned long now) const;
+
+    /**
+     * @brief Drop all queued readings
+     */
+    void clear();
+
+    uint8_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    bool full() const { return count >= BATCH_MAX_READINGS; }
+    const char* serial() const { return serialNumber; }
+    float multiplier() const { return multiplicationFactor; }
+    const Sample& sample(uint8_t index) const { return samples[index]; }
+
+private:
+    Sample samples[BATCH_MAX_READINGS];
+    uint8_t count;
+    unsigned long firstAdded;                   // millis() of first queued reading
+    char serialNumber[MeterData::TEXT_SIZE];
+    float multiplicationFactor;
+};
+
+#endif // READING_BATCH_H
@@ -0,0 +1,262 @@
+/**
+ * @file AXDR.cpp
+ * @brief Implementation of A-XDR decoder
+ * @version 2.0
+ * @date 2025-10-02
+ */
+
+#include "AXDR.h"
+#include "../utils/DLMSDateTime.h"
+
+/**
+ * @brief Content size of fixed-length types
+ * @return Size in bytes, -1 if the type carries a length
+ */
+static int8_t fixedSize(uint8_t tag) {
+    switch (tag) {
+        case AXDRTag::NULL_DATA: return 0;
+        case AXDRTag::BOOLEAN: case AXDRTag::BCD: case AXDRTag::INT8:
+        case AXDRTag::UINT8: case AXDRTag::ENUM: return 1;
+        case AXDRTag::INT16: case AXDRTag::UINT16: return 2;
+        case AXDRTag::INT32: case AXDRTag::UINT32: case AXDRTag::FLOAT32:
+        case AXDRTag::TIME: return 4;
+        case AXDRTag::DATE: return 5;
+        case AXDRTag::INT64: case AXDRTag::UINT64: case AXDRTag::FLOAT64: return 8;
+        case AXDRTag::DATE_TIME: return 12;
+        default: return -1;
+    }
+}
+
+/**
+ * @brief Big-endian unsigned of 1..8 bytes
+ */
+static uint64_t readBigEndian(const uint8_t* p, uint8_t size) {
+    uint64_t value = 0;
+    for (uint8_t i = 0; i < size; i++) {
+        value = (value << 8) | p[i];
+    }
+    return value;
+}
+
+/**
+ * @brief Content of a non-container item
+ * @param tag Item tag
+ * @param p Cursor after the tag (advanced past length fields)
+ * @param end End of data
+ * @param size Output content size in bytes
+ */
+static bool contentSize(uint8_t tag, const uint8_t*& p, const uint8_t* end, uint16_t& size) {
+    int8_t fixed = fixedSize(tag);
+    if (fixed >= 0) {
+        size = fixed;
+        return p + size <= end;
+    }
+
+    switch (tag) {
+        case AXDRTag::BIT_STRING:
+            if (!AXDRReader::decodeLength(p, end, size)) return false;
+            size = (size + 7) / 8;
+            break;
+        case AXDRTag::OCTET_STRING:
+        case AXDRTag::VISIBLE_STRING:
+        case AXDRTag::UTF8_STRING:
+            if (!AXDRReader::decodeLength(p, end, size)) return false;
+            break;
+        default:
+            return false;
+    }
+    return p + size <= end;
+}
+
+// ============================================
+// READER
+// ============================================
+
+bool AXDRReader::decodeLength(const uint8_t*& p, const uint8_t* end, uint16_t& length) {
+    if (p >= end) return false;
+
+    uint8_t first = *p++;
+    if (first < 0x80) {
+        length = first;
+        return true;
+    }
+
+    uint8_t bytes = first & 0x7F;
+    if (bytes == 0 || bytes > 2 || p + bytes > end) return false;
+
+    length = readBigEndian(p, bytes);
+    p += bytes;
+    return true;
+}
+
+bool AXDRReader::skipTypeDescription(const uint8_t*& p, const uint8_t* end, uint8_t depth) {
+    if (depth > MAX_DEPTH || p >= end) return false;
+
+    uint8_t tag = *p++;
+    if (tag == AXDRTag::ARRAY) {
+        // number-of-elements (long-unsigned) then the element type
+        if (p + 2 > end) return false;
+        p += 2;
+        return skipTypeDescription(p, end, depth + 1);
+    }
+    if (tag == AXDRTag::STRUCTURE) {
+        uint16_t items;
+        if (!decodeLength(p, end, items)) return false;
+        for (uint16_t i = 0; i < items; i++) {
+            if (!skipTypeDescription(p, end, depth + 1)) return false;
+        }
+        return true;
+    }
+    return fixedSize(tag) >= 0 || tag == AXDRTag::BIT_STRING ||
+           tag == AXDRTag::OCTET_STRING || tag == AXDRTag::VISIBLE_STRING ||
+           tag == AXDRTag::UTF8_STRING;
+}
+
+bool AXDRReader::skip(const uint8_t*& p, const uint8_t* end, uint8_t depth) {
+    if (depth > MAX_DEPTH || p >= end) return false;
+
+    uint8_t tag = *p++;
+    uint16_t size;
+
+    if (tag == AXDRTag::ARRAY || tag == AXDRTag::STRUCTURE) {
+        uint16_t items;
+        if (!decodeLength(p, end, items)) return false;
+        for (uint16_t i = 0; i < items; i++) {
+            if (!skip(p, end, depth + 1)) return false;
+        }
+        return true;
+    }
+
+    if (tag == AXDRTag::COMPACT_ARRAY) {
+        if (!skipTypeDescription(p, end, depth + 1) || !decodeLength(p, end, size) ||
+            p + size > end) {
+            return false;
+        }
+        p += size;
+        return true;
+    }
+
+    if (!contentSize(tag, p, end, size)) return false;
+    p += size;
+    return true;
+}
+
+bool AXDRReader::next(AXDRValue& value) {
+    if (atEnd()) return false;
+
+    const uint8_t* q = p;
+    value.tag = *q++;
+
+    if (value.isContainer()) {
+        if (!decodeLength(q, limit, value.length)) return false;
+        value.data = q;
+        for (uint16_t i = 0; i < value.length; i++) {
+            if (!skip(q, limit, 1)) return false;
+        }
+    } else if (value.tag == AXDRTag::COMPACT_ARRAY) {
+        // View covers the raw array-contents; the description is skipped
+        if (!skipTypeDescription(q, limit, 1) || !decodeLength(q, limit, value.length) ||
+            q + value.length > limit) {
+            return false;
+        }
+        value.data = q;
+        q += value.length;
+    } else {
+        if (!contentSize(value.tag, q, limit, value.length)) return false;
+        value.data = q;
+        q += value.length;
+    }
+
+    value.end = q;
+    p = q;
+    if (count != 0xFFFF) count--;
+    return true;
+}
+
+bool AXDRReader::readByte(uint8_t& value) {
+    if (p >= limit) return false;
+    value = *p++;
+    return true;
+}
+
+// ============================================
+// VALUE
+// ============================================
+
+bool AXDRValue::isString() const {
+    return tag == AXDRTag::OCTET_STRING || tag == AXDRTag::VISIBLE_STRING ||
+           tag == AXDRTag::UTF8_STRING;
+}
+
+bool AXDRValue::isInteger() const {
+    switch (tag) {
+        case AXDRTag::BOOLEAN: case AXDRTag::INT8: case AXDRTag::UINT8:
+        case AXDRTag::ENUM: case AXDRTag::INT16: case AXDRTag::UINT16:
+        case AXDRTag::INT32: case AXDRTag::UINT32: case AXDRTag::INT64:
+        case AXDRTag::UINT64:
+            return true;
+        default:
+            return false;
+    }
+}
+
+bool AXDRValue::toInt64(int64_t& value) const {
+    if (!isInteger()) return false;
+
+    uint64_t raw = readBigEndian(data, length);
+    switch (tag) {
+        case AXDRTag::INT8:  value = (int8_t)raw; break;
+        case AXDRTag::INT16: value = (int16_t)raw; break;
+        case AXDRTag::INT32: value = (int32_t)raw; break;
+        default:             value = (int64_t)raw; break;
+    }
+    return true;
+}
+
+bool AXDRValue::toFloat(float& value) const {
+    if (tag == AXDRTag::FLOAT32) {
+        uint32_t bits = readBigEndian(data, 4);
+        memcpy(&value, &bits, sizeof(value));
+        return true;
+    }
+    if (tag == AXDRTag::FLOAT64) {
+        uint64_t bits = readBigEndian(data, 8);
+        double wide;
+        memcpy(&wide, &bits, sizeof(wide));
+        value = wide;
+        return true;
+    }
+    if (tag == AXDRTag::UINT64) {
+        value = (float)readBigEndian(data, 8);
+        return true;
+    }
+
+    int64_t integer;
+    if (!toInt64(integer)) return false;
+    value = (float)integer;
+    return true;
+}
+
+bool AXDRValue::toDateTime(uint32_t& epoch) const {
+    if ((tag != AXDRTag::OCTET_STRING && tag != AXDRTag::DATE_TIME) ||
+        length != DLMSDateTime::SIZE) {
+        return false;
+    }
+    epoch = DLMSDateTime::toEpoch(data);
+    return true;
+}
+
+bool AXDRValue::copyText(char* text, size_t size) const {
+    if (!isString() || size == 0) return false;
+
+    size_t n = length < size - 1 ? length : size - 1;
+    memcpy(text, data, n);
+    text[n] = '\0';
+    return true;
+}
+
+AXDRReader AXDRValue::elements() const {
+    AXDRReader reader(data, isContainer() ? end : data);
+    reader.count = isContainer() ? length : 0;
+    return reader;
+}
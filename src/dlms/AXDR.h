@@ -0,0 +1,157 @@
+/**
+ * @file AXDR.h
+ * @brief Zero-copy A-XDR decoder for DLMS data (IEC 62056-6-2)
+ * @version 2.0
+ * @date 2025-10-02
+ *
+ * AXDRReader is a cursor over a received span. next() returns an
+ * AXDRValue: the tag plus pointers into the span, never a copy. Arrays
+ * and structures are walked through elements(), which returns a cursor
+ * over their children, so any nesting is decoded with the same two
+ * calls. Conversions (toFloat, toInt64, toDateTime, copyText) check the
+ * tag and fail instead of guessing.
+ */
+
+#ifndef AXDR_H
+#define AXDR_H
+
+#include <Arduino.h>
+
+/**
+ * @namespace AXDRTag
+ * @brief DLMS Data choice tags
+ */
+namespace AXDRTag {
+    const uint8_t NULL_DATA      = 0x00;
+    const uint8_t ARRAY          = 0x01;
+    const uint8_t STRUCTURE      = 0x02;
+    const uint8_t BOOLEAN        = 0x03;
+    const uint8_t BIT_STRING     = 0x04;
+    const uint8_t INT32          = 0x05;    // double-long
+    const uint8_t UINT32         = 0x06;    // double-long-unsigned
+    const uint8_t OCTET_STRING   = 0x09;
+    const uint8_t VISIBLE_STRING = 0x0A;
+    const uint8_t UTF8_STRING    = 0x0C;
+    const uint8_t BCD            = 0x0D;
+    const uint8_t INT8           = 0x0F;    // integer
+    const uint8_t INT16          = 0x10;    // long
+    const uint8_t UINT8          = 0x11;    // unsigned
+    const uint8_t UINT16         = 0x12;    // long-unsigned
+    const uint8_t COMPACT_ARRAY  = 0x13;
+    const uint8_t INT64          = 0x14;    // long64
+    const uint8_t UINT64         = 0x15;    // long64-unsigned
+    const uint8_t ENUM           = 0x16;
+    const uint8_t FLOAT32        = 0x17;
+    const uint8_t FLOAT64        = 0x18;
+    const uint8_t DATE_TIME      = 0x19;
+    const uint8_t DATE           = 0x1A;
+    const uint8_t TIME           = 0x1B;
+}
+
+class AXDRReader;
+
+/**
+ * @struct AXDRValue
+ * @brief Typed view of one encoded data item
+ */
+struct AXDRValue {
+    uint8_t tag;
+    const uint8_t* data;    // Content: value bytes, or first child
+    uint16_t length;        // Content bytes, or child count (array/structure)
+    const uint8_t* end;     // One past the whole item
+
+    bool isNull() const { return tag == AXDRTag::NULL_DATA; }
+    bool isContainer() const { return tag == AXDRTag::ARRAY || tag == AXDRTag::STRUCTURE; }
+    bool isString() const;
+    bool isInteger() const;
+
+    /**
+     * @brief Integer value (integer, unsigned, enum, boolean types)
+     */
+    bool toInt64(int64_t& value) const;
+
+    /**
+     * @brief Numeric value (integer types and float32/64)
+     */
+    bool toFloat(float& value) const;
+
+    /**
+     * @brief Meter local epoch from a 12-byte octet-string or date-time
+     */
+    bool toDateTime(uint32_t& epoch) const;
+
+    /**
+     * @brief Copy octet, visible or UTF-8 string, NUL-terminated and truncated
+     */
+    bool copyText(char* text, size_t size) const;
+
+    /**
+     * @brief Cursor over the children of an array or structure
+     */
+    AXDRReader elements() const;
+};
+
+/**
+ * @class AXDRReader
+ * @brief Forward cursor over A-XDR encoded bytes
+ */
+class AXDRReader {
+public:
+    static const uint8_t MAX_DEPTH = 8;     // Nesting accepted by skip()
+
+    AXDRReader(const uint8_t* begin, const uint8_t* end) : p(begin), limit(end), count(0xFFFF) {}
+
+    /**
+     * @brief Decode the next data item and advance past it
+     * @param value Output view
+     * @return false at end or on malformed data
+     */
+    bool next(AXDRValue& value);
+
+    /**
+     * @brief Decode the next item and require its tag
+     */
+    bool next(AXDRValue& value, uint8_t tag) { return next(value) && value.tag == tag; }
+
+    /**
+     * @brief Read one untagged byte (APDU choice, result codes)
+     */
+    bool readByte(uint8_t& value);
+
+    /**
+     * @brief Read an untagged A-XDR length (SEQUENCE OF counts)
+     */
+    bool readLength(uint16_t& length) { return decodeLength(p, limit, length); }
+
+    const uint8_t* position() const { return p; }
+    const uint8_t* end() const { return limit; }
+    bool atEnd() const { return p >= limit || count == 0; }
+
+    /**
+     * @brief Decode A-XDR length (1, 2 or 3 bytes)
+     * @param p Cursor (advanced past the length)
+     * @param end End of data
+     * @param length Output length
+     * @return true if well-formed
+     */
+    static bool decodeLength(const uint8_t*& p, const uint8_t* end, uint16_t& length);
+
+    /**
+     * @brief Skip one encoded data item
+     * @param p Cursor (advanced past the item)
+     * @param end End of data
+     * @return true if the item is complete and well-formed
+     */
+    static bool skip(const uint8_t*& p, const uint8_t* end, uint8_t depth = 0);
+
+private:
+    friend struct AXDRValue;
+
+    const uint8_t* p;
+    const uint8_t* limit;
+    uint16_t count;         // Items left when iterating children
+
+    static bool skipTypeDescription(const uint8_t*& p, const uint8_t* end, uint8_t depth);
+};
+
+#endif // AXDR_H
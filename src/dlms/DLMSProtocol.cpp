@@ -6,53 +6,109 @@
  */
 
 #include "DLMSProtocol.h"
+#include "FrameTemplates.h"
+#include "../hardware/UartTransport.h"
+#include "../utils/DLMSDateTime.h"
+#include <time.h>
 
 // ============================================
 // STATIC FRAME DEFINITIONS
 // ============================================
 
-const uint8_t DLMSProtocol::SNRM_FRAME[] = {
-    0x7E, 0xA0, 0x20, 0x03, 0x41, 0x93, 0x28, 0xBC,
-    0x81, 0x80, 0x14, 0x05, 0x02, 0x05, 0x01, 0x06,
-    0x02, 0x05, 0x01, 0x07, 0x04, 0x00, 0x00, 0x00,
-    0x01, 0x08, 0x04, 0x00, 0x00, 0x00, 0x01, 0xDD,
-    0x70, 0x7E
-};
+// Built at compile time from the HDLC_* limits, DLMS_PASSWORD,
+// DLMSConformance::PROPOSED and DLMS_MAX_PDU_SIZE (FrameTemplates.h)
+typedef FrameTemplates::HDLCFrame<0x93, FrameTemplates::SNRMParameters> SNRMProposal;
+typedef FrameTemplates::HDLCFrame<0x93> SNRMPlain;
+typedef FrameTemplates::HDLCFrame<0x53> DISCFrame;
 
-const uint8_t DLMSProtocol::AARQ_FRAME[] = {
-    0x7E, 0xA0, 0x4C, 0x03, 0x41, 0x10, 0x6B, 0x04,
-    0xE6, 0xE6, 0x00, 0x60, 0x3E, 0xA1, 0x09, 0x06,
-    0x07, 0x60, 0x85, 0x74, 0x05, 0x08, 0x01, 0x01,
-    0x8A, 0x02, 0x07, 0x80, 0x8B, 0x07, 0x60, 0x85,
-    0x74, 0x05, 0x08, 0x02, 0x01, 0xAC, 0x12, 0x80,
-    0x10, 0x31, 0x31, 0x31, 0x31, 0x31, 0x31, 0x31,
-    0x31, 0x31, 0x31, 0x31, 0x31, 0x31, 0x31, 0x31,
-    0x31, 0xBE, 0x10, 0x04, 0x0E, 0x01, 0x00, 0x00,
-    0x00, 0x06, 0x5F, 0x1F, 0x04, 0x00, 0x00, 0x18,
-    0x1D, 0xFF, 0xFF, 0xB3, 0x3D, 0x7E
-};
+// First I-frame after SNRM: N(R) = N(S) = 0, poll bit set
+static const uint8_t AARQ_CONTROL = 0x10;
+typedef FrameTemplates::HDLCFrame<AARQ_CONTROL, FrameTemplates::AARQInfo<
+    FrameTemplates::ConfigPassword, DLMSConformance::PROPOSED, DLMS_MAX_PDU_SIZE> > AARQFrame;
+
+typedef FrameTemplates::Bytes<SNRMProposal> SNRM_PROPOSAL;
+typedef FrameTemplates::Bytes<SNRMPlain> SNRM_PLAIN;
+typedef FrameTemplates::Bytes<DISCFrame> DISC;
+typedef FrameTemplates::Bytes<AARQFrame> AARQ;
 
-const uint8_t DLMSProtocol::DISC_FRAME[] = {
-    0x7E, 0xA0, 0x07, 0x03, 0x41, 0x53, 0x56, 0xA2, 0x7E
+// RR for each N(R)
+static const uint8_t* const RR_FRAMES[8] = {
+    FrameTemplates::Bytes<FrameTemplates::ReceiveReady<0> >::data,
+    FrameTemplates::Bytes<FrameTemplates::ReceiveReady<1> >::data,
+    FrameTemplates::Bytes<FrameTemplates::ReceiveReady<2> >::data,
+    FrameTemplates::Bytes<FrameTemplates::ReceiveReady<3> >::data,
+    FrameTemplates::Bytes<FrameTemplates::ReceiveReady<4> >::data,
+    FrameTemplates::Bytes<FrameTemplates::ReceiveReady<5> >::data,
+    FrameTemplates::Bytes<FrameTemplates::ReceiveReady<6> >::data,
+    FrameTemplates::Bytes<FrameTemplates::ReceiveReady<7> >::data
 };
+static const uint16_t RR_SIZE = FrameTemplates::ReceiveReady<0>::SIZE;
+
+uint8_t DLMSProtocol::receiveBuffer[DLMS_MAX_PDU_SIZE + 16];
+uint16_t DLMSProtocol::receiveLength = 0;
+uint8_t DLMSProtocol::frameBuffer[MAX_FRAME_SIZE];
+uint8_t DLMSProtocol::transmitBuffer[MAX_FRAME_SIZE];
+
+// Every register at its table tier, for instances without a site plan
+static const ReadPlan defaultPlan;
+
+// UART2 link, for instances without a transport of their own
+static UartTransport defaultTransport;
 
 // ============================================
 // CONSTRUCTOR & INITIALIZATION
 // ============================================
 
-DLMSProtocol::DLMSProtocol() 
+DLMSProtocol::DLMSProtocol(uint16_t physicalAddress, uint16_t logicalAddress) 
     : state(DLMSState::DISCONNECTED),
       lastError(DLMSError::NONE),
       errorCount(0),
-      hdlcFrameCounter(0x10),
-      receiveLength(0) {
-    memset(receiveBuffer, 0, sizeof(receiveBuffer));
+      sendSequence(0),
+      receiveSequence(0),
+      maxInfoTx(128),
+      maxInfoRx(128),
+      windowTx(1),
+      windowRx(1),
+      lastActivityTime(0),
+      valuesRead(0),
+      negotiatedConformance(0),
+      serverMaxPduSize(0),
+      readPlan(&defaultPlan),
+      identified(false) {
+    transport = &defaultTransport;
+    setAddress(physicalAddress, logicalAddress);
+}
+
+void DLMSProtocol::setTransport(MeterTransport* meterTransport) {
+    transport = meterTransport ? meterTransport : &defaultTransport;
+}
+
+void DLMSProtocol::setReadPlan(const ReadPlan* plan) {
+    readPlan = plan ? plan : &defaultPlan;
+}
+
+void DLMSProtocol::setAddress(uint16_t physical, uint16_t logical) {
+    physicalAddress = physical;
+    
+    if (physical == 0) {
+        serverAddress[0] = DLMS_SERVER_SAP;
+        serverAddressLength = 1;
+    } else if (physical <= 0x7F && logical <= 0x7F) {
+        serverAddress[0] = logical << 1;
+        serverAddress[1] = (physical << 1) | 0x01;
+        serverAddressLength = 2;
+    } else {
+        serverAddress[0] = ((logical >> 7) & 0x7F) << 1;
+        serverAddress[1] = (logical & 0x7F) << 1;
+        serverAddress[2] = ((physical >> 7) & 0x7F) << 1;
+        serverAddress[3] = ((physical & 0x7F) << 1) | 0x01;
+        serverAddressLength = 4;
+    }
 }
 
 void DLMSProtocol::begin() {
     LOG_INFO("DLMS Protocol initialized");
-    state = DLMSState::DISCONNECTED;
-    hdlcFrameCounter = 0x10;
+    resetLink();
     resetErrors();
 }
 
@@ -61,20 +117,35 @@ void DLMSProtocol::begin() {
 // ============================================
 
 bool DLMSProtocol::connect() {
+    unsigned long start = millis();
+    bool success = associate();
+    metrics.phaseDone(LinkPhase::ASSOCIATE, millis() - start, success);
+    return success;
+}
+
+bool DLMSProtocol::associate() {
     LOG_INFO("=== Starting DLMS Connection ===");
     
-    // Wake up meter
-    HardwareManager::wakeupMeter();
-    HardwareManager::clearRxBuffer();
-    
-    // Step 1: SNRM
-    if (!sendSNRM()) {
+    // Wake up meter / sign on / connect
+    if (!transport->open()) {
         setError(DLMSError::TIMEOUT);
-        LOG_ERROR("SNRM failed");
+        LOG_ERROR("Meter link not available");
         return false;
     }
-    
-    delay(100);
+    transport->clearRxBuffer();
+    
+    // Step 1: SNRM proposing our link parameters; meters that reject
+    // the negotiation field get a plain SNRM and use HDLC defaults
+    if (!sendSNRM(true)) {
+        LOG_WARN("SNRM with parameters refused - retrying with defaults");
+        metrics.onRetry();
+        transport->clearRxBuffer();
+        if (!sendSNRM(false)) {
+            setError(DLMSError::TIMEOUT);
+            LOG_ERROR("SNRM failed");
+            return false;
+        }
+    }
     
     // Step 2: AARQ
     if (!sendAARQ()) {
@@ -92,28 +163,69 @@ bool DLMSProtocol::connect() {
 
 bool DLMSProtocol::disconnect() {
     LOG_INFO("Disconnecting from meter...");
+    unsigned long start = millis();
     
+    // Repeat DISC only if the meter did not confirm the first one
     bool success = sendDisconnect();
-    delay(100);
-    sendDisconnect(); // Send twice for reliability
+    if (!success) {
+        metrics.onRetry();
+        success = sendDisconnect();
+    }
     
-    state = DLMSState::DISCONNECTED;
-    hdlcFrameCounter = 0x10;
+    resetLink();
     
-    HardwareManager::sleepMeter();
+    transport->close();
     LOG_INFO("Disconnected");
     
+    metrics.phaseDone(LinkPhase::RELEASE, millis() - start, success);
     return success;
 }
 
+bool DLMSProtocol::maintain() {
+    if (!isConnected()) return false;
+    
+    uint32_t idle = millis() - lastActivityTime;
+    if (idle >= HDLC_INACTIVITY_TIMEOUT) {
+        LOG_WARN("Association idle beyond meter inactivity timeout");
+        resetLink();
+        return false;
+    }
+    
+    if (idle < HDLC_KEEPALIVE_INTERVAL) return true;
+    
+    // RR with poll bit: meter answers RR with final bit, N(S)/N(R) unchanged
+    LOG_DEBUG(">>> Sending keep-alive RR");
+    if (sendReceiveReady() && receiveFrame() &&
+        (receiveBuffer[5] & 0x0F) == 0x01 &&
+        (receiveBuffer[5] & HDLC_POLL_FINAL)) {
+        return true;
+    }
+    
+    LOG_WARN("Keep-alive failed - association dropped");
+    resetLink();
+    return false;
+}
+
+void DLMSProtocol::resetLink() {
+    state = DLMSState::DISCONNECTED;
+    sendSequence = 0;
+    receiveSequence = 0;
+    negotiatedConformance = 0;
+    identified = false;
+}
+
 // ============================================
 // FRAME SENDING & RECEIVING
 // ============================================
 
-bool DLMSProtocol::sendSNRM() {
+bool DLMSProtocol::sendSNRM(bool proposeParameters) {
     LOG_INFO(">>> Sending SNRM");
     
-    if (!sendFrame(SNRM_FRAME, sizeof(SNRM_FRAME))) {
+    const uint8_t* frame = proposeParameters ? SNRM_PROPOSAL::data : SNRM_PLAIN::data;
+    uint16_t len = proposeParameters ? sizeof(SNRM_PROPOSAL::data) : sizeof(SNRM_PLAIN::data);
+    
+    // Meters that ignore the negotiation field are not a pacing problem
+    if (!sendFrame(frame, len, !proposeParameters)) {
         return false;
     }
     
@@ -127,13 +239,27 @@ bool DLMSProtocol::sendSNRM() {
 bool DLMSProtocol::sendAARQ() {
     LOG_INFO(">>> Sending AARQ");
     
-    if (!sendFrame(AARQ_FRAME, sizeof(AARQ_FRAME))) {
+    // The template is complete for the usual sequence numbers; anything
+    // else re-frames its APDU
+    const uint8_t* frame = AARQ::data;
+    uint16_t len = sizeof(AARQ::data);
+    uint8_t reframed[sizeof(AARQ::data)];
+    
+    if (iFrameControl() != AARQ_CONTROL) {
+        uint16_t apduLength = len - APDU_OFFSET - 3;
+        memcpy(&reframed[APDU_OFFSET], &AARQ::data[APDU_OFFSET], apduLength);
+        len = finishInfoFrame(reframed, apduLength);
+        frame = reframed;
+    }
+    
+    if (!sendFrame(frame, len)) {
         return false;
     }
     
     if (!receiveFrame()) {
         return false;
     }
+    incrementFrameCounter();
     
     return verifyAAREResponse();
 }
@@ -141,55 +267,210 @@ bool DLMSProtocol::sendAARQ() {
 bool DLMSProtocol::sendDisconnect() {
     LOG_DEBUG(">>> Sending DISCONNECT");
     
-    if (!sendFrame(DISC_FRAME, sizeof(DISC_FRAME))) {
+    if (!sendFrame(DISC::data, sizeof(DISC::data), false)) {
         return false;
     }
     
-    receiveFrame(500); // Short timeout for DISC response
-    return true;
+    return receiveFrame(500); // Short timeout for DISC response
 }
 
-bool DLMSProtocol::sendFrame(const uint8_t* frame, uint16_t length) {
-    HardwareManager::showActivity();
-    HardwareManager::write(frame, length);
-    HardwareManager::flush();
+bool DLMSProtocol::sendFrame(const uint8_t* frame, uint16_t length, bool expectReply) {
+    const uint8_t* wire = frame;
+    uint16_t wireLength = length;
+    if (serverAddressLength > 1) {
+        wireLength = addressFrame(frame, length, transmitBuffer);
+        wire = transmitBuffer;
+    }
     
-    LOG_HEX("TX", frame, length);
+    pacer.beforeSend();
+    transport->write(wire, wireLength);
+    transport->flush();
+    pacer.onSent(expectReply);
+    metrics.onSend(frame, length, wireLength);
+    
+    LOG_HEX("TX", wire, wireLength);
     
     return true;
 }
 
+bool DLMSProtocol::sendReceiveReady() {
+    return sendFrame(RR_FRAMES[receiveSequence & 0x07], RR_SIZE);
+}
+
 bool DLMSProtocol::receiveFrame(uint32_t timeout) {
-    memset(receiveBuffer, 0, sizeof(receiveBuffer));
     receiveLength = 0;
     
-    uint32_t startTime = millis();
-    bool frameStarted = false;
+    uint16_t length;
+    if (!receiveHDLCFrame(receiveBuffer, MAX_FRAME_SIZE, length, timeout)) {
+        return false;
+    }
     
-    while (millis() - startTime < timeout) {
-        if (HardwareManager::available()) {
-            uint8_t byte = HardwareManager::read();
-            
-            // Look for frame start
-            if (byte == HDLC_FLAG) {
-                frameStarted = true;
-                receiveLength = 0;
-            }
-            
-            if (frameStarted && receiveLength < MAX_FRAME_SIZE) {
-                receiveBuffer[receiveLength++] = byte;
-                
-                // Check for frame end
-                if (receiveLength > 2 && byte == HDLC_FLAG && receiveBuffer[0] == HDLC_FLAG) {
-                    LOG_HEX("RX", receiveBuffer, receiveLength);
-                    return true;
-                }
-            }
+    uint8_t control = receiveBuffer[5];
+    if ((control & 0x01) == 0) {
+        receiveSequence = ((control >> 1) + 1) & 0x07;
+    }
+    
+    if (!(receiveBuffer[1] & HDLC_SEGMENT_BIT)) {
+        receiveLength = length;
+        return true;
+    }
+    
+    // Segmented I-frame: keep header and LLC of the first segment and
+    // append the information field of every following one
+    uint16_t assembled = length - 3;    // Drop FCS + flag
+    uint8_t segments = 1;
+    
+    while (true) {
+        // Meter sets the final bit on the last frame of its window
+        if ((control & HDLC_POLL_FINAL) && !sendReceiveReady()) {
+            return false;
+        }
+        
+        if (!receiveHDLCFrame(frameBuffer, sizeof(frameBuffer), length, timeout)) {
+            LOG_ERRORF("Segment %u not received", segments + 1);
+            return false;
+        }
+        
+        control = frameBuffer[5];
+        if ((control & 0x01) != 0 || ((control >> 1) & 0x07) != receiveSequence) {
+            LOG_ERROR("Segment out of sequence");
+            metrics.onFrameError();
+            return false;
+        }
+        receiveSequence = ((control >> 1) + 1) & 0x07;
+        
+        uint16_t infoLength = length - 11;  // Header + HCS, FCS + flag
+        if (length < 11 || (size_t)assembled + infoLength + 3 > sizeof(receiveBuffer)) {
+            LOG_ERRORF("Segmented response exceeds %u bytes", DLMS_MAX_PDU_SIZE);
+            return false;
+        }
+        memcpy(&receiveBuffer[assembled], &frameBuffer[8], infoLength);
+        assembled += infoLength;
+        segments++;
+        
+        if (!(frameBuffer[1] & HDLC_SEGMENT_BIT)) break;
+    }
+    
+    // FCS of the reassembled image is not meaningful
+    receiveBuffer[assembled++] = 0x00;
+    receiveBuffer[assembled++] = 0x00;
+    receiveBuffer[assembled++] = 0x7E;
+    receiveBuffer[1] = 0xA0 | (((assembled - 2) >> 8) & 0x07);
+    receiveBuffer[2] = (assembled - 2) & 0xFF;
+    receiveLength = assembled;
+    
+    LOG_DEBUGF("Reassembled %u segments (%u bytes)", segments, receiveLength);
+    return true;
+}
+
+uint16_t DLMSProtocol::addressFrame(const uint8_t* frame, uint16_t length, uint8_t* out) const {
+    uint8_t extra = serverAddressLength - 1;
+    uint16_t frameLength = (((frame[1] & 0x07) << 8) | frame[2]) + extra;
+    
+    out[0] = 0x7E;
+    out[1] = (frame[1] & 0xF8) | ((frameLength >> 8) & 0x07);
+    out[2] = frameLength & 0xFF;
+    memcpy(&out[3], serverAddress, serverAddressLength);
+    out[4 + extra] = frame[4];     // Client address
+    out[5 + extra] = frame[5];     // Control
+    
+    // Frames without information field end with FCS right after control
+    uint16_t i = 6 + extra;
+    CRCCalculator::put(&out[i], CRCCalculator::calculate(&out[1], i - 1));
+    i += 2;
+    
+    if (length > 9) {
+        uint16_t infoLength = length - 11;
+        memcpy(&out[i], &frame[8], infoLength);
+        i += infoLength;
+        CRCCalculator::put(&out[i], CRCCalculator::calculate(&out[1], i - 1));
+        i += 2;
+    }
+    
+    out[i++] = 0x7E;
+    return i;
+}
+
+bool DLMSProtocol::unaddressFrame(uint8_t* buffer, uint16_t& length) const {
+    if (length < 9 || buffer[3] != DLMS_CLIENT_SAP) {
+        return false;
+    }
+    
+    // Source address ends with the first byte that has its LSB set
+    uint8_t n = 0;
+    while (4 + n < length - 3 && !(buffer[4 + n] & 0x01)) n++;
+    n++;
+    
+    if (n != serverAddressLength || memcmp(&buffer[4], serverAddress, n) != 0) {
+        return false;
+    }
+    
+    if (n > 1) {
+        uint8_t extra = n - 1;
+        memmove(&buffer[5], &buffer[5 + extra], length - 5 - extra);
+        length -= extra;
+        
+        uint16_t frameLength = (((buffer[1] & 0x07) << 8) | buffer[2]) - extra;
+        buffer[1] = (buffer[1] & 0xF8) | ((frameLength >> 8) & 0x07);
+        buffer[2] = frameLength & 0xFF;
+        buffer[4] = DLMS_SERVER_SAP;
+    }
+    return true;
+}
+
+bool DLMSProtocol::receiveHDLCFrame(uint8_t* buffer, uint16_t capacity,
+                                    uint16_t& length, uint32_t timeout) {
+    uint32_t start = millis();
+    HDLCFrameReader::Result result;
+    
+    while (true) {
+        uint32_t elapsed = millis() - start;
+        result = transport->receiveFrame(buffer, capacity, length,
+                                         elapsed < timeout ? timeout - elapsed : 0);
+        
+        if (length > 0) {
+            LOG_HEX("RX", buffer, length);
         }
-        delay(1);
+        
+        if (result != HDLCFrameReader::Result::COMPLETE) break;
+        
+        // Header and FCS were checked by the reader, only the
+        // addresses are left to match
+        if (unaddressFrame(buffer, length)) {
+            metrics.onFrame(length);
+            pacer.onResponse();
+            lastActivityTime = millis();
+            return true;
+        }
+        LOG_WARN("Dropped frame for another station");
     }
     
-    LOG_ERROR("Receive timeout");
+    // Silence before association (SNRM/AARQ to a meter that is unplugged
+    // or powered down) is not a sign of pacing too fast
+    if (result == HDLCFrameReader::Result::TIMEOUT && !isConnected()) {
+        pacer.onNoReply();
+    } else {
+        pacer.onFailure();
+    }
+    metrics.onError(result);
+    
+    switch (result) {
+        case HDLCFrameReader::Result::BAD_HCS:
+            LOG_ERROR("HCS error");
+            break;
+        case HDLCFrameReader::Result::BAD_FCS:
+            LOG_ERROR("FCS error");
+            break;
+        case HDLCFrameReader::Result::BAD_LENGTH:
+            LOG_ERROR("Frame too long");
+            break;
+        case HDLCFrameReader::Result::TRUNCATED:
+            LOG_ERROR("Frame truncated (inter-character timeout)");
+            break;
+        default:
+            LOG_ERROR("Receive timeout");
+            break;
+    }
     return false;
 }
 
@@ -206,18 +487,67 @@ bool DLMSProtocol::verifySNRMResponse() {
     
     if (receiveBuffer[0] != 0x7E || 
         receiveBuffer[1] != 0xA0 ||
-        receiveBuffer[3] != 0x41 ||
-        receiveBuffer[4] != 0x03 ||
+        receiveBuffer[3] != DLMS_CLIENT_SAP ||
+        receiveBuffer[4] != DLMS_SERVER_SAP ||
         receiveBuffer[5] != 0x73) {
         LOG_ERROR("Invalid SNRM response");
         return false;
     }
     
     LOG_INFO("SNRM Response OK");
+    
+    // SNRM resets the link sequence numbers
+    sendSequence = 0;
+    receiveSequence = 0;
+    parseUAParameters();
+    
     state = DLMSState::CONNECTED;
     return true;
 }
 
+void DLMSProtocol::parseUAParameters() {
+    // HDLC defaults when the UA carries no negotiation field
+    maxInfoTx = 128;
+    maxInfoRx = 128;
+    windowTx = 1;
+    windowRx = 1;
+    
+    // Information field: 81 80 <group length> { id, length, value }...
+    // Parameters are from the meter's side: its transmit is our receive
+    if (receiveLength > 14 &&
+        receiveBuffer[8] == 0x81 &&
+        receiveBuffer[9] == 0x80) {
+        const uint8_t* p = &receiveBuffer[11];
+        const uint8_t* end = p + receiveBuffer[10];
+        if (end > &receiveBuffer[receiveLength - 3]) {
+            end = &receiveBuffer[receiveLength - 3];
+        }
+        
+        while (p + 2 <= end) {
+            uint8_t id = *p++;
+            uint8_t size = *p++;
+            if (size == 0 || size > 4 || p + size > end) break;
+            
+            uint32_t value = 0;
+            for (uint8_t i = 0; i < size; i++) {
+                value = (value << 8) | *p++;
+            }
+            if (value == 0) continue;
+            
+            switch (id) {
+                case 0x05: maxInfoRx = min(value, (uint32_t)HDLC_MAX_INFO_RX); break;
+                case 0x06: maxInfoTx = min(value, (uint32_t)HDLC_MAX_INFO_TX); break;
+                case 0x07: windowRx = min(value, (uint32_t)HDLC_WINDOW_RX); break;
+                case 0x08: windowTx = min(value, (uint32_t)HDLC_WINDOW_TX); break;
+                default: break;
+            }
+        }
+    }
+    
+    LOG_INFOF("HDLC link: info TX %u RX %u, window TX %u RX %u",
+              maxInfoTx, maxInfoRx, windowTx, windowRx);
+}
+
 bool DLMSProtocol::verifyAAREResponse() {
     // AARE frame format: 7E A0 xx 41 03 ... E6 E7 00 ... 00 ... 7E
     if (receiveLength < 30) {
@@ -226,9 +556,9 @@ bool DLMSProtocol::verifyAAREResponse() {
     }
     
     if (receiveBuffer[0] != 0x7E ||
-        receiveBuffer[1] != 0xA0 ||
-        receiveBuffer[3] != 0x41 ||
-        receiveBuffer[4] != 0x03 ||
+        (receiveBuffer[1] & 0xF0) != 0xA0 ||
+        receiveBuffer[3] != DLMS_CLIENT_SAP ||
+        receiveBuffer[4] != DLMS_SERVER_SAP ||
         receiveBuffer[8] != 0xE6 ||
         receiveBuffer[9] != 0xE7) {
         LOG_ERROR("Invalid AARE response");
@@ -241,7 +571,28 @@ bool DLMSProtocol::verifyAAREResponse() {
         return false;
     }
     
+    // InitiateResponse carries the negotiated conformance block
+    // (5F 1F 04 <unused bits> <3 bytes>) followed by server max PDU size
+    negotiatedConformance = 0;
+    serverMaxPduSize = 0;
+    for (uint16_t i = 10; i + 8 < receiveLength; i++) {
+        if (receiveBuffer[i] == 0x5F &&
+            receiveBuffer[i + 1] == 0x1F &&
+            receiveBuffer[i + 2] == 0x04) {
+            negotiatedConformance = ((uint32_t)receiveBuffer[i + 4] << 16) |
+                                    ((uint32_t)receiveBuffer[i + 5] << 8) |
+                                    ((uint32_t)receiveBuffer[i + 6]);
+            serverMaxPduSize = ((uint16_t)receiveBuffer[i + 7] << 8) |
+                               receiveBuffer[i + 8];
+            break;
+        }
+    }
+    
     LOG_INFO("AARE Response OK - Association established");
+    LOG_DEBUGF("Conformance: 0x%x, max PDU: %u", negotiatedConformance, serverMaxPduSize);
+    if (!supportsGetWithList()) {
+        LOG_INFO("Meter does not support list reads - using single GETs");
+    }
     return true;
 }
 
@@ -252,9 +603,9 @@ bool DLMSProtocol::verifyOBISResponse() {
     }
     
     if (receiveBuffer[0] != 0x7E ||
-        receiveBuffer[1] != 0xA0 ||
-        receiveBuffer[3] != 0x41 ||
-        receiveBuffer[4] != 0x03 ||
+        (receiveBuffer[1] & 0xF0) != 0xA0 ||
+        receiveBuffer[3] != DLMS_CLIENT_SAP ||
+        receiveBuffer[4] != DLMS_SERVER_SAP ||
         receiveBuffer[8] != 0xE6 ||
         receiveBuffer[9] != 0xE7 ||
         receiveBuffer[13] != 0xC1 ||
@@ -266,117 +617,149 @@ bool DLMSProtocol::verifyOBISResponse() {
     return true;
 }
 
+uint8_t DLMSProtocol::accessError() const {
+    // Get-Response-Normal with data-access-result instead of data
+    if (receiveLength > 16 &&
+        receiveBuffer[11] == 0xC4 &&
+        receiveBuffer[12] == 0x01 &&
+        receiveBuffer[14] == 0x01) {
+        return receiveBuffer[15];
+    }
+    return 0;
+}
+
+bool DLMSProtocol::verifyListResponse() {
+    if (receiveLength < 18) {
+        LOG_ERROR("List response too short");
+        return false;
+    }
+    
+    if (receiveBuffer[0] != 0x7E ||
+        (receiveBuffer[1] & 0xF0) != 0xA0 ||
+        receiveBuffer[3] != DLMS_CLIENT_SAP ||
+        receiveBuffer[4] != DLMS_SERVER_SAP ||
+        receiveBuffer[8] != 0xE6 ||
+        receiveBuffer[9] != 0xE7 ||
+        receiveBuffer[11] != 0xC4 ||
+        receiveBuffer[12] != 0x03 ||
+        receiveBuffer[13] != 0xC1) {
+        LOG_ERROR("Invalid list response format");
+        return false;
+    }
+    
+    return true;
+}
+
 // ============================================
 // OBIS READING
 // ============================================
 
-bool DLMSProtocol::readMeterData(MeterData& data) {
-    LOG_INFO("=== Reading Complete Meter Data ===");
+bool DLMSProtocol::readMeterData(MeterData& data, uint8_t tiers) {
+    LOG_INFO("=== Reading Meter Data ===");
+    unsigned long start = millis();
     
-    data.clear();
     bool success = true;
     
-    // Read identification
-    if (!readOBISString(OBISCodes::METER_SERIAL_NUMBER, data.serialNumber)) {
-        LOG_WARN("Failed to read serial number");
-        success = false;
+    // Identification does not change within an association
+    if (!identified || data.serialNumber[0] == '\0') {
+        if (readOBISString(OBISCodes::METER_SERIAL_NUMBER, data.serialNumber,
+                           sizeof(data.serialNumber))) {
+            identified = true;
+        } else {
+            LOG_WARN("Failed to read serial number");
+            success = false;
+        }
+        
+        if (!readOBISString(OBISCodes::METER_MANUFACTURER, data.manufacturer,
+                            sizeof(data.manufacturer))) {
+            LOG_WARN("Failed to read manufacturer");
+            success = false;
+        }
     }
     
-    if (!readOBISString(OBISCodes::METER_MANUFACTURER, data.manufacturer)) {
-        LOG_WARN("Failed to read manufacturer");
+    // Register metadata is cached per meter
+    scalerCache.begin(data.serialNumber);
+    pacer.begin(data.serialNumber);
+    
+    // Energy, maximum demand, instantaneous and TOD registers
+    RegisterRead registers[ReadPlan::CAPACITY];
+    uint8_t count = readPlan->resolve(data, tiers, registers);
+    
+    // Without the identification reads a dropped association, or a plan
+    // the meter refused entirely, would otherwise pass as a reading of zeros
+    uint16_t values = valuesRead;
+    readRegisters(registers, count);
+    bool gotValues = count == 0 || valuesRead != values;
+    if (!gotValues) {
+        LOG_WARN("No register values read");
         success = false;
     }
+    scalerCache.save();
+    pacer.save();
     
-    // Read energy values
-    String dummy;
-    readOBIS(OBISCodes::KWH_IMPORT, data.kwhImport, dummy);
-    readOBIS(OBISCodes::KVAH_IMPORT, data.kvahImport, dummy);
-    readOBIS(OBISCodes::KWH_EXPORT, data.kwhExport, dummy);
-    readOBIS(OBISCodes::KVAH_EXPORT, data.kvahExport, dummy);
-    readOBIS(OBISCodes::KVARH_LAG, data.kvarhLag, dummy);
-    readOBIS(OBISCodes::KVARH_LEAD, data.kvarhLead, dummy);
-    
-    // Read maximum demand
-    readOBIS(OBISCodes::MD_KW_IMPORT, data.mdKWImport.value, data.mdKWImport.timestamp);
-    readOBIS(OBISCodes::MD_KVA_IMPORT, data.mdKVAImport.value, data.mdKVAImport.timestamp);
-    
-    // Read instantaneous values
-    readOBIS(OBISCodes::VOLTAGE_R, data.voltageR, dummy);
-    readOBIS(OBISCodes::VOLTAGE_Y, data.voltageY, dummy);
-    readOBIS(OBISCodes::VOLTAGE_B, data.voltageB, dummy);
-    readOBIS(OBISCodes::CURRENT_R, data.currentR, dummy);
-    readOBIS(OBISCodes::CURRENT_Y, data.currentY, dummy);
-    readOBIS(OBISCodes::CURRENT_B, data.currentB, dummy);
-    readOBIS(OBISCodes::POWER_FACTOR, data.powerFactor, dummy);
-    readOBIS(OBISCodes::FREQUENCY, data.frequency, dummy);
-    
-    // Read TOD zones (first 4 zones)
-    for (int i = 0; i < 4; i++) {
-        readOBIS(OBISCodes::KWH_IMPORT_RATE[i], data.todZones[i].kwh, data.todZones[i].kwhTimestamp);
-        readOBIS(OBISCodes::KVAH_IMPORT_RATE[i], data.todZones[i].kvah, data.todZones[i].kvahTimestamp);
-    }
-    
-    data.dataValid = true;
+    data.dataValid = gotValues;
     data.lastReadTime = millis();
     
-    // Format timestamp
-    char buffer[20];
-    sprintf(buffer, "%04d-%02d-%02d %02d:%02d:%02d", 
-            2025, 10, 2, 12, 0, 0); // You can add RTC support here
-    data.lastReadTimestamp = String(buffer);
+    // Reading time from the NTP-synced system clock, in meter local time
+    time_t now = time(nullptr);
+    data.lastReadTimestamp = now > 1600000000 ? (uint32_t)now + NTP_TIMEZONE : 0;
     
     LOG_INFO("=== Meter Data Read Complete ===");
+    metrics.phaseDone(LinkPhase::READ, millis() - start, success);
     return success;
 }
 
-bool DLMSProtocol::readOBIS(const OBISCode& obis, float& value, String& timestamp) {
+bool DLMSProtocol::readOBIS(const OBISCode& obis, float& value, uint32_t& timestamp) {
     value = 0.0;
-    timestamp = "";
+    timestamp = 0;
     
-    LOG_DEBUG("Reading: " + String(obis.name));
+    LOG_DEBUGF("Reading: %s", obis.name);
     
-    // Read Attribute 1 (class check)
-    uint8_t frame[27];
-    uint16_t len = buildOBISFrame(obis, obis.classId, 0x01, frame);
+    const ScalerEntry* cached = scalerCache.find(obis);
+    if (cached && cached->isMissing()) {
+        LOG_DEBUGF("%s: not implemented by meter (cached)", obis.name);
+        return false;
+    }
     
-    if (!sendFrame(frame, len)) return false;
-    if (!receiveFrame()) return false;
-    if (!verifyOBISResponse()) return false;
+    uint8_t frame[27];
+    uint16_t len;
     
-    incrementFrameCounter();
-    delay(50);
+    // Read Attribute 1 (class check) unless already verified
+    if (!cached || !cached->isVerified()) {
+        len = buildOBISFrame(obis, obis.classId, 0x01, frame);
+        
+        if (!sendFrame(frame, len)) return false;
+        if (!receiveFrame()) return false;
+        incrementFrameCounter();
+        if (!verifyOBISResponse()) {
+            // Only object-undefined is permanent; other refusals retry next poll
+            if (accessError() == 0x04) scalerCache.markMissing(obis);
+            return false;
+        }
+        
+        scalerCache.markVerified(obis);
+    }
     
     // Read Attribute 2 (value)
     len = buildOBISFrame(obis, obis.classId, 0x02, frame);
     
     if (!sendFrame(frame, len)) return false;
     if (!receiveFrame()) return false;
+    incrementFrameCounter();
     if (!verifyOBISResponse()) return false;
     
-    if (!extractValue(value)) {
-        LOG_WARN("Failed to extract value");
+    AXDRValue data;
+    if (!responseData(data) || !data.toFloat(value)) {
+        LOG_WARNF("%s: not a numeric value", obis.name);
         return false;
     }
     
-    incrementFrameCounter();
-    delay(50);
-    
-    // Read Attribute 3 (scaler) for class 3
-    if (obis.classId == 0x03) {
-        len = buildOBISFrame(obis, obis.classId, 0x03, frame);
-        
-        if (sendFrame(frame, len) && receiveFrame() && verifyOBISResponse()) {
-            // Apply scaler (simplified - assumes scaler in byte 18)
-            if (receiveLength > 18 && receiveBuffer[18] > 127) {
-                int8_t scaler = ~receiveBuffer[18];
-                value = value / pow(10, scaler + 1);
-            } else if (receiveLength > 18) {
-                value = value * pow(10, receiveBuffer[18]);
-            }
+    // Apply scaler (attribute 3) for class 3/4, read once and cached
+    if (obis.classId == 0x03 || obis.classId == 0x04) {
+        int8_t scaler;
+        if (readScaler(obis, scaler)) {
+            value = value * pow(10, scaler);
         }
-        
-        incrementFrameCounter();
-        delay(50);
     }
     
     // Read timestamp for MD values (class 4, attribute 5)
@@ -384,21 +767,58 @@ bool DLMSProtocol::readOBIS(const OBISCode& obis, float& value, String& timestam
         // Skip attribute 4, go to attribute 5
         len = buildOBISFrame(obis, obis.classId, 0x05, frame);
         
-        if (sendFrame(frame, len) && receiveFrame() && verifyOBISResponse()) {
-            extractDateTime(timestamp);
+        if (sendFrame(frame, len) && receiveFrame()) {
+            incrementFrameCounter();
+            if (verifyOBISResponse() && responseData(data)) {
+                data.toDateTime(timestamp);
+            }
         }
+    }
+    
+    valuesRead++;
+    LOG_DEBUGF("%s: %.3f %s", obis.name, value, obis.unit);
+    return true;
+}
+
+bool DLMSProtocol::readScaler(const OBISCode& obis, int8_t& scaler) {
+    const ScalerEntry* cached = scalerCache.find(obis);
+    if (cached && cached->hasScaler()) {
+        scaler = cached->scaler;
+        return true;
+    }
+    
+    uint8_t frame[27];
+    uint16_t len = buildOBISFrame(obis, obis.classId, 0x03, frame);
+    
+    if (!sendFrame(frame, len)) return false;
+    if (!receiveFrame()) return false;
+    incrementFrameCounter();
+    
+    uint8_t result = accessError();
+    if (result != 0) {
+        // Other refusals may be transient: leave uncached, retry next poll
+        if (result != 0x04) return false;
         
-        incrementFrameCounter();
+        // No scaler_unit (object-undefined): remember as unscaled
+        scaler = 0;
+        scalerCache.storeScaler(obis, 0, 0);
+        return true;
+    }
+    
+    AXDRValue data;
+    uint8_t unit;
+    if (!verifyOBISResponse() || !responseData(data) || !decodeScaler(data, scaler, unit)) {
+        return false;
     }
     
-    LOG_DEBUG(String(obis.name) + ": " + String(value, 3) + " " + String(obis.unit));
+    scalerCache.storeScaler(obis, scaler, unit);
     return true;
 }
 
-bool DLMSProtocol::readOBISString(const OBISCode& obis, String& value) {
-    value = "";
+bool DLMSProtocol::readOBISString(const OBISCode& obis, char* value, size_t size) {
+    value[0] = '\0';
     
-    LOG_DEBUG("Reading string: " + String(obis.name));
+    LOG_DEBUGF("Reading string: %s", obis.name);
     
     // Read Attribute 2
     uint8_t frame[27];
@@ -406,141 +826,690 @@ bool DLMSProtocol::readOBISString(const OBISCode& obis, String& value) {
     
     if (!sendFrame(frame, len)) return false;
     if (!receiveFrame()) return false;
+    incrementFrameCounter();
     if (!verifyOBISResponse()) return false;
     
-    if (!extractString(value)) {
-        LOG_WARN("Failed to extract string");
+    AXDRValue data;
+    if (!responseData(data) || !data.copyText(value, size)) {
+        LOG_WARNF("%s: not a string", obis.name);
         return false;
     }
     
-    incrementFrameCounter();
-    delay(50);
-    
-    LOG_DEBUG(String(obis.name) + ": " + value);
+    LOG_DEBUGF("%s: %s", obis.name, value);
     return true;
 }
 
 // ============================================
-// FRAME BUILDING
+// BATCHED READING (GET-Request-With-List)
 // ============================================
 
-uint16_t DLMSProtocol::buildOBISFrame(const OBISCode& obis, uint8_t classId, 
-                                       uint8_t attribute, uint8_t* frame) {
-    frame[0] = 0x7E;
-    frame[1] = 0xA0;
-    frame[2] = 0x19;  // Length
-    frame[3] = 0x03;
-    frame[4] = 0x41;
-    frame[5] = hdlcFrameCounter;
-    frame[6] = 0x00;  // HCS MSB (calculated later)
-    frame[7] = 0x00;  // HCS LSB (calculated later)
-    frame[8] = 0xE6;
-    frame[9] = 0xE6;
-    frame[10] = 0x00;
-    frame[11] = 0xC0;
-    frame[12] = 0x01;
-    frame[13] = 0xC1;
-    frame[14] = 0x00;
-    frame[15] = classId;
-    frame[16] = obis.bytes[0];
-    frame[17] = obis.bytes[1];
-    frame[18] = obis.bytes[2];
-    frame[19] = obis.bytes[3];
-    frame[20] = obis.bytes[4];
-    frame[21] = obis.bytes[5];
-    frame[22] = attribute;
-    frame[23] = 0x00;  // FCS MSB (calculated later)
-    frame[24] = 0x00;  // FCS LSB (calculated later)
-    frame[25] = 0x00;
-    frame[26] = 0x7E;
-    
-    // Calculate HCS (Header Check Sequence)
-    uint8_t hcsData[5] = {frame[1], frame[2], frame[3], frame[4], frame[5]};
-    CRCCalculator::calculate(hcsData, 5);
-    frame[6] = CRCCalculator::getMSB();
-    frame[7] = CRCCalculator::getLSB();
-    
-    // Calculate FCS (Frame Check Sequence)
-    uint8_t fcsData[23];
-    for (int i = 0; i < 23; i++) {
-        fcsData[i] = frame[i + 1];
-    }
-    CRCCalculator::calculate(fcsData, 23);
-    frame[24] = CRCCalculator::getMSB();
-    frame[25] = CRCCalculator::getLSB();
-    
-    return 27;
+uint8_t DLMSProtocol::descriptorsFor(const RegisterRead& read) const {
+    const ScalerEntry* cached = scalerCache.find(*read.obis);
+    if (cached && cached->isMissing()) return 0;
+    
+    // Attribute 2 (value), attribute 3 (scaler) if not cached,
+    // attribute 5 (capture time) for class 4 when a timestamp is wanted
+    uint8_t count = 1;
+    if ((read.obis->classId == 0x03 || read.obis->classId == 0x04) &&
+        (!cached || !cached->hasScaler())) {
+        count++;
+    }
+    if (read.obis->classId == 0x04 && read.timestamp) {
+        count++;
+    }
+    return count;
+}
+
+bool DLMSProtocol::readRegisters(const RegisterRead* reads, uint8_t count) {
+    bool success = true;
+    
+    if (!supportsGetWithList()) {
+        uint32_t dummy;
+        for (uint8_t i = 0; i < count; i++) {
+            uint32_t& ts = reads[i].timestamp ? *reads[i].timestamp : dummy;
+            if (!readOBIS(*reads[i].obis, *reads[i].value, ts)) {
+                success = false;
+            }
+        }
+        return success;
+    }
+    
+    uint8_t capacity = listCapacity();
+    uint8_t first = 0;
+    while (first < count) {
+        // Pack as many whole registers as fit in one list request
+        uint8_t batch = 0;
+        uint8_t descriptors = 0;
+        while (first + batch < count &&
+               descriptors + descriptorsFor(reads[first + batch]) <= capacity) {
+            descriptors += descriptorsFor(reads[first + batch]);
+            batch++;
+        }
+        if (batch == 0) batch = 1;
+        
+        if (!readRegisterBatch(&reads[first], batch)) {
+            LOG_WARN("List read failed - falling back to single GETs");
+            metrics.onRetry();
+            uint32_t dummy;
+            for (uint8_t i = first; i < first + batch; i++) {
+                uint32_t& ts = reads[i].timestamp ? *reads[i].timestamp : dummy;
+                if (!readOBIS(*reads[i].obis, *reads[i].value, ts)) {
+                    success = false;
+                }
+            }
+        }
+        
+        first += batch;
+    }
+    
+    return success;
+}
+
+uint8_t DLMSProtocol::listCapacity() const {
+    // Request: LLC + C0 03 C1 <count> + 10 bytes per descriptor, one frame
+    uint16_t capacity = (maxInfoTx - 3 - 4) / 10;
+    
+    // Response: up to 16 bytes per item, within both sides' max PDU
+    uint16_t pdu = DLMS_MAX_PDU_SIZE;
+    if (serverMaxPduSize != 0 && serverMaxPduSize < pdu) {
+        pdu = serverMaxPduSize;
+    }
+    if ((pdu - 8) / 16 < capacity) {
+        capacity = (pdu - 8) / 16;
+    }
+    
+    if (capacity > DLMS_GET_LIST_MAX_ITEMS) capacity = DLMS_GET_LIST_MAX_ITEMS;
+    if (capacity < 3) capacity = 3;     // One register with scaler and time
+    return capacity;
+}
+
+bool DLMSProtocol::readRegisterBatch(const RegisterRead* reads, uint8_t count) {
+    const OBISCode* obis[DLMS_GET_LIST_MAX_ITEMS];
+    uint8_t attributes[DLMS_GET_LIST_MAX_ITEMS];
+    uint8_t n = 0;
+    
+    for (uint8_t i = 0; i < count; i++) {
+        *reads[i].value = 0.0;
+        if (reads[i].timestamp) *reads[i].timestamp = 0;
+        
+        const ScalerEntry* cached = scalerCache.find(*reads[i].obis);
+        if (cached && cached->isMissing()) continue;
+        
+        obis[n] = reads[i].obis;
+        attributes[n++] = 0x02;
+        if ((reads[i].obis->classId == 0x03 || reads[i].obis->classId == 0x04) &&
+            (!cached || !cached->hasScaler())) {
+            obis[n] = reads[i].obis;
+            attributes[n++] = 0x03;
+        }
+        if (reads[i].obis->classId == 0x04 && reads[i].timestamp) {
+            obis[n] = reads[i].obis;
+            attributes[n++] = 0x05;
+        }
+    }
+    
+    if (n == 0) return true;
+    
+    LOG_DEBUGF("Reading list of %u registers (%u attributes)", count, n);
+    
+    uint8_t frame[18 + 10 * DLMS_GET_LIST_MAX_ITEMS];
+    uint16_t len = buildGetListFrame(obis, attributes, n, frame);
+    
+    if (!sendFrame(frame, len)) return false;
+    if (!receiveFrame()) return false;
+    incrementFrameCounter();
+    if (!verifyListResponse()) return false;
+    
+    // Get-Response-With-List: C4 03 <invoke> SEQUENCE OF Get-Data-Result
+    AXDRReader reader(&receiveBuffer[14], &receiveBuffer[receiveLength - 3]);  // FCS + flag
+    uint16_t items;
+    
+    if (!reader.readLength(items) || items != n) {
+        LOG_ERROR("List response item count mismatch");
+        return false;
+    }
+    
+    uint8_t item = 0;
+    for (uint8_t i = 0; i < count; i++) {
+        const RegisterRead& read = reads[i];
+        bool valueOk = false;
+        
+        while (item < n && obis[item] == read.obis) {
+            uint8_t attribute = attributes[item++];
+            
+            // Get-Data-Result: 0x00 = data, 0x01 = data-access-result
+            uint8_t choice;
+            if (!reader.readByte(choice)) {
+                LOG_ERROR("List response truncated");
+                return false;
+            }
+            
+            if (choice != 0x00) {
+                uint8_t result = 0;
+                if (!reader.readByte(result)) {
+                    LOG_ERROR("List response truncated");
+                    return false;
+                }
+                LOG_WARNF("%s: access error %u", read.obis->name, result);
+                if (result == 0x04) {                       // object-undefined
+                    if (attribute == 0x02) {
+                        scalerCache.markMissing(*read.obis);
+                    } else if (attribute == 0x03) {
+                        // No scaler_unit: remember as unscaled, as readScaler does
+                        scalerCache.storeScaler(*read.obis, 0, 0);
+                    }
+                }
+                continue;
+            }
+            
+            AXDRValue data;
+            if (!reader.next(data)) {
+                LOG_ERROR("List response malformed");
+                return false;
+            }
+            
+            int8_t scaler;
+            uint8_t unit;
+            if (attribute == 0x02) {
+                valueOk = data.toFloat(*read.value);
+            } else if (attribute == 0x03) {
+                if (decodeScaler(data, scaler, unit)) {
+                    scalerCache.storeScaler(*read.obis, scaler, unit);
+                }
+            } else {
+                data.toDateTime(*read.timestamp);
+            }
+        }
+        
+        if (!valueOk) {
+            if (descriptorsFor(read) > 0) {
+                LOG_WARNF("Failed to read %s", read.obis->name);
+            }
+            continue;
+        }
+        
+        const ScalerEntry* cached = scalerCache.find(*read.obis);
+        if (cached && cached->hasScaler()) {
+            *read.value = *read.value * pow(10, cached->scaler);
+        }
+        
+        valuesRead++;
+        LOG_DEBUGF("%s: %.3f %s", read.obis->name, *read.value, read.obis->unit);
+    }
+    
+    return true;
 }
 
 // ============================================
-// DATA EXTRACTION
+// PROFILE GENERIC (CLASS 7)
 // ============================================
 
-bool DLMSProtocol::extractValue(float& value) {
-    if (receiveLength < 20) return false;
+/**
+ * @class CaptureObjectCollector
+ * @brief Collects capture_objects (attribute 3) elements into columns
+ *
+ * Element: structure { class_id: long-unsigned, logical_name: octet-string(6),
+ *                      attribute_index: integer, data_index: long-unsigned }
+ */
+class CaptureObjectCollector : public ArrayElementHandler {
+public:
+    ProfileColumn* columns;
+    uint8_t count;
     
-    // Find data type tag
-    uint8_t dataType = receiveBuffer[15];
+    explicit CaptureObjectCollector(ProfileColumn* c) : columns(c), count(0) {}
     
-    if (dataType == 0x06) {  // 32-bit unsigned
-        uint32_t temp = ((uint32_t)receiveBuffer[16] << 24) |
-                       ((uint32_t)receiveBuffer[17] << 16) |
-                       ((uint32_t)receiveBuffer[18] << 8) |
-                       ((uint32_t)receiveBuffer[19]);
-        value = (float)temp;
+    bool onElement(const AXDRValue& element) override {
+        AXDRReader fields = element.elements();
+        AXDRValue classId, name, attribute;
+        int64_t classValue, attributeValue;
+        
+        if (element.tag != AXDRTag::STRUCTURE || element.length < 3 ||
+            !fields.next(classId) || !classId.toInt64(classValue) ||
+            !fields.next(name, AXDRTag::OCTET_STRING) || name.length != 6 ||
+            !fields.next(attribute) || !attribute.toInt64(attributeValue)) {
+            LOG_ERROR("Invalid capture object");
+            return false;
+        }
+        
+        if (count >= PROFILE_MAX_COLUMNS) {
+            LOG_WARN("Profile has more than PROFILE_MAX_COLUMNS columns");
+            return true;
+        }
+        
+        ProfileColumn& column = columns[count++];
+        column.classId = classValue;
+        memcpy(column.obis, name.data, 6);
+        column.attribute = attributeValue;
+        column.scaler = 0;
         return true;
     }
-    else if (dataType == 0x12 || dataType == 0x10) {  // 16-bit unsigned
-        uint16_t temp = ((uint16_t)receiveBuffer[16] << 8) |
-                       ((uint16_t)receiveBuffer[17]);
-        value = (float)temp;
-        return true;
+};
+
+/**
+ * @class ProfileRowDecoder
+ * @brief Decodes buffer rows into ProfileRecords for a sink
+ */
+class ProfileRowDecoder : public ArrayElementHandler {
+public:
+    ProfileRowDecoder(const ProfileColumn* c, uint8_t n, ProfileRecordSink& s)
+        : columns(c), columnCount(n), sink(s), rows(0), lastCapture(0) {}
+    
+    const ProfileColumn* columns;
+    uint8_t columnCount;
+    ProfileRecordSink& sink;
+    uint16_t rows;
+    uint32_t lastCapture;
+    
+    bool onElement(const AXDRValue& element) override;
+};
+
+bool ProfileRowDecoder::onElement(const AXDRValue& element) {
+    if (element.tag != AXDRTag::STRUCTURE) {
+        LOG_ERROR("Invalid profile row");
+        return false;
     }
     
-    return false;
+    ProfileRecord record;
+    record.captureTime = 0;
+    record.valueCount = 0;
+    
+    AXDRReader items = element.elements();
+    AXDRValue item;
+    for (uint16_t i = 0; i < columnCount && items.next(item); i++) {
+        // Clock column carries the capture time; everything else is a value
+        if (columns[i].classId == OBISCodes::CLOCK.classId) {
+            item.toDateTime(record.captureTime);
+            continue;
+        }
+        
+        float value;
+        if (item.toFloat(value)) {
+            value = value * pow(10, columns[i].scaler);
+        } else {
+            value = NAN;
+        }
+        record.values[record.valueCount++] = value;
+    }
+    
+    rows++;
+    if (record.captureTime > lastCapture) {
+        lastCapture = record.captureTime;
+    }
+    
+    return sink.onRecord(record);
 }
 
-bool DLMSProtocol::extractString(String& value) {
-    if (receiveLength < 18) return false;
+bool DLMSProtocol::readProfile(const OBISCode& profile, uint32_t from, uint32_t to,
+                               ProfileRecordSink& sink, uint32_t& lastCapture) {
+    char fromText[20];
+    char toText[20];
+    DLMSDateTime::format(from, fromText);
+    DLMSDateTime::format(to, toText);
+    LOG_INFOF("Reading %s from %s to %s", profile.name, fromText, toText);
+    unsigned long start = millis();
+    
+    // Capture objects (attribute 3) describe the row layout
+    ProfileColumn columns[PROFILE_MAX_COLUMNS];
+    CaptureObjectCollector collector(columns);
+    
+    uint8_t frame[128];
+    uint16_t len = buildOBISFrame(profile, profile.classId, 0x03, frame);
+    
+    if (!readArrayAttribute(frame, len, collector) || collector.count == 0) {
+        LOG_ERROR("Failed to read capture objects");
+        metrics.phaseDone(LinkPhase::PROFILE, millis() - start, false);
+        return false;
+    }
     
-    uint8_t dataType = receiveBuffer[15];
+    // Scalers of register columns (cached after the first read)
+    for (uint8_t i = 0; i < collector.count; i++) {
+        ProfileColumn& column = columns[i];
+        if ((column.classId == 0x03 || column.classId == 0x04) && column.attribute == 2) {
+            OBISCode obis(column.obis[0], column.obis[1], column.obis[2],
+                          column.obis[3], column.obis[4], column.obis[5],
+                          "Profile column", "", column.classId);
+            int8_t scaler;
+            if (readScaler(obis, scaler)) {
+                column.scaler = scaler;
+            }
+        }
+    }
+    
+    sink.onColumns(columns, collector.count);
+    
+    // Buffer (attribute 2) with selective access by range
+    ProfileRowDecoder decoder(columns, collector.count, sink);
+    len = buildProfileRangeFrame(profile, from, to, frame);
+    
+    bool success = readArrayAttribute(frame, len, decoder);
+    scalerCache.save();
+    
+    if (decoder.lastCapture > 0) {
+        lastCapture = decoder.lastCapture;
+    }
+    
+    LOG_INFOF("Profile rows read: %u", decoder.rows);
+    metrics.phaseDone(LinkPhase::PROFILE, millis() - start, success);
+    return success;
+}
+
+bool DLMSProtocol::readClock(uint32_t& epoch) {
+    uint8_t frame[27];
+    uint16_t len = buildOBISFrame(OBISCodes::CLOCK, OBISCodes::CLOCK.classId, 0x02, frame);
     
-    if (dataType == 0x09 || dataType == 0x0A) {  // Octet string / visible string
-        uint8_t length = receiveBuffer[16];
-        value = "";
-        for (int i = 0; i < length && (17 + i) < receiveLength; i++) {
-            value += (char)receiveBuffer[17 + i];
+    if (!sendFrame(frame, len)) return false;
+    if (!receiveFrame()) return false;
+    incrementFrameCounter();
+    if (!verifyOBISResponse()) return false;
+    
+    AXDRValue data;
+    if (!responseData(data) || !data.toDateTime(epoch)) {
+        LOG_WARN("Invalid clock value");
+        return false;
+    }
+    return epoch != 0;
+}
+
+bool DLMSProtocol::readArrayAttribute(const uint8_t* frame, uint16_t length,
+                                      ArrayElementHandler& handler) {
+    ArrayStream stream;
+    stream.handler = &handler;
+    stream.carryLength = 0;
+    stream.remaining = 0;
+    stream.headerDone = false;
+    
+    if (!sendFrame(frame, length)) return false;
+    
+    while (true) {
+        if (!receiveFrame()) return false;
+        incrementFrameCounter();
+        
+        if (receiveLength < 18 ||
+            receiveBuffer[3] != DLMS_CLIENT_SAP ||
+            receiveBuffer[4] != DLMS_SERVER_SAP ||
+            receiveBuffer[8] != 0xE6 ||
+            receiveBuffer[9] != 0xE7 ||
+            receiveBuffer[11] != 0xC4) {
+            LOG_ERROR("Invalid GET response");
+            return false;
         }
-        return true;
+        
+        const uint8_t* end = &receiveBuffer[receiveLength - 3];
+        
+        // Get-Response-Normal: whole array in one APDU
+        if (receiveBuffer[12] == 0x01) {
+            if (receiveBuffer[14] != 0x00) {
+                LOG_ERRORF("Access error %u", receiveBuffer[15]);
+                return false;
+            }
+            return feedArray(stream, &receiveBuffer[15], end - &receiveBuffer[15], true);
+        }
+        
+        // Get-Response-With-Datablock
+        if (receiveBuffer[12] != 0x02 || receiveLength < 24) {
+            LOG_ERROR("Unexpected GET response type");
+            return false;
+        }
+        
+        bool lastBlock = receiveBuffer[14] != 0x00;
+        uint32_t blockNumber = ((uint32_t)receiveBuffer[15] << 24) |
+                               ((uint32_t)receiveBuffer[16] << 16) |
+                               ((uint32_t)receiveBuffer[17] << 8) |
+                               ((uint32_t)receiveBuffer[18]);
+        
+        if (receiveBuffer[19] != 0x00) {
+            LOG_ERRORF("Block %u access error %u", blockNumber, receiveBuffer[20]);
+            return false;
+        }
+        
+        const uint8_t* p = &receiveBuffer[20];
+        uint16_t blockLength;
+        if (!AXDRReader::decodeLength(p, end, blockLength) || p + blockLength > end) {
+            LOG_ERRORF("Block %u truncated", blockNumber);
+            return false;
+        }
+        
+        LOG_DEBUGF("Data block %u (%u bytes)%s", blockNumber, blockLength,
+                   lastBlock ? ", last" : "");
+        
+        if (!feedArray(stream, p, blockLength, lastBlock)) return false;
+        if (lastBlock) return true;
+        
+        // GET-Request-Next acknowledges this block and asks for the next
+        uint8_t next[APDU_OFFSET + 7 + 3];
+        uint8_t* apdu = &next[APDU_OFFSET];
+        apdu[0] = 0xC0;
+        apdu[1] = 0x02;
+        apdu[2] = 0xC1;
+        apdu[3] = (blockNumber >> 24) & 0xFF;
+        apdu[4] = (blockNumber >> 16) & 0xFF;
+        apdu[5] = (blockNumber >> 8) & 0xFF;
+        apdu[6] = blockNumber & 0xFF;
+        
+        uint16_t nextLength = finishInfoFrame(next, 7);
+        if (!sendFrame(next, nextLength)) return false;
+    }
+}
+
+bool DLMSProtocol::feedArray(ArrayStream& stream, const uint8_t* data, uint16_t length,
+                             bool last) {
+    const uint8_t* p = data;
+    const uint8_t* end = data + length;
+    
+    if (!stream.headerDone) {
+        if (p < end && *p == 0x00) {                // null-data: empty buffer
+            return true;
+        }
+        if (p >= end || *p++ != AXDRTag::ARRAY ||
+            !AXDRReader::decodeLength(p, end, stream.remaining)) {
+            LOG_ERROR("Expected array");
+            return false;
+        }
+        stream.headerDone = true;
     }
     
-    return false;
+    // Complete an element that was split across the previous block
+    if (stream.carryLength > 0) {
+        uint16_t take = min((uint16_t)(end - p),
+                            (uint16_t)(sizeof(stream.carry) - stream.carryLength));
+        memcpy(&stream.carry[stream.carryLength], p, take);
+        
+        AXDRReader carried(stream.carry, &stream.carry[stream.carryLength + take]);
+        AXDRValue element;
+        if (carried.next(element)) {
+            if (!stream.handler->onElement(element)) return false;
+            p += (element.end - stream.carry) - stream.carryLength;
+            stream.carryLength = 0;
+            stream.remaining--;
+        } else if (stream.carryLength + take >= sizeof(stream.carry)) {
+            LOG_ERROR("Array element exceeds PROFILE_MAX_ROW_SIZE");
+            return false;
+        } else {
+            stream.carryLength += take;
+            p = end;
+        }
+    }
+    
+    while (stream.remaining > 0 && p < end) {
+        AXDRReader reader(p, end);
+        AXDRValue element;
+        if (!reader.next(element)) {
+            // Incomplete element: keep it for the next block
+            if (end - p > (int)sizeof(stream.carry)) {
+                LOG_ERROR("Array element exceeds PROFILE_MAX_ROW_SIZE");
+                return false;
+            }
+            memcpy(stream.carry, p, end - p);
+            stream.carryLength = end - p;
+            break;
+        }
+        
+        if (!stream.handler->onElement(element)) return false;
+        p = element.end;
+        stream.remaining--;
+    }
+    
+    if (last && (stream.remaining > 0 || stream.carryLength > 0)) {
+        LOG_ERRORF("Array truncated: %u elements missing", stream.remaining);
+        return false;
+    }
+    
+    return true;
 }
 
-bool DLMSProtocol::extractDateTime(String& timestamp) {
-    if (receiveLength < 30) return false;
+// ============================================
+// FRAME BUILDING
+// ============================================
+
+uint16_t DLMSProtocol::buildOBISFrame(const OBISCode& obis, uint8_t classId, 
+                                       uint8_t attribute, uint8_t* frame) {
+    uint8_t* apdu = &frame[APDU_OFFSET];
+    uint16_t i = 0;
+    
+    apdu[i++] = 0xC0;  // GET-Request
+    apdu[i++] = 0x01;  // Normal
+    apdu[i++] = 0xC1;  // Invoke ID and priority
+    apdu[i++] = 0x00;
+    apdu[i++] = classId;
+    memcpy(&apdu[i], obis.bytes, 6);
+    i += 6;
+    apdu[i++] = attribute;
+    apdu[i++] = 0x00;  // No selective access
+    
+    return finishInfoFrame(frame, i);
+}
+
+uint16_t DLMSProtocol::buildGetListFrame(const OBISCode* const* obis, const uint8_t* attributes,
+                                         uint8_t count, uint8_t* frame) {
+    uint8_t* apdu = &frame[APDU_OFFSET];
+    uint16_t i = 0;
+    
+    apdu[i++] = 0xC0;  // GET-Request
+    apdu[i++] = 0x03;  // With-List
+    apdu[i++] = 0xC1;  // Invoke ID and priority
+    apdu[i++] = count;
+    
+    for (uint8_t n = 0; n < count; n++) {
+        apdu[i++] = 0x00;
+        apdu[i++] = obis[n]->classId;
+        memcpy(&apdu[i], obis[n]->bytes, 6);
+        i += 6;
+        apdu[i++] = attributes[n];
+        apdu[i++] = 0x00;  // No selective access
+    }
     
-    // DLMS datetime: 12 bytes starting at offset 17
-    uint16_t year = (receiveBuffer[17] << 8) | receiveBuffer[18];
-    uint8_t month = receiveBuffer[19];
-    uint8_t day = receiveBuffer[20];
-    uint8_t hour = receiveBuffer[21];
-    uint8_t minute = receiveBuffer[22];
-    uint8_t second = receiveBuffer[23];
+    return finishInfoFrame(frame, i);
+}
+
+uint16_t DLMSProtocol::buildProfileRangeFrame(const OBISCode& profile, uint32_t from,
+                                              uint32_t to, uint8_t* frame) {
+    uint8_t* apdu = &frame[APDU_OFFSET];
+    uint16_t i = 0;
+    
+    apdu[i++] = 0xC0;  // GET-Request
+    apdu[i++] = 0x01;  // Normal
+    apdu[i++] = 0xC1;
+    apdu[i++] = 0x00;
+    apdu[i++] = profile.classId;
+    memcpy(&apdu[i], profile.bytes, 6);
+    i += 6;
+    apdu[i++] = 0x02;  // Attribute 2 (buffer)
+    apdu[i++] = 0x01;  // Access selection present
+    apdu[i++] = 0x01;  // Selector 1: range_descriptor
+    
+    // range_descriptor ::= structure { restricting_object, from, to, selected_values }
+    apdu[i++] = 0x02;
+    apdu[i++] = 0x04;
+    
+    // restricting_object: clock (class 8) attribute 2, data index 0
+    apdu[i++] = 0x02;
+    apdu[i++] = 0x04;
+    apdu[i++] = 0x12;
+    apdu[i++] = 0x00;
+    apdu[i++] = OBISCodes::CLOCK.classId;
+    apdu[i++] = 0x09;
+    apdu[i++] = 0x06;
+    memcpy(&apdu[i], OBISCodes::CLOCK.bytes, 6);
+    i += 6;
+    apdu[i++] = 0x0F;
+    apdu[i++] = 0x02;
+    apdu[i++] = 0x12;
+    apdu[i++] = 0x00;
+    apdu[i++] = 0x00;
+    
+    apdu[i++] = 0x09;
+    apdu[i++] = DLMSDateTime::SIZE;
+    DLMSDateTime::fromEpoch(from, &apdu[i]);
+    i += DLMSDateTime::SIZE;
+    
+    apdu[i++] = 0x09;
+    apdu[i++] = DLMSDateTime::SIZE;
+    DLMSDateTime::fromEpoch(to, &apdu[i]);
+    i += DLMSDateTime::SIZE;
+    
+    // selected_values: empty array = all columns
+    apdu[i++] = 0x01;
+    apdu[i++] = 0x00;
+    
+    return finishInfoFrame(frame, i);
+}
+
+uint16_t DLMSProtocol::finishInfoFrame(uint8_t* frame, uint16_t apduLength) {
+    uint16_t i = APDU_OFFSET + apduLength;
     
-    // Handle "not specified" values
-    if (year == 0xFFFF) year = 0;
-    if (month == 0xFF) month = 1;
-    if (day == 0xFF) day = 1;
-    if (hour == 0xFF) hour = 0;
-    if (minute == 0xFF) minute = 0;
-    if (second == 0xFF) second = 0;
+    // Length excludes opening/closing flags, includes FCS
+    uint16_t frameLength = i + 2 - 1;
     
-    char buffer[20];
-    sprintf(buffer, "%04u-%02u-%02u %02u:%02u:%02u", 
-            year, month, day, hour, minute, second);
-    timestamp = String(buffer);
+    frame[0] = 0x7E;
+    frame[1] = 0xA0 | ((frameLength >> 8) & 0x07);
+    frame[2] = frameLength & 0xFF;
+    frame[3] = DLMS_SERVER_SAP;
+    frame[4] = DLMS_CLIENT_SAP;
+    frame[5] = iFrameControl();
+    frame[8] = 0xE6;
+    frame[9] = 0xE6;
+    frame[10] = 0x00;
+    
+    CRCCalculator::put(&frame[6], CRCCalculator::calculate(&frame[1], 5));
+    
+    CRCCalculator::put(&frame[i], CRCCalculator::calculate(&frame[1], i - 1));
+    i += 2;
+    frame[i++] = 0x7E;
+    
+    return i;
+}
+
+// ============================================
+// DATA EXTRACTION
+// ============================================
+
+bool DLMSProtocol::responseData(AXDRValue& value) const {
+    if (receiveLength < APDU_OFFSET + 4 + 3) return false;
+    
+    // Get-Response-Normal ::= C4 01 <invoke-id> Get-Data-Result
+    AXDRReader reader(&receiveBuffer[APDU_OFFSET], &receiveBuffer[receiveLength - 3]);
+    uint8_t tag, type, invokeId, choice;
+    
+    return reader.readByte(tag) && tag == 0xC4 &&
+           reader.readByte(type) && type == 0x01 &&
+           reader.readByte(invokeId) &&
+           reader.readByte(choice) && choice == 0x00 &&
+           reader.next(value);
+}
+
+bool DLMSProtocol::decodeScaler(const AXDRValue& value, int8_t& scaler, uint8_t& unit) {
+    AXDRReader fields = value.elements();
+    AXDRValue scalerValue, unitValue;
+    int64_t s, u;
+    
+    if (value.tag != AXDRTag::STRUCTURE || value.length != 2 ||
+        !fields.next(scalerValue) || !scalerValue.toInt64(s) ||
+        !fields.next(unitValue) || !unitValue.toInt64(u)) {
+        return false;
+    }
     
+    scaler = s;
+    unit = u;
     return true;
 }
 
@@ -549,11 +1518,8 @@ bool DLMSProtocol::extractDateTime(String& timestamp) {
 // ============================================
 
 void DLMSProtocol::incrementFrameCounter() {
-    if (hdlcFrameCounter < 0xFE) {
-        hdlcFrameCounter += 0x22;
-    } else {
-        hdlcFrameCounter = 0x10;
-    }
+    // N(R) follows the meter's frames in receiveFrame
+    sendSequence = (sendSequence + 1) & 0x07;
 }
 
 void DLMSProtocol::setError(DLMSError error) {
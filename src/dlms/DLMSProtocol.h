@@ -14,8 +14,15 @@
 #include "../utils/CRCCalculator.h"
 #include "../utils/Logger.h"
 #include "../hardware/HardwareManager.h"
+#include "../hardware/MeterTransport.h"
 #include "../data/MeterData.h"
 #include "OBISCodes.h"
+#include "ScalerCache.h"
+#include "LinkPacer.h"
+#include "LinkMetrics.h"
+#include "ProfileGeneric.h"
+#include "AXDR.h"
+#include "ReadPlan.h"
 
 /**
  * @enum DLMSState
@@ -46,6 +53,24 @@ enum class DLMSError {
     UNKNOWN
 };
 
+/**
+ * @namespace DLMSConformance
+ * @brief Conformance block bits (24-bit, bit 0 = MSB of first byte)
+ */
+namespace DLMSConformance {
+    const uint32_t BLOCK_TRANSFER_GET   = 1UL << (23 - 11);
+    const uint32_t BLOCK_TRANSFER_SET   = 1UL << (23 - 12);
+    const uint32_t MULTIPLE_REFERENCES  = 1UL << (23 - 14);
+    const uint32_t GET                  = 1UL << (23 - 19);
+    const uint32_t SET                  = 1UL << (23 - 20);
+    const uint32_t SELECTIVE_ACCESS     = 1UL << (23 - 21);
+    const uint32_t ACTION               = 1UL << (23 - 23);
+    
+    // Proposed in AARQ (00 1A 1D)
+    const uint32_t PROPOSED = BLOCK_TRANSFER_GET | BLOCK_TRANSFER_SET | MULTIPLE_REFERENCES |
+                              GET | SET | SELECTIVE_ACCESS | ACTION;
+}
+
 /**
  * @class DLMSProtocol
  * @brief Handles DLMS/COSEM protocol communication
@@ -54,8 +79,34 @@ class DLMSProtocol {
 public:
     /**
      * @brief Constructor
+     * @param physicalAddress HDLC lower (physical) server address, 0 for
+     *        the single-meter 1-byte DLMS_SERVER_SAP address
+     * @param logicalAddress HDLC upper (logical device) server address
      */
-    DLMSProtocol();
+    explicit DLMSProtocol(uint16_t physicalAddress = 0,
+                          uint16_t logicalAddress = DLMS_LOGICAL_DEVICE);
+    
+    /**
+     * @brief Set HDLC server address (only while disconnected)
+     * 
+     * Both parts up to 0x7F give a 2-byte address, larger values the
+     * 4-byte form (14 bits each).
+     * 
+     * @param physicalAddress Lower address, 0 for 1-byte DLMS_SERVER_SAP
+     * @param logicalAddress Upper address
+     */
+    void setAddress(uint16_t physicalAddress, uint16_t logicalAddress = DLMS_LOGICAL_DEVICE);
+    
+    /**
+     * @brief Get HDLC physical server address (0 = single-meter address)
+     */
+    uint16_t getPhysicalAddress() const { return physicalAddress; }
+    
+    /**
+     * @brief Use a meter link other than UART2 (only while disconnected)
+     * @param transport Link to use, nullptr for the default UartTransport
+     */
+    void setTransport(MeterTransport* transport);
     
     /**
      * @brief Initialize DLMS protocol
@@ -75,28 +126,127 @@ public:
     bool disconnect();
     
     /**
-     * @brief Read all meter data
+     * @brief Keep a held association alive between polls
+     * 
+     * Sends RR once the link has been idle for HDLC_KEEPALIVE_INTERVAL.
+     * A missing reply, or idling past HDLC_INACTIVITY_TIMEOUT, marks the
+     * association as lost so the next poll re-associates.
+     * 
+     * @return true if the association is still up
+     */
+    bool maintain();
+    
+    /**
+     * @brief Read identification and the registers selected by the read plan
+     * 
+     * Serial number and manufacturer are read once per association.
+     * Registers outside the tier mask keep their previous values.
+     * 
      * @param data MeterData structure to populate
-     * @return true if successful
+     * @param tiers Mask of ReadTier bits to read
+     * @return true if successful; false (data not valid) if no register
+     *         in the plan produced a value
      */
-    bool readMeterData(MeterData& data);
+    bool readMeterData(MeterData& data, uint8_t tiers = ReadTier::ALL);
+    
+    /**
+     * @brief Use a site read plan (kept by reference, nullptr for defaults)
+     */
+    void setReadPlan(const ReadPlan* plan);
     
     /**
      * @brief Read specific OBIS code
      * @param obis OBIS code to read
      * @param value Output value
-     * @param timestamp Output timestamp (for MD values)
+     * @param timestamp Output capture time, meter local epoch (for MD values)
      * @return true if successful
      */
-    bool readOBIS(const OBISCode& obis, float& value, String& timestamp);
+    bool readOBIS(const OBISCode& obis, float& value, uint32_t& timestamp);
     
     /**
      * @brief Read string data (serial number, manufacturer)
      * @param obis OBIS code
-     * @param value Output string
+     * @param value Output string (truncated to size, always terminated)
+     * @param size Size of value buffer
+     * @return true if successful
+     */
+    bool readOBISString(const OBISCode& obis, char* value, size_t size);
+    
+    /**
+     * @brief Read several registers using GET-Request-With-List
+     * 
+     * Falls back to single GETs (readOBIS) when the meter did not
+     * grant the multiple-references conformance bit, or when a list
+     * exchange fails.
+     * 
+     * @param reads Registers to read
+     * @param count Number of registers
+     * @return true if every register was read
+     */
+    bool readRegisters(const RegisterRead* reads, uint8_t count);
+    
+    /**
+     * @brief Read Profile Generic rows captured in a time range
+     * 
+     * Reads capture objects (attribute 3), then the buffer (attribute 2)
+     * with selective access by range on the clock column. Long buffers
+     * are fetched with GET-Request-Next block transfer and decoded row
+     * by row into the sink.
+     * 
+     * @param profile Profile Generic object (class 7)
+     * @param from First capture time to read (meter local epoch)
+     * @param to Last capture time to read (meter local epoch)
+     * @param sink Receives capture objects and decoded rows
+     * @param lastCapture Output: capture time of last row (unchanged if none)
+     * @return true if the range was read completely
+     */
+    bool readProfile(const OBISCode& profile, uint32_t from, uint32_t to,
+                     ProfileRecordSink& sink, uint32_t& lastCapture);
+    
+    /**
+     * @brief Read meter clock (class 8, attribute 2)
+     * @param epoch Output: meter local time, seconds since 1970
      * @return true if successful
      */
-    bool readOBISString(const OBISCode& obis, String& value);
+    bool readClock(uint32_t& epoch);
+    
+    /**
+     * @brief Get conformance block negotiated in AARE
+     */
+    uint32_t getConformance() const { return negotiatedConformance; }
+    
+    /**
+     * @brief Check if meter accepts GET-Request-With-List
+     */
+    bool supportsGetWithList() const {
+        return DLMS_GET_LIST_ENABLED &&
+               (negotiatedConformance & DLMSConformance::MULTIPLE_REFERENCES);
+    }
+    
+    /**
+     * @brief Get negotiated HDLC max information field (transmit)
+     */
+    uint16_t getMaxInfoTx() const { return maxInfoTx; }
+    
+    /**
+     * @brief Get negotiated HDLC max information field (receive)
+     */
+    uint16_t getMaxInfoRx() const { return maxInfoRx; }
+    
+    /**
+     * @brief Get negotiated HDLC receive window (frames per RR)
+     */
+    uint8_t getWindowRx() const { return windowRx; }
+    
+    /**
+     * @brief Get inter-frame pacing learned for current meter
+     */
+    const LinkPacer& getPacer() const { return pacer; }
+    
+    /**
+     * @brief Performance counters of this link
+     */
+    const LinkMetrics& getMetrics() const { return metrics; }
     
     /**
      * @brief Get current state
@@ -118,29 +268,90 @@ public:
      */
     void resetErrors() { errorCount = 0; lastError = DLMSError::NONE; }
     
+    /**
+     * @brief Drop cached scaler/class-check results for current meter
+     */
+    void clearScalerCache() { scalerCache.clear(); }
+    
     /**
      * @brief Check if connected
      */
     bool isConnected() const { return state == DLMSState::ASSOCIATED; }
-
+    
 private:
     DLMSState state;
     DLMSError lastError;
     uint8_t errorCount;
-    uint8_t hdlcFrameCounter;
-    uint8_t receiveBuffer[MAX_FRAME_SIZE];
-    uint16_t receiveLength;
+    uint8_t sendSequence;       // HDLC N(S) of next I-frame
+    uint8_t receiveSequence;    // HDLC N(R): next N(S) expected from meter
+    uint16_t maxInfoTx;
+    uint16_t maxInfoRx;
+    uint8_t windowTx;
+    uint8_t windowRx;
+    uint16_t physicalAddress;
+    MeterTransport* transport;
+    uint8_t serverAddress[4];       // Encoded HDLC server address
+    uint8_t serverAddressLength;    // 1, 2 or 4 bytes
+    uint32_t lastActivityTime;                      // Last valid frame from meter
+    uint16_t valuesRead;                            // Register values decoded, wraps
+    uint32_t negotiatedConformance;
+    uint16_t serverMaxPduSize;
+    ScalerCache scalerCache;
+    LinkPacer pacer;
+    LinkMetrics metrics;
+    const ReadPlan* readPlan;
+    bool identified;            // Identification read in this association
+    
+    // Exchange buffers, shared by all instances since only one meter
+    // talks on the bus at a time. Frames in them always use the 1-byte
+    // (DLMS_SERVER_SAP) layout; the wire address is swapped in and out
+    // by sendFrame and receiveHDLCFrame.
+    static uint8_t receiveBuffer[DLMS_MAX_PDU_SIZE + 16];  // Response, segments reassembled
+    static uint16_t receiveLength;
+    static uint8_t frameBuffer[MAX_FRAME_SIZE];            // Follow-up segment
+    static uint8_t transmitBuffer[MAX_FRAME_SIZE];         // Frame with wire address
     
-    // Protocol frames
-    static const uint8_t SNRM_FRAME[];
-    static const uint8_t AARQ_FRAME[];
-    static const uint8_t DISC_FRAME[];
+    // Offset of APDU in an I-frame (flag, header, HCS, LLC)
+    static const uint16_t APDU_OFFSET = 11;
+    
+    // Frame format segmentation bit and control poll/final bit
+    static const uint8_t HDLC_SEGMENT_BIT = 0x08;
+    static const uint8_t HDLC_POLL_FINAL = 0x10;
     
     /**
      * @brief Send SNRM (Set Normal Response Mode)
+     * @param proposeParameters Include HDLC_MAX_INFO_* / HDLC_WINDOW_* proposal
+     * @return true if successful
+     */
+    bool sendSNRM(bool proposeParameters);
+    
+    /**
+     * @brief SNRM and AARQ, timed by connect()
+     */
+    bool associate();
+    
+    /**
+     * @brief Send RR (Receive Ready) acknowledging received I-frames
      * @return true if successful
      */
-    bool sendSNRM();
+    bool sendReceiveReady();
+    
+    /**
+     * @brief Parse negotiated link parameters from UA frame
+     */
+    void parseUAParameters();
+    
+    /**
+     * @brief Control byte for next I-frame (N(R), P, N(S))
+     */
+    uint8_t iFrameControl() const {
+        return (receiveSequence << 5) | HDLC_POLL_FINAL | (sendSequence << 1);
+    }
+    
+    /**
+     * @brief Attribute descriptors that fit one list request and response
+     */
+    uint8_t listCapacity() const;
     
     /**
      * @brief Send AARQ (Association Request)
@@ -148,6 +359,11 @@ private:
      */
     bool sendAARQ();
     
+    /**
+     * @brief Forget link and association state (no frames sent)
+     */
+    void resetLink();
+    
     /**
      * @brief Send disconnect frame
      * @return true if successful
@@ -166,20 +382,149 @@ private:
                             uint8_t attribute, uint8_t* frame);
     
     /**
-     * @brief Send frame to meter
+     * @brief Build GET-Request-With-List frame
+     * @param obis OBIS codes (one per descriptor)
+     * @param attributes Attribute numbers (one per descriptor)
+     * @param count Number of descriptors
+     * @param frame Output frame buffer
+     * @return Frame length
+     */
+    uint16_t buildGetListFrame(const OBISCode* const* obis, const uint8_t* attributes,
+                               uint8_t count, uint8_t* frame);
+    
+    /**
+     * @brief Complete an I-frame around an APDU written at APDU_OFFSET
+     * @param frame Frame buffer holding APDU at APDU_OFFSET
+     * @param apduLength APDU length
+     * @return Frame length
+     */
+    uint16_t finishInfoFrame(uint8_t* frame, uint16_t apduLength);
+    
+    /**
+     * @brief Build profile buffer request with selective access by range
+     * @param profile Profile Generic object
+     * @param from First capture time (epoch)
+     * @param to Last capture time (epoch)
+     * @param frame Output frame buffer
+     * @return Frame length
+     */
+    uint16_t buildProfileRangeFrame(const OBISCode& profile, uint32_t from,
+                                    uint32_t to, uint8_t* frame);
+    
+    /**
+     * @brief Read scaler of a register (cached)
+     * @param obis Register OBIS code
+     * @param scaler Output scaler
+     * @return true if scaler is known
+     */
+    bool readScaler(const OBISCode& obis, int8_t& scaler);
+    
+    /**
+     * @brief Send GET request for an array attribute and stream its elements
+     * 
+     * Handles both Get-Response-Normal and Get-Response-With-Datablock,
+     * requesting further blocks with GET-Request-Next.
+     * 
+     * @param frame Request frame
+     * @param length Request frame length
+     * @param handler Receives each complete element
+     * @return true if the whole array was received
+     */
+    bool readArrayAttribute(const uint8_t* frame, uint16_t length,
+                            ArrayElementHandler& handler);
+    
+    /**
+     * @struct ArrayStream
+     * @brief Decoding state of an array arriving in blocks
+     */
+    struct ArrayStream {
+        ArrayElementHandler* handler;
+        uint8_t carry[PROFILE_MAX_ROW_SIZE];    // Element split across blocks
+        uint16_t carryLength;
+        uint16_t remaining;                     // Elements still expected
+        bool headerDone;
+    };
+    
+    /**
+     * @brief Feed one block of array data
+     * @param stream Decoding state
+     * @param data Block data
+     * @param length Block length
+     * @param last true if this is the last block
+     * @return false on malformed data or handler abort
+     */
+    bool feedArray(ArrayStream& stream, const uint8_t* data, uint16_t length, bool last);
+    
+    /**
+     * @brief Read one batch of registers in a single list exchange
+     * @param reads Registers to read
+     * @param count Number of registers (must fit listCapacity())
+     * @return true if the exchange succeeded (per-item failures are logged)
+     */
+    bool readRegisterBatch(const RegisterRead* reads, uint8_t count);
+    
+    /**
+     * @brief Number of attribute descriptors needed for one register
+     * @param read Register to read
+     * @return Descriptor count (0 if meter lacks the object)
+     */
+    uint8_t descriptorsFor(const RegisterRead& read) const;
+    
+    /**
+     * @brief Send frame to meter, paced by the learned inter-frame gap
      * @param frame Frame data
      * @param length Frame length
+     * @param expectReply false if a missing reply is not a link failure
      * @return true if successful
      */
-    bool sendFrame(const uint8_t* frame, uint16_t length);
+    bool sendFrame(const uint8_t* frame, uint16_t length, bool expectReply = true);
     
     /**
-     * @brief Receive frame from meter
-     * @param timeout Timeout in milliseconds
+     * @brief Receive response from meter into receiveBuffer
+     * 
+     * Segmented I-frames are acknowledged with RR at the end of each
+     * window and reassembled so the result reads like one long frame:
+     * header and LLC of the first segment, all information fields, then
+     * placeholder FCS and closing flag.
+     * 
+     * @param timeout Timeout in milliseconds (per frame)
      * @return true if frame received
      */
     bool receiveFrame(uint32_t timeout = COMMAND_TIMEOUT);
     
+    /**
+     * @brief Rewrite a frame with the wire server address
+     * @param frame Frame in 1-byte address layout
+     * @param length Frame length
+     * @param out Output frame buffer (length + 3 bytes)
+     * @return Output frame length
+     */
+    uint16_t addressFrame(const uint8_t* frame, uint16_t length, uint8_t* out) const;
+    
+    /**
+     * @brief Check addresses of a received frame and collapse it to the
+     *        1-byte address layout in place
+     * @param buffer Frame buffer
+     * @param length Frame length (updated)
+     * @return true if the frame is from our meter to us
+     */
+    bool unaddressFrame(uint8_t* buffer, uint16_t& length) const;
+    
+    /**
+     * @brief Receive one physical HDLC frame from our meter
+     * 
+     * Frames addressed to another station (a late reply from a meter
+     * polled before) are dropped while the timeout runs.
+     * 
+     * @param buffer Destination buffer
+     * @param capacity Buffer size
+     * @param length Output frame length
+     * @param timeout Timeout in milliseconds
+     * @return true if frame received
+     */
+    bool receiveHDLCFrame(uint8_t* buffer, uint16_t capacity,
+                          uint16_t& length, uint32_t timeout);
+    
     /**
      * @brief Verify SNRM response (UA frame)
      * @return true if valid
@@ -199,28 +544,35 @@ private:
     bool verifyOBISResponse();
     
     /**
-     * @brief Extract value from OBIS response
-     * @param value Output value
-     * @return true if successful
+     * @brief Verify Get-Response-With-List header
+     * @return true if valid
      */
-    bool extractValue(float& value);
+    bool verifyListResponse();
     
     /**
-     * @brief Extract string from OBIS response
-     * @param value Output string
-     * @return true if successful
+     * @brief Data-access-result of the last response
+     * @return Result code (4 = object-undefined), 0 if the response carries data
      */
-    bool extractString(String& value);
+    uint8_t accessError() const;
     
     /**
-     * @brief Extract datetime from OBIS response
-     * @param timestamp Output timestamp
-     * @return true if successful
+     * @brief Data of the last Get-Response-Normal
+     * @param value Output view into receiveBuffer
+     * @return true if the response carries data (not an access error)
+     */
+    bool responseData(AXDRValue& value) const;
+    
+    /**
+     * @brief Decode scaler_unit ::= structure { scaler: integer, unit: enum }
+     * @param value Decoded item
+     * @param scaler Output scaler (power of ten)
+     * @param unit Output unit enum
+     * @return true if item is a scaler_unit
      */
-    bool extractDateTime(String& timestamp);
+    static bool decodeScaler(const AXDRValue& value, int8_t& scaler, uint8_t& unit);
     
     /**
-     * @brief Increment HDLC frame counter
+     * @brief Advance HDLC send sequence after an I-frame exchange
      */
     void incrementFrameCounter();
     
@@ -0,0 +1,217 @@
+/**
+ * @file FrameTemplates.h
+ * @brief HDLC frames with constant content, assembled at compile time
+ * @version 2.0
+ * @date 2025-10-02
+ *
+ * A frame layout is a type with SIZE and a constexpr at(i) returning
+ * byte i. Literal, Concat and the AARQ/SNRM layouts describe information
+ * fields; HDLCFrame wraps one in flags, format, addresses, control, HCS
+ * and FCS, the check sequences coming from CRCCalculator::updateConst.
+ * Bytes<Frame>::data is then the finished frame in flash, so sending it
+ * costs no assembly and no CRC at run time.
+ *
+ * Frames use the 1-byte DLMS_SERVER_SAP layout like every frame the
+ * protocol builds; sendFrame swaps in a longer bus address on the wire.
+ */
+
+#ifndef FRAME_TEMPLATES_H
+#define FRAME_TEMPLATES_H
+
+#include <Arduino.h>
+#include <type_traits>
+#include "../config/config.h"
+#include "../utils/CRCCalculator.h"
+
+namespace FrameTemplates {
+
+// ============================================
+// LAYOUTS
+// ============================================
+
+/**
+ * @struct Literal
+ * @brief Fixed byte sequence
+ */
+template <uint8_t... B>
+struct Literal;
+
+template <>
+struct Literal<> {
+    static constexpr uint16_t SIZE = 0;
+    static constexpr uint8_t at(uint16_t) { return 0; }
+};
+
+template <uint8_t B, uint8_t... Rest>
+struct Literal<B, Rest...> {
+    static constexpr uint16_t SIZE = 1 + sizeof...(Rest);
+    static constexpr uint8_t at(uint16_t i) {
+        return i == 0 ? B : Literal<Rest...>::at(i - 1);
+    }
+};
+
+/**
+ * @struct Concat
+ * @brief Layouts one after the other
+ */
+template <class... Parts>
+struct Concat;
+
+template <class Part>
+struct Concat<Part> : Part {};
+
+template <class First, class... Rest>
+struct Concat<First, Rest...> {
+    static constexpr uint16_t SIZE = First::SIZE + Concat<Rest...>::SIZE;
+    static constexpr uint8_t at(uint16_t i) {
+        return i < First::SIZE ? First::at(i) : Concat<Rest...>::at(i - First::SIZE);
+    }
+};
+
+/**
+ * @struct ConfigPassword
+ * @brief DLMS_PASSWORD without its terminator
+ */
+struct ConfigPassword {
+    static constexpr uint16_t SIZE = sizeof(DLMS_PASSWORD) - 1;
+    static constexpr uint8_t at(uint16_t i) { return DLMS_PASSWORD[i]; }
+};
+
+/**
+ * @typedef SNRMParameters
+ * @brief HDLC parameter negotiation field proposing the HDLC_* limits
+ */
+typedef Literal<
+    0x81, 0x80, 0x14,                               // Format, group, group length
+    0x05, 0x02, (HDLC_MAX_INFO_TX >> 8) & 0xFF, HDLC_MAX_INFO_TX & 0xFF,
+    0x06, 0x02, (HDLC_MAX_INFO_RX >> 8) & 0xFF, HDLC_MAX_INFO_RX & 0xFF,
+    0x07, 0x04, 0x00, 0x00, 0x00, HDLC_WINDOW_TX,
+    0x08, 0x04, 0x00, 0x00, 0x00, HDLC_WINDOW_RX
+> SNRMParameters;
+
+/**
+ * @struct AARQInfo
+ * @brief LLC and AARQ APDU: LN referencing, no ciphering
+ *
+ * A password of at least one byte gives low level security, an empty
+ * one the lowest level (no authentication fields at all).
+ *
+ * @tparam Password Layout of the LLS secret
+ * @tparam Conformance Proposed conformance block (24 bits)
+ * @tparam MaxPDU Client max receive PDU size
+ */
+template <class Password, uint32_t Conformance, uint16_t MaxPDU>
+struct AARQInfo {
+    typedef Literal<0xA1, 0x09, 0x06, 0x07,         // application-context-name
+                    0x60, 0x85, 0x74, 0x05, 0x08, 0x01, 0x01> ContextName;
+
+    typedef Concat<
+        Literal<0x8A, 0x02, 0x07, 0x80,             // sender-acse-requirements: authentication
+                0x8B, 0x07,                         // mechanism-name: low level security
+                0x60, 0x85, 0x74, 0x05, 0x08, 0x02, 0x01,
+                0xAC, Password::SIZE + 2,           // calling-authentication-value
+                0x80, Password::SIZE>,
+        Password
+    > LowLevelSecurity;
+
+    typedef typename std::conditional<(Password::SIZE > 0),
+                                      LowLevelSecurity, Literal<> >::type Authentication;
+
+    typedef Literal<0xBE, 0x10, 0x04, 0x0E,         // user-information: InitiateRequest
+                    0x01, 0x00, 0x00, 0x00, 0x06,   // No key, QoS; DLMS version 6
+                    0x5F, 0x1F, 0x04, 0x00,         // Conformance block
+                    (Conformance >> 16) & 0xFF, (Conformance >> 8) & 0xFF, Conformance & 0xFF,
+                    (MaxPDU >> 8) & 0xFF, MaxPDU & 0xFF> UserInformation;
+
+    typedef Concat<ContextName, Authentication, UserInformation> Body;
+    static_assert(Body::SIZE < 0x80, "AARQ needs a long-form length");
+
+    typedef Concat<Literal<0xE6, 0xE6, 0x00, 0x60, Body::SIZE>, Body> Layout;
+
+    static constexpr uint16_t SIZE = Layout::SIZE;
+    static constexpr uint8_t at(uint16_t i) { return Layout::at(i); }
+};
+
+// ============================================
+// FRAMES
+// ============================================
+
+/**
+ * @struct HDLCFrame
+ * @brief Complete HDLC frame around an information field layout
+ *
+ * Without information field (SIZE 0) the frame ends with the FCS right
+ * after the control byte, as for DISC, RR and SNRM without proposal.
+ */
+template <uint8_t Control, class Info = Literal<>,
+          uint8_t Server = DLMS_SERVER_SAP, uint8_t Client = DLMS_CLIENT_SAP>
+struct HDLCFrame {
+    static constexpr uint16_t SIZE = Info::SIZE ? Info::SIZE + 11 : 9;
+    static_assert(SIZE - 2 <= 0x7FF, "HDLC frame length field overflow");
+
+    static constexpr uint8_t at(uint16_t i) {
+        return i == 0 || i == SIZE - 1 ? 0x7E :
+               i == 1 ? 0xA0 | (((SIZE - 2) >> 8) & 0x07) :
+               i == 2 ? (SIZE - 2) & 0xFF :
+               i == 3 ? Server :
+               i == 4 ? Client :
+               i == 5 ? Control :
+               i == SIZE - 3 ? checksum(SIZE - 3) & 0xFF :        // FCS
+               i == SIZE - 2 ? checksum(SIZE - 3) >> 8 :
+               i == 6 ? checksum(6) & 0xFF :                      // HCS
+               i == 7 ? checksum(6) >> 8 :
+               Info::at(i - 8);
+    }
+
+    /**
+     * @brief CRC over bytes 1 up to end (exclusive), final XOR applied
+     */
+    static constexpr uint16_t checksum(uint16_t end) {
+        return ~run(CRCCalculator::INITIAL_VALUE, 1, end) & 0xFFFF;
+    }
+
+private:
+    static constexpr uint16_t run(uint16_t crc, uint16_t i, uint16_t end) {
+        return i == end ? crc : run(CRCCalculator::updateConst(crc, at(i)), i + 1, end);
+    }
+};
+
+/**
+ * @brief RR acknowledging up to N(R), poll bit set
+ */
+template <uint8_t NR>
+using ReceiveReady = HDLCFrame<(NR << 5) | 0x11>;
+
+// ============================================
+// STORAGE
+// ============================================
+
+template <uint16_t... I>
+struct Indices {};
+
+template <uint16_t N, uint16_t... I>
+struct MakeIndices : MakeIndices<N - 1, N - 1, I...> {};
+
+template <uint16_t... I>
+struct MakeIndices<0, I...> {
+    typedef Indices<I...> Type;
+};
+
+/**
+ * @struct Bytes
+ * @brief The frame's bytes as a constant array
+ */
+template <class Frame, class Sequence = typename MakeIndices<Frame::SIZE>::Type>
+struct Bytes;
+
+template <class Frame, uint16_t... I>
+struct Bytes<Frame, Indices<I...> > {
+    static constexpr uint8_t data[sizeof...(I)] = { Frame::at(I)... };
+};
+
+template <class Frame, uint16_t... I>
+constexpr uint8_t Bytes<Frame, Indices<I...> >::data[sizeof...(I)];
+
+} // namespace FrameTemplates
+
+#endif // FRAME_TEMPLATES_H
@@ -0,0 +1,457 @@
+/**
+ * @file LinkMetrics.cpp
+ * @brief Implementation of link counters and latency histograms
+ * @version 2.0
+ * @date 2025-10-02
+ */
+
+#include "LinkMetrics.h"
+#include <stdarg.h>
+
+static_assert(METRICS_REGISTER_SLOTS <= 255, "registerCount is 8-bit");
+
+// ============================================
+// EXCHANGE KINDS AND PHASES
+// ============================================
+
+static const char* const EXCHANGE_NAMES[Exchange::COUNT] = {
+    "snrm", "aarq", "get", "get_list", "get_next", "rr", "disc", "other"
+};
+
+static const char* const PHASE_NAMES[LinkPhase::COUNT] = {
+    "associate", "read", "profile", "release"
+};
+
+const char* Exchange::name(uint8_t kind) {
+    return kind < COUNT ? EXCHANGE_NAMES[kind] : "";
+}
+
+uint8_t Exchange::classify(const uint8_t* frame, uint16_t length) {
+    if (length < 9) return OTHER;
+
+    // Control field without the poll/final bit
+    uint8_t control = frame[5] & ~0x10;
+    if (control == 0x83) return SNRM;
+    if (control == 0x43) return DISC;
+    if ((control & 0x0F) == 0x01) return RR;
+
+    // I-frame: LLC at 8, APDU at 11
+    if ((control & 0x01) == 0 && length > 14 && frame[8] == 0xE6) {
+        if (frame[11] == 0x60) return AARQ;
+        if (frame[11] == 0xC0) {
+            switch (frame[12]) {
+                case 0x01: return GET;
+                case 0x02: return GET_NEXT;
+                case 0x03: return GET_LIST;
+            }
+        }
+    }
+    return OTHER;
+}
+
+const char* LinkPhase::name(uint8_t phase) {
+    return phase < COUNT ? PHASE_NAMES[phase] : "";
+}
+
+// ============================================
+// HISTOGRAM
+// ============================================
+
+static const uint16_t BIN_BOUNDS[LatencyHistogram::BINS] = {
+    5, 10, 20, 50, 100, 200, 500, 1000, 2000, 0
+};
+
+void LatencyHistogram::clear() {
+    memset(bins, 0, sizeof(bins));
+    count = 0;
+    totalMs = 0;
+    maxMs = 0;
+}
+
+void LatencyHistogram::add(uint32_t ms) {
+    uint8_t bin = 0;
+    while (bin < BINS - 1 && ms > BIN_BOUNDS[bin]) bin++;
+    bins[bin]++;
+
+    count++;
+    totalMs += ms;
+    if (ms > maxMs) maxMs = ms > 0xFFFF ? 0xFFFF : ms;
+}
+
+uint16_t LatencyHistogram::bound(uint8_t bin) {
+    return bin < BINS ? BIN_BOUNDS[bin] : 0;
+}
+
+uint16_t LatencyHistogram::percentile(float fraction) const {
+    uint32_t total = 0;
+    for (uint8_t i = 0; i < BINS; i++) total += bins[i];
+    if (total == 0) return 0;
+
+    float rank = fraction * total;
+    uint32_t below = 0;
+    for (uint8_t i = 0; i < BINS - 1; i++) {
+        below += bins[i];
+        if (below >= rank) return BIN_BOUNDS[i] < maxMs ? BIN_BOUNDS[i] : maxMs;
+    }
+    return maxMs;
+}
+
+// ============================================
+// COUNTERS
+// ============================================
+
+LinkMetrics::LinkMetrics() {
+    clear();
+}
+
+void LinkMetrics::clear() {
+    framesTx = framesRx = 0;
+    bytesTx = bytesRx = 0;
+    retries = crcErrors = timeouts = frameErrors = untracked = 0;
+
+    for (uint8_t i = 0; i < Exchange::COUNT; i++) exchanges[i].clear();
+    memset(phases, 0, sizeof(phases));
+    memset(registers, 0, sizeof(registers));
+    registerCount = 0;
+
+    pending = false;
+    pendingKind = Exchange::OTHER;
+    pendingRegister = -1;
+    pendingSince = 0;
+}
+
+int16_t LinkMetrics::registerSlot(const uint8_t* obis, uint8_t attribute) {
+    for (uint8_t i = 0; i < registerCount; i++) {
+        if (registers[i].attribute == attribute && memcmp(registers[i].obis, obis, 6) == 0) {
+            return i;
+        }
+    }
+
+    if (registerCount >= METRICS_REGISTER_SLOTS) {
+        untracked++;
+        return -1;
+    }
+
+    RegisterStats& entry = registers[registerCount];
+    memcpy(entry.obis, obis, 6);
+    entry.attribute = attribute;
+    return registerCount++;
+}
+
+void LinkMetrics::onSend(const uint8_t* frame, uint16_t length, uint16_t wireLength) {
+    framesTx++;
+    bytesTx += wireLength;
+
+    pending = true;
+    pendingKind = Exchange::classify(frame, length);
+    pendingSince = millis();
+
+    // Get-Request-Normal: class id at 14, OBIS at 16, attribute at 22
+    pendingRegister = -1;
+    if (pendingKind == Exchange::GET && length >= 23) {
+        pendingRegister = registerSlot(&frame[16], frame[22]);
+    }
+}
+
+void LinkMetrics::onFrame(uint16_t length) {
+    framesRx++;
+    bytesRx += length;
+
+    // Later frames of a window belong to the same round trip
+    if (!pending) return;
+    pending = false;
+
+    uint32_t ms = millis() - pendingSince;
+    exchanges[pendingKind].add(ms);
+
+    if (pendingRegister >= 0) {
+        RegisterStats& entry = registers[pendingRegister];
+        entry.count++;
+        entry.totalMs += ms;
+        if (ms > entry.maxMs) entry.maxMs = ms > 0xFFFF ? 0xFFFF : ms;
+    }
+}
+
+void LinkMetrics::onError(HDLCFrameReader::Result result) {
+    switch (result) {
+        case HDLCFrameReader::Result::BAD_HCS:
+        case HDLCFrameReader::Result::BAD_FCS:
+            crcErrors++;
+            break;
+        case HDLCFrameReader::Result::TIMEOUT:
+        case HDLCFrameReader::Result::TRUNCATED:
+            timeouts++;
+            break;
+        default:
+            frameErrors++;
+            break;
+    }
+
+    if (pending && pendingRegister >= 0) {
+        registers[pendingRegister].failures++;
+    }
+    pending = false;
+}
+
+void LinkMetrics::phaseDone(uint8_t phase, uint32_t ms, bool success) {
+    if (phase >= LinkPhase::COUNT) return;
+
+    PhaseStats& stats = phases[phase];
+    stats.count++;
+    if (!success) stats.failures++;
+    stats.totalMs += ms;
+    stats.lastMs = ms;
+    if (ms > stats.maxMs) stats.maxMs = ms;
+}
+
+// ============================================
+// EXPORT
+// ============================================
+
+/**
+ * @brief Dotted OBIS text ("1.0.1.8.0.255")
+ */
+static void formatObis(const uint8_t* obis, char* text, size_t size) {
+    snprintf(text, size, "%u.%u.%u.%u.%u.%u",
+             obis[0], obis[1], obis[2], obis[3], obis[4], obis[5]);
+}
+
+void LinkMetrics::toJson(JsonObject out) const {
+    out["tx_frames"] = framesTx;
+    out["rx_frames"] = framesRx;
+    out["tx_bytes"] = bytesTx;
+    out["rx_bytes"] = bytesRx;
+    out["retries"] = retries;
+    out["crc_errors"] = crcErrors;
+    out["timeouts"] = timeouts;
+    out["frame_errors"] = frameErrors;
+
+    JsonObject phaseTimes = out.createNestedObject("phase_ms");
+    for (uint8_t i = 0; i < LinkPhase::COUNT; i++) {
+        const PhaseStats& stats = phases[i];
+        if (stats.count == 0) continue;
+        JsonObject entry = phaseTimes.createNestedObject(PHASE_NAMES[i]);
+        entry["n"] = stats.count;
+        entry["fail"] = stats.failures;
+        entry["avg"] = stats.totalMs / stats.count;
+        entry["max"] = stats.maxMs;
+        entry["last"] = stats.lastMs;
+    }
+
+    JsonObject roundTrips = out.createNestedObject("rtt_ms");
+    for (uint8_t i = 0; i < Exchange::COUNT; i++) {
+        const LatencyHistogram& h = exchanges[i];
+        if (h.count == 0) continue;
+        JsonObject entry = roundTrips.createNestedObject(EXCHANGE_NAMES[i]);
+        entry["n"] = h.count;
+        entry["avg"] = h.totalMs / h.count;
+        entry["p95"] = h.percentile(0.95f);
+        entry["max"] = h.maxMs;
+    }
+
+    // Slowest registers by mean round trip
+    bool taken[METRICS_REGISTER_SLOTS] = {};
+    JsonArray slowest = out.createNestedArray("slow");
+    for (uint8_t n = 0; n < METRICS_TOP_REGISTERS; n++) {
+        int16_t best = -1;
+        uint32_t bestMean = 0;
+        for (uint8_t i = 0; i < registerCount; i++) {
+            if (taken[i] || registers[i].count == 0) continue;
+            uint32_t mean = registers[i].totalMs / registers[i].count;
+            if (best < 0 || mean > bestMean) {
+                best = i;
+                bestMean = mean;
+            }
+        }
+        if (best < 0) break;
+        taken[best] = true;
+
+        const RegisterStats& r = registers[best];
+        char obis[24];
+        formatObis(r.obis, obis, sizeof(obis));
+        JsonObject entry = slowest.createNestedObject();
+        entry["obis"] = obis;
+        entry["attr"] = r.attribute;
+        entry["n"] = r.count;
+        entry["avg"] = bestMean;
+        entry["max"] = r.maxMs;
+        entry["fail"] = r.failures;
+    }
+}
+
+/**
+ * @class PrometheusWriter
+ * @brief Line builder that hands text to the sink in ~1 KB chunks
+ *
+ * Lines are formatted straight into a fixed buffer, which is flushed
+ * whenever it has less than one line of room left.
+ */
+class PrometheusWriter {
+public:
+    explicit PrometheusWriter(MetricsTextSink& s) : sink(s), used(0) {}
+    ~PrometheusWriter() { flush(); }
+
+    void family(const char* name, const char* type, const char* help) {
+        line("# HELP %s %s\n# TYPE %s %s\n", name, help, name, type);
+    }
+
+    void line(const char* format, ...) __attribute__((format(printf, 2, 3))) {
+        if (sizeof(text) - used < LINE_MAX) flush();
+
+        va_list args;
+        va_start(args, format);
+        int n = vsnprintf(text + used, LINE_MAX, format, args);
+        va_end(args);
+
+        if (n > 0) used += (size_t)n < LINE_MAX ? (size_t)n : LINE_MAX - 1;
+    }
+
+    void flush() {
+        if (used == 0) return;
+        sink.write(text, used);
+        used = 0;
+    }
+
+private:
+    static const size_t LINE_MAX = 192;
+
+    MetricsTextSink& sink;
+    char text[1024 + LINE_MAX];
+    size_t used;
+};
+
+/**
+ * @brief Milliseconds as seconds text, no float formatting involved
+ */
+static const char* seconds(uint32_t ms, char* text, size_t size) {
+    snprintf(text, size, "%lu.%03lu", (unsigned long)(ms / 1000), (unsigned long)(ms % 1000));
+    return text;
+}
+
+void LinkMetrics::toPrometheus(MetricsTextSink& sink, const LinkMetrics* links,
+                               const char* const* meters, uint8_t count) {
+    PrometheusWriter out(sink);
+    char s[16];
+
+    out.family("dlms_frames_total", "counter", "HDLC frames by direction");
+    for (uint8_t m = 0; m < count; m++) {
+        out.line("dlms_frames_total{meter=\"%s\",direction=\"tx\"} %lu\n",
+                 meters[m], (unsigned long)links[m].framesTx);
+        out.line("dlms_frames_total{meter=\"%s\",direction=\"rx\"} %lu\n",
+                 meters[m], (unsigned long)links[m].framesRx);
+    }
+
+    out.family("dlms_bytes_total", "counter", "Bytes on the meter link by direction");
+    for (uint8_t m = 0; m < count; m++) {
+        out.line("dlms_bytes_total{meter=\"%s\",direction=\"tx\"} %lu\n",
+                 meters[m], (unsigned long)links[m].bytesTx);
+        out.line("dlms_bytes_total{meter=\"%s\",direction=\"rx\"} %lu\n",
+                 meters[m], (unsigned long)links[m].bytesRx);
+    }
+
+    out.family("dlms_link_errors_total", "counter", "Retries and receive failures by type");
+    for (uint8_t m = 0; m < count; m++) {
+        const LinkMetrics& l = links[m];
+        out.line("dlms_link_errors_total{meter=\"%s\",type=\"retry\"} %lu\n",
+                 meters[m], (unsigned long)l.retries);
+        out.line("dlms_link_errors_total{meter=\"%s\",type=\"crc\"} %lu\n",
+                 meters[m], (unsigned long)l.crcErrors);
+        out.line("dlms_link_errors_total{meter=\"%s\",type=\"timeout\"} %lu\n",
+                 meters[m], (unsigned long)l.timeouts);
+        out.line("dlms_link_errors_total{meter=\"%s\",type=\"frame\"} %lu\n",
+                 meters[m], (unsigned long)l.frameErrors);
+    }
+
+    out.family("dlms_exchange_seconds", "histogram", "Request to first reply frame");
+    for (uint8_t m = 0; m < count; m++) {
+        for (uint8_t k = 0; k < Exchange::COUNT; k++) {
+            const LatencyHistogram& h = links[m].exchanges[k];
+            if (h.count == 0) continue;
+
+            uint32_t cumulative = 0;
+            for (uint8_t b = 0; b < LatencyHistogram::BINS - 1; b++) {
+                cumulative += h.bins[b];
+                out.line("dlms_exchange_seconds_bucket{meter=\"%s\",kind=\"%s\",le=\"%s\"} %lu\n",
+                         meters[m], EXCHANGE_NAMES[k], seconds(BIN_BOUNDS[b], s, sizeof(s)),
+                         (unsigned long)cumulative);
+            }
+            out.line("dlms_exchange_seconds_bucket{meter=\"%s\",kind=\"%s\",le=\"+Inf\"} %lu\n",
+                     meters[m], EXCHANGE_NAMES[k], (unsigned long)h.count);
+            out.line("dlms_exchange_seconds_sum{meter=\"%s\",kind=\"%s\"} %s\n",
+                     meters[m], EXCHANGE_NAMES[k], seconds(h.totalMs, s, sizeof(s)));
+            out.line("dlms_exchange_seconds_count{meter=\"%s\",kind=\"%s\"} %lu\n",
+                     meters[m], EXCHANGE_NAMES[k], (unsigned long)h.count);
+        }
+    }
+
+    out.family("dlms_phase_seconds_total", "counter", "Time spent per poll phase");
+    for (uint8_t m = 0; m < count; m++) {
+        for (uint8_t p = 0; p < LinkPhase::COUNT; p++) {
+            out.line("dlms_phase_seconds_total{meter=\"%s\",phase=\"%s\"} %s\n",
+                     meters[m], PHASE_NAMES[p], seconds(links[m].phases[p].totalMs, s, sizeof(s)));
+        }
+    }
+
+    out.family("dlms_phase_runs_total", "counter", "Phase runs by outcome");
+    for (uint8_t m = 0; m < count; m++) {
+        for (uint8_t p = 0; p < LinkPhase::COUNT; p++) {
+            const PhaseStats& stats = links[m].phases[p];
+            out.line("dlms_phase_runs_total{meter=\"%s\",phase=\"%s\",result=\"ok\"} %lu\n",
+                     meters[m], PHASE_NAMES[p], (unsigned long)(stats.count - stats.failures));
+            out.line("dlms_phase_runs_total{meter=\"%s\",phase=\"%s\",result=\"failed\"} %lu\n",
+                     meters[m], PHASE_NAMES[p], (unsigned long)stats.failures);
+        }
+    }
+
+    out.family("dlms_phase_last_seconds", "gauge", "Duration of the latest run of each phase");
+    for (uint8_t m = 0; m < count; m++) {
+        for (uint8_t p = 0; p < LinkPhase::COUNT; p++) {
+            out.line("dlms_phase_last_seconds{meter=\"%s\",phase=\"%s\"} %s\n",
+                     meters[m], PHASE_NAMES[p], seconds(links[m].phases[p].lastMs, s, sizeof(s)));
+        }
+    }
+
+    out.family("dlms_register_requests_total", "counter", "Answered GETs per OBIS code and attribute");
+    for (uint8_t m = 0; m < count; m++) {
+        for (uint8_t i = 0; i < links[m].registerCount; i++) {
+            const RegisterStats& r = links[m].registers[i];
+            char obis[24];
+            formatObis(r.obis, obis, sizeof(obis));
+            out.line("dlms_register_requests_total{meter=\"%s\",obis=\"%s\",attribute=\"%u\"} %lu\n",
+                     meters[m], obis, r.attribute, (unsigned long)r.count);
+        }
+    }
+
+    out.family("dlms_register_failures_total", "counter", "Unanswered GETs per OBIS code and attribute");
+    for (uint8_t m = 0; m < count; m++) {
+        for (uint8_t i = 0; i < links[m].registerCount; i++) {
+            const RegisterStats& r = links[m].registers[i];
+            char obis[24];
+            formatObis(r.obis, obis, sizeof(obis));
+            out.line("dlms_register_failures_total{meter=\"%s\",obis=\"%s\",attribute=\"%u\"} %lu\n",
+                     meters[m], obis, r.attribute, (unsigned long)r.failures);
+        }
+    }
+
+    out.family("dlms_register_seconds_total", "counter", "Round-trip time per OBIS code and attribute");
+    for (uint8_t m = 0; m < count; m++) {
+        for (uint8_t i = 0; i < links[m].registerCount; i++) {
+            const RegisterStats& r = links[m].registers[i];
+            char obis[24];
+            formatObis(r.obis, obis, sizeof(obis));
+            out.line("dlms_register_seconds_total{meter=\"%s\",obis=\"%s\",attribute=\"%u\"} %s\n",
+                     meters[m], obis, r.attribute, seconds(r.totalMs, s, sizeof(s)));
+        }
+    }
+
+    out.family("dlms_register_max_seconds", "gauge", "Slowest round trip per OBIS code and attribute");
+    for (uint8_t m = 0; m < count; m++) {
+        for (uint8_t i = 0; i < links[m].registerCount; i++) {
+            const RegisterStats& r = links[m].registers[i];
+            char obis[24];
+            formatObis(r.obis, obis, sizeof(obis));
+            out.line("dlms_register_max_seconds{meter=\"%s\",obis=\"%s\",attribute=\"%u\"} %s\n",
+                     meters[m], obis, r.attribute, seconds(r.maxMs, s, sizeof(s)));
+        }
+    }
+}
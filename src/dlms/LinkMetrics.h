@@ -0,0 +1,214 @@
+/**
+ * @file LinkMetrics.h
+ * @brief Performance counters and latency histograms of one meter link
+ * @version 2.0
+ * @date 2025-10-02
+ *
+ * DLMSProtocol reports every frame it sends and every frame (or failure)
+ * it receives. The exchange kind is taken from the frame itself (SNRM,
+ * AARQ, GET, GET-with-list, GET-next, RR, DISC), so the request/response
+ * round trip lands in that kind's histogram without the callers tagging
+ * anything; GET-Request-Normal also lands in a per OBIS/attribute entry.
+ * Association, register reads, profile reads and release are timed as
+ * phases. Everything is fixed-size, so a copy of the whole object can be
+ * queued to the network task as a snapshot.
+ */
+
+#ifndef LINK_METRICS_H
+#define LINK_METRICS_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include "../config/config.h"
+#include "../utils/HDLCFrameReader.h"
+
+/**
+ * @namespace Exchange
+ * @brief Request kinds, classified from the frame sent
+ */
+namespace Exchange {
+    const uint8_t SNRM = 0;
+    const uint8_t AARQ = 1;
+    const uint8_t GET = 2;          // Get-Request-Normal (also selective access)
+    const uint8_t GET_LIST = 3;     // Get-Request-With-List
+    const uint8_t GET_NEXT = 4;     // Get-Request-Next (data blocks)
+    const uint8_t RR = 5;           // Receive ready: segments, keep-alive
+    const uint8_t DISC = 6;
+    const uint8_t OTHER = 7;
+    const uint8_t COUNT = 8;
+
+    /**
+     * @brief Short name ("snrm", "get_list", ...)
+     */
+    const char* name(uint8_t kind);
+
+    /**
+     * @brief Kind of a frame in the 1-byte address layout
+     */
+    uint8_t classify(const uint8_t* frame, uint16_t length);
+}
+
+/**
+ * @namespace LinkPhase
+ * @brief Timed parts of a poll
+ */
+namespace LinkPhase {
+    const uint8_t ASSOCIATE = 0;    // SNRM + AARQ
+    const uint8_t READ = 1;         // Identification and register reads
+    const uint8_t PROFILE = 2;      // Load profile catch-up
+    const uint8_t RELEASE = 3;      // DISC
+    const uint8_t COUNT = 4;
+
+    const char* name(uint8_t phase);
+}
+
+/**
+ * @struct LatencyHistogram
+ * @brief Round trips in fixed millisecond bins
+ */
+struct LatencyHistogram {
+    static const uint8_t BINS = 10;
+
+    uint32_t bins[BINS];
+    uint32_t count;
+    uint32_t totalMs;
+    uint16_t maxMs;
+
+    void clear();
+    void add(uint32_t ms);
+
+    /**
+     * @brief Upper bound of a bin in ms (0 for the overflow bin)
+     */
+    static uint16_t bound(uint8_t bin);
+
+    /**
+     * @brief Approximate percentile (upper bound of the bin holding it)
+     */
+    uint16_t percentile(float fraction) const;
+};
+
+/**
+ * @struct PhaseStats
+ * @brief Time spent in one phase
+ */
+struct PhaseStats {
+    uint32_t count;
+    uint32_t failures;
+    uint32_t totalMs;
+    uint32_t maxMs;
+    uint32_t lastMs;
+};
+
+/**
+ * @struct RegisterStats
+ * @brief Round trips of GETs on one OBIS code and attribute
+ */
+struct RegisterStats {
+    uint8_t obis[6];
+    uint8_t attribute;
+    uint16_t maxMs;
+    uint32_t count;
+    uint32_t failures;
+    uint32_t totalMs;
+};
+
+/**
+ * @class MetricsTextSink
+ * @brief Receives rendered metrics text
+ */
+class MetricsTextSink {
+public:
+    virtual ~MetricsTextSink() {}
+    virtual void write(const char* text, size_t length) = 0;
+};
+
+/**
+ * @class LinkMetrics
+ * @brief Counters of one DLMSProtocol instance
+ */
+class LinkMetrics {
+public:
+    uint32_t framesTx;
+    uint32_t framesRx;
+    uint32_t bytesTx;
+    uint32_t bytesRx;
+    uint32_t retries;       // Repeated SNRM/DISC, list reads redone as single GETs
+    uint32_t crcErrors;     // HCS or FCS
+    uint32_t timeouts;      // No frame, or cut off by the inter-character timeout
+    uint32_t frameErrors;   // Oversized, out of sequence, malformed reply
+    uint32_t untracked;     // GETs past the register table
+
+    LatencyHistogram exchanges[Exchange::COUNT];
+    PhaseStats phases[LinkPhase::COUNT];
+    RegisterStats registers[METRICS_REGISTER_SLOTS];
+    uint8_t registerCount;
+
+    /**
+     * @brief Constructor
+     */
+    LinkMetrics();
+
+    /**
+     * @brief Zero every counter
+     */
+    void clear();
+
+    /**
+     * @brief A request went out; starts its round trip
+     * @param frame Frame in the 1-byte address layout
+     * @param length Frame length
+     * @param wireLength Bytes actually written
+     */
+    void onSend(const uint8_t* frame, uint16_t length, uint16_t wireLength);
+
+    /**
+     * @brief A valid frame for this station arrived
+     */
+    void onFrame(uint16_t length);
+
+    /**
+     * @brief No valid frame arrived
+     */
+    void onError(HDLCFrameReader::Result result);
+
+    void onRetry() { retries++; }
+    void onFrameError() { frameErrors++; }
+
+    /**
+     * @brief Record a finished phase
+     */
+    void phaseDone(uint8_t phase, uint32_t ms, bool success);
+
+    /**
+     * @brief Compact summary for the metrics message
+     * @param out Object to fill
+     *
+     * Counters, phase times, per-kind count/mean/p95/max and the
+     * METRICS_TOP_REGISTERS registers with the slowest mean round trip.
+     */
+    void toJson(JsonObject out) const;
+
+    /**
+     * @brief Prometheus text exposition of several links
+     * @param sink Receives the text in chunks of about 1 KB
+     * @param links Metrics, one per meter
+     * @param meters "meter" label value of each
+     * @param count Number of links
+     *
+     * Samples are grouped by family across meters, as the format needs.
+     */
+    static void toPrometheus(MetricsTextSink& sink, const LinkMetrics* links,
+                             const char* const* meters, uint8_t count);
+
+private:
+    // Round trip in flight, closed by the first reply
+    bool pending;
+    uint8_t pendingKind;
+    int16_t pendingRegister;        // Index into registers or -1
+    unsigned long pendingSince;
+
+    int16_t registerSlot(const uint8_t* obis, uint8_t attribute);
+};
+
+#endif // LINK_METRICS_H
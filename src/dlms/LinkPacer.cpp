@@ -0,0 +1,172 @@
+/**
+ * @file LinkPacer.cpp
+ * @brief Implementation of adaptive inter-frame pacing
+ * @version 2.0
+ * @date 2025-10-02
+ */
+
+#include "LinkPacer.h"
+#include "../utils/CRCCalculator.h"
+#include "../utils/Logger.h"
+
+#if PREFERENCES_ENABLED
+#include <Preferences.h>
+#endif
+
+LinkPacer::LinkPacer()
+    : gap(PACING_DEFAULT_GAP),
+      floor(PACING_MIN_GAP),
+      turnaround(0),
+      failures(0),
+      streak(0),
+      lastSendTime(0),
+      lastReceiveTime(0),
+      awaitingReply(false),
+      confirmed(true),
+      dirty(false) {
+    serial[0] = '\0';
+}
+
+void LinkPacer::begin(const char* serialNumber) {
+    if (serialNumber[0] == '\0' || strcmp(serial, serialNumber) == 0) {
+        return;
+    }
+    
+    save();
+    
+    strncpy(serial, serialNumber, sizeof(serial) - 1);
+    serial[sizeof(serial) - 1] = '\0';
+    dirty = false;
+    confirmed = true;
+    streak = 0;
+    
+#if PREFERENCES_ENABLED
+    char key[8];
+    makeKey(key);
+    
+    Preferences prefs;
+    if (!prefs.begin(PACING_NAMESPACE, true)) return;
+    
+    Record record;
+    size_t length = prefs.getBytes(key, &record, sizeof(record));
+    prefs.end();
+    
+    if (length == sizeof(record) &&
+        record.version == VERSION &&
+        strncmp(record.serial, serial, sizeof(record.serial)) == 0) {
+        gap = constrain(record.gap, (uint16_t)PACING_MIN_GAP, (uint16_t)PACING_MAX_GAP);
+        floor = constrain(record.floor, (uint16_t)PACING_MIN_GAP, (uint16_t)PACING_MAX_GAP);
+        turnaround = record.turnaround;
+        LOG_INFOF("Link pacing loaded: gap %u ms", gap);
+    }
+#endif
+}
+
+// ============================================
+// PACING
+// ============================================
+
+void LinkPacer::beforeSend() {
+    if (lastReceiveTime == 0) return;
+    
+    uint32_t elapsed = millis() - lastReceiveTime;
+    if (elapsed < gap) {
+        delay(gap - elapsed);
+    }
+}
+
+void LinkPacer::onSent(bool expectReply) {
+    lastSendTime = millis();
+    awaitingReply = expectReply;
+}
+
+void LinkPacer::onResponse() {
+    lastReceiveTime = millis();
+    confirmed = true;
+    if (!awaitingReply) return;
+    awaitingReply = false;
+    
+    uint16_t sample = lastReceiveTime - lastSendTime;
+    turnaround = turnaround == 0 ? sample : (turnaround * 7 + sample) / 8;
+    
+    // Shrink after a run of clean exchanges, never below the last failing gap
+    if (++streak >= PACING_SHRINK_AFTER && gap > floor) {
+        uint16_t step = max(gap / 4, 1);
+        gap = gap - step < floor ? floor : gap - step;
+        streak = 0;
+        dirty = true;
+    } else if (streak >= PACING_FLOOR_DECAY_AFTER && floor > PACING_MIN_GAP) {
+        // Long clean run at the floor: the failure that set it may have
+        // been a one-off, so let the gap probe below it again
+        uint16_t step = max(floor / 4, 1);
+        floor = floor - step < PACING_MIN_GAP ? PACING_MIN_GAP : floor - step;
+        streak = 0;
+        dirty = true;
+    }
+}
+
+void LinkPacer::onFailure() {
+    lastReceiveTime = millis();
+    if (!awaitingReply) return;
+    awaitingReply = false;
+    
+    failures++;
+    streak = 0;
+    confirmed = false;
+    
+    // The gap in use was too short: remember it and back off
+    floor = min(gap + PACING_BACKOFF_STEP, PACING_MAX_GAP);
+    gap = min(max(gap * 2, (int)floor), PACING_MAX_GAP);
+    dirty = true;
+    
+    LOG_WARNF("Link error - inter-frame gap now %u ms", gap);
+}
+
+void LinkPacer::onNoReply() {
+    lastReceiveTime = millis();
+    awaitingReply = false;
+}
+
+// ============================================
+// PERSISTENCE
+// ============================================
+
+/**
+ * @brief Same key scheme as ScalerCache: CRC of the serial number
+ */
+void LinkPacer::makeKey(char* key) const {
+    uint16_t crc = CRCCalculator::calculate((const uint8_t*)serial, strlen(serial));
+    sprintf(key, "m%04X", crc);
+}
+
+bool LinkPacer::save() {
+    if (!dirty || serial[0] == '\0') return true;
+    if (!confirmed) return true;        // Kept dirty until the link answers
+    
+#if PREFERENCES_ENABLED
+    char key[8];
+    makeKey(key);
+    
+    Record record;
+    memset(&record, 0, sizeof(record));
+    record.version = VERSION;
+    record.gap = gap;
+    record.floor = floor;
+    record.turnaround = turnaround;
+    strncpy(record.serial, serial, sizeof(record.serial) - 1);
+    
+    Preferences prefs;
+    if (!prefs.begin(PACING_NAMESPACE, false)) return false;
+    bool ok = prefs.putBytes(key, &record, sizeof(record)) == sizeof(record);
+    prefs.end();
+    
+    if (!ok) {
+        LOG_ERROR("Failed to save link pacing");
+        return false;
+    }
+    LOG_DEBUGF("Link pacing saved: gap %u ms, floor %u ms", gap, floor);
+#endif
+    
+    dirty = false;
+    return true;
+}
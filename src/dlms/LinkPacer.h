@@ -0,0 +1,124 @@
+/**
+ * @file LinkPacer.h
+ * @brief Adaptive inter-frame pacing for the meter link
+ * @version 2.0
+ * @date 2025-10-02
+ * 
+ * Replaces fixed sleeps between exchanges with a gap learned per meter:
+ * the gap shrinks after a run of clean responses and backs off on
+ * timeouts or CRC errors. The gap that last failed becomes a floor the
+ * pacer does not shrink below, until a long clean run lowers it again.
+ * Learned values are persisted to Preferences (NVS) per serial number
+ * when enabled, once the link has answered since the last back-off.
+ */
+
+#ifndef LINK_PACER_H
+#define LINK_PACER_H
+
+#include <Arduino.h>
+#include "../config/config.h"
+
+/**
+ * @class LinkPacer
+ * @brief Measures turnaround and paces frames sent to one meter
+ */
+class LinkPacer {
+public:
+    /**
+     * @brief Constructor
+     */
+    LinkPacer();
+    
+    /**
+     * @brief Select meter, loading its learned pacing
+     * @param serialNumber Meter serial number
+     * 
+     * Does nothing if the pacer already belongs to this meter.
+     */
+    void begin(const char* serialNumber);
+    
+    /**
+     * @brief Wait out the remaining gap since the last response
+     */
+    void beforeSend();
+    
+    /**
+     * @brief Record that a frame was sent
+     * @param expectReply false if a missing reply is not a link failure
+     */
+    void onSent(bool expectReply = true);
+    
+    /**
+     * @brief Record a valid response frame
+     */
+    void onResponse();
+    
+    /**
+     * @brief Record a timeout or corrupt response
+     */
+    void onFailure();
+    
+    /**
+     * @brief Record a missing reply that says nothing about pacing
+     * 
+     * A meter that is unplugged or asleep does not answer at any gap.
+     */
+    void onNoReply();
+    
+    /**
+     * @brief Persist learned values if changed
+     * 
+     * Deferred while no valid response has followed the last back-off,
+     * so a floor raised while the link was down is not kept.
+     * 
+     * @return true if saved or nothing to save
+     */
+    bool save();
+    
+    /**
+     * @brief Get current inter-frame gap (ms)
+     */
+    uint16_t getGap() const { return gap; }
+    
+    /**
+     * @brief Get average response turnaround (ms)
+     */
+    uint16_t getTurnaround() const { return turnaround; }
+    
+    /**
+     * @brief Get link failures since boot
+     */
+    uint16_t getFailures() const { return failures; }
+
+private:
+    /**
+     * @struct Record
+     * @brief Persisted pacing of one meter
+     */
+    struct Record {
+        uint8_t version;
+        uint8_t reserved;
+        uint16_t gap;
+        uint16_t floor;
+        uint16_t turnaround;
+        char serial[24];
+    };
+    
+    static const uint8_t VERSION = 1;
+    
+    uint16_t gap;
+    uint16_t floor;             // Smallest gap not known to fail
+    uint16_t turnaround;
+    uint16_t failures;
+    uint8_t streak;             // Clean responses since last change
+    uint32_t lastSendTime;
+    uint32_t lastReceiveTime;
+    bool awaitingReply;
+    bool confirmed;             // Valid response since the last back-off
+    bool dirty;
+    char serial[24];
+    
+    void makeKey(char* key) const;
+};
+
+#endif // LINK_PACER_H
@@ -0,0 +1,128 @@
+/**
+ * @file MeterBus.cpp
+ * @brief Implementation of RS-485 bus scheduler
+ * @version 2.0
+ * @date 2025-10-02
+ */
+
+#include "MeterBus.h"
+#include "../utils/Logger.h"
+
+#if METER_BUS_SIZE > 0
+
+MeterBus::MeterBus() : next(0) {
+}
+
+void MeterBus::begin() {
+    for (uint8_t i = 0; i < METER_BUS_SIZE; i++) {
+        BusMeter& m = meters[i];
+        m.protocol.setAddress(METER_BUS_FIRST_ADDRESS + i);
+        m.protocol.begin();
+        m.reads = 0;
+        m.errors = 0;
+        m.failures = 0;
+        m.skip = 0;
+    }
+    next = 0;
+
+    LOG_INFOF("Meter bus: %u meters from address %u", METER_BUS_SIZE, METER_BUS_FIRST_ADDRESS);
+}
+
+void MeterBus::setReadPlan(const ReadPlan* plan) {
+    for (uint8_t i = 0; i < METER_BUS_SIZE; i++) {
+        meters[i].protocol.setReadPlan(plan);
+    }
+}
+
+void MeterBus::setTransport(MeterTransport* transport) {
+    for (uint8_t i = 0; i < METER_BUS_SIZE; i++) {
+        meters[i].protocol.setTransport(transport);
+    }
+}
+
+void MeterBus::resetSchedules() {
+    for (uint8_t i = 0; i < METER_BUS_SIZE; i++) {
+        meters[i].schedule.reset();
+    }
+}
+
+void MeterBus::save(Saved& out, unsigned long wake) const {
+    for (uint8_t i = 0; i < METER_BUS_SIZE; i++) {
+        const BusMeter& m = meters[i];
+        Saved::Meter& saved = out.meters[i];
+        m.schedule.save(saved.schedule, wake);
+        memcpy(saved.data, &m.data, sizeof(saved.data));
+        saved.reads = m.reads;
+        saved.errors = m.errors;
+        saved.failures = m.failures;
+        saved.skip = m.skip;
+    }
+    out.next = next;
+}
+
+void MeterBus::restore(const Saved& in, unsigned long now) {
+    for (uint8_t i = 0; i < METER_BUS_SIZE; i++) {
+        BusMeter& m = meters[i];
+        const Saved::Meter& saved = in.meters[i];
+        m.schedule.restore(saved.schedule, now);
+        memcpy(&m.data, saved.data, sizeof(saved.data));
+        m.reads = saved.reads;
+        m.errors = saved.errors;
+        m.failures = saved.failures;
+        m.skip = saved.skip;
+    }
+    next = in.next % METER_BUS_SIZE;
+}
+
+bool MeterBus::poll(BusMeter*& meter) {
+    meter = nullptr;
+
+    // At most one full round; meters backing off use up one skip each
+    for (uint8_t n = 0; n < METER_BUS_SIZE; n++) {
+        BusMeter& m = meters[next];
+        next = (next + 1) % METER_BUS_SIZE;
+
+        if (m.skip > 0) {
+            m.skip--;
+            continue;
+        }
+
+        meter = &m;
+        return read(m);
+    }
+    return false;
+}
+
+bool MeterBus::pollMeter(uint8_t index) {
+    BusMeter& m = meters[index];
+    m.schedule.reset();
+    return read(m);
+}
+
+bool MeterBus::read(BusMeter& m) {
+    uint16_t address = m.protocol.getPhysicalAddress();
+    LOG_INFOF("Polling meter at address %u", address);
+
+    unsigned long start = millis();
+    uint8_t tiers = m.schedule.due(start);
+
+    bool success = m.protocol.connect() && m.protocol.readMeterData(m.data, tiers);
+    m.protocol.disconnect();
+
+    if (success) {
+        m.schedule.complete(tiers, start);
+        m.reads++;
+        m.failures = 0;
+        return true;
+    }
+
+    m.errors++;
+    if (m.failures < 8) m.failures++;
+    m.skip = min(1 << (m.failures - 1), METER_BUS_BACKOFF_MAX);
+
+    LOG_WARNF("Meter at address %u failed %ux - skipping %u rounds",
+              address, m.failures, m.skip);
+    return false;
+}
+
+#endif // METER_BUS_SIZE > 0
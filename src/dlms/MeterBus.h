@@ -0,0 +1,134 @@
+/**
+ * @file MeterBus.h
+ * @brief Round-robin scheduler for meters sharing one RS-485 segment
+ * @version 2.0
+ * @date 2025-10-02
+ */
+
+#ifndef METER_BUS_H
+#define METER_BUS_H
+
+#include <Arduino.h>
+#include "../config/config.h"
+#include "../data/MeterData.h"
+#include "DLMSProtocol.h"
+#include "PollSchedule.h"
+
+/**
+ * @struct BusMeter
+ * @brief One meter on the bus with its own link state, data and counters
+ */
+struct BusMeter {
+    DLMSProtocol protocol;
+    MeterData data;
+    PollSchedule schedule;  // Tiers due at this meter
+    uint16_t reads;         // Successful polls
+    uint16_t errors;        // Failed polls
+    uint8_t failures;       // Consecutive failed polls
+    uint8_t skip;           // Rounds left before the next attempt
+};
+
+/**
+ * @class MeterBus
+ * @brief Polls METER_BUS_SIZE meters at consecutive HDLC physical addresses
+ *
+ * Each poll() reads the next meter in turn with a full connect, read and
+ * disconnect, so only one meter holds the bus at a time. A meter that
+ * fails is skipped for 1, 2, 4 ... METER_BUS_BACKOFF_MAX rounds, keeping
+ * a dead meter from costing a full timeout every round.
+ */
+class MeterBus {
+public:
+    /**
+     * @struct Saved
+     * @brief Round-robin position and per-meter state, for RTC memory
+     */
+    struct Saved {
+        struct Meter {
+            PollSchedule::Saved schedule;
+            uint8_t data[sizeof(MeterData)];    // MeterData is plain data
+            uint16_t reads;
+            uint16_t errors;
+            uint8_t failures;
+            uint8_t skip;
+        } meters[METER_BUS_SIZE > 0 ? METER_BUS_SIZE : 1];
+        uint8_t next;
+    };
+
+    /**
+     * @brief Constructor
+     */
+    MeterBus();
+
+    /**
+     * @brief Assign addresses and initialize every meter
+     */
+    void begin();
+
+    /**
+     * @brief Read every meter with the same site plan
+     */
+    void setReadPlan(const ReadPlan* plan);
+
+    /**
+     * @brief Reach every meter through the same link (default UART2)
+     */
+    void setTransport(MeterTransport* transport);
+
+    /**
+     * @brief Make every tier due at every meter
+     */
+    void resetSchedules();
+
+    /**
+     * @brief Keep schedules, readings and backoff through a deep sleep
+     * @param wake millis() the sleep ends at
+     */
+    void save(Saved& out, unsigned long wake) const;
+
+    /**
+     * @brief Take them back after the wake (after begin())
+     * @param now Current millis()
+     */
+    void restore(const Saved& in, unsigned long now);
+
+    /**
+     * @brief Read the next meter that is due
+     * @param meter Output: meter that was polled (nullptr if all backing off)
+     * @return true if the meter was read successfully
+     */
+    bool poll(BusMeter*& meter);
+
+    /**
+     * @brief Read one meter now, every tier, backoff or not
+     * @param index Bus position
+     * @return true if the meter was read successfully
+     */
+    bool pollMeter(uint8_t index);
+
+    /**
+     * @brief Number of meters on the bus
+     */
+    uint8_t size() const { return METER_BUS_SIZE; }
+
+    /**
+     * @brief Get meter by bus position
+     */
+    BusMeter& meter(uint8_t index) { return meters[index]; }
+    const BusMeter& meter(uint8_t index) const { return meters[index]; }
+
+private:
+    static const uint8_t CAPACITY = METER_BUS_SIZE > 0 ? METER_BUS_SIZE : 1;
+
+    BusMeter meters[CAPACITY];
+    uint8_t next;
+
+    /**
+     * @brief Read one meter and update its counters and backoff
+     * @param meter Meter to read
+     * @return true if successful
+     */
+    bool read(BusMeter& meter);
+};
+
+#endif // METER_BUS_H
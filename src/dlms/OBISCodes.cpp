@@ -137,16 +137,82 @@ const OBISCode OBISCodes::FREQUENCY(0x01, 0x00, 0x0E, 0x07, 0x00, 0xFF,
 // ============================================
 const OBISCode OBISCodes::MULTIPLICATION_FACTOR(0x01, 0x00, 0x00, 0x04, 0x03, 0xFF,
     "Multiplication Factor", "", 0x01);
+const OBISCode OBISCodes::CLOCK(0x00, 0x00, 0x01, 0x00, 0x00, 0xFF,
+    "Clock", "", 0x08);
+
+// ============================================
+// PROFILES
+// ============================================
+const OBISCode OBISCodes::LOAD_PROFILE(0x01, 0x00, 0x63, 0x01, 0x00, 0xFF,
+    "Load Profile", "", 0x07);
+
+// ============================================
+// LOOKUP BY NAME
+// ============================================
+
+static const OBISCode* const SINGLE_CODES[] = {
+    &OBISCodes::METER_SERIAL_NUMBER, &OBISCodes::METER_MANUFACTURER,
+    &OBISCodes::METER_TYPE, &OBISCodes::KWH_IMPORT, &OBISCodes::KWH_EXPORT,
+    &OBISCodes::KVAH_IMPORT, &OBISCodes::KVAH_EXPORT, &OBISCodes::KVARH_LAG,
+    &OBISCodes::KVARH_LEAD, &OBISCodes::MD_KW_IMPORT, &OBISCodes::MD_KW_EXPORT,
+    &OBISCodes::MD_KVA_IMPORT, &OBISCodes::MD_KVA_EXPORT, &OBISCodes::VOLTAGE_R,
+    &OBISCodes::VOLTAGE_Y, &OBISCodes::VOLTAGE_B, &OBISCodes::CURRENT_R,
+    &OBISCodes::CURRENT_Y, &OBISCodes::CURRENT_B, &OBISCodes::CURRENT_NEUTRAL,
+    &OBISCodes::POWER_FACTOR, &OBISCodes::FREQUENCY,
+    &OBISCodes::MULTIPLICATION_FACTOR, &OBISCodes::CLOCK, &OBISCodes::LOAD_PROFILE
+};
+
+static const OBISCode* const RATE_CODES[] = {
+    OBISCodes::KWH_IMPORT_RATE, OBISCodes::KVAH_IMPORT_RATE,
+    OBISCodes::MD_KW_IMPORT_RATE, OBISCodes::MD_KVA_IMPORT_RATE
+};
+
+static const uint8_t NAMED_CODES = sizeof(SINGLE_CODES) / sizeof(SINGLE_CODES[0]) +
+                                   8 * sizeof(RATE_CODES) / sizeof(RATE_CODES[0]);
+
+/**
+ * @brief Fill index with every code, sorted by name
+ * @return Number of codes
+ */
+static uint8_t buildNameIndex(const OBISCode** index) {
+    uint8_t count = 0;
+    for (const OBISCode* code : SINGLE_CODES) index[count++] = code;
+    for (const OBISCode* rate : RATE_CODES) {
+        for (uint8_t i = 0; i < 8; i++) index[count++] = &rate[i];
+    }
+    
+    // Insertion sort, run once
+    for (uint8_t i = 1; i < count; i++) {
+        const OBISCode* code = index[i];
+        uint8_t j = i;
+        while (j > 0 && strcmp(index[j - 1]->name, code->name) > 0) {
+            index[j] = index[j - 1];
+            j--;
+        }
+        index[j] = code;
+    }
+    return count;
+}
 
 /**
- * @brief Get OBIS code by name (simple linear search)
+ * @brief Get OBIS code by name (binary search over a sorted index)
  */
 const OBISCode* OBISCodes::getByName(const char* name) {
-    // This is a simplified version - in production you might use a map
-    if (strcmp(name, "Serial Number") == 0) return &METER_SERIAL_NUMBER;
-    if (strcmp(name, "Manufacturer") == 0) return &METER_MANUFACTURER;
-    if (strcmp(name, "kWh Import") == 0) return &KWH_IMPORT;
-    // Add more as needed
+    static const OBISCode* index[NAMED_CODES];
+    static const uint8_t count = buildNameIndex(index);
+    
+    int low = 0;
+    int high = count - 1;
+    while (low <= high) {
+        int mid = (low + high) / 2;
+        int cmp = strcmp(name, index[mid]->name);
+        if (cmp == 0) return index[mid];
+        if (cmp < 0) {
+            high = mid - 1;
+        } else {
+            low = mid + 1;
+        }
+    }
     return nullptr;
 }
 
@@ -119,10 +119,16 @@ public:
     // CONFIGURATION
     // ============================================
     static const OBISCode MULTIPLICATION_FACTOR;// Meter MF/CT ratio
+    static const OBISCode CLOCK;                // Meter clock
+    
+    // ============================================
+    // PROFILES
+    // ============================================
+    static const OBISCode LOAD_PROFILE;         // Block load profile
     
     /**
      * @brief Get OBIS code by name
-     * @param name Name of the parameter
+     * @param name Exact OBISCode::name, e.g. "Active Energy Import"
      * @return Pointer to OBISCode or nullptr if not found
      */
     static const OBISCode* getByName(const char* name);
@@ -0,0 +1,70 @@
+/**
+ * @file PollSchedule.cpp
+ * @brief Implementation of tier deadlines
+ * @version 2.0
+ * @date 2025-10-02
+ */
+
+#include "PollSchedule.h"
+
+// A tier falling due within half a poll period is read on this poll
+// rather than one full period late
+static const uint32_t DUE_SLACK = READ_INTERVAL / 2;
+
+PollSchedule::PollSchedule() {
+    reset();
+}
+
+uint32_t PollSchedule::interval(uint8_t tier) {
+    switch (tier) {
+        case ReadTier::FAST:   return TIER_FAST_INTERVAL;
+        case ReadTier::NORMAL: return TIER_NORMAL_INTERVAL;
+        default:               return TIER_SLOW_INTERVAL;
+    }
+}
+
+uint8_t PollSchedule::due(unsigned long now) const {
+    uint8_t tiers = pending;
+    for (uint8_t tier = 0; tier < ReadTier::COUNT; tier++) {
+        if ((long)(now + DUE_SLACK - deadline[tier]) >= 0) {
+            tiers |= ReadTier::bit(tier);
+        }
+    }
+    return tiers;
+}
+
+void PollSchedule::complete(uint8_t tiers, unsigned long now) {
+    pending &= ~tiers;
+
+    for (uint8_t tier = 0; tier < ReadTier::COUNT; tier++) {
+        if (!(tiers & ReadTier::bit(tier))) continue;
+
+        // Fixed grid; after a long outage restart from this poll
+        uint32_t period = interval(tier);
+        deadline[tier] += period;
+        if ((long)(now + DUE_SLACK - deadline[tier]) >= 0) {
+            deadline[tier] = now + period;
+        }
+    }
+}
+
+void PollSchedule::reset() {
+    pending = ReadTier::ALL;
+    for (uint8_t tier = 0; tier < ReadTier::COUNT; tier++) {
+        deadline[tier] = 0;
+    }
+}
+
+void PollSchedule::save(Saved& out, unsigned long wake) const {
+    out.pending = pending;
+    for (uint8_t tier = 0; tier < ReadTier::COUNT; tier++) {
+        out.remaining[tier] = (int32_t)(deadline[tier] - wake);
+    }
+}
+
+void PollSchedule::restore(const Saved& in, unsigned long now) {
+    pending = in.pending;
+    for (uint8_t tier = 0; tier < ReadTier::COUNT; tier++) {
+        deadline[tier] = now + in.remaining[tier];
+    }
+}
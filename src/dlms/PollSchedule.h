@@ -0,0 +1,84 @@
+/**
+ * @file PollSchedule.h
+ * @brief Per-meter deadlines for the ReadPlan poll tiers
+ * @version 2.0
+ * @date 2025-10-02
+ *
+ * Polls run every READ_INTERVAL; each asks due() which tiers to include,
+ * so a poll carries instantaneous values alone most of the time and the
+ * energy, MD and TOD registers only when their own interval has passed.
+ * Deadlines follow a fixed grid from the poll start time, and a tier
+ * that failed stays due for the next poll.
+ */
+
+#ifndef POLL_SCHEDULE_H
+#define POLL_SCHEDULE_H
+
+#include <Arduino.h>
+#include "../config/config.h"
+#include "ReadPlan.h"
+
+/**
+ * @class PollSchedule
+ * @brief Which tiers a poll should read
+ */
+class PollSchedule {
+public:
+    /**
+     * @struct Saved
+     * @brief Deadlines relative to a wake time, for RTC memory
+     */
+    struct Saved {
+        int32_t remaining[ReadTier::COUNT];     // ms after the wake
+        uint8_t pending;
+    };
+
+    /**
+     * @brief Constructor - every tier due on the first poll
+     */
+    PollSchedule();
+
+    /**
+     * @brief Tiers whose deadline has been reached
+     * @param now Poll start, millis()
+     * @return Mask of ReadTier bits
+     */
+    uint8_t due(unsigned long now) const;
+
+    /**
+     * @brief Advance the deadlines of tiers read successfully
+     * @param tiers Mask returned by due()
+     * @param now The same poll start passed to due()
+     */
+    void complete(uint8_t tiers, unsigned long now);
+
+    /**
+     * @brief Make every tier due (remote read, meter replaced)
+     */
+    void reset();
+
+    /**
+     * @brief Keep the deadlines through a deep sleep
+     * @param out RTC copy
+     * @param wake millis() the sleep ends at, in this boot's time
+     */
+    void save(Saved& out, unsigned long wake) const;
+
+    /**
+     * @brief Take the deadlines back after the wake
+     * @param in RTC copy written by save()
+     * @param now Current millis()
+     */
+    void restore(const Saved& in, unsigned long now);
+
+    /**
+     * @brief Interval of one tier in ms
+     */
+    static uint32_t interval(uint8_t tier);
+
+private:
+    unsigned long deadline[ReadTier::COUNT];
+    uint8_t pending;            // Tiers forced due regardless of deadline
+};
+
+#endif // POLL_SCHEDULE_H
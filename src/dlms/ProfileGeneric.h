@@ -0,0 +1,83 @@
+/**
+ * @file ProfileGeneric.h
+ * @brief Types for reading Profile Generic (class 7) buffers
+ * @version 2.0
+ * @date 2025-10-02
+ * 
+ * A load profile buffer is an array of rows; each row is a structure
+ * with one element per capture object (usually clock + registers).
+ * Rows are decoded one at a time and handed to a ProfileRecordSink,
+ * so the buffer never has to fit in memory.
+ */
+
+#ifndef PROFILE_GENERIC_H
+#define PROFILE_GENERIC_H
+
+#include <Arduino.h>
+#include "../config/config.h"
+#include "AXDR.h"
+
+/**
+ * @struct ProfileColumn
+ * @brief One capture object of a profile (attribute 3 element)
+ */
+struct ProfileColumn {
+    uint16_t classId;
+    uint8_t obis[6];
+    int8_t attribute;
+    int8_t scaler;          // Applied to numeric values (0 if none)
+};
+
+/**
+ * @struct ProfileRecord
+ * @brief One decoded profile row
+ */
+struct ProfileRecord {
+    uint32_t captureTime;   // Meter local time, seconds since 1970
+    uint8_t valueCount;     // Numeric columns stored in values[]
+    float values[PROFILE_MAX_COLUMNS];
+};
+
+/**
+ * @class ProfileRecordSink
+ * @brief Receives profile rows as they are decoded
+ */
+class ProfileRecordSink {
+public:
+    virtual ~ProfileRecordSink() {}
+    
+    /**
+     * @brief Called once before rows, after capture objects are known
+     * @param columns Capture objects (one per row element)
+     * @param count Number of capture objects
+     */
+    virtual void onColumns(const ProfileColumn* columns, uint8_t count) {}
+    
+    /**
+     * @brief Called for every decoded row
+     * @param record Decoded row
+     * @return false to abort the read
+     */
+    virtual bool onRecord(const ProfileRecord& record) = 0;
+};
+
+/**
+ * @class ArrayElementHandler
+ * @brief Receives complete elements of an array attribute
+ * 
+ * Used by DLMSProtocol to stream arrays that arrive in several
+ * data blocks; an element split across blocks is reassembled first.
+ */
+class ArrayElementHandler {
+public:
+    virtual ~ArrayElementHandler() {}
+    
+    /**
+     * @brief Called for every complete array element
+     * @param element View of the element (valid only during the call)
+     * @return false to abort the read
+     */
+    virtual bool onElement(const AXDRValue& element) = 0;
+};
+
+#endif // PROFILE_GENERIC_H
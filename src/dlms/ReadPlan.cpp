@@ -0,0 +1,228 @@
+/**
+ * @file ReadPlan.cpp
+ * @brief Register table and site selection
+ * @version 2.0
+ * @date 2025-10-02
+ */
+
+#include "ReadPlan.h"
+#include "../utils/Logger.h"
+#include <ArduinoJson.h>
+#include <stddef.h>
+
+#if SPIFFS_ENABLED
+#include <SPIFFS.h>
+#endif
+
+// ============================================
+// REGISTER TABLE
+// ============================================
+
+#define FIELD(member) ((uint16_t)offsetof(MeterData, member))
+
+#define REGISTER(key, obis, member, tier) \
+    { key, &OBISCodes::obis, FIELD(member), ReadPlanEntry::NO_TIMESTAMP, tier }
+
+#define DEMAND(key, obis, member, tier) \
+    { key, &OBISCodes::obis, FIELD(member.value), FIELD(member.timestamp), tier }
+
+#define TOD_ZONE(n) \
+    { "tod" #n "_kvah",   &OBISCodes::KVAH_IMPORT_RATE[n - 1], \
+      FIELD(todZones[n - 1].kvah), ReadPlanEntry::NO_TIMESTAMP, ReadTier::SLOW }, \
+    { "tod" #n "_kwh",    &OBISCodes::KWH_IMPORT_RATE[n - 1], \
+      FIELD(todZones[n - 1].kwh), ReadPlanEntry::NO_TIMESTAMP, ReadTier::SLOW }, \
+    { "tod" #n "_md_kva", &OBISCodes::MD_KVA_IMPORT_RATE[n - 1], \
+      FIELD(todZones[n - 1].mdKVA), FIELD(todZones[n - 1].mdKVATimestamp), ReadTier::SLOW }, \
+    { "tod" #n "_md_kw",  &OBISCodes::MD_KW_IMPORT_RATE[n - 1], \
+      FIELD(todZones[n - 1].mdKW), FIELD(todZones[n - 1].mdKWTimestamp), ReadTier::SLOW }
+
+// Sorted by key (strcmp order), enforced below
+static constexpr ReadPlanEntry ENTRIES[] = {
+    REGISTER("current_b",     CURRENT_B,       currentB,       ReadTier::FAST),
+    REGISTER("current_n",     CURRENT_NEUTRAL, currentNeutral, ReadTier::FAST),
+    REGISTER("current_r",     CURRENT_R,       currentR,       ReadTier::FAST),
+    REGISTER("current_y",     CURRENT_Y,       currentY,       ReadTier::FAST),
+    REGISTER("frequency",     FREQUENCY,       frequency,      ReadTier::FAST),
+    REGISTER("kvah_export",   KVAH_EXPORT,     kvahExport,     ReadTier::NORMAL),
+    REGISTER("kvah_import",   KVAH_IMPORT,     kvahImport,     ReadTier::NORMAL),
+    REGISTER("kvarh_lag",     KVARH_LAG,       kvarhLag,       ReadTier::NORMAL),
+    REGISTER("kvarh_lead",    KVARH_LEAD,      kvarhLead,      ReadTier::NORMAL),
+    REGISTER("kwh_export",    KWH_EXPORT,      kwhExport,      ReadTier::NORMAL),
+    REGISTER("kwh_import",    KWH_IMPORT,      kwhImport,      ReadTier::NORMAL),
+    DEMAND("md_kva_export",   MD_KVA_EXPORT,   mdKVAExport,    ReadTier::SLOW),
+    DEMAND("md_kva_import",   MD_KVA_IMPORT,   mdKVAImport,    ReadTier::SLOW),
+    DEMAND("md_kw_export",    MD_KW_EXPORT,    mdKWExport,     ReadTier::SLOW),
+    DEMAND("md_kw_import",    MD_KW_IMPORT,    mdKWImport,     ReadTier::SLOW),
+    REGISTER("power_factor",  POWER_FACTOR,    powerFactor,    ReadTier::FAST),
+    TOD_ZONE(1),
+    TOD_ZONE(2),
+    TOD_ZONE(3),
+    TOD_ZONE(4),
+    TOD_ZONE(5),
+    TOD_ZONE(6),
+    TOD_ZONE(7),
+    TOD_ZONE(8),
+    REGISTER("voltage_b",     VOLTAGE_B,       voltageB,       ReadTier::FAST),
+    REGISTER("voltage_r",     VOLTAGE_R,       voltageR,       ReadTier::FAST),
+    REGISTER("voltage_y",     VOLTAGE_Y,       voltageY,       ReadTier::FAST)
+};
+
+#undef TOD_ZONE
+#undef DEMAND
+#undef REGISTER
+#undef FIELD
+
+static constexpr uint8_t ENTRY_COUNT = sizeof(ENTRIES) / sizeof(ENTRIES[0]);
+
+static constexpr int compareKeys(const char* a, const char* b) {
+    return (*a != *b || *a == '\0') ? (int)(uint8_t)*a - (int)(uint8_t)*b
+                                    : compareKeys(a + 1, b + 1);
+}
+
+static constexpr bool sortedFrom(uint8_t i) {
+    return i + 1 >= ENTRY_COUNT ||
+           (compareKeys(ENTRIES[i].key, ENTRIES[i + 1].key) < 0 && sortedFrom(i + 1));
+}
+
+static_assert(sortedFrom(0), "ReadPlan table must be sorted by key without duplicates");
+
+// ============================================
+// TABLE ACCESS
+// ============================================
+
+uint8_t ReadPlan::size() {
+    return ENTRY_COUNT;
+}
+
+const ReadPlanEntry& ReadPlan::entry(uint8_t index) {
+    return ENTRIES[index];
+}
+
+int ReadPlan::find(const char* key) {
+    int low = 0;
+    int high = ENTRY_COUNT - 1;
+    while (low <= high) {
+        int mid = (low + high) / 2;
+        int cmp = strcmp(key, ENTRIES[mid].key);
+        if (cmp == 0) return mid;
+        if (cmp < 0) {
+            high = mid - 1;
+        } else {
+            low = mid + 1;
+        }
+    }
+    return -1;
+}
+
+// ============================================
+// SITE SELECTION
+// ============================================
+
+ReadPlan::ReadPlan() {
+    static_assert(ENTRY_COUNT <= CAPACITY, "ReadPlan table exceeds CAPACITY");
+    reset();
+}
+
+void ReadPlan::reset() {
+    for (uint8_t i = 0; i < ENTRY_COUNT; i++) {
+        tiers[i] = ENTRIES[i].tier;
+    }
+}
+
+bool ReadPlan::setTier(const char* key, uint8_t tier) {
+    int index = find(key);
+    if (index < 0 || (tier >= ReadTier::COUNT && tier != ReadTier::OFF)) {
+        return false;
+    }
+    tiers[index] = tier;
+    return true;
+}
+
+uint8_t ReadPlan::enabledCount() const {
+    uint8_t count = 0;
+    for (uint8_t i = 0; i < ENTRY_COUNT; i++) {
+        if (tiers[i] != ReadTier::OFF) count++;
+    }
+    return count;
+}
+
+uint8_t ReadPlan::resolve(MeterData& data, uint8_t mask, RegisterRead* reads) const {
+    uint8_t* base = reinterpret_cast<uint8_t*>(&data);
+    uint8_t count = 0;
+
+    for (uint8_t i = 0; i < ENTRY_COUNT; i++) {
+        if (!(ReadTier::bit(tiers[i]) & mask)) continue;
+
+        const ReadPlanEntry& e = ENTRIES[i];
+        RegisterRead& read = reads[count++];
+        read.obis = e.obis;
+        read.value = reinterpret_cast<float*>(base + e.value);
+        read.timestamp = e.timestamp == ReadPlanEntry::NO_TIMESTAMP
+                       ? nullptr
+                       : reinterpret_cast<uint32_t*>(base + e.timestamp);
+    }
+    return count;
+}
+
+bool ReadPlan::load(const char* path) {
+#if SPIFFS_ENABLED
+    if (!SPIFFS.begin(true) || !SPIFFS.exists(path)) {
+        return false;
+    }
+
+    File file = SPIFFS.open(path, "r");
+    if (!file) return false;
+
+    // Only the plan section is kept, whatever else the file holds
+    StaticJsonDocument<32> filter;
+    filter["read_plan"] = true;
+
+    DynamicJsonDocument doc(READ_PLAN_JSON_SIZE);
+    DeserializationError error = deserializeJson(doc, file,
+                                                 DeserializationOption::Filter(filter));
+    file.close();
+
+    if (error) {
+        LOG_WARN("Read plan: " + String(path) + " invalid (" + String(error.c_str()) + ")");
+        return false;
+    }
+
+    JsonObjectConst plan = doc["read_plan"].as<JsonObjectConst>();
+    if (plan.isNull()) return false;
+
+    JsonVariantConst all = plan["default"];
+    if (all.is<bool>()) {
+        bool enabled = all.as<bool>();
+        for (uint8_t i = 0; i < ENTRY_COUNT; i++) {
+            tiers[i] = enabled ? ENTRIES[i].tier : ReadTier::OFF;
+        }
+    }
+
+    for (JsonPairConst item : plan) {
+        const char* key = item.key().c_str();
+        if (strcmp(key, "default") == 0) continue;
+
+        int index = find(key);
+        if (index < 0) {
+            LOG_WARN("Read plan: unknown register " + String(key));
+            continue;
+        }
+
+        JsonVariantConst value = item.value();
+        if (value.is<bool>()) {
+            tiers[index] = value.as<bool>() ? ENTRIES[index].tier : ReadTier::OFF;
+        } else if (value.is<int>() && value.as<int>() >= 0 &&
+                   value.as<int>() < ReadTier::COUNT) {
+            tiers[index] = value.as<int>();
+        } else {
+            LOG_WARN("Read plan: invalid setting for " + String(key));
+        }
+    }
+
+    LOG_INFO("Read plan: " + String(enabledCount()) + " of " + String(ENTRY_COUNT) +
+             " registers enabled");
+    return true;
+#else
+    return false;
+#endif
+}
@@ -0,0 +1,139 @@
+/**
+ * @file ReadPlan.h
+ * @brief Declarative list of registers read into MeterData
+ * @version 2.0
+ * @date 2025-10-02
+ *
+ * Every register the reader knows is one row of a constexpr table: a
+ * stable key, the OBIS object (which carries the interface class), the
+ * MeterData fields that receive the value (attribute 2) and capture time
+ * (attribute 5, class 4 only) as byte offsets, and a default poll tier.
+ * Rows are sorted by key, checked at compile time, so find() is a binary
+ * search. A ReadPlan instance holds the per-site selection on top of the
+ * table and can be overridden from CONFIG_FILE without reflashing:
+ *
+ *   { "read_plan": { "default": true, "tod8_kwh": false, "md_kw_export": 2 } }
+ *
+ * "default" (optional, applied first) enables or disables every row; a
+ * key set to false skips that register, true restores its table tier and
+ * a number 0-2 moves it to that tier.
+ */
+
+#ifndef READ_PLAN_H
+#define READ_PLAN_H
+
+#include <Arduino.h>
+#include "../config/config.h"
+#include "../data/MeterData.h"
+#include "OBISCodes.h"
+
+/**
+ * @namespace ReadTier
+ * @brief Poll tiers, as bits in a tier mask
+ */
+namespace ReadTier {
+    const uint8_t FAST   = 0;       // Instantaneous values
+    const uint8_t NORMAL = 1;       // Cumulative energy
+    const uint8_t SLOW   = 2;       // Maximum demand and TOD billing
+    const uint8_t COUNT  = 3;
+    const uint8_t OFF    = 0xFF;    // Not read at this site
+
+    const uint8_t ALL    = (1 << COUNT) - 1;
+
+    inline uint8_t bit(uint8_t tier) { return tier < COUNT ? 1 << tier : 0; }
+}
+
+/**
+ * @struct ReadPlanEntry
+ * @brief One register of the plan table
+ */
+struct ReadPlanEntry {
+    static const uint16_t NO_TIMESTAMP = 0xFFFF;
+
+    const char* key;            // Stable name used by the config override
+    const OBISCode* obis;       // Object and interface class
+    uint16_t value;             // offsetof(MeterData, <float>)
+    uint16_t timestamp;         // offsetof(MeterData, <uint32_t>) or NO_TIMESTAMP
+    uint8_t tier;               // Default ReadTier
+};
+
+/**
+ * @struct RegisterRead
+ * @brief One register to read, with destinations for value and timestamp
+ */
+struct RegisterRead {
+    const OBISCode* obis;
+    float* value;
+    uint32_t* timestamp;    // Capture time for class 4 (nullptr to skip)
+};
+
+/**
+ * @class ReadPlan
+ * @brief Site selection over the register table
+ */
+class ReadPlan {
+public:
+    static const uint8_t CAPACITY = 64;     // Upper bound of size()
+
+    /**
+     * @brief Constructor - every register enabled at its table tier
+     */
+    ReadPlan();
+
+    /**
+     * @brief Apply the "read_plan" override from a JSON config file
+     * @param path SPIFFS path
+     * @return true if an override was found and applied
+     */
+    bool load(const char* path = CONFIG_FILE);
+
+    /**
+     * @brief Restore table defaults
+     */
+    void reset();
+
+    /**
+     * @brief Set the tier of one register
+     * @param key Table key
+     * @param tier ReadTier value or ReadTier::OFF
+     * @return false if the key is unknown
+     */
+    bool setTier(const char* key, uint8_t tier);
+
+    /**
+     * @brief Resolve the selected registers into read requests
+     * @param data Destination record
+     * @param mask ReadTier bits to include
+     * @param reads Output, room for CAPACITY entries
+     * @return Number of requests written
+     */
+    uint8_t resolve(MeterData& data, uint8_t mask, RegisterRead* reads) const;
+
+    /**
+     * @brief Registers enabled in any tier
+     */
+    uint8_t enabledCount() const;
+
+    uint8_t tierOf(uint8_t index) const { return tiers[index]; }
+
+    /**
+     * @brief Number of rows in the register table
+     */
+    static uint8_t size();
+
+    /**
+     * @brief Table row by index (key order)
+     */
+    static const ReadPlanEntry& entry(uint8_t index);
+
+    /**
+     * @brief Look up a row by key (binary search)
+     * @return Table index or -1
+     */
+    static int find(const char* key);
+
+private:
+    uint8_t tiers[CAPACITY];    // Per row: ReadTier or ReadTier::OFF
+};
+
+#endif // READ_PLAN_H
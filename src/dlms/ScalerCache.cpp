@@ -0,0 +1,192 @@
+/**
+ * @file ScalerCache.cpp
+ * @brief Implementation of scaler/class-check cache
+ * @version 2.0
+ * @date 2025-10-02
+ */
+
+#include "ScalerCache.h"
+#include "../utils/CRCCalculator.h"
+#include "../utils/Logger.h"
+
+#if PREFERENCES_ENABLED
+#include <Preferences.h>
+#endif
+
+ScalerCache::ScalerCache() : count(0), dirty(false) {
+    serial[0] = '\0';
+}
+
+void ScalerCache::begin(const char* serialNumber) {
+    if (serialNumber[0] == '\0' || strcmp(serial, serialNumber) == 0) {
+        return;
+    }
+    
+    save();
+    
+    strncpy(serial, serialNumber, sizeof(serial) - 1);
+    serial[sizeof(serial) - 1] = '\0';
+    count = 0;
+    dirty = false;
+    
+    if (load()) {
+        LOG_INFO("Scaler cache loaded: " + String(count) + " entries");
+    }
+}
+
+const ScalerEntry* ScalerCache::find(const OBISCode& obis) const {
+    for (uint8_t i = 0; i < count; i++) {
+        if (memcmp(entries[i].obis, obis.bytes, 6) == 0) {
+            return &entries[i];
+        }
+    }
+    return nullptr;
+}
+
+ScalerEntry* ScalerCache::lookup(const OBISCode& obis) {
+    return const_cast<ScalerEntry*>(find(obis));
+}
+
+ScalerEntry* ScalerCache::obtain(const OBISCode& obis) {
+    ScalerEntry* entry = lookup(obis);
+    if (entry) return entry;
+    
+    if (count >= SCALER_CACHE_SIZE) {
+        LOG_WARN("Scaler cache full");
+        return nullptr;
+    }
+    
+    entry = &entries[count++];
+    memcpy(entry->obis, obis.bytes, 6);
+    entry->scaler = 0;
+    entry->unit = 0;
+    entry->flags = 0;
+    return entry;
+}
+
+void ScalerCache::storeScaler(const OBISCode& obis, int8_t scaler, uint8_t unit) {
+    ScalerEntry* entry = obtain(obis);
+    if (!entry) return;
+    
+    if (!entry->hasScaler() || entry->scaler != scaler || entry->unit != unit) {
+        entry->scaler = scaler;
+        entry->unit = unit;
+        entry->flags |= ScalerEntry::SCALER_VALID;
+        entry->flags &= ~ScalerEntry::OBJECT_MISSING;
+        dirty = true;
+    }
+}
+
+void ScalerCache::markVerified(const OBISCode& obis) {
+    ScalerEntry* entry = obtain(obis);
+    if (!entry || entry->isVerified()) return;
+    
+    entry->flags |= ScalerEntry::CLASS_VERIFIED;
+    entry->flags &= ~ScalerEntry::OBJECT_MISSING;
+    dirty = true;
+}
+
+void ScalerCache::markMissing(const OBISCode& obis) {
+    ScalerEntry* entry = obtain(obis);
+    if (!entry || entry->isMissing()) return;
+    
+    entry->flags = ScalerEntry::OBJECT_MISSING;
+    dirty = true;
+}
+
+// ============================================
+// PERSISTENCE
+// ============================================
+
+/**
+ * @brief NVS keys are limited to 15 characters, so the key is a
+ * CRC of the serial number; the serial itself is kept in the header.
+ */
+void ScalerCache::makeKey(char* key) const {
+    uint16_t crc = CRCCalculator::calculate((const uint8_t*)serial, strlen(serial));
+    sprintf(key, "m%04X", crc);
+}
+
+bool ScalerCache::load() {
+#if PREFERENCES_ENABLED
+    char key[8];
+    makeKey(key);
+    
+    Preferences prefs;
+    if (!prefs.begin(SCALER_CACHE_NAMESPACE, true)) return false;
+    
+    uint8_t blob[sizeof(Header) + sizeof(entries)];
+    size_t length = prefs.getBytes(key, blob, sizeof(blob));
+    prefs.end();
+    
+    if (length < sizeof(Header)) return false;
+    
+    Header header;
+    memcpy(&header, blob, sizeof(header));
+    if (header.version != VERSION ||
+        header.count > SCALER_CACHE_SIZE ||
+        length != sizeof(Header) + header.count * sizeof(ScalerEntry) ||
+        strncmp(header.serial, serial, sizeof(header.serial)) != 0) {
+        return false;
+    }
+    
+    memcpy(entries, blob + sizeof(Header), header.count * sizeof(ScalerEntry));
+    count = header.count;
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool ScalerCache::save() {
+    if (!dirty || serial[0] == '\0') return true;
+    
+#if PREFERENCES_ENABLED
+    char key[8];
+    makeKey(key);
+    
+    Header header;
+    memset(&header, 0, sizeof(header));
+    header.version = VERSION;
+    header.count = count;
+    strncpy(header.serial, serial, sizeof(header.serial) - 1);
+    
+    uint8_t blob[sizeof(Header) + sizeof(entries)];
+    memcpy(blob, &header, sizeof(header));
+    memcpy(blob + sizeof(Header), entries, count * sizeof(ScalerEntry));
+    size_t length = sizeof(Header) + count * sizeof(ScalerEntry);
+    
+    Preferences prefs;
+    if (!prefs.begin(SCALER_CACHE_NAMESPACE, false)) return false;
+    bool ok = prefs.putBytes(key, blob, length) == length;
+    prefs.end();
+    
+    if (!ok) {
+        LOG_ERROR("Failed to save scaler cache");
+        return false;
+    }
+    LOG_DEBUG("Scaler cache saved: " + String(count) + " entries");
+#endif
+    
+    dirty = false;
+    return true;
+}
+
+void ScalerCache::clear() {
+#if PREFERENCES_ENABLED
+    if (serial[0] != '\0') {
+        char key[8];
+        makeKey(key);
+        
+        Preferences prefs;
+        if (prefs.begin(SCALER_CACHE_NAMESPACE, false)) {
+            prefs.remove(key);
+            prefs.end();
+        }
+    }
+#endif
+    
+    count = 0;
+    dirty = false;
+    LOG_INFO("Scaler cache cleared");
+}
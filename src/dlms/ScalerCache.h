@@ -0,0 +1,122 @@
+/**
+ * @file ScalerCache.h
+ * @brief Per-meter cache of register scaler_unit and class-check results
+ * @version 2.0
+ * @date 2025-10-02
+ * 
+ * Scaler/unit (attribute 3) and logical name (attribute 1) of a
+ * register never change for a given meter firmware, so they are read
+ * once and cached, keyed by meter serial number plus OBIS bytes.
+ * The cache is persisted to Preferences (NVS) when enabled.
+ */
+
+#ifndef SCALER_CACHE_H
+#define SCALER_CACHE_H
+
+#include <Arduino.h>
+#include "../config/config.h"
+#include "OBISCodes.h"
+
+/**
+ * @struct ScalerEntry
+ * @brief Cached metadata of one register
+ */
+struct ScalerEntry {
+    enum Flags : uint8_t {
+        SCALER_VALID   = 0x01,  // scaler/unit known
+        CLASS_VERIFIED = 0x02,  // attribute 1 read successfully
+        OBJECT_MISSING = 0x04   // meter reported object undefined
+    };
+    
+    uint8_t obis[6];
+    int8_t scaler;
+    uint8_t unit;
+    uint8_t flags;
+    
+    bool hasScaler() const { return flags & SCALER_VALID; }
+    bool isVerified() const { return flags & CLASS_VERIFIED; }
+    bool isMissing() const { return flags & OBJECT_MISSING; }
+};
+
+/**
+ * @class ScalerCache
+ * @brief Fixed-size scaler/class-check cache for one meter
+ */
+class ScalerCache {
+public:
+    /**
+     * @brief Constructor
+     */
+    ScalerCache();
+    
+    /**
+     * @brief Select meter, loading its persisted entries
+     * @param serialNumber Meter serial number
+     * 
+     * Does nothing if the cache already belongs to this meter.
+     */
+    void begin(const char* serialNumber);
+    
+    /**
+     * @brief Find cached entry for register
+     * @param obis OBIS code
+     * @return Entry or nullptr if not cached
+     */
+    const ScalerEntry* find(const OBISCode& obis) const;
+    
+    /**
+     * @brief Store scaler/unit for register
+     */
+    void storeScaler(const OBISCode& obis, int8_t scaler, uint8_t unit);
+    
+    /**
+     * @brief Record successful class check (attribute 1)
+     */
+    void markVerified(const OBISCode& obis);
+    
+    /**
+     * @brief Record that meter does not implement register
+     */
+    void markMissing(const OBISCode& obis);
+    
+    /**
+     * @brief Persist entries if changed
+     * @return true if saved or nothing to save
+     */
+    bool save();
+    
+    /**
+     * @brief Drop all entries (memory and persisted)
+     */
+    void clear();
+    
+    /**
+     * @brief Get number of cached entries
+     */
+    uint8_t size() const { return count; }
+
+private:
+    /**
+     * @struct Header
+     * @brief Persisted blob header
+     */
+    struct Header {
+        uint8_t version;
+        uint8_t count;
+        char serial[24];
+    };
+    
+    static const uint8_t VERSION = 1;
+    
+    ScalerEntry entries[SCALER_CACHE_SIZE];
+    uint8_t count;
+    char serial[24];
+    bool dirty;
+    
+    ScalerEntry* lookup(const OBISCode& obis);
+    ScalerEntry* obtain(const OBISCode& obis);
+    void makeKey(char* key) const;
+    bool load();
+};
+
+#endif // SCALER_CACHE_H
@@ -7,15 +7,79 @@
 
 #include "HardwareManager.h"
 
+#if DLMS_UART_EVENT_DRIVEN && defined(ARDUINO_ARCH_ESP32)
+#include "driver/uart.h"
+#define UART_EVENTS 1
+#define DLMS_UART_PORT ((uart_port_t)DLMS_UART_NUM)
+
+/**
+ * @struct RxFrame
+ * @brief Frame queue item: slot holding the frame and its outcome
+ */
+struct RxFrame {
+    uint8_t slot;           // NO_SLOT for outcomes without data
+    uint16_t length;
+    HDLCFrameReader::Result result;
+};
+
+static const uint8_t NO_SLOT = 0xFF;
+
+static QueueHandle_t uartEvents = nullptr;
+static QueueHandle_t rxFrames = nullptr;
+static QueueHandle_t rxFreeSlots = nullptr;     // Slots handed back by the consumer
+static uint8_t rxSlots[DLMS_RX_FRAME_SLOTS][MAX_FRAME_SIZE];
+static volatile bool rxResetRequested = false;
+static volatile bool rxLines = false;       // Sign-on: deliver lines, not frames
+#else
+#define UART_EVENTS 0
+#endif
+
+#ifdef ARDUINO_ARCH_ESP32
+#include <esp_timer.h>
+#define LED_TIMER 1
+
+static esp_timer_handle_t ledTimerHandle = nullptr;
+static portMUX_TYPE ledLock = portMUX_INITIALIZER_UNLOCKED;
+#define LED_LOCK()      portENTER_CRITICAL(&ledLock)
+#define LED_UNLOCK()    portEXIT_CRITICAL(&ledLock)
+#else
+// Host build has no LED timer: patterns are dropped, steady colors shown
+#define LED_TIMER 0
+#define LED_LOCK()
+#define LED_UNLOCK()
+#endif
+
+#if LED_TIMER
+/**
+ * @struct LEDPattern
+ * @brief Queued blink pattern: count on/off pairs, then a pause
+ */
+struct LEDPattern {
+    LEDColor color;
+    uint8_t count;
+    uint16_t onTime;
+    uint16_t offTime;
+    uint16_t after;
+};
+
+static LEDPattern ledPatterns[LED_PATTERN_QUEUE];
+static uint8_t ledHead = 0;
+static uint8_t ledCount = 0;
+static uint8_t ledPhase = 0;                // Even: on, odd: off
+#endif
+static bool ledRunning = false;             // Timer armed or step in progress
+static LEDColor ledSteady = LEDColor::OFF;
+
 // Initialize static members
 HardwareSerial* HardwareManager::dlmsSerial = nullptr;
 bool HardwareManager::initialized = false;
 bool HardwareManager::statusLedState = false;
+HDLCFrameReader HardwareManager::frameReader;
 
 /**
  * @brief Initialize all hardware components
  */
-void HardwareManager::begin() {
+void HardwareManager::begin(bool startup) {
     if (initialized) return;
     
     // Initialize LED pins
@@ -37,19 +101,88 @@ void HardwareManager::begin() {
     // Initialize DLMS serial
     initDLMSSerial();
     
+#if LED_TIMER
+    esp_timer_create_args_t timerArgs = {};
+    timerArgs.callback = ledTimer;
+    timerArgs.dispatch_method = ESP_TIMER_TASK;
+    timerArgs.name = "led";
+    esp_timer_create(&timerArgs, &ledTimerHandle);
+#endif
+    
     initialized = true;
     
     // Show startup sequence
-    startupSequence();
+    if (startup) startupSequence();
 }
 
 /**
  * @brief Initialize DLMS UART
  */
-void HardwareManager::initDLMSSerial(uint32_t baudRate) {
+void HardwareManager::initDLMSSerial(uint32_t baudRate, uint32_t format) {
+#if UART_EVENTS
+    bool signOn = format == SERIAL_7E1;
+    uart_word_length_t dataBits = signOn ? UART_DATA_7_BITS : UART_DATA_8_BITS;
+    uart_parity_t parity = signOn ? UART_PARITY_EVEN : UART_PARITY_DISABLE;
+    
+    if (rxFrames) {
+        uart_wait_tx_done(DLMS_UART_PORT, pdMS_TO_TICKS(COMMAND_TIMEOUT));
+        uart_set_baudrate(DLMS_UART_PORT, baudRate);
+        uart_set_word_length(DLMS_UART_PORT, dataBits);
+        uart_set_parity(DLMS_UART_PORT, parity);
+        rxLines = signOn;
+        clearRxBuffer();
+        return;
+    }
+    rxLines = signOn;
+    
+    uart_config_t config = {};
+    config.baud_rate = baudRate;
+    config.data_bits = dataBits;
+    config.parity = parity;
+    config.stop_bits = UART_STOP_BITS_1;
+    config.flow_ctrl = UART_HW_FLOWCTRL_DISABLE;
+    
+    uart_param_config(DLMS_UART_PORT, &config);
+    uart_set_pin(DLMS_UART_PORT, DLMS_TXD_PIN, DLMS_RXD_PIN,
+                 RS485_DE_PIN >= 0 ? RS485_DE_PIN : UART_PIN_NO_CHANGE,
+                 UART_PIN_NO_CHANGE);
+    uart_driver_install(DLMS_UART_PORT, DLMS_UART_RX_BUFFER, 0, 20, &uartEvents, 0);
+    
+    // Driver switches the transceiver via RTS for the length of each write
+    if (RS485_DE_PIN >= 0) {
+        uart_set_mode(DLMS_UART_PORT, UART_MODE_RS485_HALF_DUPLEX);
+    }
+    
+    // Deliver data after 16 bytes or 3 idle symbols, so the reader task
+    // sees progress well within HDLC_INTERCHAR_TIMEOUT, and wake it on
+    // every flag
+    uart_set_rx_full_threshold(DLMS_UART_PORT, 16);
+    uart_set_rx_timeout(DLMS_UART_PORT, 3);
+    uart_enable_pattern_det_baud_intr(DLMS_UART_PORT, HDLC_FLAG, 1, 1, 0, 0);
+    uart_pattern_queue_reset(DLMS_UART_PORT, 20);
+    
+    // The reader task fills the slot it owns and takes the next one from
+    // rxFreeSlots; receiveFrame hands a slot back only after copying it
+    rxFrames = xQueueCreate(DLMS_RX_FRAME_SLOTS, sizeof(RxFrame));
+    rxFreeSlots = xQueueCreate(DLMS_RX_FRAME_SLOTS, sizeof(uint8_t));
+    for (uint8_t i = 1; i < DLMS_RX_FRAME_SLOTS; i++) {
+        xQueueSend(rxFreeSlots, &i, 0);
+    }
+    xTaskCreatePinnedToCore(uartEventTask, "dlms_rx", 3072, nullptr,
+                            DLMS_UART_TASK_PRIORITY, nullptr, 1);
+#else
+    if (dlmsSerial) {
+        dlmsSerial->flush();
+    }
     dlmsSerial = &Serial2;
-    dlmsSerial->begin(baudRate, SERIAL_8N1, DLMS_RXD_PIN, DLMS_TXD_PIN);
+    dlmsSerial->begin(baudRate, format, DLMS_RXD_PIN, DLMS_TXD_PIN);
     dlmsSerial->setTimeout(1000);
+    
+    if (RS485_DE_PIN >= 0) {
+        pinMode(RS485_DE_PIN, OUTPUT);
+        digitalWrite(RS485_DE_PIN, LOW);
+    }
+#endif
 }
 
 // ============================================
@@ -70,7 +203,7 @@ void HardwareManager::sleepMeter() {
 // LED CONTROL
 // ============================================
 
-void HardwareManager::setLED(LEDColor color) {
+void HardwareManager::writeLED(LEDColor color) {
     // Active LOW LEDs (common anode RGB)
     switch (color) {
         case LEDColor::RED:
@@ -110,38 +243,56 @@ void HardwareManager::setLED(LEDColor color) {
             break;
         case LEDColor::OFF:
         default:
-            ledsOff();
+            digitalWrite(RED_LED_PIN, HIGH);
+            digitalWrite(GREEN_LED_PIN, HIGH);
+            digitalWrite(BLUE_LED_PIN, HIGH);
             break;
     }
 }
 
+void HardwareManager::setLED(LEDColor color) {
+    LED_LOCK();
+    ledSteady = color;
+    if (!ledRunning) writeLED(color);
+    LED_UNLOCK();
+}
+
 void HardwareManager::ledsOff() {
-    digitalWrite(RED_LED_PIN, HIGH);
-    digitalWrite(GREEN_LED_PIN, HIGH);
-    digitalWrite(BLUE_LED_PIN, HIGH);
+    setLED(LEDColor::OFF);
 }
 
 void HardwareManager::blinkLED(LEDColor color, uint8_t count, 
-                               uint16_t onTime, uint16_t offTime) {
-    for (uint8_t i = 0; i < count; i++) {
-        setLED(color);
-        delay(onTime);
-        ledsOff();
-        if (i < count - 1) {
-            delay(offTime);
-        }
+                               uint16_t onTime, uint16_t offTime, uint16_t after) {
+#if LED_TIMER
+    if (!ledTimerHandle || count == 0) return;
+    
+    bool start = false;
+    LED_LOCK();
+    // Indication is best effort: a full queue drops the new pattern
+    if (ledCount < LED_PATTERN_QUEUE) {
+        LEDPattern& pattern = ledPatterns[(ledHead + ledCount) % LED_PATTERN_QUEUE];
+        pattern.color = color;
+        pattern.count = count;
+        pattern.onTime = onTime;
+        pattern.offTime = offTime;
+        pattern.after = after;
+        ledCount++;
+        
+        start = !ledRunning;
+        ledRunning = true;
     }
+    LED_UNLOCK();
+    
+    if (start) ledStep();
+#endif
 }
 
 void HardwareManager::showError(uint8_t errorCode) {
-    blinkLED(LEDColor::RED, errorCode, 200, 200);
-    delay(500);
+    blinkLED(LEDColor::RED, errorCode, 200, 200, 500);
 }
 
 void HardwareManager::showSuccess() {
-    setLED(LEDColor::GREEN);
-    delay(1000);
-    ledsOff();
+    blinkLED(LEDColor::GREEN, 1, 1000, 0);
 }
 
 void HardwareManager::showActivity() {
@@ -149,10 +300,67 @@ void HardwareManager::showActivity() {
 }
 
 void HardwareManager::startupSequence() {
-    blinkLED(LEDColor::RED, 1, 100, 100);
-    blinkLED(LEDColor::GREEN, 1, 100, 100);
-    blinkLED(LEDColor::BLUE, 1, 100, 100);
-    delay(200);
+    blinkLED(LEDColor::RED, 1, 100, 0);
+    blinkLED(LEDColor::GREEN, 1, 100, 0);
+    blinkLED(LEDColor::BLUE, 1, 100, 0, 200);
+}
+
+void HardwareManager::stopPatterns() {
+#if LED_TIMER
+    if (ledTimerHandle) esp_timer_stop(ledTimerHandle);
+#endif
+    LED_LOCK();
+#if LED_TIMER
+    ledCount = 0;
+    ledPhase = 0;
+#endif
+    ledRunning = false;
+    writeLED(ledSteady);
+    LED_UNLOCK();
+}
+
+void HardwareManager::ledStep() {
+#if LED_TIMER
+    uint16_t duration = 0;
+    
+    // Pins are written under the lock so a steady color set meanwhile
+    // cannot be overwritten by a stale step
+    LED_LOCK();
+    while (ledCount > 0 && duration == 0) {
+        const LEDPattern& pattern = ledPatterns[ledHead];
+        uint8_t phases = pattern.count * 2;
+        
+        if (ledPhase >= phases) {
+            ledHead = (ledHead + 1) % LED_PATTERN_QUEUE;
+            ledCount--;
+            ledPhase = 0;
+            continue;
+        }
+        
+        bool on = (ledPhase & 1) == 0;
+        if (on) {
+            duration = pattern.onTime;
+        } else {
+            duration = ledPhase == phases - 1 ? pattern.after : pattern.offTime;
+        }
+        writeLED(on ? pattern.color : LEDColor::OFF);
+        ledPhase++;
+    }
+    
+    if (ledCount == 0) {
+        writeLED(ledSteady);
+        ledRunning = false;
+    }
+    LED_UNLOCK();
+    
+    if (duration > 0) {
+        esp_timer_start_once(ledTimerHandle, (uint64_t)duration * 1000);
+    }
+#endif
+}
+
+void HardwareManager::ledTimer(void* parameter) {
+    ledStep();
 }
 
 // ============================================
@@ -178,6 +386,218 @@ void HardwareManager::statusLedToggle() {
 // UART OPERATIONS
 // ============================================
 
+#if UART_EVENTS
+static void postFrame(uint8_t& slot, HDLCFrameReader::Result result, uint16_t length) {
+    if (result == HDLCFrameReader::Result::TRUNCATED ||
+        result == HDLCFrameReader::Result::BAD_HCS) {
+        RxFrame frame = { NO_SLOT, 0, result };
+        xQueueSend(rxFrames, &frame, 0);
+        return;
+    }
+    
+    // No free slot or queue full: nobody is reading, drop the frame and
+    // keep filling the slot this task owns
+    uint8_t next;
+    if (xQueueReceive(rxFreeSlots, &next, 0) != pdTRUE) return;
+    
+    RxFrame frame = { slot, length, result };
+    if (xQueueSend(rxFrames, &frame, 0) != pdTRUE) {
+        xQueueSend(rxFreeSlots, &next, 0);
+        return;
+    }
+    slot = next;
+}
+
+/**
+ * @brief Hand a dequeued frame's slot back to the reader task
+ */
+static void releaseFrame(const RxFrame& frame) {
+    if (frame.slot != NO_SLOT) {
+        xQueueSend(rxFreeSlots, &frame.slot, 0);
+    }
+}
+
+void HardwareManager::uartEventTask(void* parameter) {
+    uint8_t slot = 0;
+    uint16_t lineLength = 0;
+    uint8_t chunk[64];
+    uart_event_t event;
+    
+    frameReader.setBuffer(rxSlots[slot], MAX_FRAME_SIZE);
+    
+    while (true) {
+        TickType_t wait = frameReader.inFrame() ?
+                          pdMS_TO_TICKS(HDLC_INTERCHAR_TIMEOUT) : portMAX_DELAY;
+        bool gotEvent = xQueueReceive(uartEvents, &event, wait) == pdTRUE;
+        
+        if (rxResetRequested) {
+            rxResetRequested = false;
+            frameReader.setBuffer(rxSlots[slot], MAX_FRAME_SIZE);
+            frameReader.reset();
+            lineLength = 0;
+        }
+        
+        if (!gotEvent) {
+            // Line went quiet in the middle of a frame
+            frameReader.reset();
+            postFrame(slot, HDLCFrameReader::Result::TRUNCATED, 0);
+            continue;
+        }
+        
+        switch (event.type) {
+            case UART_DATA:
+            case UART_PATTERN_DET: {
+                size_t buffered = 0;
+                uart_get_buffered_data_len(DLMS_UART_PORT, &buffered);
+                
+                while (buffered > 0) {
+                    int n = uart_read_bytes(DLMS_UART_PORT, chunk,
+                                            min(buffered, sizeof(chunk)), 0);
+                    if (n <= 0) break;
+                    buffered -= n;
+                    
+                    for (int i = 0; i < n; i++) {
+                        if (rxLines) {
+                            // Sign-on lines go through the same slots
+                            if (lineLength < MAX_FRAME_SIZE) {
+                                rxSlots[slot][lineLength++] = chunk[i];
+                            }
+                            if (chunk[i] == '\n') {
+                                postFrame(slot, HDLCFrameReader::Result::COMPLETE, lineLength);
+                                lineLength = 0;
+                            }
+                            continue;
+                        }
+                        
+                        HDLCFrameReader::Result result = frameReader.feed(chunk[i]);
+                        if (result == HDLCFrameReader::Result::COMPLETE ||
+                            result == HDLCFrameReader::Result::BAD_FCS ||
+                            result == HDLCFrameReader::Result::BAD_HCS) {
+                            postFrame(slot, result, frameReader.frameLength());
+                            frameReader.setBuffer(rxSlots[slot], MAX_FRAME_SIZE);
+                        }
+                    }
+                }
+                
+                // Flag positions are not needed once the data is consumed
+                while (uart_pattern_pop_pos(DLMS_UART_PORT) != -1) {}
+                break;
+            }
+            
+            case UART_FIFO_OVF:
+            case UART_BUFFER_FULL:
+                uart_flush_input(DLMS_UART_PORT);
+                xQueueReset(uartEvents);
+                frameReader.reset();
+                postFrame(slot, HDLCFrameReader::Result::TRUNCATED, 0);
+                break;
+            
+            default:
+                break;
+        }
+    }
+}
+#endif
+
+HDLCFrameReader::Result HardwareManager::receiveFrame(uint8_t* buffer, uint16_t capacity,
+                                                      uint16_t& length, uint32_t timeout) {
+    length = 0;
+    
+#if UART_EVENTS
+    RxFrame frame;
+    if (!rxFrames || xQueueReceive(rxFrames, &frame, pdMS_TO_TICKS(timeout)) != pdTRUE) {
+        return HDLCFrameReader::Result::TIMEOUT;
+    }
+    
+    if (frame.result == HDLCFrameReader::Result::COMPLETE ||
+        frame.result == HDLCFrameReader::Result::BAD_FCS) {
+        if (frame.length > capacity) {
+            releaseFrame(frame);
+            return HDLCFrameReader::Result::BAD_LENGTH;
+        }
+        memcpy(buffer, rxSlots[frame.slot], frame.length);
+        length = frame.length;
+    }
+    releaseFrame(frame);
+    return frame.result;
+#else
+    if (!dlmsSerial) return HDLCFrameReader::Result::TIMEOUT;
+    
+    frameReader.setBuffer(buffer, capacity);
+    
+    uint32_t startTime = millis();
+    uint32_t lastByteTime = startTime;
+    
+    while (millis() - startTime < timeout) {
+        if (dlmsSerial->available()) {
+            lastByteTime = millis();
+            HDLCFrameReader::Result result = frameReader.feed(dlmsSerial->read());
+            
+            switch (result) {
+                case HDLCFrameReader::Result::COMPLETE:
+                case HDLCFrameReader::Result::BAD_FCS:
+                    length = frameReader.frameLength();
+                    return result;
+                case HDLCFrameReader::Result::BAD_HCS:
+                    return result;
+                default:
+                    continue;   // Pending, or hunting for the next flag
+            }
+        }
+        
+        if (frameReader.inFrame() && millis() - lastByteTime > HDLC_INTERCHAR_TIMEOUT) {
+            frameReader.reset();
+            return HDLCFrameReader::Result::TRUNCATED;
+        }
+        delay(1);
+    }
+    
+    frameReader.reset();
+    return HDLCFrameReader::Result::TIMEOUT;
+#endif
+}
+
+bool HardwareManager::receiveLine(char* buffer, uint16_t capacity,
+                                  uint16_t& length, uint32_t timeout) {
+    length = 0;
+    if (capacity == 0) return false;
+    buffer[0] = '\0';
+    
+#if UART_EVENTS
+    RxFrame frame;
+    if (!rxFrames || xQueueReceive(rxFrames, &frame, pdMS_TO_TICKS(timeout)) != pdTRUE) {
+        return false;
+    }
+    if (frame.result != HDLCFrameReader::Result::COMPLETE) {
+        releaseFrame(frame);
+        return false;
+    }
+    length = min<uint16_t>(frame.length, capacity - 1);
+    memcpy(buffer, rxSlots[frame.slot], length);
+    releaseFrame(frame);
+    buffer[length] = '\0';
+    return true;
+#else
+    if (!dlmsSerial) return false;
+    
+    uint32_t startTime = millis();
+    while (millis() - startTime < timeout) {
+        if (dlmsSerial->available()) {
+            char c = dlmsSerial->read() & 0x7F;
+            if (length < capacity - 1) buffer[length++] = c;
+            if (c == '\n') {
+                buffer[length] = '\0';
+                return true;
+            }
+            continue;
+        }
+        delay(1);
+    }
+    buffer[length] = '\0';
+    return false;
+#endif
+}
+
 int HardwareManager::available() {
     return dlmsSerial ? dlmsSerial->available() : 0;
 }
@@ -187,19 +607,47 @@ uint8_t HardwareManager::read() {
 }
 
 size_t HardwareManager::write(const uint8_t* data, size_t length) {
+#if UART_EVENTS
+    int written = uart_write_bytes(DLMS_UART_PORT, (const char*)data, length);
+    return written > 0 ? written : 0;
+#else
     if (!dlmsSerial) return 0;
+    if (RS485_DE_PIN >= 0) {
+        digitalWrite(RS485_DE_PIN, HIGH);   // Released in flush()
+    }
     return dlmsSerial->write(data, length);
+#endif
 }
 
 void HardwareManager::flush() {
+#if UART_EVENTS
+    uart_wait_tx_done(DLMS_UART_PORT, pdMS_TO_TICKS(COMMAND_TIMEOUT));
+#else
     if (dlmsSerial) {
         dlmsSerial->flush();
     }
+    if (RS485_DE_PIN >= 0) {
+        digitalWrite(RS485_DE_PIN, LOW);
+    }
+#endif
 }
 
 void HardwareManager::clearRxBuffer() {
+#if UART_EVENTS
+    if (!rxFrames) return;
+    uart_flush_input(DLMS_UART_PORT);
+    rxResetRequested = true;
+    
+    // Drain rather than reset, so queued slots go back to the reader task
+    RxFrame frame;
+    while (xQueueReceive(rxFrames, &frame, 0) == pdTRUE) {
+        releaseFrame(frame);
+    }
+#else
     if (!dlmsSerial) return;
     while (dlmsSerial->available()) {
         dlmsSerial->read();
     }
+    frameReader.reset();
+#endif
 }
@@ -9,7 +9,9 @@
 #define HARDWARE_MANAGER_H
 
 #include <Arduino.h>
+#include "../config/config.h"
 #include "../config/pins.h"
+#include "../utils/HDLCFrameReader.h"
 
 /**
  * @enum LEDColor
@@ -34,14 +36,22 @@ class HardwareManager {
 public:
     /**
      * @brief Initialize all hardware
+     * @param startup Show the LED startup sequence (not on a wake from deep sleep)
      */
-    static void begin();
+    static void begin(bool startup = true);
     
     /**
-     * @brief Initialize DLMS UART
+     * @brief Initialize DLMS UART, or change its rate and format
+     * 
+     * SERIAL_7E1 is the IEC 62056-21 sign-on format: while it is set,
+     * received bytes are collected into lines for receiveLine() instead
+     * of HDLC frames.
+     * 
      * @param baudRate Baud rate (default 9600)
+     * @param format SERIAL_8N1 (HDLC) or SERIAL_7E1 (sign-on)
      */
-    static void initDLMSSerial(uint32_t baudRate = DLMS_BAUD_RATE);
+    static void initDLMSSerial(uint32_t baudRate = DLMS_BAUD_RATE,
+                               uint32_t format = SERIAL_8N1);
     
     // ============================================
     // DTR CONTROL
@@ -60,49 +70,59 @@ public:
     // ============================================
     // LED CONTROL
     // ============================================
+    // Patterns are queued and played by an esp_timer, so none of these
+    // calls wait. The color set by setLED() shows whenever no pattern is
+    // playing.
     
     /**
-     * @brief Set LED color
+     * @brief Set the steady LED color
      * @param color Color to display
      */
     static void setLED(LEDColor color);
     
     /**
-     * @brief Turn all LEDs off
+     * @brief Steady LED color off
      */
     static void ledsOff();
     
     /**
-     * @brief Blink LED pattern
+     * @brief Queue a blink pattern
      * @param color Color to blink
      * @param count Number of blinks
      * @param onTime Time LED is on (ms)
      * @param offTime Time LED is off (ms)
+     * @param after Time LED stays off after the last blink (ms)
      */
     static void blinkLED(LEDColor color, uint8_t count = 1, 
-                        uint16_t onTime = 100, uint16_t offTime = 100);
+                        uint16_t onTime = 100, uint16_t offTime = 100,
+                        uint16_t after = 0);
     
     /**
-     * @brief Show error pattern
+     * @brief Queue error pattern
      * @param errorCode Error code (number of blinks)
      */
     static void showError(uint8_t errorCode);
     
     /**
-     * @brief Show success pattern
+     * @brief Queue success pattern
      */
     static void showSuccess();
     
     /**
-     * @brief Show activity pulse
+     * @brief Queue activity pulse
      */
     static void showActivity();
     
     /**
-     * @brief Show startup sequence
+     * @brief Queue startup sequence
      */
     static void startupSequence();
     
+    /**
+     * @brief Drop queued patterns and show the steady color (before sleep)
+     */
+    static void stopPatterns();
+    
     // ============================================
     // STATUS LED (Built-in)
     // ============================================
@@ -127,13 +147,41 @@ public:
     // ============================================
     
     /**
-     * @brief Check if DLMS serial is available
+     * @brief Receive one HDLC frame from the meter
+     * 
+     * With DLMS_UART_EVENT_DRIVEN a reader task assembles frames from
+     * UART driver events and this call only waits on the frame queue;
+     * otherwise Serial2 is polled. Either way a gap longer than
+     * HDLC_INTERCHAR_TIMEOUT inside a frame fails it immediately.
+     * 
+     * @param buffer Destination buffer
+     * @param capacity Buffer size
+     * @param length Output frame length (also set for BAD_FCS)
+     * @param timeout Time to wait for a frame (ms)
+     * @return COMPLETE, or the reason no valid frame was received
+     */
+    static HDLCFrameReader::Result receiveFrame(uint8_t* buffer, uint16_t capacity,
+                                                uint16_t& length, uint32_t timeout);
+    
+    /**
+     * @brief Receive one CR LF terminated line (SERIAL_7E1 only)
+     * @param buffer Destination buffer (terminated, line end included)
+     * @param capacity Buffer size
+     * @param length Output line length
+     * @param timeout Time to wait for the line end (ms)
+     * @return true if a complete line was received
+     */
+    static bool receiveLine(char* buffer, uint16_t capacity,
+                            uint16_t& length, uint32_t timeout);
+    
+    /**
+     * @brief Check if DLMS serial is available (polled mode)
      * @return Number of bytes available
      */
     static int available();
     
     /**
-     * @brief Read byte from DLMS serial
+     * @brief Read byte from DLMS serial (polled mode)
      * @return Byte read
      */
     static uint8_t read();
@@ -159,6 +207,27 @@ public:
 private:
     static HardwareSerial* dlmsSerial;
     static bool initialized;
+    static HDLCFrameReader frameReader;
+    
+    /**
+     * @brief Reader task: UART driver events to frame queue
+     */
+    static void uartEventTask(void* parameter);
+    
+    /**
+     * @brief Drive the RGB LED pins
+     */
+    static void writeLED(LEDColor color);
+    
+    /**
+     * @brief Show the next pattern step and arm the timer for its end
+     */
+    static void ledStep();
+    
+    /**
+     * @brief LED timer callback (esp_timer task)
+     */
+    static void ledTimer(void* parameter);
     
     // LED state tracking
     static bool statusLedState;
@@ -0,0 +1,69 @@
+/**
+ * @file MeterTransport.h
+ * @brief Frame-level link to the meter, replaceable per DLMSProtocol
+ * @version 2.0
+ * @date 2025-10-02
+ *
+ * DLMSProtocol always speaks HDLC: it writes whole frames and reads
+ * whole frames back, with the same Result codes and timing rules as
+ * the UART path. A transport decides how those frames reach the meter:
+ * UartTransport puts them on UART2, OpticalTransport signs on through
+ * the optical port first (IEC 62056-21 mode E), WrapperTransport maps
+ * them to the TCP wrapper (IEC 62056-47). The host build installs a
+ * simulated meter the same way.
+ */
+
+#ifndef METER_TRANSPORT_H
+#define METER_TRANSPORT_H
+
+#include <Arduino.h>
+#include "../utils/HDLCFrameReader.h"
+
+/**
+ * @class MeterTransport
+ * @brief Byte sink and frame source for one meter link
+ */
+class MeterTransport {
+public:
+    virtual ~MeterTransport() {}
+
+    /**
+     * @brief Bring the link up before SNRM (wake, sign-on, connect)
+     * @return true if frames can be exchanged
+     */
+    virtual bool open() = 0;
+
+    /**
+     * @brief Take the link down after DISC
+     */
+    virtual void close() = 0;
+
+    /**
+     * @brief Queue a frame for the meter
+     * @return Number of bytes accepted
+     */
+    virtual size_t write(const uint8_t* data, size_t length) = 0;
+
+    /**
+     * @brief Wait until written bytes are on the line
+     */
+    virtual void flush() = 0;
+
+    /**
+     * @brief Receive one HDLC frame
+     * @param buffer Destination buffer
+     * @param capacity Buffer size
+     * @param length Output frame length (also set for BAD_FCS)
+     * @param timeout Time to wait for a frame (ms)
+     * @return COMPLETE, or the reason no valid frame was received
+     */
+    virtual HDLCFrameReader::Result receiveFrame(uint8_t* buffer, uint16_t capacity,
+                                                 uint16_t& length, uint32_t timeout) = 0;
+
+    /**
+     * @brief Discard anything received but not yet read
+     */
+    virtual void clearRxBuffer() = 0;
+};
+
+#endif // METER_TRANSPORT_H
@@ -0,0 +1,76 @@
+/**
+ * @file OpticalTransport.cpp
+ * @brief Implementation of the optical port mode E sign-on
+ * @version 2.0
+ * @date 2025-10-02
+ */
+
+#include "OpticalTransport.h"
+#include "../utils/Logger.h"
+
+OpticalTransport::OpticalTransport() : baudRate(0) {
+    identification[0] = '\0';
+}
+
+uint32_t OpticalTransport::baudFor(char code) {
+    if (code < '0' || code > '6') return 0;
+    return SIGN_ON_BAUD << (code - '0');
+}
+
+bool OpticalTransport::open() {
+    baudRate = 0;
+    identification[0] = '\0';
+
+    // Request message: / ? [device address] ! CR LF
+    HardwareManager::initDLMSSerial(SIGN_ON_BAUD, SERIAL_7E1);
+    char message[48];
+    int length = snprintf(message, sizeof(message), "/?%s!\r\n", OPTICAL_DEVICE_ADDRESS);
+    HardwareManager::write((const uint8_t*)message, length);
+    HardwareManager::flush();
+
+    // Identification message: / XXX Z [\W] ident CR LF
+    uint16_t received;
+    if (!HardwareManager::receiveLine(message, sizeof(message), received, OPTICAL_IDENT_TIMEOUT) ||
+        received < 7 || message[0] != '/') {
+        LOG_ERROR("Optical sign-on: no identification");
+        return false;
+    }
+
+    size_t identLength = min<size_t>(received - 3, sizeof(identification) - 1);
+    memcpy(identification, &message[1], identLength);
+    identification[identLength] = '\0';
+
+    char code = message[4];
+    if (baudFor(code) == 0) {
+        LOG_ERRORF("Optical sign-on: %s offers no mode C/E baud rate", identification);
+        return false;
+    }
+    if (!strstr(message, "\\2")) {
+        LOG_WARNF("Optical sign-on: %s does not announce mode E, trying HDLC anyway",
+                  identification);
+    }
+
+    // Highest rate both sides support
+    while (code > '0' && baudFor(code) > OPTICAL_MAX_BAUD) code--;
+    baudRate = baudFor(code);
+
+    // Option select: ACK, protocol control '2' (HDLC), rate, mode '2' (binary)
+    const uint8_t select[] = { 0x06, '2', (uint8_t)code, '2', '\r', '\n' };
+    HardwareManager::write(select, sizeof(select));
+    HardwareManager::flush();
+
+    // Meter switches after its acknowledgement; anything it sends
+    // meanwhile is dropped with the receive buffer
+    HardwareManager::initDLMSSerial(baudRate, SERIAL_8N1);
+    delay(OPTICAL_SWITCH_DELAY);
+    HardwareManager::clearRxBuffer();
+
+    LOG_INFOF("Optical sign-on: %s, HDLC at %u baud", identification, (unsigned)baudRate);
+    return true;
+}
+
+void OpticalTransport::close() {
+    // No DTR on the optical probe: the meter leaves mode E by itself
+    HardwareManager::initDLMSSerial(SIGN_ON_BAUD, SERIAL_7E1);
+    baudRate = 0;
+}
@@ -0,0 +1,54 @@
+/**
+ * @file OpticalTransport.h
+ * @brief HDLC through the optical port after an IEC 62056-21 mode E sign-on
+ * @version 2.0
+ * @date 2025-10-02
+ *
+ * Every open() signs on at 300 baud 7E1: request "/?!", identification
+ * "/XXXZ\2..." with the meter's highest baud character Z, then the
+ * option select ACK '2' Z '2' switches both sides to HDLC at that rate
+ * (capped at OPTICAL_MAX_BAUD). close() leaves the UART at 300 baud so
+ * the next sign-on starts from a known state.
+ */
+
+#ifndef OPTICAL_TRANSPORT_H
+#define OPTICAL_TRANSPORT_H
+
+#include <Arduino.h>
+#include "UartTransport.h"
+
+/**
+ * @class OpticalTransport
+ * @brief UartTransport with a mode E sign-on in front of HDLC
+ */
+class OpticalTransport : public UartTransport {
+public:
+    OpticalTransport();
+
+    bool open() override;
+    void close() override;
+
+    /**
+     * @brief HDLC rate agreed in the last sign-on (0 if none)
+     */
+    uint32_t getBaudRate() const { return baudRate; }
+
+    /**
+     * @brief Identification message of the last sign-on, without "/" and CR LF
+     */
+    const char* getIdentification() const { return identification; }
+
+private:
+    static const uint32_t SIGN_ON_BAUD = 300;
+
+    uint32_t baudRate;
+    char identification[40];
+
+    /**
+     * @brief Baud rate of an IEC 62056-21 mode C/E baud character
+     * @return Rate, or 0 if the character is not '0'-'6'
+     */
+    static uint32_t baudFor(char code);
+};
+
+#endif // OPTICAL_TRANSPORT_H
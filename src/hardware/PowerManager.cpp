@@ -0,0 +1,230 @@
+/**
+ * @file PowerManager.cpp
+ * @brief Implementation of sleep control and energy accounting
+ * @version 2.0
+ * @date 2025-10-02
+ */
+
+#include "PowerManager.h"
+#include "../config/pins.h"
+#include "../utils/Logger.h"
+
+#ifdef ARDUINO_ARCH_ESP32
+#include <esp_sleep.h>
+#include <driver/gpio.h>
+
+static portMUX_TYPE accountLock = portMUX_INITIALIZER_UNLOCKED;
+#define ACCOUNT_LOCK()      portENTER_CRITICAL(&accountLock)
+#define ACCOUNT_UNLOCK()    portEXIT_CRITICAL(&accountLock)
+#else
+// Host build runs the stack on one thread
+#define ACCOUNT_LOCK()
+#define ACCOUNT_UNLOCK()
+#endif
+
+/**
+ * @struct Account
+ * @brief Time per state since power-on, kept through deep sleep
+ *
+ * Plain data only: RTC_DATA_ATTR survives deep sleep, but a constructor
+ * would run again on every boot.
+ */
+struct Account {
+    uint32_t magic;
+    uint64_t awakeMs;           // Up to awakeSince (this boot) or the last deep sleep
+    uint64_t wifiMs;            // Up to the last radioOff()
+    uint64_t lightSleepMs;
+    uint64_t deepSleepMs;
+    uint32_t pendingDeepMs;     // Deep sleep in progress, counted on its timer wake
+    uint32_t wakeups;
+    uint32_t readings;
+};
+
+static const uint32_t ACCOUNT_MAGIC = 0x50574D31;     // "PWM1"
+
+RTC_DATA_ATTR static Account account;
+
+WakeCause PowerManager::wakeCause = WakeCause::POWER_ON;
+bool PowerManager::deepResume = false;
+uint32_t PowerManager::awakeSince = 0;
+bool PowerManager::radio = false;
+uint32_t PowerManager::radioSince = 0;
+
+void PowerManager::begin() {
+    wakeCause = WakeCause::POWER_ON;
+#ifdef ARDUINO_ARCH_ESP32
+    switch (esp_sleep_get_wakeup_cause()) {
+        case ESP_SLEEP_WAKEUP_UNDEFINED: break;
+        case ESP_SLEEP_WAKEUP_TIMER:     wakeCause = WakeCause::TIMER; break;
+        default:                         wakeCause = WakeCause::OTHER; break;
+    }
+#endif
+
+    // RTC memory is only valid after a power-on if we wrote it
+    deepResume = false;
+    if (account.magic != ACCOUNT_MAGIC) {
+        memset(&account, 0, sizeof(account));
+        account.magic = ACCOUNT_MAGIC;
+    } else if (account.pendingDeepMs > 0 && wakeCause == WakeCause::TIMER) {
+        account.deepSleepMs += account.pendingDeepMs;
+        account.wakeups++;
+        deepResume = true;
+    }
+    account.pendingDeepMs = 0;
+    awakeSince = millis();
+}
+
+// ============================================
+// SLEEP
+// ============================================
+
+uint32_t PowerManager::lightSleep(uint32_t ms) {
+    uint32_t start = millis();
+
+#ifdef ARDUINO_ARCH_ESP32
+    esp_sleep_enable_timer_wakeup((uint64_t)ms * 1000);
+#if POWER_RX_WAKEUP
+    // UART2 is no UART wake source; a start bit on its RX pin is
+    gpio_wakeup_enable((gpio_num_t)DLMS_RXD_PIN, GPIO_INTR_LOW_LEVEL);
+    esp_sleep_enable_gpio_wakeup();
+#endif
+
+    esp_light_sleep_start();
+    wakeCause = esp_sleep_get_wakeup_cause() == ESP_SLEEP_WAKEUP_GPIO ?
+                WakeCause::METER_RX : WakeCause::TIMER;
+
+#if POWER_RX_WAKEUP
+    gpio_wakeup_disable((gpio_num_t)DLMS_RXD_PIN);
+    esp_sleep_disable_wakeup_source(ESP_SLEEP_WAKEUP_GPIO);
+#endif
+#else
+    delay(ms);
+    wakeCause = WakeCause::TIMER;
+#endif
+
+    // millis() runs on through light sleep
+    uint32_t end = millis();
+    uint32_t slept = end - start;
+
+    ACCOUNT_LOCK();
+    account.awakeMs += start - awakeSince;
+    account.lightSleepMs += slept;
+    account.wakeups++;
+    awakeSince = end;
+    ACCOUNT_UNLOCK();
+
+    return slept;
+}
+
+void PowerManager::deepSleep(uint32_t ms) {
+#ifndef ARDUINO_ARCH_ESP32
+    // Host build has no RTC domain to boot from
+    lightSleep(ms);
+#else
+    LOG_INFOF("Deep sleep for %u ms", (unsigned)ms);
+
+    // Give the logger and the console time to empty before power goes
+    delay(50);
+    Serial.flush();
+
+    ACCOUNT_LOCK();
+    account.awakeMs += millis() - awakeSince;
+    if (radio) {
+        account.wifiMs += millis() - radioSince;
+        radio = false;
+    }
+    account.pendingDeepMs = ms;
+    ACCOUNT_UNLOCK();
+
+    esp_sleep_enable_timer_wakeup((uint64_t)ms * 1000);
+    esp_deep_sleep_start();
+#endif
+}
+
+// ============================================
+// ACCOUNTING
+// ============================================
+
+void PowerManager::radioOn() {
+    ACCOUNT_LOCK();
+    if (!radio) {
+        radio = true;
+        radioSince = millis();
+    }
+    ACCOUNT_UNLOCK();
+}
+
+void PowerManager::radioOff() {
+    ACCOUNT_LOCK();
+    if (radio) {
+        account.wifiMs += millis() - radioSince;
+        radio = false;
+    }
+    ACCOUNT_UNLOCK();
+}
+
+void PowerManager::countReading() {
+    ACCOUNT_LOCK();
+    account.readings++;
+    ACCOUNT_UNLOCK();
+}
+
+PowerStats PowerManager::stats() {
+    PowerStats stats;
+
+    ACCOUNT_LOCK();
+    uint32_t now = millis();
+    stats.awakeMs = account.awakeMs + (now - awakeSince);
+    stats.wifiMs = account.wifiMs + (radio ? now - radioSince : 0);
+    stats.lightSleepMs = account.lightSleepMs;
+    stats.deepSleepMs = account.deepSleepMs;
+    stats.wakeups = account.wakeups;
+    stats.readings = account.readings;
+    ACCOUNT_UNLOCK();
+
+    // mA x ms = uC; radio current comes on top of the awake current
+    double charge = (double)stats.awakeMs * POWER_ACTIVE_MA +
+                    (double)stats.wifiMs * POWER_WIFI_MA +
+                    (double)stats.lightSleepMs * POWER_LIGHT_SLEEP_MA +
+                    (double)stats.deepSleepMs * POWER_DEEP_SLEEP_MA;
+    uint64_t total = stats.awakeMs + stats.lightSleepMs + stats.deepSleepMs;
+
+    stats.energy = charge * POWER_SUPPLY_VOLTAGE / 1e6;
+    stats.averageCurrent = total ? charge / total : 0;
+    stats.perReading = stats.readings ? stats.energy * 1000 / stats.readings : 0;
+    return stats;
+}
+
+void PowerStats::toJson(JsonObject out) const {
+    out["mode"] = POWER_MODE;
+    out["awake_s"] = (uint32_t)(awakeMs / 1000);
+    out["wifi_s"] = (uint32_t)(wifiMs / 1000);
+    out["light_sleep_s"] = (uint32_t)(lightSleepMs / 1000);
+    out["deep_sleep_s"] = (uint32_t)(deepSleepMs / 1000);
+    out["wakeups"] = wakeups;
+    out["readings"] = readings;
+    out["energy_j"] = energy;
+    out["avg_ma"] = averageCurrent;
+    out["reading_mj"] = perReading;
+}
+
+void PowerStats::toPrometheus(MetricsTextSink& sink) const {
+    char text[768];
+    int n = snprintf(text, sizeof(text),
+                     "# TYPE device_power_state_seconds counter\n"
+                     "device_power_state_seconds{state=\"awake\"} %.3f\n"
+                     "device_power_state_seconds{state=\"wifi\"} %.3f\n"
+                     "device_power_state_seconds{state=\"light_sleep\"} %.3f\n"
+                     "device_power_state_seconds{state=\"deep_sleep\"} %.3f\n"
+                     "# TYPE device_wakeups_total counter\n"
+                     "device_wakeups_total %lu\n"
+                     "# TYPE device_energy_joules counter\n"
+                     "device_energy_joules %.3f\n"
+                     "# TYPE device_current_average_milliamps gauge\n"
+                     "device_current_average_milliamps %.3f\n"
+                     "# TYPE device_energy_per_reading_joules gauge\n"
+                     "device_energy_per_reading_joules %.6f\n",
+                     awakeMs / 1000.0, wifiMs / 1000.0, lightSleepMs / 1000.0, deepSleepMs / 1000.0,
+                     (unsigned long)wakeups, energy, averageCurrent, perReading / 1000.0);
+    if (n > 0) sink.write(text, (size_t)n < sizeof(text) ? (size_t)n : sizeof(text) - 1);
+}
@@ -0,0 +1,121 @@
+/**
+ * @file PowerManager.h
+ * @brief Sleep between polls and the energy account behind energy per reading
+ * @version 2.0
+ * @date 2025-10-02
+ *
+ * POWER_LIGHT_SLEEP stops both cores between polls with RAM kept and
+ * wakes on the timer (or the meter's RX line); POWER_DEEP_SLEEP powers
+ * down to the RTC and boots again, so whatever must survive lives in
+ * RTC memory. Time in each state is accounted in RTC memory as well and
+ * weighted with the POWER_*_MA currents: the energy figures are a model
+ * of the board, exact only as far as those currents are.
+ */
+
+#ifndef POWER_MANAGER_H
+#define POWER_MANAGER_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include "../config/config.h"
+#include "../dlms/LinkMetrics.h"
+
+/**
+ * @enum WakeCause
+ * @brief Why the chip is running
+ */
+enum class WakeCause : uint8_t {
+    POWER_ON,       // Cold boot or reset
+    TIMER,          // Sleep timer expired
+    METER_RX,       // Meter RX line (light sleep)
+    OTHER
+};
+
+/**
+ * @struct PowerStats
+ * @brief Time in each power state since power-on, and the energy it cost
+ */
+struct PowerStats {
+    uint64_t awakeMs;           // CPU running, radio on or off
+    uint64_t wifiMs;            // Radio on (part of awakeMs)
+    uint64_t lightSleepMs;
+    uint64_t deepSleepMs;
+    uint32_t wakeups;           // Sleeps ended
+    uint32_t readings;          // Successful meter readings
+    float energy;               // J, modelled
+    float averageCurrent;       // mA over all states
+    float perReading;           // mJ per successful reading (0 before the first)
+
+    /**
+     * @brief Compact summary for the status message
+     */
+    void toJson(JsonObject out) const;
+
+    /**
+     * @brief Prometheus text exposition
+     */
+    void toPrometheus(MetricsTextSink& sink) const;
+};
+
+/**
+ * @class PowerManager
+ * @brief Chip sleep and per-state time accounting
+ *
+ * Sleep is entered by the metering task once the network task has gone
+ * idle with the radio off; radioOn()/radioOff() come from the network
+ * task. Each counter has one writer, a short lock covers the reader.
+ */
+class PowerManager {
+public:
+    /**
+     * @brief Read the wake cause and resume the account kept in RTC memory
+     */
+    static void begin();
+
+    /**
+     * @brief Why the chip is running
+     */
+    static WakeCause getWakeCause() { return wakeCause; }
+
+    /**
+     * @brief Booted from deep sleep with RTC memory intact
+     */
+    static bool resumed() { return deepResume; }
+
+    /**
+     * @brief Light sleep with RAM and task state kept
+     * @param ms Sleep time
+     * @return Time actually slept (less if the meter RX line woke us)
+     */
+    static uint32_t lightSleep(uint32_t ms);
+
+    /**
+     * @brief Deep sleep; the chip boots again after ms (does not return)
+     */
+    static void deepSleep(uint32_t ms);
+
+    /**
+     * @brief Radio switched on or off
+     */
+    static void radioOn();
+    static void radioOff();
+
+    /**
+     * @brief Count one successful reading
+     */
+    static void countReading();
+
+    /**
+     * @brief Current account with modelled energy
+     */
+    static PowerStats stats();
+
+private:
+    static WakeCause wakeCause;
+    static bool deepResume;
+    static uint32_t awakeSince;         // millis() of the last wake
+    static bool radio;
+    static uint32_t radioSince;         // millis() the radio came on
+};
+
+#endif // POWER_MANAGER_H
@@ -0,0 +1,34 @@
+/**
+ * @file UartTransport.cpp
+ * @brief Implementation of HDLC on UART2
+ * @version 2.0
+ * @date 2025-10-02
+ */
+
+#include "UartTransport.h"
+
+bool UartTransport::open() {
+    HardwareManager::wakeupMeter();
+    return true;
+}
+
+void UartTransport::close() {
+    HardwareManager::sleepMeter();
+}
+
+size_t UartTransport::write(const uint8_t* data, size_t length) {
+    return HardwareManager::write(data, length);
+}
+
+void UartTransport::flush() {
+    HardwareManager::flush();
+}
+
+HDLCFrameReader::Result UartTransport::receiveFrame(uint8_t* buffer, uint16_t capacity,
+                                                    uint16_t& length, uint32_t timeout) {
+    return HardwareManager::receiveFrame(buffer, capacity, length, timeout);
+}
+
+void UartTransport::clearRxBuffer() {
+    HardwareManager::clearRxBuffer();
+}
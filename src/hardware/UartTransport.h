@@ -0,0 +1,34 @@
+/**
+ * @file UartTransport.h
+ * @brief HDLC on UART2 (wired port or RS-485 segment)
+ * @version 2.0
+ * @date 2025-10-02
+ */
+
+#ifndef UART_TRANSPORT_H
+#define UART_TRANSPORT_H
+
+#include <Arduino.h>
+#include "HardwareManager.h"
+#include "MeterTransport.h"
+
+/**
+ * @class UartTransport
+ * @brief Meter link through HardwareManager's DLMS UART
+ *
+ * The UART is set up by HardwareManager::begin() at DLMS_BAUD_RATE;
+ * open() and close() only wake the meter and put it back to sleep
+ * through DTR.
+ */
+class UartTransport : public MeterTransport {
+public:
+    bool open() override;
+    void close() override;
+    size_t write(const uint8_t* data, size_t length) override;
+    void flush() override;
+    HDLCFrameReader::Result receiveFrame(uint8_t* buffer, uint16_t capacity,
+                                         uint16_t& length, uint32_t timeout) override;
+    void clearRxBuffer() override;
+};
+
+#endif // UART_TRANSPORT_H
@@ -0,0 +1,326 @@
+/**
+ * @file WrapperTransport.cpp
+ * @brief Implementation of the IEC 62056-47 TCP wrapper transport
+ * @version 2.0
+ * @date 2025-10-02
+ */
+
+#include "../config/config.h"
+
+#if METER_TRANSPORT == METER_TRANSPORT_TCP
+
+#include "WrapperTransport.h"
+#include "../utils/CRCCalculator.h"
+#include "../utils/Logger.h"
+
+// HDLC control fields (poll/final bit masked off)
+static const uint8_t CONTROL_SNRM = 0x83;
+static const uint8_t CONTROL_DISC = 0x43;
+static const uint8_t CONTROL_UA = 0x73;
+static const uint8_t CONTROL_RR = 0x01;
+static const uint8_t POLL_FINAL = 0x10;
+static const uint8_t SEGMENT_BIT = 0x08;
+
+// LLC header of a response
+static const uint8_t LLC_RESPONSE[] = { 0xE6, 0xE7, 0x00 };
+
+WrapperTransport::WrapperTransport(const char* host, uint16_t port)
+    : host(host),
+      port(port),
+      reply(Reply::NONE),
+      addressLength(0),
+      clientPort(0),
+      serverPort(0),
+      sendSequence(0),
+      receiveSequence(0),
+      maxInfo(128),
+      parametersLength(0),
+      apduLength(0),
+      apduOffset(0),
+      apduReady(false) {
+}
+
+// ============================================
+// CONNECTION
+// ============================================
+
+bool WrapperTransport::open() {
+    // The association lives as long as the connection, so a new one
+    // always starts on a fresh connection
+    reply = Reply::NONE;
+    client.stop();
+
+    LOG_INFOF("Connecting to meter at %s:%u", host, port);
+    if (!client.connect(host, port, WRAPPER_CONNECT_TIMEOUT)) {
+        LOG_ERRORF("TCP connect to %s:%u failed", host, port);
+        return false;
+    }
+    client.setNoDelay(true);
+    return true;
+}
+
+void WrapperTransport::close() {
+    reply = Reply::NONE;
+    client.stop();
+}
+
+void WrapperTransport::clearRxBuffer() {
+    apduReady = false;
+    while (client.available()) {
+        client.read();
+    }
+}
+
+// ============================================
+// HDLC TO WRAPPER
+// ============================================
+
+size_t WrapperTransport::write(const uint8_t* frame, size_t length) {
+    // Destination (server) address ends with the first byte that has its LSB set
+    uint8_t n = 0;
+    while ((size_t)3 + n < length && !(frame[3 + n] & 0x01)) n++;
+    n++;
+    if (length < (size_t)8 + n || frame[0] != HDLC_FLAG || (n != 1 && n != 2 && n != 4)) {
+        LOG_ERROR("Wrapper: malformed HDLC frame");
+        return 0;
+    }
+
+    uint8_t control = frame[4 + n];
+    const uint8_t* info = &frame[7 + n];
+    uint16_t infoLength = length > (size_t)8 + n ? length - (10 + n) : 0;
+
+    // Replies go back with source and destination swapped
+    address[0] = frame[3 + n];
+    memcpy(&address[1], &frame[3], n);
+    addressLength = n + 1;
+    clientPort = frame[3 + n] >> 1;
+    serverPort = n == 4 ? ((frame[3] >> 1) << 7) | (frame[4] >> 1) : frame[3] >> 1;
+
+    if ((control & 0x01) == 0) {
+        // I-frame: LLC E6 E6 00 followed by the APDU
+        if ((frame[1] & SEGMENT_BIT) || infoLength < 3 || info[0] != 0xE6) {
+            LOG_ERROR("Wrapper: segmented or non-LLC request not supported");
+            return 0;
+        }
+        uint16_t apduSize = infoLength - 3;
+        packet[0] = VERSION >> 8;
+        packet[1] = VERSION & 0xFF;
+        packet[2] = clientPort >> 8;
+        packet[3] = clientPort & 0xFF;
+        packet[4] = serverPort >> 8;
+        packet[5] = serverPort & 0xFF;
+        packet[6] = apduSize >> 8;
+        packet[7] = apduSize & 0xFF;
+        memcpy(&packet[HEADER_SIZE], &info[3], apduSize);
+
+        if (client.write(packet, HEADER_SIZE + apduSize) != (size_t)HEADER_SIZE + apduSize) {
+            LOG_ERROR("Wrapper: TCP write failed");
+            client.stop();
+            reply = Reply::NONE;
+            return 0;
+        }
+
+        // Meter answers with its N(S) = our N(R) and acknowledges our N(S)
+        sendSequence = control >> 5;
+        receiveSequence = ((control >> 1) + 1) & 0x07;
+        apduReady = false;
+        reply = Reply::DATA;
+        return length;
+    }
+
+    switch (control & ~POLL_FINAL) {
+        case CONTROL_SNRM:
+            acceptParameters(info, infoLength);
+            reply = Reply::UA;
+            break;
+        case CONTROL_DISC:
+            parametersLength = 0;
+            reply = Reply::UA;
+            break;
+        default:
+            // Keep-alive only means something while the socket is up
+            reply = (control & 0x0F) == CONTROL_RR && client.connected() ?
+                    Reply::RR : Reply::NONE;
+            break;
+    }
+    return length;
+}
+
+void WrapperTransport::acceptParameters(const uint8_t* info, uint16_t length) {
+    maxInfo = 128;
+    parametersLength = 0;
+
+    // 81 80 <group length> { id, length, value }... echoed from the meter's
+    // side: our transmit limits become its receive limits and vice versa
+    if (length < 3 || info[0] != 0x81 || info[1] != 0x80 ||
+        length > sizeof(parameters)) {
+        return;
+    }
+    memcpy(parameters, info, length);
+    parametersLength = length;
+
+    uint16_t end = min<uint16_t>(3 + info[2], length);
+    for (uint16_t i = 3; i + 2 <= end; ) {
+        uint8_t& id = parameters[i];
+        uint8_t size = parameters[i + 1];
+        if (i + 2 + size > end) break;
+
+        if (id == 0x06 && size > 0 && size <= 4) {
+            uint32_t value = 0;
+            for (uint8_t b = 0; b < size; b++) value = (value << 8) | parameters[i + 2 + b];
+            maxInfo = min<uint32_t>(max<uint32_t>(value, 32), MAX_FRAME_SIZE - 16);
+        }
+        if (id == 0x05 || id == 0x07) id++;
+        else if (id == 0x06 || id == 0x08) id--;
+        i += 2 + size;
+    }
+}
+
+// ============================================
+// WRAPPER TO HDLC
+// ============================================
+
+HDLCFrameReader::Result WrapperTransport::receiveFrame(uint8_t* buffer, uint16_t capacity,
+                                                       uint16_t& length, uint32_t timeout) {
+    length = 0;
+
+    switch (reply) {
+        case Reply::UA:
+            reply = Reply::NONE;
+            length = buildFrame(buffer, capacity, CONTROL_UA | POLL_FINAL, false,
+                                parameters, parametersLength, nullptr, 0);
+            return length ? HDLCFrameReader::Result::COMPLETE : HDLCFrameReader::Result::BAD_LENGTH;
+
+        case Reply::RR:
+            reply = Reply::NONE;
+            length = buildFrame(buffer, capacity,
+                                (receiveSequence << 5) | POLL_FINAL | CONTROL_RR, false,
+                                nullptr, 0, nullptr, 0);
+            return length ? HDLCFrameReader::Result::COMPLETE : HDLCFrameReader::Result::BAD_LENGTH;
+
+        case Reply::DATA:
+            break;
+
+        default:
+            return HDLCFrameReader::Result::TIMEOUT;
+    }
+
+    if (!apduReady) {
+        HDLCFrameReader::Result result = readPdu(timeout);
+        if (result != HDLCFrameReader::Result::COMPLETE) {
+            reply = Reply::NONE;
+            return result;
+        }
+        apduReady = true;
+        apduOffset = 0;
+    }
+
+    // First segment carries the LLC header
+    bool first = apduOffset == 0;
+    uint16_t room = maxInfo - (first ? sizeof(LLC_RESPONSE) : 0);
+    uint16_t chunk = min<uint16_t>(apduLength - apduOffset, room);
+    bool last = apduOffset + chunk >= apduLength;
+
+    uint8_t control = (receiveSequence << 5) | (last ? POLL_FINAL : 0) | (sendSequence << 1);
+    length = buildFrame(buffer, capacity, control, !last,
+                        first ? LLC_RESPONSE : nullptr, first ? sizeof(LLC_RESPONSE) : 0,
+                        &apdu[apduOffset], chunk);
+    if (length == 0) {
+        reply = Reply::NONE;
+        return HDLCFrameReader::Result::BAD_LENGTH;
+    }
+
+    apduOffset += chunk;
+    sendSequence = (sendSequence + 1) & 0x07;
+    if (last) {
+        reply = Reply::NONE;
+        apduReady = false;
+    }
+    return HDLCFrameReader::Result::COMPLETE;
+}
+
+HDLCFrameReader::Result WrapperTransport::readPdu(uint32_t timeout) {
+    uint32_t start = millis();
+    uint8_t header[HEADER_SIZE];
+
+    while (true) {
+        uint16_t got = readBytes(header, HEADER_SIZE, start, timeout);
+        if (got == 0) return HDLCFrameReader::Result::TIMEOUT;
+        if (got < HEADER_SIZE) break;
+
+        uint16_t version = (header[0] << 8) | header[1];
+        uint16_t destination = (header[4] << 8) | header[5];
+        apduLength = (header[6] << 8) | header[7];
+
+        if (version != VERSION) {
+            LOG_ERRORF("Wrapper: version %u", version);
+            break;
+        }
+        if (apduLength > sizeof(apdu)) {
+            LOG_ERRORF("Wrapper: %u byte APDU exceeds %u", apduLength, DLMS_MAX_PDU_SIZE);
+            client.stop();
+            return HDLCFrameReader::Result::BAD_LENGTH;
+        }
+        if (readBytes(apdu, apduLength, start, timeout) < apduLength) break;
+
+        // Unsolicited PDUs for other clients (event notifications) are skipped
+        if (destination == clientPort) {
+            return HDLCFrameReader::Result::COMPLETE;
+        }
+        LOG_WARNF("Wrapper: dropped PDU for wPort %u", destination);
+    }
+
+    // Stream position is lost; the next open() reconnects
+    LOG_ERROR("Wrapper: incomplete PDU");
+    client.stop();
+    return HDLCFrameReader::Result::TRUNCATED;
+}
+
+uint16_t WrapperTransport::readBytes(uint8_t* buffer, uint16_t count,
+                                     uint32_t start, uint32_t timeout) {
+    uint16_t got = 0;
+    while (got < count && millis() - start < timeout) {
+        int available = client.available();
+        if (available > 0) {
+            int n = client.read(&buffer[got], min<int>(available, count - got));
+            if (n > 0) got += n;
+            continue;
+        }
+        if (!client.connected()) break;
+        delay(1);
+    }
+    return got;
+}
+
+uint16_t WrapperTransport::buildFrame(uint8_t* buffer, uint16_t capacity, uint8_t control,
+                                      bool segmented, const uint8_t* prefix, uint16_t prefixLength,
+                                      const uint8_t* info, uint16_t infoLength) const {
+    uint16_t infoTotal = prefixLength + infoLength;
+    uint16_t length = 1 + 2 + addressLength + 1 + 2 + (infoTotal ? infoTotal + 2 : 0) + 1;
+    if (length > capacity) return 0;
+
+    uint16_t frameLength = length - 2;
+    buffer[0] = HDLC_FLAG;
+    buffer[1] = 0xA0 | (segmented ? SEGMENT_BIT : 0) | ((frameLength >> 8) & 0x07);
+    buffer[2] = frameLength & 0xFF;
+    memcpy(&buffer[3], address, addressLength);
+
+    uint16_t i = 3 + addressLength;
+    buffer[i++] = control;
+    CRCCalculator::put(&buffer[i], CRCCalculator::calculate(&buffer[1], i - 1));
+    i += 2;
+
+    if (infoTotal) {
+        if (prefixLength) memcpy(&buffer[i], prefix, prefixLength);
+        i += prefixLength;
+        if (infoLength) memcpy(&buffer[i], info, infoLength);
+        i += infoLength;
+        CRCCalculator::put(&buffer[i], CRCCalculator::calculate(&buffer[1], i - 1));
+        i += 2;
+    }
+
+    buffer[i++] = HDLC_FLAG;
+    return i;
+}
+
+#endif // METER_TRANSPORT == METER_TRANSPORT_TCP
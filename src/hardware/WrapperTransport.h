@@ -0,0 +1,127 @@
+/**
+ * @file WrapperTransport.h
+ * @brief DLMS over TCP with the IEC 62056-47 wrapper (meter or GPRS modem)
+ * @version 2.0
+ * @date 2025-10-02
+ *
+ * The wrapper carries bare APDUs behind an 8-byte header (version 1,
+ * source wPort, destination wPort, length); there is no HDLC link on
+ * the wire. DLMSProtocol still speaks HDLC, so this transport terminates
+ * the link locally: SNRM and DISC are answered with UA, keep-alive RR
+ * with RR, and each I-frame's APDU is sent as one wrapper PDU. The reply
+ * APDU comes back as I-frames with the sequence numbers the request
+ * expects, segmented at the information field size proposed in SNRM.
+ * wPorts are the HDLC SAPs of the request (client SAP, logical device).
+ */
+
+#ifndef WRAPPER_TRANSPORT_H
+#define WRAPPER_TRANSPORT_H
+
+#include <Arduino.h>
+#include <WiFiClient.h>
+#include "../config/config.h"
+#include "MeterTransport.h"
+
+/**
+ * @class WrapperTransport
+ * @brief MeterTransport over a TCP connection to the meter
+ */
+class WrapperTransport : public MeterTransport {
+public:
+    /**
+     * @brief Constructor
+     * @param host Meter or modem address
+     * @param port TCP port (4059 is the IANA DLMS/COSEM port)
+     */
+    WrapperTransport(const char* host, uint16_t port);
+
+    /**
+     * @brief Open a new connection (closing any previous one)
+     */
+    bool open() override;
+
+    /**
+     * @brief Close the connection
+     */
+    void close() override;
+
+    size_t write(const uint8_t* data, size_t length) override;
+    void flush() override {}
+    HDLCFrameReader::Result receiveFrame(uint8_t* buffer, uint16_t capacity,
+                                         uint16_t& length, uint32_t timeout) override;
+    void clearRxBuffer() override;
+
+private:
+    /**
+     * @enum Reply
+     * @brief What the last request is answered with
+     */
+    enum class Reply : uint8_t {
+        NONE,
+        UA,             // SNRM or DISC, answered locally
+        RR,             // Keep-alive, answered locally
+        DATA            // I-frame, answered by the meter
+    };
+
+    static const uint8_t HEADER_SIZE = 8;
+    static const uint16_t VERSION = 0x0001;
+
+    WiFiClient client;
+    const char* host;
+    uint16_t port;
+
+    Reply reply;
+    uint8_t address[5];             // Reply addresses: client, then server (1-4)
+    uint8_t addressLength;
+    uint16_t clientPort;            // wPorts of the pending request
+    uint16_t serverPort;
+    uint8_t sendSequence;           // Meter side N(S) of the next reply segment
+    uint8_t receiveSequence;        // Meter side N(R)
+    uint16_t maxInfo;               // Information field per reply segment
+    uint8_t parameters[32];         // UA negotiation field (empty for DISC)
+    uint8_t parametersLength;
+
+    uint8_t packet[HEADER_SIZE + MAX_FRAME_SIZE];   // Outgoing wrapper PDU
+    uint8_t apdu[DLMS_MAX_PDU_SIZE];                // Reply APDU
+    uint16_t apduLength;
+    uint16_t apduOffset;            // Bytes already returned as segments
+    bool apduReady;
+
+    /**
+     * @brief Take link parameters from SNRM and prepare the UA field
+     * @param info SNRM information field
+     * @param length Field length (0 for a plain SNRM)
+     */
+    void acceptParameters(const uint8_t* info, uint16_t length);
+
+    /**
+     * @brief Read one wrapper PDU addressed to the client into apdu
+     * @param timeout Time to wait (ms)
+     * @return COMPLETE, TIMEOUT, TRUNCATED or BAD_LENGTH
+     */
+    HDLCFrameReader::Result readPdu(uint32_t timeout);
+
+    /**
+     * @brief Read exactly count bytes before the deadline
+     * @return Bytes read
+     */
+    uint16_t readBytes(uint8_t* buffer, uint16_t count, uint32_t start, uint32_t timeout);
+
+    /**
+     * @brief Build a reply frame with the pending addresses
+     * @param buffer Output buffer
+     * @param capacity Buffer size
+     * @param control Control field
+     * @param segmented Set the segmentation bit
+     * @param prefix First part of the information field (may be nullptr)
+     * @param prefixLength Its length
+     * @param info Rest of the information field (may be nullptr)
+     * @param infoLength Its length
+     * @return Frame length (0 if it does not fit)
+     */
+    uint16_t buildFrame(uint8_t* buffer, uint16_t capacity, uint8_t control, bool segmented,
+                        const uint8_t* prefix, uint16_t prefixLength,
+                        const uint8_t* info, uint16_t infoLength) const;
+};
+
+#endif // WRAPPER_TRANSPORT_H
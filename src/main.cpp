@@ -8,69 +8,373 @@
 #include <Arduino.h>
 #include <WiFi.h>
 #include <PubSubClient.h>
-#include <HTTPClient.h>
 #include <ArduinoJson.h>
+#include <Preferences.h>
 
 #include "config/config.h"
 #include "config/pins.h"
 #include "utils/Logger.h"
 #include "utils/CRCCalculator.h"
 #include "hardware/HardwareManager.h"
+#include "hardware/PowerManager.h"
+#if METER_TRANSPORT == METER_TRANSPORT_OPTICAL
+#include "hardware/OpticalTransport.h"
+#elif METER_TRANSPORT == METER_TRANSPORT_TCP
+#include "hardware/WrapperTransport.h"
+#endif
 #include "dlms/DLMSProtocol.h"
 #include "dlms/OBISCodes.h"
+#include "dlms/MeterBus.h"
+#include "dlms/ReadPlan.h"
+#include "dlms/PollSchedule.h"
+#include "dlms/LinkMetrics.h"
 #include "data/MeterData.h"
+#include "data/PayloadEncoder.h"
+#include "data/OfflineLog.h"
+#include "data/ReadingBatch.h"
+#include "data/EdgeAggregator.h"
+#include "data/ChangeReporter.h"
+#include "utils/DLMSDateTime.h"
+#include "utils/SPSCQueue.h"
+#include "utils/SystemMetrics.h"
+#include "utils/BootProfile.h"
+#include "utils/BufferedPrint.h"
+#include "cloud/WiFiLink.h"
+#include "cloud/CommandTracker.h"
+#include "cloud/UplinkSink.h"
+#include "cloud/HttpSinks.h"
 
 // ============================================
 // GLOBAL OBJECTS
 // ============================================
 
+// Metering task: DLMS link and the reading being assembled
 DLMSProtocol dlms;
+MeterData meterReading;
+PollSchedule pollSchedule;
+
+#if METER_BUS_SIZE > 0
+MeterBus meterBus;
+#endif
+
+// Meter link other than UART2 (DLMSProtocol defaults to UART2)
+#if METER_TRANSPORT == METER_TRANSPORT_OPTICAL
+OpticalTransport meterLink;
+#elif METER_TRANSPORT == METER_TRANSPORT_TCP
+WrapperTransport meterLink(WRAPPER_HOST, WRAPPER_PORT);
+#endif
+
+// Network task: latest readings as received from the metering task
 MeterData meterData;
+#if METER_BUS_SIZE > 0
+MeterData busData[METER_BUS_SIZE];
+#endif
 
 WiFiClient wifiClient;
 PubSubClient mqttClient(wifiClient);
 
+// Binary payloads are encoded in place, no heap involved
+uint8_t payloadBuffer[MQTT_BUFFER_SIZE];
+
+// Readings the broker could not take, replayed on reconnect
+OfflineLog offlineLog;
+
+// Backends replaying the offline log on tasks of their own (nullptr-terminated)
+#if HTTP_ENABLED
+HttpSink httpSink;
+#endif
+#if THINGSPEAK_ENABLED
+ThingSpeakSink thingSpeakSink;
+#endif
+UplinkSink* const uplinkSinks[] = {
+#if HTTP_ENABLED
+    &httpSink,
+#endif
+#if THINGSPEAK_ENABLED
+    &thingSpeakSink,
+#endif
+    nullptr
+};
+static const uint8_t UPLINK_SINKS = sizeof(uplinkSinks) / sizeof(uplinkSinks[0]) - 1;
+
+// Cursors of backends that are not configured never fall behind
+static const uint8_t ALL_CURSORS = (1 << LogCursor::COUNT) - 1;
+static const uint8_t IDLE_CURSORS = (MQTT_ENABLED ? 0 : 1 << LogCursor::MQTT) |
+                                    (HTTP_ENABLED ? 0 : 1 << LogCursor::HTTP) |
+                                    (THINGSPEAK_ENABLED ? 0 : 1 << LogCursor::THINGSPEAK);
+
+// Registers read at this site (table defaults unless CONFIG_FILE overrides)
+ReadPlan readPlan;
+
+// Readings queued for the batched uplink, one batch per meter
+#if METER_BUS_SIZE > 0
+ReadingBatch batches[METER_BUS_SIZE];
+#else
+ReadingBatch batches[1];
+#endif
+
+// Deadband state for report-by-exception, one per meter
+#if METER_BUS_SIZE > 0
+ChangeReporter reporters[METER_BUS_SIZE];
+#else
+ChangeReporter reporters[1];
+#endif
+
+// Latest link metrics from the metering task, one per meter
+#if METER_BUS_SIZE > 0
+LinkMetrics linkMetrics[METER_BUS_SIZE];
+#else
+LinkMetrics linkMetrics[1];
+#endif
+SystemMetrics systemMetrics;
+
+// Power-quality windows over the instantaneous values, one per meter
+#if METER_BUS_SIZE > 0
+EdgeAggregator aggregators[METER_BUS_SIZE];
+#else
+EdgeAggregator aggregators[1];
+#endif
+
+/**
+ * @class BacklogUploader
+ * @brief Publishes replayed offline readings (schema 0x01, self-identifying)
+ */
+class BacklogUploader : public OfflineRecordSink {
+public:
+    bool onRecord(const uint8_t* payload, size_t length) override;
+};
+
+/**
+ * @class PQPublisher
+ * @brief Publishes power-quality window summaries and limit crossings
+ *
+ * Summaries are statistics, not readings: one the broker cannot take
+ * is dropped rather than logged offline.
+ */
+class PQPublisher : public AggregateSink {
+public:
+    void onWindow(const WindowSummary& summary) override;
+    void onEvent(const ThresholdEvent& event) override;
+};
+
+// ============================================
+// TASK QUEUES
+// ============================================
+
+/**
+ * @struct MeterReport
+ * @brief A successful reading, metering task -> network task
+ */
+struct MeterReport {
+    MeterData data;
+    uint8_t meter;          // Bus index (0 without a bus)
+    bool upload;            // Publish now instead of on UPLOAD_INTERVAL
+};
+
+/**
+ * @struct ProfileChunk
+ * @brief Load profile rows for one uplink message
+ *
+ * after is the capture time the chunk continues from; the network task
+ * only publishes a chunk that continues from the last row it
+ * committed, so a failed publish never leaves a gap.
+ */
+struct ProfileChunk {
+    uint32_t after;
+    uint8_t count;
+    ProfileRecord rows[PROFILE_PUBLISH_ROWS];
+};
+
+/**
+ * @struct MetricsReport
+ * @brief Copy of one meter's link metrics after a poll
+ */
+struct MetricsReport {
+    LinkMetrics link;
+    uint8_t meter;
+};
+
+/**
+ * @struct MeterCommand
+ * @brief Remote command for the metering task (READ or CLEAR_CACHE)
+ */
+struct MeterCommand {
+    CommandType type;
+    uint8_t slot;                               // CommandTracker slot to answer
+    uint8_t meter;                              // Bus index (0 without a bus)
+    uint8_t count;                              // Targeted registers, 0 = full read
+    uint8_t registers[COMMAND_MAX_REGISTERS];   // ReadPlan table indices
+};
+
+/**
+ * @struct CommandResult
+ * @brief Outcome of a MeterCommand, metering task -> network task
+ *
+ * A full read hands its reading over through readingQueue first, so
+ * only a targeted read carries values here.
+ */
+struct CommandResult {
+    uint8_t slot;
+    uint8_t meter;
+    uint8_t count;
+    bool ok;
+    float values[COMMAND_MAX_REGISTERS];
+    uint32_t timestamps[COMMAND_MAX_REGISTERS];
+};
+
+SPSCQueue<MeterReport, READING_QUEUE_DEPTH> readingQueue;
+SPSCQueue<ProfileChunk, PROFILE_QUEUE_DEPTH> profileQueue;
+SPSCQueue<MeterCommand, COMMAND_QUEUE_DEPTH> commandQueue;
+SPSCQueue<CommandResult, COMMAND_QUEUE_DEPTH> resultQueue;
+SPSCQueue<MetricsReport, METRICS_QUEUE_DEPTH> metricsQueue;
+
+// Requests waiting for a result; one slot per queued command, so a
+// result never finds resultQueue full
+CommandTracker commands;
+static_assert(CommandTracker::SLOTS <= COMMAND_QUEUE_DEPTH,
+              "Every pending command needs room in resultQueue");
+
+TaskHandle_t meteringTaskHandle = nullptr;
+TaskHandle_t networkTaskHandle = nullptr;
+TaskHandle_t uplinkTaskHandles[UPLINK_SINKS + 1] = {};
+
 // ============================================
 // TIMING VARIABLES
 // ============================================
 
-unsigned long lastReadTime = 0;
 unsigned long lastUploadTime = 0;
 unsigned long lastReconnectAttempt = 0;
 unsigned long lastHeartbeat = 0;
+unsigned long lastProfileRead = 0;
+unsigned long lastOfflineDrain = 0;
+unsigned long lastMetricsPublish = 0;
+unsigned long nextRead = 0;                 // Metering task poll grid
+unsigned long uplinkStart = 0;              // Network task, sleep modes
+unsigned long uplinkIdleSince = 0;
+bool uplinkBackoff = false;                 // Last session failed: wait for nextUplink
+unsigned long restartAt = 0;                // Remote restart, once its response is out
+bool restartPending = false;
 
 // ============================================
 // STATE VARIABLES
 // ============================================
 
-bool wifiConnected = false;
-bool mqttConnected = false;
-uint8_t consecutiveErrors = 0;
-uint16_t readingCount = 0;
+// Written by the network task
+volatile bool wifiConnected = false;
+volatile bool mqttConnected = false;
+volatile uint32_t lastProfileCapture = 0;   // Meter local epoch of last uploaded profile row
+volatile unsigned long nextUplink = 0;      // millis() of the next uplink session (sleep modes)
+volatile bool sleepGranted = false;         // Parked with the radio off (cleared by the metering task)
+
+// Written by the metering task
+volatile uint8_t consecutiveErrors = 0;
+volatile uint16_t readingCount = 0;
+volatile bool statusPending = false;        // Poll finished, publish status
+volatile bool sleepRequested = false;       // Next poll is far off: sleep once the network is idle
+
+#if POWER_MODE == POWER_DEEP_SLEEP
+/**
+ * @struct RetainedState
+ * @brief What a deep sleep must not lose, in RTC memory
+ *
+ * Times are ms after the wake. Pacing and scaler caches persist per
+ * meter in Preferences already, and the offline log in flash; MeterData
+ * is plain data, kept as bytes so no constructor runs over it at boot.
+ */
+struct RetainedState {
+    uint32_t magic;
+    int32_t nextRead;
+    int32_t nextUplink;
+    int32_t uploadAge;          // Since the last UPLOAD_INTERVAL upload
+    int32_t profileAge;         // Since the last load profile read
+    uint16_t readingCount;
+    bool uplinkBackoff;
+#if METER_BUS_SIZE > 0
+    MeterBus::Saved bus;
+#else
+    PollSchedule::Saved schedule;
+    uint8_t reading[sizeof(MeterData)];
+#endif
+};
+
+static const uint32_t RETAINED_MAGIC = 0x52544E31 ^ sizeof(RetainedState);
+static_assert(sizeof(RetainedState) <= 6144,
+              "Retained state must fit in RTC slow memory (8 KB, shared with the SDK)");
+
+RTC_DATA_ATTR RetainedState retained;
+#endif
 
 // ============================================
 // FUNCTION DECLARATIONS
 // ============================================
 
-bool connectWiFi();
+void meteringTask(void* parameter);
+void networkTask(void* parameter);
+void uplinkTask(void* parameter);
+void wakeUplinks();
+bool pollMeters(bool upload, int target = -1);
+void runCommand(const MeterCommand& command);
+bool readTargeted(const MeterCommand& command, CommandResult& result);
+void reportReading(const MeterData& data, uint8_t meter, bool upload);
+void reportMetrics(const LinkMetrics& link, uint8_t meter);
+void handleReport(const MeterReport& report);
+void publishProfile(const ProfileChunk& chunk);
 bool connectMQTT();
 void reconnectMQTT();
 bool publishMQTT(const String& topic, const String& payload);
-bool publishHTTP(const String& jsonData);
-bool readMeter();
-void uploadData();
+bool publishMQTT(const String& topic, const uint8_t* payload, size_t length);
+bool publishMQTT(const String& topic, const JsonDocument& doc);
+bool readMeter(bool upload);
+bool readBus(bool upload, int target = -1);
+bool readLoadProfile();
+void uploadData(const MeterData& data);
+void storeOffline(const MeterData& data, uint8_t taken);
+void reportChanges(ChangeReporter& reporter, const MeterData& data);
+void batchReading(ReadingBatch& batch, const MeterData& data);
+bool flushBatch(ReadingBatch& batch);
 void handleErrors();
+bool startUplink();
+#if POWER_MODE != POWER_ALWAYS_ON
+void endUplink(bool failed);
+bool uplinkDue(unsigned long now);
+void serviceUplink(unsigned long now);
+bool batchesPending();
+void powerDown();
+void releaseNetwork();
+#endif
+#if POWER_MODE == POWER_DEEP_SLEEP
+void retainState(unsigned long wake);
+void recallState();
+#endif
 void printSystemStatus();
+void publishStatus();
+void publishMetrics();
 void mqttCallback(char* topic, byte* payload, unsigned int length);
+void handleResult(const CommandResult& result);
+void serveStatus();
+void beginResponse(JsonDocument& doc, CommandType type, uint8_t meter, bool ok, const char* error);
+void sendResponse(JsonDocument& doc, const char* id);
+void answerCommand(uint8_t slot, JsonDocument& doc);
+#if ENABLE_WEB_SERVER
+void setupWebServer();
+void handleWebServer();
+#endif
 
 // ============================================
 // SETUP
 // ============================================
 
 void setup() {
+    // Wake cause first: a wake from deep sleep or a fast boot skips the
+    // boot delays and the LED show
+    BootProfile::begin();
+    PowerManager::begin();
+    bool resumed = PowerManager::resumed();
+    bool quiet = resumed || FAST_BOOT_ENABLED;
+    
     // Initialize serial for debugging
     Serial.begin(DEBUG_BAUD_RATE);
-    delay(1000);
+    if (!quiet) delay(1000);
     
     Serial.println("\n\n");
     Serial.println("╔════════════════════════════════════════╗");
@@ -80,320 +384,1312 @@ void setup() {
     Serial.println();
     
     // Initialize logger
-    Logger::begin(Logger::DEBUG);
+    Logger::begin((Logger::Level)LOG_LEVEL);
     Logger::enableColors(true);
     Logger::enableTimestamp(true);
     
-    LOG_INFO("System starting...");
+    LOG_INFO(resumed ? "Woke from deep sleep" : "System starting...");
     
     // Initialize hardware
     LOG_INFO("Initializing hardware...");
-    HardwareManager::begin();
+    HardwareManager::begin(!quiet);
     
     // Initialize DLMS protocol
     LOG_INFO("Initializing DLMS protocol...");
+#if METER_BUS_SIZE > 0
+#if METER_TRANSPORT != METER_TRANSPORT_UART
+    meterBus.setTransport(&meterLink);
+#endif
+    meterBus.begin();
+#else
+#if METER_TRANSPORT != METER_TRANSPORT_UART
+    dlms.setTransport(&meterLink);
+#endif
     dlms.begin();
+#endif
+    
+#if CRC_BENCHMARK_ENABLED
+    CRCCalculator::benchmark();
+#endif
+    BootProfile::mark(BootPhase::HARDWARE);
+    
+    // Site register selection, before the metering task starts reading
+    readPlan.load();
+#if METER_BUS_SIZE > 0
+    meterBus.setReadPlan(&readPlan);
+#else
+    dlms.setReadPlan(&readPlan);
+#endif
+    
+    // The metering task resumes the profile from here, so it is loaded
+    // before it starts
+#if PREFERENCES_ENABLED
+    Preferences prefs;
+    if (prefs.begin(PROFILE_NAMESPACE, true)) {
+        lastProfileCapture = prefs.getUInt("last", 0);
+        prefs.end();
+    }
+#endif
     
     // Print OBIS codes (optional)
     // OBISCodes::printAll();
     
-    // Connect to WiFi
+    nextRead = millis();
+#if POWER_MODE == POWER_DEEP_SLEEP
+    if (resumed) recallState();
+#endif
+    
+    // Metering never waits on the network: WiFi and MQTT come up in
+    // their own task on the other core
+    xTaskCreatePinnedToCore(meteringTask, "metering", METERING_TASK_STACK, nullptr,
+                            METERING_TASK_PRIORITY, &meteringTaskHandle, METERING_TASK_CORE);
+    xTaskCreatePinnedToCore(networkTask, "network", NETWORK_TASK_STACK, nullptr,
+                            NETWORK_TASK_PRIORITY, &networkTaskHandle, NETWORK_TASK_CORE);
+    BootProfile::mark(BootPhase::TASKS);
+    
+    LOG_INFO("═══════════════════════════════════════");
+    LOG_INFO("    System Ready - Tasks Started");
+    LOG_INFO("═══════════════════════════════════════\n");
+    
+    if (!quiet) HardwareManager::showSuccess();
+}
+
+// ============================================
+// MAIN LOOP
+// ============================================
+
+void loop() {
+    // All work runs in the metering and network tasks
+    vTaskDelete(nullptr);
+}
+
+// ============================================
+// METERING TASK (core 1, owns DLMSProtocol)
+// ============================================
+
+void meteringTask(void* parameter) {
+#if METER_BUS_SIZE > 0
+    // Spread bus meters evenly over the read interval
+    const uint32_t period = READ_INTERVAL / METER_BUS_SIZE;
+#else
+    const uint32_t period = READ_INTERVAL;
+#endif
+    
+    for (;;) {
+        MeterCommand command;
+        while (commandQueue.pop(command)) {
+            runCommand(command);
+        }
+        
+        // Fixed schedule: a slow read does not push later reads back
+        if ((long)(millis() - nextRead) >= 0) {
+            nextRead += period;
+            if ((long)(millis() - nextRead) >= 0) {
+                nextRead = millis() + period;
+            }
+            pollMeters(false);
+            continue;
+        }
+        
+#if METER_BUS_SIZE == 0
+        // Keep a held association alive between readings
+        if (DLMS_HOLD_ASSOCIATION) {
+            dlms.maintain();
+        }
+#endif
+        
+        // Sleep until the next read is due or a command arrives
+        long wait = (long)(nextRead - millis());
+#if POWER_MODE != POWER_ALWAYS_ON
+        // A long gap sleeps the chip once the network task has parked
+        if (wait >= POWER_MIN_SLEEP) {
+            if (sleepGranted) {
+                powerDown();
+                continue;
+            }
+            sleepRequested = true;
+        } else {
+            releaseNetwork();
+        }
+#endif
+        if (wait > METERING_IDLE_WAIT) wait = METERING_IDLE_WAIT;
+        if (wait > 0) {
+            ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(wait));
+        }
+    }
+}
+
+/**
+ * @brief Poll the meter (or the next bus meter) and report the reading
+ * @param upload Requested reading: every tier, published at once
+ * @param target Bus index to read instead of the next due meter
+ * @return true if the reading succeeded
+ */
+bool pollMeters(bool upload, int target) {
+    bool success;
+#if METER_BUS_SIZE > 0
+    // A requested reading is a complete one
+    if (upload && target < 0) meterBus.resetSchedules();
+    success = readBus(upload, target);
+#else
+    LOG_INFO("\n┌─────────────────────────────────────┐");
+    LOG_INFO("│  Starting Meter Reading #" + String(++readingCount) + "       │");
+    LOG_INFO("└─────────────────────────────────────┘");
+    
+    if (upload) pollSchedule.reset();
+    success = readMeter(upload);
+    reportMetrics(dlms.getMetrics(), 0);
+    
+    if (success) {
+        consecutiveErrors = 0;
+        HardwareManager::blinkLED(LEDColor::GREEN, 1, 500, 0);
+    } else {
+        handleErrors();
+    }
+#endif
+    statusPending = true;
+    return success;
+}
+
+/**
+ * @brief Run a remote command and hand its result to the network task
+ */
+void runCommand(const MeterCommand& command) {
+    static CommandResult result;
+    memset(&result, 0, sizeof(result));
+    result.slot = command.slot;
+    result.meter = command.meter;
+    
+    if (command.type == CommandType::CLEAR_CACHE) {
+        LOG_INFO("Clearing register scaler cache");
+        dlms.clearScalerCache();
+        result.ok = true;
+    } else if (command.count > 0) {
+        LOG_INFOF("Remote read of %u registers, meter %u", command.count, command.meter);
+        result.count = command.count;
+        result.ok = readTargeted(command, result);
+    } else {
+        LOG_INFO("Remote read command received");
+        result.ok = pollMeters(true, command.meter);
+    }
+    
+    // Cannot fail: each pending slot has at most one result in flight
+    resultQueue.push(result);
+}
+
+/**
+ * @brief Hand a reading to the network task
+ *
+ * A full queue means the network is far behind; the reading is dropped
+ * rather than stalling the poll schedule.
+ */
+void reportReading(const MeterData& data, uint8_t meter, bool upload) {
+    static MeterReport report;
+    report.data = data;
+    report.meter = meter;
+    report.upload = upload;
+    PowerManager::countReading();
+    
+    if (!readingQueue.push(report)) {
+        LOG_WARN("Reading queue full - reading dropped");
+    }
+}
+
+/**
+ * @brief Hand a copy of a link's metrics to the network task
+ *
+ * Counters are cumulative, so a snapshot dropped on a full queue is
+ * covered by the next one.
+ */
+void reportMetrics(const LinkMetrics& link, uint8_t meter) {
+    static MetricsReport report;
+    report.link = link;
+    report.meter = meter;
+    metricsQueue.push(report);
+}
+
+// ============================================
+// UPLINK TASKS (one per HTTP/ThingSpeak backend)
+// ============================================
+
+/**
+ * @brief Deliver a backend's share of the offline log
+ *
+ * Sleeps until a new reading is stored, its retry or rate limit runs
+ * out, or UPLINK_IDLE_WAIT passes. Only sends while WiFi is up; the
+ * network task owns the connection.
+ */
+void uplinkTask(void* parameter) {
+    UplinkSink* sink = static_cast<UplinkSink*>(parameter);
+    
+    for (;;) {
+        uint32_t wait = UPLINK_IDLE_WAIT;
+        if (wifiConnected) {
+            sink->service(offlineLog, millis());
+            wait = sink->waitTime(offlineLog, millis(), UPLINK_IDLE_WAIT);
+        }
+        if (wait > 0) {
+            ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(wait));
+        }
+    }
+}
+
+/**
+ * @brief A reading was stored: let the backends pick it up now
+ */
+void wakeUplinks() {
+    for (uint8_t i = 0; i < UPLINK_SINKS; i++) {
+        if (uplinkTaskHandles[i]) xTaskNotifyGive(uplinkTaskHandles[i]);
+    }
+}
+
+// ============================================
+// NETWORK TASK (core 0, owns WiFi and MQTT)
+// ============================================
+
+void networkTask(void* parameter) {
+    // Offline log survives reboots while a backend is unreachable; mounted
+    // here so it does not hold up the first reading
+    offlineLog.begin();
+    BootProfile::mark(BootPhase::STORAGE);
+    
+    // Backends reading it back start once it is mounted
+    for (uint8_t i = 0; i < UPLINK_SINKS; i++) {
+        xTaskCreatePinnedToCore(uplinkTask, uplinkSinks[i]->getName(), UPLINK_TASK_STACK,
+                                uplinkSinks[i], UPLINK_TASK_PRIORITY, &uplinkTaskHandles[i],
+                                UPLINK_TASK_CORE);
+    }
+    
+    // Setup MQTT
+    mqttClient.setServer(MQTT_BROKER, MQTT_PORT);
+    mqttClient.setCallback(mqttCallback);
+    mqttClient.setKeepAlive(MQTT_KEEPALIVE);
+    mqttClient.setBufferSize(MQTT_BUFFER_SIZE);
+    
+#if POWER_MODE == POWER_ALWAYS_ON
+    startUplink();
+#else
+    // WiFi stays off until an uplink session is due
+    LOG_INFO("Power managed: WiFi on for uplink sessions only");
+#endif
+    
+    static MeterReport report;
+    static ProfileChunk chunk;
+    static MetricsReport metrics;
+    static CommandResult result;
+    
+    for (;;) {
+        unsigned long currentMillis = millis();
+        
+#if POWER_MODE != POWER_ALWAYS_ON
+        if (!wifiConnected && uplinkDue(currentMillis)) {
+            uplinkStart = currentMillis;
+            uplinkIdleSince = currentMillis;
+            if (!startUplink()) {
+                endUplink(true);
+            }
+            currentMillis = millis();
+        }
+#endif
+        
+        // Handle MQTT connection
+        if (wifiConnected && mqttConnected) {
+            if (!mqttClient.loop()) {
+                mqttConnected = false;
+            }
+        }
+        
+        // Auto-reconnect MQTT
+        if (wifiConnected && !mqttConnected) {
+            if (currentMillis - lastReconnectAttempt > 5000) {
+                lastReconnectAttempt = currentMillis;
+                reconnectMQTT();
+            }
+        }
+        
+        // Readings and profile rows from the metering task
+        while (readingQueue.pop(report)) {
+            handleReport(report);
+        }
+        // After the readings, so a full read's data is in place
+        while (resultQueue.pop(result)) {
+            handleResult(result);
+        }
+        while (profileQueue.pop(chunk)) {
+            publishProfile(chunk);
+        }
+        while (metricsQueue.pop(metrics)) {
+            linkMetrics[metrics.meter] = metrics.link;
+        }
+        
+        if (statusPending && mqttConnected) {
+            statusPending = false;
+            publishStatus();
+        }
+        
+        // STATUS waits for a read in flight and answers with its data
+        if (commands.find(CommandType::STATUS) >= 0 && commands.find(CommandType::READ) < 0) {
+            serveStatus();
+        }
+        
+        if (restartPending && (long)(currentMillis - restartAt) >= 0) {
+            LOG_WARN("Restarting on remote command");
+            ESP.restart();
+        }
+        
+        if (mqttConnected && currentMillis - lastMetricsPublish >= METRICS_PUBLISH_INTERVAL) {
+            lastMetricsPublish = currentMillis;
+            publishMetrics();
+        }
+        
+#if ENABLE_WEB_SERVER
+        if (wifiConnected) {
+            handleWebServer();
+        }
+#endif
+        
+        // Replay stored readings in short bursts once the broker is back
+        if (mqttConnected && offlineLog.pending(LogCursor::MQTT) > 0 &&
+            currentMillis - lastOfflineDrain >= OFFLINE_DRAIN_INTERVAL) {
+            lastOfflineDrain = currentMillis;
+            BacklogUploader backlog;
+            offlineLog.drain(LogCursor::MQTT, OFFLINE_DRAIN_BATCH, backlog);
+        }
+        
+        // Publish batches that reached their size or age limit
+        if (MQTT_BATCH_ENABLED && mqttConnected) {
+            for (uint8_t i = 0; i < sizeof(batches) / sizeof(batches[0]); i++) {
+                if (batches[i].due(currentMillis)) {
+                    flushBatch(batches[i]);
+                }
+            }
+        }
+        
+        // Upload data to cloud periodically (by exception: per reading)
+        if (!MQTT_REPORT_BY_EXCEPTION && currentMillis - lastUploadTime >= UPLOAD_INTERVAL) {
+            lastUploadTime = currentMillis;
+            
+#if METER_BUS_SIZE > 0
+            for (uint8_t i = 0; i < METER_BUS_SIZE; i++) {
+                if (busData[i].isValid()) {
+                    uploadData(busData[i]);
+                }
+            }
+#else
+            if (meterData.isValid()) {
+                uploadData(meterData);
+            } else {
+                LOG_WARN("No valid data to upload");
+            }
+#endif
+        }
+        
+#if POWER_MODE != POWER_ALWAYS_ON
+        if (wifiConnected) {
+            serviceUplink(currentMillis);
+        }
+#endif
+        
+        // Heartbeat / status LED (no idle blinking on battery)
+        if (currentMillis - lastHeartbeat >= 2000) {
+            lastHeartbeat = currentMillis;
+            if (POWER_MODE == POWER_ALWAYS_ON) {
+                HardwareManager::statusLedToggle();
+            }
+            
+            // Optional: Print system status every minute
+            static uint8_t heartbeatCount = 0;
+            if (++heartbeatCount >= 30) {
+                heartbeatCount = 0;
+                printSystemStatus();
+            }
+        }
+        
+        // Check for WiFi reconnection
+        if (POWER_MODE == POWER_ALWAYS_ON &&
+            !wifiConnected && currentMillis - lastReconnectAttempt > 30000) {
+            lastReconnectAttempt = currentMillis;
+            LOG_INFO("Attempting WiFi reconnection...");
+            if (WiFiLink::connect()) {
+                wifiConnected = true;
+                connectMQTT();
+            }
+        }
+        
+#if POWER_MODE != POWER_ALWAYS_ON
+        // Park while the metering task sleeps the chip; it checks the
+        // queues again once parked, so a reading pushed meanwhile is safe
+        if (sleepRequested && !wifiConnected && readingQueue.empty() &&
+            profileQueue.empty() && metricsQueue.empty() && resultQueue.empty() &&
+            !commands.busy() && !uplinkDue(millis())) {
+            sleepGranted = true;
+            xTaskNotifyGive(meteringTaskHandle);
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+            continue;
+        }
+#endif
+        
+        vTaskDelay(pdMS_TO_TICKS(NETWORK_TASK_TICK));
+    }
+}
+
+/**
+ * @brief Take over a reading from the metering task
+ */
+void handleReport(const MeterReport& report) {
+#if METER_BUS_SIZE > 0
+    MeterData& latest = busData[report.meter];
+#else
+    MeterData& latest = meterData;
+#endif
+    latest = report.data;
+    
+    if (MQTT_BATCH_ENABLED) {
+        // Batches live in RAM; between deep sleep sessions flash is safer
+        if (POWER_MODE == POWER_DEEP_SLEEP && !mqttConnected) {
+            storeOffline(latest, ALL_CURSORS & ~LogCursor::bit(LogCursor::MQTT));
+        } else {
+            batchReading(batches[report.meter], latest);
+        }
+    }
+    if (PQ_ENABLED) {
+        PQPublisher publisher;
+        aggregators[report.meter].add(latest, publisher);
+    }
+    if (report.upload) {
+        uploadData(latest);
+        reporters[report.meter].keyframeSent(latest, millis());
+    } else if (MQTT_REPORT_BY_EXCEPTION && !MQTT_BATCH_ENABLED) {
+        reportChanges(reporters[report.meter], latest);
+    }
+}
+
+// ============================================
+// UPLINK SESSIONS
+// ============================================
+
+/**
+ * @brief Bring WiFi and MQTT up
+ * @return true if WiFi connected (MQTT may still be down)
+ */
+bool startUplink() {
     LOG_INFO("Connecting to WiFi...");
-    if (connectWiFi()) {
+    PowerManager::radioOn();
+    if (WiFiLink::connect()) {
         wifiConnected = true;
+        BootProfile::mark(BootPhase::WIFI);
         LOG_INFO("WiFi connected!");
         LOG_INFO("IP Address: " + WiFi.localIP().toString());
         LOG_INFO("Signal: " + String(WiFi.RSSI()) + " dBm");
         
-        // Setup MQTT
-        mqttClient.setServer(MQTT_BROKER, MQTT_PORT);
-        mqttClient.setCallback(mqttCallback);
-        mqttClient.setKeepAlive(MQTT_KEEPALIVE);
-        
-        // Connect to MQTT
-        if (connectMQTT()) {
-            mqttConnected = true;
-            LOG_INFO("MQTT connected!");
+        // System clock for reading timestamps
+        if (NTP_ENABLED) {
+            configTime(NTP_TIMEZONE, 0, NTP_SERVER);
         }
     } else {
         LOG_WARN("WiFi connection failed - continuing in offline mode");
         wifiConnected = false;
     }
     
-    LOG_INFO("═══════════════════════════════════════");
-    LOG_INFO("    System Ready - Starting Loop");
-    LOG_INFO("═══════════════════════════════════════\n");
+#if ENABLE_WEB_SERVER
+    static bool webServerStarted = false;
+    if (!webServerStarted) {
+        setupWebServer();
+        webServerStarted = true;
+    }
+#endif
     
-    HardwareManager::showSuccess();
-    delay(1000);
+    // Connect to MQTT
+    if (wifiConnected && connectMQTT()) {
+        mqttConnected = true;
+        LOG_INFO("MQTT connected!");
+    }
+    return wifiConnected;
 }
 
-// ============================================
-// MAIN LOOP
-// ============================================
+#if POWER_MODE != POWER_ALWAYS_ON
+/**
+ * @brief Close the session and switch the radio off
+ * @param failed Data was left unsent: retry after POWER_UPLINK_RETRY
+ */
+void endUplink(bool failed) {
+    if (mqttConnected) {
+        mqttClient.disconnect();
+    }
+    mqttConnected = false;
+    wifiConnected = false;
+    WiFi.disconnect(true);
+    WiFi.mode(WIFI_OFF);
+    PowerManager::radioOff();
+    
+    uplinkBackoff = failed;
+    nextUplink = millis() + (failed ? POWER_UPLINK_RETRY : POWER_UPLINK_INTERVAL);
+    LOG_INFOF("WiFi off after a %lu s session%s", (millis() - uplinkStart) / 1000,
+              failed ? " (incomplete)" : "");
+}
 
-void loop() {
-    unsigned long currentMillis = millis();
+/**
+ * @brief Whether an uplink session should start
+ *
+ * Every POWER_UPLINK_INTERVAL for commands and status; earlier once the
+ * offline log or a batch needs flushing, unless the last session failed.
+ */
+bool uplinkDue(unsigned long now) {
+    if ((long)(now - nextUplink) >= 0) return true;
+    if (uplinkBackoff) return false;
+    if (offlineLog.pending(LogCursor::MQTT) >= POWER_UPLINK_BACKLOG) return true;
+    for (uint8_t i = 0; i < UPLINK_SINKS; i++) {
+        if (!uplinkSinks[i]->backingOff() &&
+            offlineLog.pending(uplinkSinks[i]->getCursor()) >= POWER_UPLINK_BACKLOG) return true;
+    }
     
-    // Handle MQTT connection
-    if (wifiConnected && mqttConnected) {
-        if (!mqttClient.loop()) {
-            mqttConnected = false;
+    if (MQTT_BATCH_ENABLED) {
+        for (uint8_t i = 0; i < sizeof(batches) / sizeof(batches[0]); i++) {
+            if (batches[i].due(now)) return true;
         }
     }
+    return false;
+}
+
+/**
+ * @brief End the session once its data is out
+ *
+ * With nothing else left to send, batches go out early: the radio is on
+ * anyway. A session that cannot get its data out within
+ * POWER_SESSION_TIMEOUT is ended and retried later.
+ */
+void serviceUplink(unsigned long now) {
+    bool busy = (MQTT_ENABLED && !mqttConnected) || offlineLog.pending(LogCursor::MQTT) > 0 ||
+                statusPending || !readingQueue.empty() || commands.busy() || restartPending;
+    for (uint8_t i = 0; i < UPLINK_SINKS; i++) {
+        if (uplinkSinks[i]->busy(offlineLog)) busy = true;
+    }
     
-    // Auto-reconnect MQTT
-    if (wifiConnected && !mqttConnected) {
-        if (currentMillis - lastReconnectAttempt > 5000) {
-            lastReconnectAttempt = currentMillis;
-            reconnectMQTT();
+    if (!busy && MQTT_BATCH_ENABLED) {
+        for (uint8_t i = 0; i < sizeof(batches) / sizeof(batches[0]); i++) {
+            if (!batches[i].empty() && !flushBatch(batches[i])) busy = true;
         }
     }
     
-    // Read meter data periodically
-    if (currentMillis - lastReadTime >= READ_INTERVAL) {
-        lastReadTime = currentMillis;
+    if (busy) {
+        uplinkIdleSince = now;
+        if (now - uplinkStart >= POWER_SESSION_TIMEOUT) {
+            LOG_WARN("Uplink session timed out");
+            endUplink(true);
+        }
+        return;
+    }
+    
+    if (now - uplinkIdleSince >= POWER_WIFI_IDLE_TIMEOUT) {
+        endUplink(false);
+    }
+}
+
+/**
+ * @brief Unsent batched readings in RAM
+ */
+bool batchesPending() {
+    for (uint8_t i = 0; i < sizeof(batches) / sizeof(batches[0]); i++) {
+        if (!batches[i].empty()) return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Sleep until the next poll or uplink session
+ *
+ * Runs on the metering task with the network task parked. Anything
+ * queued after the network task went idle is handed over first. Deep
+ * sleep takes a gap worth the reboot and no unsent batch in RAM;
+ * otherwise the chip light-sleeps.
+ */
+void powerDown() {
+    unsigned long now = millis();
+    long duration = (long)(nextRead - now);
+    long uplink = (long)(nextUplink - now);
+    if (uplink < duration) duration = uplink;
+    
+    if (duration < POWER_MIN_SLEEP || !readingQueue.empty() || !profileQueue.empty() ||
+        !metricsQueue.empty() || !commandQueue.empty() || !resultQueue.empty()) {
+        releaseNetwork();
+        return;
+    }
+    
+#if METER_BUS_SIZE == 0
+    // A held association would time out at the meter anyway
+    if (dlms.isConnected()) {
+        dlms.disconnect();
+    }
+#endif
+    HardwareManager::stopPatterns();
+    HardwareManager::ledsOff();
+    HardwareManager::statusLedOff();
+    
+#if POWER_MODE == POWER_DEEP_SLEEP
+    if (duration >= POWER_DEEP_MIN_SLEEP && !batchesPending()) {
+        retainState(now + duration);
+        PowerManager::deepSleep(duration);      // Does not return
+    }
+#endif
+    
+    LOG_DEBUGF("Light sleep for %ld ms", duration);
+    uint32_t slept = PowerManager::lightSleep(duration);
+    if (PowerManager::getWakeCause() == WakeCause::METER_RX) {
+        LOG_INFOF("Meter line woke us after %u ms", (unsigned)slept);
+    }
+    releaseNetwork();
+}
+
+/**
+ * @brief Withdraw the sleep request and let a parked network task run
+ */
+void releaseNetwork() {
+    sleepRequested = false;
+    if (sleepGranted) {
+        sleepGranted = false;
+        xTaskNotifyGive(networkTaskHandle);
+    }
+}
+#endif
+
+#if POWER_MODE == POWER_DEEP_SLEEP
+/**
+ * @brief Time since a millis() mark, capped at the interval it counts to
+ */
+static int32_t ageAt(unsigned long since, unsigned long wake, uint32_t cap) {
+    unsigned long age = wake - since;
+    return age < cap ? age : cap;
+}
+
+/**
+ * @brief Copy what the next boot needs into RTC memory
+ * @param wake millis() the sleep ends at, in this boot's time
+ *
+ * The network task is parked, so its timers are stable.
+ */
+void retainState(unsigned long wake) {
+    retained.magic = RETAINED_MAGIC;
+    retained.nextRead = (int32_t)(nextRead - wake);
+    retained.nextUplink = (int32_t)(nextUplink - wake);
+    retained.uploadAge = ageAt(lastUploadTime, wake, UPLOAD_INTERVAL);
+    retained.profileAge = lastProfileRead == 0 ? PROFILE_READ_INTERVAL :
+                          ageAt(lastProfileRead, wake, PROFILE_READ_INTERVAL);
+    retained.readingCount = readingCount;
+    retained.uplinkBackoff = uplinkBackoff;
+#if METER_BUS_SIZE > 0
+    meterBus.save(retained.bus, wake);
+#else
+    pollSchedule.save(retained.schedule, wake);
+    memcpy(retained.reading, &meterReading, sizeof(retained.reading));
+#endif
+}
+
+/**
+ * @brief Take the retained state back after a wake from deep sleep
+ */
+void recallState() {
+    if (retained.magic != RETAINED_MAGIC) {
+        LOG_WARN("No retained state - starting a new schedule");
+        return;
+    }
+    
+    unsigned long now = millis();
+    nextRead = now + retained.nextRead;
+    nextUplink = now + retained.nextUplink;
+    lastUploadTime = now - retained.uploadAge;
+    lastProfileRead = now - retained.profileAge;
+    readingCount = retained.readingCount;
+    uplinkBackoff = retained.uplinkBackoff;
+#if METER_BUS_SIZE > 0
+    meterBus.restore(retained.bus, now);
+    for (uint8_t i = 0; i < METER_BUS_SIZE; i++) {
+        busData[i] = meterBus.meter(i).data;
+    }
+#else
+    pollSchedule.restore(retained.schedule, now);
+    memcpy(&meterReading, retained.reading, sizeof(retained.reading));
+    meterData = meterReading;
+#endif
+    LOG_INFOF("Retained state restored, next poll in %ld ms", (long)retained.nextRead);
+}
+#endif
+
+// ============================================
+// MQTT FUNCTIONS
+// ============================================
+
+bool connectMQTT() {
+    String clientId = String(MQTT_CLIENT_ID) + String(WiFi.macAddress());
+    clientId.replace(":", "");
+    
+    LOG_INFO("Connecting to MQTT broker: " + String(MQTT_BROKER));
+    
+    bool connected = false;
+    if (strlen(MQTT_USER) > 0) {
+        connected = mqttClient.connect(clientId.c_str(), MQTT_USER, MQTT_PASSWORD);
+    } else {
+        connected = mqttClient.connect(clientId.c_str());
+    }
+    
+    if (connected) {
+        BootProfile::mark(BootPhase::MQTT);
+        LOG_INFO("MQTT Client ID: " + clientId);
         
-        LOG_INFO("\n┌─────────────────────────────────────┐");
-        LOG_INFO("│  Starting Meter Reading #" + String(++readingCount) + "       │");
-        LOG_INFO("└─────────────────────────────────────┘");
+        // Subscribe to command topic
+        String cmdTopic = String(MQTT_TOPIC_BASE) + meterData.serialNumber + "/" + MQTT_TOPIC_CMD;
+        mqttClient.subscribe(cmdTopic.c_str());
+        LOG_INFO("Subscribed to: " + cmdTopic);
         
-        if (readMeter()) {
-            consecutiveErrors = 0;
-            HardwareManager::setLED(LEDColor::GREEN);
-            delay(500);
-            HardwareManager::ledsOff();
-        } else {
-            handleErrors();
-        }
+        // Publish status
+        String statusTopic = String(MQTT_TOPIC_BASE) + meterData.serialNumber + "/" + MQTT_TOPIC_STATUS;
+        publishMQTT(statusTopic, "online");
+        
+        return true;
+    }
+    
+    LOG_ERROR("MQTT connection failed, rc=" + String(mqttClient.state()));
+    return false;
+}
+
+void reconnectMQTT() {
+    LOG_INFO("Attempting MQTT reconnection...");
+    if (connectMQTT()) {
+        mqttConnected = true;
+        LOG_INFO("MQTT reconnected");
+    }
+}
+
+bool publishMQTT(const String& topic, const String& payload) {
+    if (!mqttConnected) {
+        LOG_WARN("MQTT not connected, cannot publish");
+        return false;
+    }
+    
+    bool result = mqttClient.publish(topic.c_str(), payload.c_str(), false);
+    
+    if (result) {
+        LOG_DEBUG("Published to " + topic);
+    } else {
+        LOG_ERROR("Failed to publish to " + topic);
+    }
+    
+    return result;
+}
+
+bool publishMQTT(const String& topic, const uint8_t* payload, size_t length) {
+    if (!mqttConnected) {
+        LOG_WARN("MQTT not connected, cannot publish");
+        return false;
+    }
+    
+    if (length == 0) {
+        LOG_ERROR("Payload for " + topic + " exceeds buffer");
+        return false;
+    }
+    
+    bool result = mqttClient.publish(topic.c_str(), payload, length, false);
+    
+    if (result) {
+        LOG_DEBUG("Published " + String(length) + " bytes to " + topic);
+    } else {
+        LOG_ERROR("Failed to publish to " + topic);
+    }
+    
+    return result;
+}
+
+/**
+ * @brief Publish a JSON document, serialized straight into the socket
+ *
+ * The message length comes from measureJson, so the payload is never
+ * held in memory as a whole and may exceed MQTT_BUFFER_SIZE.
+ */
+bool publishMQTT(const String& topic, const JsonDocument& doc) {
+    if (!mqttConnected) {
+        LOG_WARN("MQTT not connected, cannot publish");
+        return false;
+    }
+    
+    size_t length = measureJson(doc);
+    bool result = mqttClient.beginPublish(topic.c_str(), length, false);
+    if (result) {
+        BufferedPrint<JSON_STREAM_CHUNK> out(mqttClient);
+        serializeJson(doc, out);
+        out.flush();
+        result = mqttClient.endPublish() == 1 && out.written() == length;
+    }
+    
+    if (result) {
+        LOG_DEBUG("Published " + String(length) + " bytes to " + topic);
+    } else {
+        LOG_ERROR("Failed to publish to " + topic);
     }
     
-    // Upload data to cloud periodically
-    if (currentMillis - lastUploadTime >= UPLOAD_INTERVAL) {
-        lastUploadTime = currentMillis;
+    return result;
+}
+
+void mqttCallback(char* topic, byte* payload, unsigned int length) {
+    // Payload is not NUL-terminated; the log record cuts longer text anyway
+    char text[LOG_RECORD_MAX];
+    size_t shown = length;
+    if (shown > sizeof(text) - 1) shown = sizeof(text) - 1;
+    memcpy(text, payload, shown);
+    text[shown] = '\0';
+    LOG_INFOF("MQTT Message [%s]: %s", topic, text);
+    
+    StaticJsonDocument<COMMAND_RESPONSE_SIZE> response;
+    CommandRequest request;
+    const char* error;
+    if (!CommandTracker::parse(payload, length, request, error)) {
+        LOG_WARNF("Command rejected: %s", error);
+        beginResponse(response, request.type, request.meter, false, error);
+        response["cmd"] = nullptr;
+        sendResponse(response, request.id);
+        return;
+    }
+    
+    if (request.type == CommandType::RESTART) {
+        // Answered first; the restart follows from the network loop
+        LOG_WARN("Restart command received");
+        beginResponse(response, request.type, request.meter, true, nullptr);
+        sendResponse(response, request.id);
+        restartPending = true;
+        restartAt = millis() + 1000;
+        return;
+    }
+    
+    // A request identical to a pending one is answered by its result
+    bool joined;
+    int slot = commands.open(request, joined);
+    if (slot < 0) {
+        LOG_WARN("Too many pending commands - request refused");
+        beginResponse(response, request.type, request.meter, false, "busy");
+        sendResponse(response, request.id);
+        return;
+    }
+    if (joined) {
+        LOG_INFOF("%s joined a pending request", CommandTracker::typeName(request.type));
+        return;
+    }
+    
+    // STATUS is served by the network loop; meter access goes to the
+    // metering task, so this task never waits on the meter line
+    if (request.type == CommandType::STATUS) return;
+    
+    MeterCommand command;
+    command.type = request.type;
+    command.slot = slot;
+    command.meter = request.meter;
+    command.count = request.count;
+    memcpy(command.registers, request.registers, sizeof(command.registers));
+    
+    if (commandQueue.push(command)) {
+        xTaskNotifyGive(meteringTaskHandle);
+    } else {
+        LOG_WARN("Command queue full - request refused");
+        beginResponse(response, request.type, request.meter, false, "busy");
+        answerCommand(slot, response);
+    }
+}
+
+/**
+ * @brief Answer the requests of a finished metering task command
+ */
+void handleResult(const CommandResult& result) {
+    const CommandRequest& request = commands.request(result.slot);
+    
+    StaticJsonDocument<COMMAND_RESPONSE_SIZE> response;
+    beginResponse(response, request.type, result.meter, result.ok,
+                  result.ok ? nullptr : "meter read failed");
+    
+    if (result.ok && request.type == CommandType::READ) {
+#if METER_BUS_SIZE > 0
+        const MeterData& data = busData[result.meter];
+#else
+        const MeterData& data = meterData;
+#endif
+        response["serial"] = data.serialNumber;
         
-        if (meterData.isValid()) {
-            uploadData();
+        if (result.count == 0) {
+            // Full reading: published on the data topic already
+            response["topic"] = MQTT_TOPIC_DATA;
         } else {
-            LOG_WARN("No valid data to upload");
+            // Capture times (meter local epoch) for the demand registers
+            JsonObject values = response.createNestedObject("values");
+            JsonObject times = response.createNestedObject("timestamps");
+            for (uint8_t i = 0; i < result.count; i++) {
+                const ReadPlanEntry& entry = ReadPlan::entry(request.registers[i]);
+                values[entry.key] = result.values[i];
+                if (entry.timestamp != ReadPlanEntry::NO_TIMESTAMP) {
+                    times[entry.key] = result.timestamps[i];
+                }
+            }
         }
     }
     
-    // Heartbeat / status LED
-    if (currentMillis - lastHeartbeat >= 2000) {
-        lastHeartbeat = currentMillis;
-        HardwareManager::statusLedToggle();
-        
-        // Optional: Print system status every minute
-        static uint8_t heartbeatCount = 0;
-        if (++heartbeatCount >= 30) {
-            heartbeatCount = 0;
-            printSystemStatus();
-        }
+    answerCommand(result.slot, response);
+}
+
+/**
+ * @brief Answer pending STATUS requests with the latest reading
+ */
+void serveStatus() {
+    int slot = commands.find(CommandType::STATUS);
+    const CommandRequest& request = commands.request(slot);
+    
+#if METER_BUS_SIZE > 0
+    const MeterData& data = busData[request.meter];
+#else
+    const MeterData& data = meterData;
+#endif
+    
+    printSystemStatus();
+    if (data.isValid()) {
+        uploadData(data);
     }
+    publishStatus();
     
-    // Check for WiFi reconnection
-    if (!wifiConnected && currentMillis - lastReconnectAttempt > 30000) {
-        lastReconnectAttempt = currentMillis;
-        LOG_INFO("Attempting WiFi reconnection...");
-        if (connectWiFi()) {
-            wifiConnected = true;
-            connectMQTT();
-        }
+    StaticJsonDocument<COMMAND_RESPONSE_SIZE> response;
+    beginResponse(response, request.type, request.meter, true, nullptr);
+    response["serial"] = data.serialNumber;
+    response["valid"] = data.isValid();
+    response["readings"] = readingCount;
+    response["errors"] = consecutiveErrors;
+    answerCommand(slot, response);
+}
+
+/**
+ * @brief Common fields of a command response
+ */
+void beginResponse(JsonDocument& doc, CommandType type, uint8_t meter, bool ok, const char* error) {
+    doc.clear();
+    doc["id"] = "";
+    doc["cmd"] = CommandTracker::typeName(type);
+    doc["ok"] = ok;
+    doc["meter"] = meter;
+    if (error) {
+        doc["error"] = error;
+    }
+}
+
+/**
+ * @brief Publish a response to one request
+ */
+void sendResponse(JsonDocument& doc, const char* id) {
+    // An id-less request still gets its answer, with a null id
+    if (id[0]) {
+        doc["id"] = id;
+    } else {
+        doc["id"] = nullptr;
     }
     
-    delay(100);
+    String topic = String(MQTT_TOPIC_BASE) + meterData.serialNumber + "/" + MQTT_TOPIC_RESPONSE;
+    publishMQTT(topic, doc);
+}
+
+/**
+ * @brief Send a response to every waiter of a slot and release it
+ */
+void answerCommand(uint8_t slot, JsonDocument& doc) {
+    for (uint8_t i = 0; i < commands.waiters(slot); i++) {
+        sendResponse(doc, commands.waiterId(slot, i));
+    }
+    commands.close(slot);
 }
 
 // ============================================
-// WIFI FUNCTIONS
+// METER READING FUNCTIONS
 // ============================================
 
-bool connectWiFi() {
-    WiFi.mode(WIFI_STA);
-    WiFi.begin(WIFI_SSID, WIFI_PASSWORD);
+bool readMeter(bool upload) {
+    // Only tiers that fell due go into this poll
+    unsigned long start = millis();
+    uint8_t tiers = pollSchedule.due(start);
+    if (tiers == 0) {
+        LOG_DEBUG("No register tier due");
+        return true;
+    }
+    
+    HardwareManager::setLED(LEDColor::BLUE);
     
-    uint32_t startTime = millis();
-    int dots = 0;
+    bool held = DLMS_HOLD_ASSOCIATION && dlms.isConnected();
     
-    while (WiFi.status() != WL_CONNECTED) {
-        if (millis() - startTime > WIFI_TIMEOUT) {
-            LOG_ERROR("WiFi connection timeout");
+    if (held) {
+        LOG_INFO("Using held association");
+    } else {
+        LOG_INFO("Connecting to meter...");
+        
+        if (!dlms.connect()) {
+            LOG_ERROR("Failed to connect to meter");
+            HardwareManager::showError(2);
             return false;
         }
-        
-        delay(500);
-        Serial.print(".");
-        if (++dots % 50 == 0) Serial.println();
+        BootProfile::mark(BootPhase::METER_LINK);
     }
     
-    Serial.println();
-    return true;
-}
-
-// ============================================
-// MQTT FUNCTIONS
-// ============================================
-
-bool connectMQTT() {
-    String clientId = String(MQTT_CLIENT_ID) + String(WiFi.macAddress());
-    clientId.replace(":", "");
+    LOG_INFO("Reading meter data...");
     
-    LOG_INFO("Connecting to MQTT broker: " + String(MQTT_BROKER));
+    bool success = dlms.readMeterData(meterReading, tiers);
     
-    bool connected = false;
-    if (strlen(MQTT_USER) > 0) {
-        connected = mqttClient.connect(clientId.c_str(), MQTT_USER, MQTT_PASSWORD);
-    } else {
-        connected = mqttClient.connect(clientId.c_str());
+    // Meter may have dropped a held association: re-associate once
+    if (!success && held) {
+        LOG_WARN("Held association lost - re-associating");
+        dlms.disconnect();
+        success = dlms.connect() && dlms.readMeterData(meterReading, tiers);
     }
     
-    if (connected) {
-        LOG_INFO("MQTT Client ID: " + clientId);
-        
-        // Subscribe to command topic
-        String cmdTopic = String(MQTT_TOPIC_BASE) + meterData.serialNumber + "/" + MQTT_TOPIC_CMD;
-        mqttClient.subscribe(cmdTopic.c_str());
-        LOG_INFO("Subscribed to: " + cmdTopic);
+    if (success) {
+        BootProfile::mark(BootPhase::FIRST_READING);
+        pollSchedule.complete(tiers, start);
+        LOG_INFO("✓ Meter data read successfully");
+        meterReading.printSummary();
+        reportReading(meterReading, 0, upload);
         
-        // Publish status
-        String statusTopic = String(MQTT_TOPIC_BASE) + meterData.serialNumber + "/" + MQTT_TOPIC_STATUS;
-        publishMQTT(statusTopic, "online");
+        // Optional: Print full data
+        // meterReading.print();
         
-        return true;
+        // Hourly load profile catch-up within the same association
+        if (PROFILE_ENABLED && mqttConnected &&
+            (lastProfileRead == 0 || millis() - lastProfileRead >= PROFILE_READ_INTERVAL)) {
+            lastProfileRead = millis();
+            readLoadProfile();
+        }
+    } else {
+        LOG_ERROR("Failed to read meter data");
+        HardwareManager::showError(3);
     }
     
-    LOG_ERROR("MQTT connection failed, rc=" + String(mqttClient.state()));
-    return false;
-}
-
-void reconnectMQTT() {
-    LOG_INFO("Attempting MQTT reconnection...");
-    if (connectMQTT()) {
-        mqttConnected = true;
-        LOG_INFO("MQTT reconnected");
+    if (!DLMS_HOLD_ASSOCIATION || !success) {
+        dlms.disconnect();
     }
+    HardwareManager::ledsOff();
+    
+    return success;
 }
 
-bool publishMQTT(const String& topic, const String& payload) {
-    if (!mqttConnected) {
-        LOG_WARN("MQTT not connected, cannot publish");
+/**
+ * @brief Read the next due meter on the RS-485 bus and upload its data
+ *
+ * Errors are counted and backed off per meter by MeterBus, so one dead
+ * meter does not trigger handleErrors() for the whole panel.
+ *
+ * @param upload Publish at once
+ * @param target Bus index to read now, every tier (-1: next due meter)
+ */
+bool readBus(bool upload, int target) {
+#if METER_BUS_SIZE > 0
+    HardwareManager::setLED(LEDColor::BLUE);
+    
+    BusMeter* meter;
+    bool success;
+    if (target >= 0) {
+        meter = &meterBus.meter(target);
+        success = meterBus.pollMeter(target);
+    } else {
+        success = meterBus.poll(meter);
+    }
+    readingCount++;
+    
+    if (!meter) {
+        HardwareManager::ledsOff();
         return false;
     }
     
-    bool result = mqttClient.publish(topic.c_str(), payload.c_str(), false);
+    uint8_t index = meter - &meterBus.meter(0);
+    reportMetrics(meter->protocol.getMetrics(), index);
     
-    if (result) {
-        LOG_DEBUG("Published to " + topic);
-    } else {
-        LOG_ERROR("Failed to publish to " + topic);
+    if (success) {
+        // The bus associates inside poll(), so both milestones land here
+        BootProfile::mark(BootPhase::METER_LINK);
+        BootProfile::mark(BootPhase::FIRST_READING);
+        LOG_INFO("✓ Meter " + String(meter->data.serialNumber) + " read successfully");
+        meter->data.printSummary();
+        reportReading(meter->data, index, upload);
     }
     
-    return result;
+    HardwareManager::ledsOff();
+    return success;
+#else
+    return false;
+#endif
 }
 
-void mqttCallback(char* topic, byte* payload, unsigned int length) {
-    String message = "";
-    for (unsigned int i = 0; i < length; i++) {
-        message += (char)payload[i];
+/**
+ * @brief Read the registers of a targeted remote read
+ *
+ * Values go straight into the result; the reading in MeterData and the
+ * poll schedule are left alone. A single meter reuses (and keeps) a
+ * held association.
+ */
+bool readTargeted(const MeterCommand& command, CommandResult& result) {
+    RegisterRead reads[COMMAND_MAX_REGISTERS];
+    for (uint8_t i = 0; i < command.count; i++) {
+        const ReadPlanEntry& entry = ReadPlan::entry(command.registers[i]);
+        reads[i].obis = entry.obis;
+        reads[i].value = &result.values[i];
+        reads[i].timestamp = entry.timestamp == ReadPlanEntry::NO_TIMESTAMP
+                           ? nullptr : &result.timestamps[i];
     }
     
-    LOG_INFO("MQTT Message [" + String(topic) + "]: " + message);
+#if METER_BUS_SIZE > 0
+    DLMSProtocol& protocol = meterBus.meter(command.meter).protocol;
+    const bool hold = false;
+#else
+    DLMSProtocol& protocol = dlms;
+    const bool hold = DLMS_HOLD_ASSOCIATION;
+#endif
     
-    // Handle commands
-    if (message == "READ") {
-        LOG_INFO("Remote read command received");
-        readMeter();
-        uploadData();
+    HardwareManager::setLED(LEDColor::BLUE);
+    
+    bool held = hold && protocol.isConnected();
+    bool success = (held || protocol.connect()) && protocol.readRegisters(reads, command.count);
+    
+    if (!success && held) {
+        LOG_WARN("Held association lost - re-associating");
+        protocol.disconnect();
+        success = protocol.connect() && protocol.readRegisters(reads, command.count);
     }
-    else if (message == "STATUS") {
-        printSystemStatus();
-        uploadData();
+    
+    if (!hold || !success) {
+        protocol.disconnect();
     }
-    else if (message == "RESTART") {
-        LOG_WARN("Restart command received");
-        delay(1000);
-        ESP.restart();
+    reportMetrics(protocol.getMetrics(), command.meter);
+    HardwareManager::ledsOff();
+    
+    if (!success) {
+        LOG_ERROR("Targeted read failed");
     }
+    return success;
 }
 
 // ============================================
-// HTTP FUNCTIONS
+// LOAD PROFILE
 // ============================================
 
-bool publishHTTP(const String& jsonData) {
-    if (!HTTP_ENABLED) return false;
-    
-    HTTPClient http;
-    
-    LOG_INFO("Posting to HTTP API...");
-    
-    http.begin(API_ENDPOINT);
-    http.addHeader("Content-Type", "application/json");
-    http.addHeader("X-API-Key", API_KEY);
-    http.setTimeout(5000);
+/**
+ * @class ProfileUploader
+ * @brief Hands profile rows to the network task in chunks of PROFILE_PUBLISH_ROWS
+ *
+ * Waits up to PROFILE_QUEUE_WAIT for room in the queue; if the network
+ * stays behind the read stops and resumes from the last published row
+ * next time.
+ */
+class ProfileUploader : public ProfileRecordSink {
+public:
+    explicit ProfileUploader(uint32_t start) {
+        chunk.after = start;
+        chunk.count = 0;
+    }
     
-    int httpCode = http.POST(jsonData);
+    bool onRecord(const ProfileRecord& record) override {
+        chunk.rows[chunk.count++] = record;
+        if (chunk.count >= PROFILE_PUBLISH_ROWS) {
+            return flush();
+        }
+        return true;
+    }
     
-    if (httpCode > 0) {
-        LOG_INFO("HTTP Response code: " + String(httpCode));
+    bool flush() {
+        if (chunk.count == 0) return true;
         
-        if (httpCode == HTTP_CODE_OK || httpCode == HTTP_CODE_CREATED) {
-            String response = http.getString();
-            LOG_DEBUG("Response: " + response);
-            http.end();
-            return true;
+        unsigned long start = millis();
+        while (!profileQueue.push(chunk)) {
+            if (millis() - start >= PROFILE_QUEUE_WAIT) {
+                LOG_WARN("Uplink busy - load profile read paused");
+                return false;
+            }
+            delay(10);
         }
-    } else {
-        LOG_ERROR("HTTP POST failed: " + http.errorToString(httpCode));
+        
+        chunk.after = chunk.rows[chunk.count - 1].captureTime;
+        chunk.count = 0;
+        return true;
     }
-    
-    http.end();
-    return false;
-}
 
-// ============================================
-// METER READING FUNCTIONS
-// ============================================
+private:
+    ProfileChunk chunk;
+};
 
-bool readMeter() {
-    HardwareManager::setLED(LEDColor::BLUE);
-    
-    LOG_INFO("Connecting to meter...");
-    
-    if (!dlms.connect()) {
-        LOG_ERROR("Failed to connect to meter");
-        HardwareManager::showError(2);
+bool readLoadProfile() {
+    uint32_t now;
+    if (!dlms.readClock(now)) {
+        LOG_WARN("Cannot read meter clock - skipping load profile");
         return false;
     }
     
-    LOG_INFO("Reading meter data...");
+    uint32_t committed = lastProfileCapture;
+    uint32_t from = committed ? committed + 1 : now - PROFILE_INITIAL_SPAN;
+    if (from > now) {
+        return true;
+    }
     
-    bool success = dlms.readMeterData(meterData);
+    ProfileUploader uploader(committed);
+    uint32_t lastCapture = 0;
+    bool success = dlms.readProfile(OBISCodes::LOAD_PROFILE, from, now, uploader, lastCapture);
+    uploader.flush();
     
-    if (success) {
-        LOG_INFO("✓ Meter data read successfully");
-        meterData.printSummary();
-        
-        // Optional: Print full data
-        // meterData.print();
+    return success;
+}
+
+/**
+ * @brief Publish one chunk of profile rows and commit its last capture time
+ *
+ * A chunk that does not continue from the committed row belongs to a
+ * read whose earlier chunk failed; it is dropped and re-read later.
+ */
+void publishProfile(const ProfileChunk& chunk) {
+    if (chunk.count == 0 || chunk.after != lastProfileCapture) {
+        return;
+    }
+    
+    const ProfileRecord* rows = chunk.rows;
+    String topic = String(MQTT_TOPIC_BASE) + meterData.serialNumber + "/" + MQTT_TOPIC_PROFILE;
+    bool published;
+    
+    if (MQTT_PROFILE_ENCODING == PAYLOAD_BINARY) {
+        size_t length = PayloadEncoder::encodeProfile(meterData.serialNumber, rows, chunk.count,
+                                                      payloadBuffer, sizeof(payloadBuffer));
+        published = publishMQTT(topic, payloadBuffer, length);
     } else {
-        LOG_ERROR("Failed to read meter data");
-        HardwareManager::showError(3);
+        StaticJsonDocument<4096> doc;
+        doc["serial"] = meterData.serialNumber;
+        JsonArray data = doc.createNestedArray("rows");
+        for (uint8_t i = 0; i < chunk.count; i++) {
+            JsonArray row = data.createNestedArray();
+            row.add(rows[i].captureTime);
+            for (uint8_t v = 0; v < rows[i].valueCount; v++) {
+                row.add(rows[i].values[v]);
+            }
+        }
+        
+        published = publishMQTT(topic, doc);
     }
     
-    dlms.disconnect();
-    HardwareManager::ledsOff();
+    if (!published) {
+        return;
+    }
     
-    return success;
+    lastProfileCapture = rows[chunk.count - 1].captureTime;
+    
+#if PREFERENCES_ENABLED
+    Preferences prefs;
+    if (prefs.begin(PROFILE_NAMESPACE, false)) {
+        prefs.putUInt("last", lastProfileCapture);
+        prefs.end();
+    }
+#endif
+    
+    char text[20];
+    DLMSDateTime::format(lastProfileCapture, text);
+    LOG_INFO("Load profile uploaded up to " + String(text));
 }
 
 // ============================================
 // DATA UPLOAD FUNCTIONS
 // ============================================
 
-void uploadData() {
-    if (!meterData.isValid()) {
+void uploadData(const MeterData& data) {
+    if (!data.isValid()) {
         LOG_WARN("Cannot upload - data not valid");
         return;
     }
@@ -402,44 +1698,242 @@ void uploadData() {
     LOG_INFO("  Uploading Data to Cloud");
     LOG_INFO("─────────────────────────────────────");
     
-    // Create JSON (without TOD for smaller payload)
-    String jsonData = meterData.toJsonString(false);
-    
-    LOG_DEBUG("JSON Size: " + String(jsonData.length()) + " bytes");
+    // JSON document (without TOD for smaller payload) on the stack,
+    // unless the broker takes the binary encoding
+    StaticJsonDocument<MeterData::JSON_CAPACITY> doc;
+    if (MQTT_DATA_ENCODING == PAYLOAD_JSON) {
+        data.toJson(doc, false);
+        LOG_DEBUG("JSON Size: " + String(measureJson(doc)) + " bytes");
+    }
     
     bool uploadSuccess = false;
+    bool mqttPublished = false;
     
-    // Upload via MQTT
-    if (MQTT_ENABLED && mqttConnected) {
-        String dataTopic = String(MQTT_TOPIC_BASE) + meterData.serialNumber + "/" + MQTT_TOPIC_DATA;
+    // Upload via MQTT (batched readings go out through flushBatch)
+    if (MQTT_ENABLED && !MQTT_BATCH_ENABLED && mqttConnected) {
+        String dataTopic = String(MQTT_TOPIC_BASE) + data.serialNumber + "/" + MQTT_TOPIC_DATA;
         
-        if (publishMQTT(dataTopic, jsonData)) {
+        bool published;
+        if (MQTT_DATA_ENCODING == PAYLOAD_BINARY) {
+            size_t length = PayloadEncoder::encodeMeterData(data, false, payloadBuffer,
+                                                            sizeof(payloadBuffer));
+            published = publishMQTT(dataTopic, payloadBuffer, length);
+        } else {
+            published = publishMQTT(dataTopic, doc);
+        }
+        
+        if (published) {
             LOG_INFO("✓ MQTT upload successful");
             uploadSuccess = true;
+            mqttPublished = true;
         } else {
             LOG_ERROR("✗ MQTT upload failed");
         }
     }
     
-    // Upload via HTTP
-    if (HTTP_ENABLED && wifiConnected) {
-        if (publishHTTP(jsonData)) {
-            LOG_INFO("✓ HTTP upload successful");
-            uploadSuccess = true;
-        } else {
-            LOG_ERROR("✗ HTTP upload failed");
-        }
+    // HTTP and ThingSpeak send from the offline log on their own tasks,
+    // so a slow backend holds up neither MQTT nor the next poll; it also
+    // keeps the reading for the broker if that did not take it
+    uint8_t taken = IDLE_CURSORS;
+    if (mqttPublished || MQTT_BATCH_ENABLED) taken |= LogCursor::bit(LogCursor::MQTT);
+    if (taken != ALL_CURSORS) {
+        storeOffline(data, taken);
+        wakeUplinks();
     }
     
     if (uploadSuccess) {
+        BootProfile::mark(BootPhase::FIRST_UPLOAD);
         HardwareManager::blinkLED(LEDColor::GREEN, 2, 200, 200);
-    } else {
+    } else if (UPLINK_SINKS == 0) {
         LOG_WARN("No upload method succeeded");
     }
     
     LOG_INFO("─────────────────────────────────────\n");
 }
 
+/**
+ * @brief Append a reading to the offline log
+ * @param taken LogCursor bits of backends that already have it
+ */
+static_assert(PayloadEncoder::METER_DATA_MAX <= OfflineLog::MAX_PAYLOAD,
+              "OFFLINE_RECORD_SIZE too small for the largest reading");
+
+void storeOffline(const MeterData& data, uint8_t taken) {
+    size_t length = PayloadEncoder::encodeMeterData(data, false, payloadBuffer,
+                                                    OfflineLog::MAX_PAYLOAD);
+    if (length == 0 || !offlineLog.append(payloadBuffer, length, taken | IDLE_CURSORS)) {
+        LOG_WARN("Reading could not be stored offline");
+        return;
+    }
+    if (!(taken & LogCursor::bit(LogCursor::MQTT))) {
+        LOG_INFO("Reading stored offline (" + String(offlineLog.pending(LogCursor::MQTT)) +
+                 " pending)");
+    }
+}
+
+/**
+ * @brief Publish a reading by exception
+ *
+ * A keyframe goes through uploadData (MQTT, HTTP, offline log); between
+ * keyframes only fields past their deadband are published. While the
+ * broker is away nothing is sent and the changes add up against the
+ * last published values, so the first delta after reconnect carries
+ * them all.
+ */
+void reportChanges(ChangeReporter& reporter, const MeterData& data) {
+    unsigned long now = millis();
+    if (reporter.keyframeDue(now)) {
+        uploadData(data);
+        reporter.keyframeSent(data, now);
+        return;
+    }
+    
+    if (!MQTT_ENABLED || !mqttConnected) return;
+    
+    FieldChange changes[ChangeReporter::FIELDS];
+    uint8_t count = reporter.changes(data, changes);
+    if (count == 0) {
+        LOG_DEBUG("No field beyond its deadband");
+        return;
+    }
+    
+    String topic = String(MQTT_TOPIC_BASE) + data.serialNumber + "/" + MQTT_TOPIC_DELTA;
+    bool published;
+    
+    if (MQTT_DATA_ENCODING == PAYLOAD_BINARY) {
+        size_t length = PayloadEncoder::encodeChanges(data, changes, count, payloadBuffer,
+                                                      sizeof(payloadBuffer));
+        published = publishMQTT(topic, payloadBuffer, length);
+    } else {
+        StaticJsonDocument<2048> doc;
+        char text[20];
+        char key[24];
+        doc["serial"] = data.serialNumber;
+        DLMSDateTime::format(data.lastReadTimestamp, text);
+        doc["time"] = text;
+        
+        JsonObject fields = doc.createNestedObject("changes");
+        for (uint8_t i = 0; i < count; i++) {
+            const char* name = ChangeReporter::fieldName(changes[i].id);
+            fields[name] = changes[i].value;
+            if (ChangeReporter::hasTime(changes[i].id) && changes[i].time != 0) {
+                DLMSDateTime::format(changes[i].time, text);
+                snprintf(key, sizeof(key), "%s_time", name);
+                fields[key] = text;
+            }
+        }
+        
+        published = publishMQTT(topic, doc);
+    }
+    
+    if (published) {
+        BootProfile::mark(BootPhase::FIRST_UPLOAD);
+        reporter.commit(changes, count);
+        LOG_INFO("✓ Published " + String(count) + " changed fields");
+    }
+}
+
+/**
+ * @brief Queue a reading for the batched uplink
+ *
+ * A full batch that cannot be published keeps its readings; the new
+ * one goes to the offline log instead, so nothing is lost while the
+ * broker is away.
+ */
+void batchReading(ReadingBatch& batch, const MeterData& data) {
+    if (batch.add(data)) {
+        return;
+    }
+    if (!flushBatch(batch) || !batch.add(data)) {
+        storeOffline(data, ALL_CURSORS & ~LogCursor::bit(LogCursor::MQTT));
+    }
+}
+
+bool flushBatch(ReadingBatch& batch) {
+    if (batch.empty()) return true;
+    
+    String topic = String(MQTT_TOPIC_BASE) + batch.serial() + "/" + MQTT_TOPIC_BATCH;
+    size_t length = PayloadEncoder::encodeBatch(batch, payloadBuffer, sizeof(payloadBuffer));
+    if (!publishMQTT(topic, payloadBuffer, length)) {
+        return false;
+    }
+    BootProfile::mark(BootPhase::FIRST_UPLOAD);
+    
+    LOG_INFO("✓ Published batch of " + String(batch.size()) + " readings (" +
+             String(length) + " bytes)");
+    batch.clear();
+    return true;
+}
+
+bool BacklogUploader::onRecord(const uint8_t* payload, size_t length) {
+    String topic = String(MQTT_TOPIC_BASE) + MQTT_TOPIC_BACKLOG;
+    return publishMQTT(topic, payload, length);
+}
+
+void PQPublisher::onWindow(const WindowSummary& summary) {
+    if (!MQTT_ENABLED || !mqttConnected) return;
+    
+    String topic = String(MQTT_TOPIC_BASE) + summary.serial + "/" + MQTT_TOPIC_PQ;
+    bool published;
+    
+    if (MQTT_PQ_ENCODING == PAYLOAD_BINARY) {
+        size_t length = PayloadEncoder::encodeWindow(summary, payloadBuffer,
+                                                     sizeof(payloadBuffer));
+        published = publishMQTT(topic, payloadBuffer, length);
+    } else {
+        StaticJsonDocument<2048> doc;
+        doc["serial"] = summary.serial;
+        doc["start"] = summary.start;
+        doc["length"] = summary.length;
+        doc["samples"] = summary.samples;
+        for (uint8_t c = 0; c < PQChannel::COUNT; c++) {
+            const ChannelSummary& s = summary.channels[c];
+            JsonObject channel = doc.createNestedObject(PQChannel::name(c));
+            channel["min"] = s.min;
+            channel["max"] = s.max;
+            channel["mean"] = s.mean;
+            channel["std"] = s.stddev;
+            channel["p5"] = s.p5;
+            channel["p50"] = s.p50;
+            channel["p95"] = s.p95;
+        }
+        
+        published = publishMQTT(topic, doc);
+    }
+    
+    if (published) {
+        LOG_DEBUG("Power-quality window " + String(summary.length) + " s published (" +
+                  String(summary.samples) + " samples)");
+    } else {
+        LOG_WARN("Power-quality window dropped");
+    }
+}
+
+void PQPublisher::onEvent(const ThresholdEvent& event) {
+    LOG_WARN(String(PQChannel::name(event.channel)) + " " +
+             (event.state > 0 ? "above" : event.state < 0 ? "below" : "back within") +
+             " limit " + String(event.limit, 2) + ": " + String(event.value, 2));
+    
+    if (!MQTT_ENABLED || !mqttConnected) return;
+    
+    String topic = String(MQTT_TOPIC_BASE) + event.serial + "/" + MQTT_TOPIC_EVENT;
+    
+    if (MQTT_PQ_ENCODING == PAYLOAD_BINARY) {
+        size_t length = PayloadEncoder::encodeEvent(event, payloadBuffer, sizeof(payloadBuffer));
+        publishMQTT(topic, payloadBuffer, length);
+    } else {
+        StaticJsonDocument<192> doc;
+        doc["serial"] = event.serial;
+        doc["time"] = event.time;
+        doc["channel"] = PQChannel::name(event.channel);
+        doc["state"] = event.state;
+        doc["value"] = event.value;
+        doc["limit"] = event.limit;
+        
+        publishMQTT(topic, doc);
+    }
+}
+
 // ============================================
 // ERROR HANDLING
 // ============================================
@@ -487,6 +1981,9 @@ void printSystemStatus() {
     LOG_INFO("║ Firmware: v" FIRMWARE_VERSION "                         ║");
     LOG_INFO("║ Uptime: " + String(millis() / 1000 / 60) + " minutes                      ║");
     LOG_INFO("║ Free Heap: " + String(ESP.getFreeHeap()) + " bytes            ║");
+    PowerStats power = PowerManager::stats();
+    LOG_INFO("║ Energy: " + String(power.energy, 1) + " J, " +
+             String(power.perReading, 1) + " mJ/reading      ║");
     LOG_INFO("╠═══════════════════════════════════════════╣");
     
     // WiFi status
@@ -508,10 +2005,21 @@ void printSystemStatus() {
     LOG_INFO("╠═══════════════════════════════════════════╣");
     
     // Meter status
-    LOG_INFO("║ Meter S/N: " + meterData.serialNumber + "                   ║");
+    LOG_INFO("║ Meter S/N: " + String(meterData.serialNumber) + "                   ║");
     LOG_INFO("║ Readings: " + String(readingCount) + "                           ║");
     LOG_INFO("║ Errors: " + String(consecutiveErrors) + "/" + String(MAX_CONSECUTIVE_ERRORS) + "                           ║");
     LOG_INFO("║ Data Valid: " + String(meterData.isValid() ? "Yes ✓" : "No ✗") + "                  ║");
+    LOG_INFO("║ Link: gap " + String(dlms.getPacer().getGap()) + " ms, turnaround " +
+             String(dlms.getPacer().getTurnaround()) + " ms       ║");
+    
+#if METER_BUS_SIZE > 0
+    for (uint8_t i = 0; i < meterBus.size(); i++) {
+        const BusMeter& m = meterBus.meter(i);
+        LOG_INFO("║ Bus " + String(m.protocol.getPhysicalAddress()) + ": " +
+                 busData[i].serialNumber + " reads " + String(m.reads) +
+                 ", errors " + String(m.errors) + "        ║");
+    }
+#endif
     
     if (meterData.isValid()) {
         LOG_INFO("║ kWh: " + String(meterData.kwhImport, 2) + "                         ║");
@@ -522,35 +2030,71 @@ void printSystemStatus() {
     LOG_INFO("╚═══════════════════════════════════════════╝\n");
 }
 
-// ============================================
-// OPTIONAL: THINGSPEAK UPLOAD
-// ============================================
-
-#if THINGSPEAK_ENABLED
-void uploadToThingSpeak() {
-    if (!wifiConnected) return;
-    
-    HTTPClient http;
-    String url = "http://api.thingspeak.com/update?api_key=" + String(THINGSPEAK_API_KEY);
-    url += "&field1=" + String(meterData.kwhImport);
-    url += "&field2=" + String(meterData.voltageR);
-    url += "&field3=" + String(meterData.currentR);
-    url += "&field4=" + String(meterData.powerFactor);
-    url += "&field5=" + String(meterData.frequency);
-    url += "&field6=" + String(meterData.mdKWImport.value);
-    
-    http.begin(url);
-    int httpCode = http.GET();
-    
-    if (httpCode > 0) {
-        LOG_INFO("ThingSpeak upload successful");
-    } else {
-        LOG_ERROR("ThingSpeak upload failed");
+void publishStatus() {
+    StaticJsonDocument<1024 + METER_BUS_SIZE * 160> doc;
+    doc["state"] = "online";
+    doc["uptime"] = millis() / 1000;
+    doc["heap"] = ESP.getFreeHeap();
+    doc["rssi"] = WiFi.RSSI();
+    doc["readings"] = readingCount;
+    doc["errors"] = consecutiveErrors;
+    
+    systemMetrics.sample(meteringTaskHandle, nullptr);
+    systemMetrics.toJson(doc.createNestedObject("system"));
+    PowerManager::stats().toJson(doc.createNestedObject("power"));
+    
+    JsonObject boot = doc.createNestedObject("boot");
+    BootProfile::toJson(boot);
+    boot["wifi_ms"] = WiFiLink::getConnectTime();
+    boot["wifi_cached"] = WiFiLink::usedCache();
+    
+#if METER_BUS_SIZE > 0
+    JsonArray meters = doc.createNestedArray("meters");
+    for (uint8_t i = 0; i < meterBus.size(); i++) {
+        const BusMeter& m = meterBus.meter(i);
+        JsonObject entry = meters.createNestedObject();
+        entry["address"] = m.protocol.getPhysicalAddress();
+        entry["serial"] = busData[i].serialNumber;
+        entry["reads"] = m.reads;
+        entry["errors"] = m.errors;
+        entry["failures"] = m.failures;
+        entry["gap_ms"] = m.protocol.getPacer().getGap();
     }
+#else
+    const LinkPacer& pacer = dlms.getPacer();
+    JsonObject link = doc.createNestedObject("link");
+    link["gap_ms"] = pacer.getGap();
+    link["turnaround_ms"] = pacer.getTurnaround();
+    link["failures"] = pacer.getFailures();
+#endif
     
-    http.end();
+    String topic = String(MQTT_TOPIC_BASE) + meterData.serialNumber + "/" + MQTT_TOPIC_STATUS;
+    publishMQTT(topic, doc);
 }
+
+/**
+ * @brief Publish each meter's link metrics under its status topic
+ *
+ * One message per meter keeps each within MQTT_BUFFER_SIZE.
+ */
+void publishMetrics() {
+    for (uint8_t i = 0; i < sizeof(linkMetrics) / sizeof(linkMetrics[0]); i++) {
+#if METER_BUS_SIZE > 0
+        const MeterData& data = busData[i];
+#else
+        const MeterData& data = meterData;
 #endif
+        if (linkMetrics[i].framesTx == 0) continue;
+        
+        StaticJsonDocument<METRICS_JSON_SIZE> doc;
+        doc["serial"] = data.serialNumber;
+        linkMetrics[i].toJson(doc.createNestedObject("link"));
+        
+        String topic = String(MQTT_TOPIC_BASE) + data.serialNumber + "/" +
+                       MQTT_TOPIC_STATUS + "/metrics";
+        publishMQTT(topic, doc);
+    }
+}
 
 // ============================================
 // OPTIONAL: WEB SERVER (if enabled)
@@ -561,21 +2105,80 @@ void uploadToThingSpeak() {
 
 WebServer webServer(80);
 
+/**
+ * @class MetricsPage
+ * @brief Streams metrics text as chunks of the current response
+ */
+class MetricsPage : public MetricsTextSink {
+public:
+    void write(const char* text, size_t length) override { webServer.sendContent(text, length); }
+};
+
+/**
+ * @class ResponseChunks
+ * @brief Print onto the current chunked response
+ *
+ * Wrapped in a BufferedPrint, so each chunk carries JSON_STREAM_CHUNK
+ * bytes rather than one character.
+ */
+class ResponseChunks : public Print {
+public:
+    using Print::write;
+    
+    size_t write(uint8_t c) override { return write(&c, 1); }
+    
+    size_t write(const uint8_t* data, size_t length) override {
+        webServer.sendContent((const char*)data, length);
+        return length;
+    }
+};
+
 void setupWebServer() {
     webServer.on("/", []() {
-        String html = "<html><body>";
-        html += "<h1>DLMS Meter Reader</h1>";
-        html += "<p>Serial: " + meterData.serialNumber + "</p>";
-        html += "<p>kWh: " + String(meterData.kwhImport) + "</p>";
-        html += "<p>Voltage: " + String(meterData.voltageR) + " V</p>";
-        html += "<p><a href='/data'>JSON Data</a></p>";
-        html += "</body></html>";
-        webServer.send(200, "text/html", html);
+        webServer.setContentLength(CONTENT_LENGTH_UNKNOWN);
+        webServer.send(200, "text/html", "");
+        ResponseChunks chunks;
+        BufferedPrint<JSON_STREAM_CHUNK> page(chunks);
+        page.print("<html><body><h1>DLMS Meter Reader</h1>");
+        page.printf("<p>Serial: %s</p>", meterData.serialNumber);
+        page.printf("<p>kWh: %.2f</p>", meterData.kwhImport);
+        page.printf("<p>Voltage: %.2f V</p>", meterData.voltageR);
+        page.print("<p><a href='/data'>JSON Data</a></p></body></html>");
+        page.flush();
+        webServer.sendContent("");
     });
     
     webServer.on("/data", []() {
-        String json = meterData.toJsonString(true);
-        webServer.send(200, "application/json", json);
+        webServer.setContentLength(CONTENT_LENGTH_UNKNOWN);
+        webServer.send(200, "application/json", "");
+        ResponseChunks chunks;
+        BufferedPrint<JSON_STREAM_CHUNK> body(chunks);
+        meterData.toJson(body, true);
+        body.flush();
+        webServer.sendContent("");
+    });
+    
+    // Prometheus text exposition, streamed in chunks
+    webServer.on("/metrics", []() {
+        MetricsPage page;
+        const char* meters[sizeof(linkMetrics) / sizeof(linkMetrics[0])];
+        for (uint8_t i = 0; i < sizeof(linkMetrics) / sizeof(linkMetrics[0]); i++) {
+#if METER_BUS_SIZE > 0
+            meters[i] = busData[i].serialNumber[0] ? busData[i].serialNumber : "unknown";
+#else
+            meters[i] = meterData.serialNumber[0] ? meterData.serialNumber : "unknown";
+#endif
+        }
+        
+        systemMetrics.sample(meteringTaskHandle, nullptr);
+        webServer.setContentLength(CONTENT_LENGTH_UNKNOWN);
+        webServer.send(200, "text/plain; version=0.0.4", "");
+        systemMetrics.toPrometheus(page);
+        PowerManager::stats().toPrometheus(page);
+        BootProfile::toPrometheus(page);
+        LinkMetrics::toPrometheus(page, linkMetrics, meters,
+                                  sizeof(linkMetrics) / sizeof(linkMetrics[0]));
+        webServer.sendContent("");
     });
     
     webServer.begin();
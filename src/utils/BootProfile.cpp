@@ -0,0 +1,92 @@
+/**
+ * @file BootProfile.cpp
+ * @brief Implementation of the boot milestone record
+ * @version 2.0
+ * @date 2025-10-02
+ */
+
+#include "BootProfile.h"
+#include "Logger.h"
+
+#ifdef ARDUINO_ARCH_ESP32
+#include <esp_system.h>
+#endif
+
+volatile uint32_t BootProfile::phases[(uint8_t)BootPhase::COUNT] = {0};
+const char* BootProfile::reason = "unknown";
+
+void BootProfile::begin() {
+#ifdef ARDUINO_ARCH_ESP32
+    switch (esp_reset_reason()) {
+        case ESP_RST_POWERON:   reason = "power_on"; break;
+        case ESP_RST_EXT:       reason = "external"; break;
+        case ESP_RST_SW:        reason = "software"; break;
+        case ESP_RST_PANIC:     reason = "panic"; break;
+        case ESP_RST_INT_WDT:
+        case ESP_RST_TASK_WDT:
+        case ESP_RST_WDT:       reason = "watchdog"; break;
+        case ESP_RST_DEEPSLEEP: reason = "deep_sleep"; break;
+        case ESP_RST_BROWNOUT:  reason = "brownout"; break;
+        default:                reason = "unknown"; break;
+    }
+#endif
+}
+
+void BootProfile::mark(BootPhase phase) {
+    uint8_t index = (uint8_t)phase;
+    if (index >= (uint8_t)BootPhase::COUNT || phases[index] != 0) return;
+
+    // A milestone at 0 ms would read as not reached
+    uint32_t now = millis();
+    phases[index] = now ? now : 1;
+    LOG_INFOF("Boot: %s at %u ms", phaseName(phase), (unsigned)now);
+}
+
+const char* BootProfile::phaseName(BootPhase phase) {
+    switch (phase) {
+        case BootPhase::HARDWARE:      return "hardware";
+        case BootPhase::TASKS:         return "tasks";
+        case BootPhase::STORAGE:       return "storage";
+        case BootPhase::METER_LINK:    return "meter_link";
+        case BootPhase::FIRST_READING: return "first_reading";
+        case BootPhase::WIFI:          return "wifi";
+        case BootPhase::MQTT:          return "mqtt";
+        case BootPhase::FIRST_UPLOAD:  return "first_upload";
+        default:                       return "unknown";
+    }
+}
+
+void BootProfile::toJson(JsonObject out) {
+    out["reset"] = reason;
+    for (uint8_t i = 0; i < (uint8_t)BootPhase::COUNT; i++) {
+        if (phases[i]) {
+            out[phaseName((BootPhase)i)] = (uint32_t)phases[i];
+        }
+    }
+}
+
+/**
+ * @brief Length snprintf actually wrote, given its return value
+ */
+static size_t bounded(int n, size_t size) {
+    if (n < 0) return 0;
+    return (size_t)n < size ? (size_t)n : size - 1;
+}
+
+void BootProfile::toPrometheus(MetricsTextSink& sink) {
+    char line[96];
+    int n = snprintf(line, sizeof(line),
+                     "# TYPE device_reset_info gauge\n"
+                     "device_reset_info{reason=\"%s\"} 1\n", reason);
+    sink.write(line, bounded(n, sizeof(line)));
+
+    static const char PHASE_TYPE[] = "# TYPE device_boot_phase_milliseconds gauge\n";
+    sink.write(PHASE_TYPE, sizeof(PHASE_TYPE) - 1);
+    for (uint8_t i = 0; i < (uint8_t)BootPhase::COUNT; i++) {
+        if (!phases[i]) continue;
+        n = snprintf(line, sizeof(line),
+                     "device_boot_phase_milliseconds{phase=\"%s\"} %lu\n",
+                     phaseName((BootPhase)i), (unsigned long)phases[i]);
+        sink.write(line, bounded(n, sizeof(line)));
+    }
+}
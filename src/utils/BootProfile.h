@@ -0,0 +1,81 @@
+/**
+ * @file BootProfile.h
+ * @brief Time from reset to each boot milestone
+ * @version 2.0
+ * @date 2025-10-02
+ */
+
+#ifndef BOOT_PROFILE_H
+#define BOOT_PROFILE_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include "../config/config.h"
+#include "../dlms/LinkMetrics.h"
+
+/**
+ * @enum BootPhase
+ * @brief Milestones of a boot, roughly in the order they are reached
+ */
+enum class BootPhase : uint8_t {
+    HARDWARE,       // Pins, UART and meter stack initialized
+    TASKS,          // Metering and network tasks started
+    STORAGE,        // Offline log and profile state loaded
+    METER_LINK,     // First meter association
+    FIRST_READING,  // First successful reading
+    WIFI,           // Station connected with an IP
+    MQTT,           // Broker connected
+    FIRST_UPLOAD,   // First reading delivered
+    COUNT
+};
+
+/**
+ * @class BootProfile
+ * @brief millis() at each milestone of the current boot
+ *
+ * Each phase is marked by one task only and just once, so no lock is
+ * needed; 0 means the phase has not been reached yet.
+ */
+class BootProfile {
+public:
+    /**
+     * @brief Record the reset reason; call first in setup()
+     */
+    static void begin();
+
+    /**
+     * @brief Record the time of a milestone (later calls are ignored)
+     */
+    static void mark(BootPhase phase);
+
+    /**
+     * @brief ms from reset to the milestone (0 if not reached)
+     */
+    static uint32_t at(BootPhase phase) { return phases[(uint8_t)phase]; }
+
+    /**
+     * @brief Lower-case phase name
+     */
+    static const char* phaseName(BootPhase phase);
+
+    /**
+     * @brief Why the chip last reset
+     */
+    static const char* resetReason() { return reason; }
+
+    /**
+     * @brief Reached milestones for the status message
+     */
+    static void toJson(JsonObject out);
+
+    /**
+     * @brief Prometheus text exposition
+     */
+    static void toPrometheus(MetricsTextSink& sink);
+
+private:
+    static volatile uint32_t phases[(uint8_t)BootPhase::COUNT];
+    static const char* reason;
+};
+
+#endif // BOOT_PROFILE_H
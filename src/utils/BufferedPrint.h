@@ -0,0 +1,75 @@
+/**
+ * @file BufferedPrint.h
+ * @brief Print adapter that hands output on in fixed-size chunks
+ * @version 2.0
+ * @date 2025-10-02
+ *
+ * ArduinoJson serializes into a Print mostly one character at a time.
+ * Written straight to a socket (PubSubClient, WebServer chunks) every
+ * character would be a TCP write of its own; collected here they go out
+ * N bytes at a time from a buffer on the stack, with no heap involved.
+ */
+
+#ifndef BUFFERED_PRINT_H
+#define BUFFERED_PRINT_H
+
+#include <Arduino.h>
+
+/**
+ * @class BufferedPrint
+ * @brief Collects writes and forwards them in chunks of up to N bytes
+ * @tparam N Chunk size
+ */
+template <size_t N>
+class BufferedPrint : public Print {
+public:
+    explicit BufferedPrint(Print& target) : target(target), used(0), total(0) {}
+
+    ~BufferedPrint() { flush(); }
+
+    using Print::write;
+
+    size_t write(uint8_t c) override {
+        if (used == N) flush();
+        buffer[used++] = c;
+        total++;
+        return 1;
+    }
+
+    size_t write(const uint8_t* data, size_t length) override {
+        size_t left = length;
+        while (left > 0) {
+            if (used == N) flush();
+            size_t n = N - used < left ? N - used : left;
+            memcpy(buffer + used, data, n);
+            used += n;
+            data += n;
+            left -= n;
+        }
+        total += length;
+        return length;
+    }
+
+    /**
+     * @brief Pass on what is buffered
+     */
+    void flush() override {
+        if (used > 0) {
+            target.write(buffer, used);
+            used = 0;
+        }
+    }
+
+    /**
+     * @brief Bytes written so far
+     */
+    size_t written() const { return total; }
+
+private:
+    Print& target;
+    size_t used;
+    size_t total;
+    uint8_t buffer[N];
+};
+
+#endif // BUFFERED_PRINT_H
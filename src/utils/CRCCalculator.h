@@ -9,32 +9,70 @@
 #define CRC_CALCULATOR_H
 
 #include <Arduino.h>
+#include "../config/config.h"
 
 /**
  * @class CRCCalculator
  * @brief Handles CRC16-X25 checksum calculation for HDLC/DLMS frames
+ * 
+ * Table-driven and stateless. A running CRC can be fed byte by byte
+ * while a frame streams in: start from INITIAL_VALUE, update() every
+ * byte including the received FCS, and the frame is valid when the
+ * result equals GOOD_RESIDUE.
  */
 class CRCCalculator {
 public:
+    static const uint16_t INITIAL_VALUE = 0xFFFF;
+    static const uint16_t GOOD_RESIDUE = 0xF0B8;   // Running CRC over data + FCS
+    
     /**
-     * @brief Calculate CRC16-X25 checksum
+     * @brief Feed one byte into a running CRC
+     * @param crc Running CRC (start with INITIAL_VALUE)
+     * @param data Next byte
+     * @return Updated running CRC
+     */
+    static inline uint16_t update(uint16_t crc, uint8_t data) {
+        return (crc >> 8) ^ TABLE[(crc ^ data) & 0xFF];
+    }
+    
+    /**
+     * @brief Feed one byte into a running CRC, bitwise
+     * 
+     * constexpr and table-free, so frames with constant content get
+     * their HCS/FCS at compile time (see FrameTemplates.h).
+     */
+    static constexpr uint16_t updateConst(uint16_t crc, uint8_t data) {
+        return shiftConst(crc ^ data, 8);
+    }
+    
+    /**
+     * @brief Feed a buffer into a running CRC
+     * @param crc Running CRC (start with INITIAL_VALUE)
      * @param data Pointer to data buffer
      * @param length Length of data
-     * @return 16-bit CRC value
+     * @return Updated running CRC
      */
-    static uint16_t calculate(const uint8_t* data, uint16_t length);
+    static uint16_t update(uint16_t crc, const uint8_t* data, uint16_t length);
     
     /**
-     * @brief Get LSB of last calculated CRC
-     * @return Least significant byte
+     * @brief Calculate CRC16-X25 checksum
+     * @param data Pointer to data buffer
+     * @param length Length of data
+     * @return 16-bit CRC value (final XOR applied)
      */
-    static uint8_t getLSB();
+    static uint16_t calculate(const uint8_t* data, uint16_t length) {
+        return ~update(INITIAL_VALUE, data, length);
+    }
     
     /**
-     * @brief Get MSB of last calculated CRC
-     * @return Most significant byte
+     * @brief Store CRC in HDLC byte order (low byte first)
+     * @param dest Destination (2 bytes)
+     * @param crc CRC from calculate()
      */
-    static uint8_t getMSB();
+    static inline void put(uint8_t* dest, uint16_t crc) {
+        dest[0] = crc & 0xFF;
+        dest[1] = (crc >> 8) & 0xFF;
+    }
     
     /**
      * @brief Verify CRC of received frame
@@ -43,12 +81,24 @@ public:
      * @return true if CRC is valid
      */
     static bool verify(const uint8_t* data, uint16_t length);
+    
+#if CRC_BENCHMARK_ENABLED
+    /**
+     * @brief Time table-driven CRC against the bitwise loop it replaced
+     * 
+     * Logs microseconds per frame for both over a max-size frame.
+     */
+    static void benchmark();
+#endif
 
 private:
-    static uint8_t crcLSB;
-    static uint8_t crcMSB;
     static const uint16_t POLYNOMIAL = 0x8408; // Reversed polynomial
-    static const uint16_t INITIAL_VALUE = 0xFFFF;
+    static const uint16_t TABLE[256];          // Kept in flash (const)
+    
+    static constexpr uint16_t shiftConst(uint16_t crc, uint8_t bits) {
+        return bits == 0 ? crc :
+               shiftConst((crc & 1) ? (crc >> 1) ^ POLYNOMIAL : crc >> 1, bits - 1);
+    }
 };
 
 #endif // CRC_CALCULATOR_H 
@@ -0,0 +1,93 @@
+/**
+ * @file DLMSDateTime.cpp
+ * @brief Implementation of DLMS date-time conversion
+ * @version 2.0
+ * @date 2025-10-02
+ */
+
+#include "DLMSDateTime.h"
+
+/**
+ * @brief Days since 1970-01-01 for a proleptic Gregorian date
+ */
+int32_t DLMSDateTime::daysFromCivil(int32_t year, uint8_t month, uint8_t day) {
+    year -= month <= 2;
+    int32_t era = (year >= 0 ? year : year - 399) / 400;
+    uint32_t yoe = (uint32_t)(year - era * 400);
+    uint32_t doy = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    uint32_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + (int32_t)doe - 719468;
+}
+
+uint32_t DLMSDateTime::toEpoch(const uint8_t* dt) {
+    uint16_t year = ((uint16_t)dt[0] << 8) | dt[1];
+    uint8_t month = dt[2];
+    uint8_t day = dt[3];
+    
+    if (year == 0xFFFF || year < 1970 || month == 0 || month > 12 ||
+        day == 0 || day > 31) {
+        return 0;
+    }
+    
+    uint8_t hour = dt[5] == 0xFF ? 0 : dt[5];
+    uint8_t minute = dt[6] == 0xFF ? 0 : dt[6];
+    uint8_t second = dt[7] == 0xFF ? 0 : dt[7];
+    
+    return (uint32_t)daysFromCivil(year, month, day) * 86400UL +
+           hour * 3600UL + minute * 60UL + second;
+}
+
+void DLMSDateTime::fromEpoch(uint32_t epoch, uint8_t* dt) {
+    uint32_t days = epoch / 86400UL;
+    uint32_t secs = epoch % 86400UL;
+    
+    // Civil from days (Howard Hinnant's algorithm)
+    int32_t z = (int32_t)days + 719468;
+    int32_t era = z / 146097;
+    uint32_t doe = (uint32_t)(z - era * 146097);
+    uint32_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    int32_t year = (int32_t)yoe + era * 400;
+    uint32_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    uint32_t mp = (5 * doy + 2) / 153;
+    uint8_t day = doy - (153 * mp + 2) / 5 + 1;
+    uint8_t month = mp < 10 ? mp + 3 : mp - 9;
+    year += month <= 2;
+    
+    dt[0] = (year >> 8) & 0xFF;
+    dt[1] = year & 0xFF;
+    dt[2] = month;
+    dt[3] = day;
+    dt[4] = ((days + 3) % 7) + 1;   // 1970-01-01 was a Thursday; Monday = 1
+    dt[5] = secs / 3600;
+    dt[6] = (secs / 60) % 60;
+    dt[7] = secs % 60;
+    dt[8] = 0x00;                   // Hundredths
+    dt[9] = 0x80;                   // Deviation not specified
+    dt[10] = 0x00;
+    dt[11] = 0xFF;                  // Clock status not specified
+}
+
+void DLMSDateTime::format(uint32_t epoch, char* buffer) {
+    uint8_t dt[SIZE];
+    fromEpoch(epoch, dt);
+    sprintf(buffer, "%04u-%02u-%02u %02u:%02u:%02u",
+            ((uint16_t)dt[0] << 8) | dt[1], dt[2], dt[3], dt[5], dt[6], dt[7]);
+}
+
+uint32_t DLMSDateTime::parse(const char* text) {
+    unsigned year, month, day, hour, minute, second;
+    if (sscanf(text, "%4u-%2u-%2u %2u:%2u:%2u",
+               &year, &month, &day, &hour, &minute, &second) != 6) {
+        return 0;
+    }
+    
+    uint8_t dt[SIZE];
+    dt[0] = (year >> 8) & 0xFF;
+    dt[1] = year & 0xFF;
+    dt[2] = month;
+    dt[3] = day;
+    dt[5] = hour;
+    dt[6] = minute;
+    dt[7] = second;
+    return toEpoch(dt);
+}
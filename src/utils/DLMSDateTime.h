@@ -0,0 +1,59 @@
+/**
+ * @file DLMSDateTime.h
+ * @brief Conversion between DLMS date-time octet strings and epoch seconds
+ * @version 2.0
+ * @date 2025-10-02
+ * 
+ * DLMS date-time (12 bytes):
+ * year(2) month day day-of-week hour minute second hundredths deviation(2) status
+ * 
+ * Epoch values are meter local time in seconds since 1970-01-01,
+ * which is what the meter clock and load profile use.
+ */
+
+#ifndef DLMS_DATETIME_H
+#define DLMS_DATETIME_H
+
+#include <Arduino.h>
+
+/**
+ * @class DLMSDateTime
+ * @brief Static helpers for DLMS date-time values
+ */
+class DLMSDateTime {
+public:
+    static const uint8_t SIZE = 12;
+    
+    /**
+     * @brief Convert DLMS date-time to epoch seconds
+     * @param dt 12-byte date-time
+     * @return Seconds since 1970 (0 if date is not specified)
+     */
+    static uint32_t toEpoch(const uint8_t* dt);
+    
+    /**
+     * @brief Convert epoch seconds to DLMS date-time
+     * @param epoch Seconds since 1970
+     * @param dt Output 12-byte date-time (deviation/status not specified)
+     */
+    static void fromEpoch(uint32_t epoch, uint8_t* dt);
+    
+    /**
+     * @brief Format epoch seconds as "YYYY-MM-DD HH:MM:SS"
+     * @param epoch Seconds since 1970
+     * @param buffer Output buffer (at least 20 bytes)
+     */
+    static void format(uint32_t epoch, char* buffer);
+    
+    /**
+     * @brief Parse "YYYY-MM-DD HH:MM:SS" (as produced by format)
+     * @param text Timestamp text
+     * @return Seconds since 1970 (0 if empty or malformed)
+     */
+    static uint32_t parse(const char* text);
+
+private:
+    static int32_t daysFromCivil(int32_t year, uint8_t month, uint8_t day);
+};
+
+#endif // DLMS_DATETIME_H
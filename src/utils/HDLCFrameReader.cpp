@@ -0,0 +1,72 @@
+/**
+ * @file HDLCFrameReader.cpp
+ * @brief Implementation of HDLC frame assembler
+ * @version 2.0
+ * @date 2025-10-02
+ */
+
+#include "HDLCFrameReader.h"
+
+HDLCFrameReader::Result HDLCFrameReader::feed(uint8_t byte) {
+    if (count == 0) {
+        if (byte == HDLC_FLAG) {
+            flagSeen = true;
+            return Result::PENDING;
+        }
+        if (!flagSeen) {
+            return Result::PENDING;     // Noise between frames
+        }
+        buffer[0] = HDLC_FLAG;
+        count = 1;
+        expected = 0;
+        headerEnd = 0;
+        addressFields = 0;
+        crc = CRCCalculator::INITIAL_VALUE;
+    }
+    
+    buffer[count++] = byte;
+    
+    // Everything between the flags feeds the running CRC
+    if (expected == 0 || count < expected) {
+        crc = CRCCalculator::update(crc, byte);
+    }
+    
+    if (count == 3) {
+        expected = (((buffer[1] & 0x07) << 8) | buffer[2]) + 2;
+        if (expected < 9 || expected > capacity) {
+            reset();
+            return Result::BAD_LENGTH;
+        }
+    }
+    
+    // Addresses are 1, 2 or 4 bytes, the last one with its LSB set;
+    // control follows the source address
+    if (count > 3 && headerEnd == 0) {
+        if (addressFields < 2) {
+            if (byte & 0x01) addressFields++;
+        } else {
+            headerEnd = count + 2;
+        }
+    }
+    
+    // Frames with an information field carry HCS after the header
+    if (count == headerEnd && expected > headerEnd + 1 &&
+        crc != CRCCalculator::GOOD_RESIDUE) {
+        reset();
+        return Result::BAD_HCS;
+    }
+    
+    if (count >= 3 && count == expected) {
+        completedLength = count;
+        bool valid = crc == CRCCalculator::GOOD_RESIDUE;
+        reset();
+        
+        if (byte != HDLC_FLAG) {
+            return Result::NO_CLOSING_FLAG;
+        }
+        flagSeen = true;
+        return valid ? Result::COMPLETE : Result::BAD_FCS;
+    }
+    
+    return Result::PENDING;
+}
@@ -0,0 +1,91 @@
+/**
+ * @file HDLCFrameReader.h
+ * @brief Byte-wise HDLC frame assembler with on-the-fly CRC check
+ * @version 2.0
+ * @date 2025-10-02
+ * 
+ * HDLC over a serial line (IEC 62056-46) has no byte stuffing, so 0x7E
+ * may appear inside a frame. The frame end is taken from the 11-bit
+ * length field; HCS and FCS are checked against the running CRC while
+ * the bytes arrive.
+ */
+
+#ifndef HDLC_FRAME_READER_H
+#define HDLC_FRAME_READER_H
+
+#include <Arduino.h>
+#include "../config/config.h"
+#include "CRCCalculator.h"
+
+/**
+ * @class HDLCFrameReader
+ * @brief Assembles one HDLC frame at a time into a caller-owned buffer
+ */
+class HDLCFrameReader {
+public:
+    /**
+     * @enum Result
+     * @brief Outcome of feeding one byte
+     */
+    enum class Result : uint8_t {
+        PENDING,            // Frame not complete yet
+        COMPLETE,           // Valid frame in buffer
+        BAD_LENGTH,         // Length field out of range, hunting for flag
+        NO_CLOSING_FLAG,    // Length reached without flag, hunting for flag
+        BAD_HCS,
+        BAD_FCS,
+        TRUNCATED,          // Inter-character timeout inside a frame
+        TIMEOUT             // No frame within the response timeout
+    };
+    
+    HDLCFrameReader() : buffer(nullptr), capacity(0) { reset(); }
+    
+    /**
+     * @brief Set destination buffer (only between frames)
+     * @param frame Buffer for the next frame
+     * @param size Buffer size
+     */
+    void setBuffer(uint8_t* frame, uint16_t size) { buffer = frame; capacity = size; }
+    
+    /**
+     * @brief Drop any partial frame
+     */
+    void reset() {
+        count = 0;
+        expected = 0;
+        headerEnd = 0;
+        addressFields = 0;
+        crc = CRCCalculator::INITIAL_VALUE;
+        flagSeen = false;
+    }
+    
+    /**
+     * @brief Feed one received byte
+     * @param byte Received byte
+     * @return COMPLETE when a frame ends with a valid FCS
+     */
+    Result feed(uint8_t byte);
+    
+    /**
+     * @brief Check if a frame is partially received
+     */
+    bool inFrame() const { return count > 1; }
+    
+    /**
+     * @brief Length of the last completed frame (flags included)
+     */
+    uint16_t frameLength() const { return completedLength; }
+
+private:
+    uint8_t* buffer;
+    uint16_t capacity;
+    uint16_t count;
+    uint16_t expected;
+    uint16_t headerEnd;     // Count at which HCS is complete (0 = not known yet)
+    uint8_t addressFields;  // Destination/source addresses seen so far
+    uint16_t completedLength;
+    uint16_t crc;
+    bool flagSeen;          // Closing flag of previous frame may open the next
+};
+
+#endif // HDLC_FRAME_READER_H
@@ -1,4 +1,4 @@
- /**
+/**
  * @file Logger.cpp
  * @brief Implementation of logging system
  * @version 2.0
@@ -6,12 +6,432 @@
  */
 
 #include "Logger.h"
+#include <atomic>
 
 // Initialize static members
 Logger::Level Logger::currentLevel = Logger::INFO;
 bool Logger::colorsEnabled = true;
 bool Logger::timestampEnabled = true;
 
+// ============================================
+// RECORDS
+// ============================================
+
+/**
+ * @struct RecordHeader
+ * @brief First bytes of every record
+ */
+struct RecordHeader {
+    uint32_t time;          // millis() at the call
+    uint8_t level;
+    uint8_t kind;
+    uint16_t length;        // Payload bytes after the header
+};
+
+// Payloads:
+//   TEXT    message bytes
+//   FORMAT  format pointer, u8 count, per argument u8 type and either
+//           4 value bytes or u8 length + text + NUL
+//   HEX     u8 label length + label, u16 original length, bytes
+static const uint8_t KIND_TEXT = 0;
+static const uint8_t KIND_FORMAT = 1;
+static const uint8_t KIND_HEX = 2;
+
+/**
+ * @struct RecordWriter
+ * @brief Appends to a record buffer, truncating at its end
+ */
+struct RecordWriter {
+    uint8_t* data;
+    size_t length;
+
+    explicit RecordWriter(uint8_t* buffer) : data(buffer), length(sizeof(RecordHeader)) {}
+
+    size_t room() const { return LOG_RECORD_MAX - length; }
+
+    void put(const void* source, size_t count) {
+        if (count > room()) count = room();
+        memcpy(data + length, source, count);
+        length += count;
+    }
+
+    void u8(uint8_t value) { put(&value, 1); }
+    void u16(uint16_t value) { put(&value, 2); }
+
+    void begin(Logger::Level level, uint8_t kind) {
+        header.time = millis();
+        header.level = level;
+        header.kind = kind;
+    }
+
+    // The buffer is a byte array, so the header is copied, not cast
+    void end() {
+        header.length = length - sizeof(RecordHeader);
+        memcpy(data, &header, sizeof(header));
+    }
+
+    RecordHeader header;
+};
+
+// ============================================
+// RING BUFFER
+// ============================================
+// Fixed slots, each with a sequence number: slot i is free for position
+// p when its sequence equals p, and holds position p's data when it
+// equals p + 1. A producer claims a run of slots with one CAS on head,
+// fills them and publishes them; the drain task is the only consumer and
+// frees slots in order, so when the last slot of a run is free the whole
+// run is. Nobody blocks or takes a lock.
+
+static const size_t SLOT_SIZE = 32;
+static const size_t SLOT_PAYLOAD = SLOT_SIZE - sizeof(uint32_t);
+static const uint32_t RING_MASK = LOG_RING_SLOTS - 1;
+
+static_assert((LOG_RING_SLOTS & RING_MASK) == 0, "LOG_RING_SLOTS must be a power of two");
+static_assert((LOG_RECORD_MAX + SLOT_PAYLOAD - 1) / SLOT_PAYLOAD <= LOG_RING_SLOTS,
+              "LOG_RECORD_MAX does not fit the ring");
+
+struct Slot {
+    std::atomic<uint32_t> sequence;
+    uint8_t data[SLOT_PAYLOAD];
+};
+
+static Slot ring[LOG_RING_SLOTS];
+static std::atomic<uint32_t> ringHead(0);      // Next position to claim (producers)
+static uint32_t ringTail = 0;                  // Next position to drain (drain task)
+static std::atomic<uint32_t> droppedCount(0);
+static std::atomic<bool> draining(false);       // Drain task owns the ring
+
+/**
+ * @brief Claim count consecutive slots
+ * @return false if the ring is full
+ */
+static bool reserve(uint32_t count, uint32_t& position) {
+    uint32_t pos = ringHead.load(std::memory_order_relaxed);
+    for (;;) {
+        uint32_t last = pos + count - 1;
+        uint32_t sequence = ring[last & RING_MASK].sequence.load(std::memory_order_acquire);
+        int32_t diff = (int32_t)(sequence - last);
+
+        if (diff == 0) {
+            if (ringHead.compare_exchange_weak(pos, pos + count, std::memory_order_relaxed)) {
+                position = pos;
+                return true;
+            }
+        } else if (diff < 0) {
+            return false;               // Not drained yet
+        } else {
+            pos = ringHead.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+void Logger::submit(uint8_t* record, size_t length) {
+    if (!draining.load(std::memory_order_acquire)) {
+        render(record);
+        return;
+    }
+
+    uint32_t count = (length + SLOT_PAYLOAD - 1) / SLOT_PAYLOAD;
+    uint32_t position;
+    if (!reserve(count, position)) {
+        droppedCount.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    for (uint32_t i = 0; i < count; i++) {
+        Slot& slot = ring[(position + i) & RING_MASK];
+        size_t chunk = length - i * SLOT_PAYLOAD;
+        if (chunk > SLOT_PAYLOAD) chunk = SLOT_PAYLOAD;
+        memcpy(slot.data, record + i * SLOT_PAYLOAD, chunk);
+        slot.sequence.store(position + i + 1, std::memory_order_release);
+    }
+}
+
+bool Logger::drainOne() {
+    Slot& first = ring[ringTail & RING_MASK];
+    if (first.sequence.load(std::memory_order_acquire) != ringTail + 1) return false;
+
+    RecordHeader header;
+    memcpy(&header, first.data, sizeof(header));
+    size_t length = sizeof(header) + header.length;
+    uint32_t count = (length + SLOT_PAYLOAD - 1) / SLOT_PAYLOAD;
+
+    // Rest of the run may still be in flight
+    for (uint32_t i = 1; i < count; i++) {
+        Slot& slot = ring[(ringTail + i) & RING_MASK];
+        if (slot.sequence.load(std::memory_order_acquire) != ringTail + i + 1) return false;
+    }
+
+    uint8_t record[LOG_RECORD_MAX];
+    for (uint32_t i = 0; i < count; i++) {
+        Slot& slot = ring[(ringTail + i) & RING_MASK];
+        size_t chunk = length - i * SLOT_PAYLOAD;
+        if (chunk > SLOT_PAYLOAD) chunk = SLOT_PAYLOAD;
+        memcpy(record + i * SLOT_PAYLOAD, slot.data, chunk);
+        slot.sequence.store(ringTail + i + LOG_RING_SLOTS, std::memory_order_release);
+    }
+    ringTail += count;
+
+    render(record);
+    return true;
+}
+
+void Logger::drainTask(void* parameter) {
+    uint32_t reported = 0;
+
+    for (;;) {
+        while (drainOne()) {}
+
+        uint32_t lost = droppedCount.load(std::memory_order_relaxed);
+        if (lost != reported) {
+            logf(WARN, "Log overflow: %u records dropped", lost - reported);
+            reported = lost;
+        }
+
+        vTaskDelay(pdMS_TO_TICKS(LOG_DRAIN_TICK));
+    }
+}
+
+uint32_t Logger::dropped() {
+    return droppedCount.load(std::memory_order_relaxed);
+}
+
+// ============================================
+// RENDERING (drain task)
+// ============================================
+
+/**
+ * @struct LineBuffer
+ * @brief Output staging, written to Serial whenever it fills
+ */
+struct LineBuffer {
+    char text[128];
+    size_t length;
+
+    LineBuffer() : length(0) {}
+
+    void append(const char* source, size_t count) {
+        while (count > 0) {
+            if (length == sizeof(text)) flush();
+            size_t chunk = sizeof(text) - length;
+            if (chunk > count) chunk = count;
+            memcpy(text + length, source, chunk);
+            length += chunk;
+            source += chunk;
+            count -= chunk;
+        }
+    }
+
+    void append(const char* source) { append(source, strlen(source)); }
+
+    void flush() {
+        Serial.write(reinterpret_cast<const uint8_t*>(text), length);
+        length = 0;
+    }
+};
+
+/**
+ * @struct DecodedArg
+ * @brief Argument read back from a FORMAT record
+ */
+struct DecodedArg {
+    uint8_t type;
+    uint32_t bits;
+    const char* text;
+
+    int32_t asInt() const {
+        if (type == LogArg::FLOAT) return (int32_t)asFloat();
+        return (int32_t)bits;
+    }
+
+    float asFloat() const {
+        if (type == LogArg::INT) return (float)(int32_t)bits;
+        if (type == LogArg::UINT) return (float)bits;
+        float f;
+        memcpy(&f, &bits, sizeof(f));
+        return f;
+    }
+};
+
+/**
+ * @brief Read the next argument of a FORMAT record
+ * @return false when the arguments are exhausted
+ */
+static bool nextArg(const uint8_t*& cursor, const uint8_t* end, uint8_t& remaining,
+                    DecodedArg& arg) {
+    if (remaining == 0 || cursor >= end) return false;
+    remaining--;
+
+    arg.type = *cursor++;
+    arg.bits = 0;
+    arg.text = "";
+
+    if (arg.type == LogArg::TEXT) {
+        if (cursor >= end) return false;
+        uint8_t length = *cursor++;
+        if (cursor + length + 1 > end) return false;
+        arg.text = reinterpret_cast<const char*>(cursor);
+        cursor += length + 1;
+    } else {
+        if (cursor + 4 > end) return false;
+        memcpy(&arg.bits, cursor, 4);
+        cursor += 4;
+    }
+    return true;
+}
+
+/**
+ * @brief Expand a format against the record's arguments
+ */
+static void renderFormat(LineBuffer& out, const uint8_t* payload, const uint8_t* end) {
+    const char* format;
+    if (payload + sizeof(format) + 1 > end) return;
+    memcpy(&format, payload, sizeof(format));
+    payload += sizeof(format);
+    uint8_t remaining = *payload++;
+
+    const char* p = format;
+    while (*p) {
+        if (*p != '%') {
+            const char* next = strchr(p, '%');
+            size_t count = next ? (size_t)(next - p) : strlen(p);
+            out.append(p, count);
+            p += count;
+            continue;
+        }
+        if (p[1] == '%') {
+            out.append("%", 1);
+            p += 2;
+            continue;
+        }
+
+        // Flags, width and precision are passed through; arguments are
+        // 32-bit, so length modifiers are dropped
+        char spec[16];
+        size_t s = 0;
+        spec[s++] = *p++;
+        while (*p && strchr("-+ #0123456789.", *p) && s < sizeof(spec) - 2) spec[s++] = *p++;
+        while (*p && strchr("hlzjt", *p)) p++;
+        char conversion = *p ? *p++ : 's';
+        spec[s++] = conversion;
+        spec[s] = '\0';
+
+        DecodedArg arg;
+        if (!nextArg(payload, end, remaining, arg)) {
+            out.append("?", 1);
+            continue;
+        }
+
+        char text[64];
+        int written;
+        switch (conversion) {
+            case 'd': case 'i': case 'c':
+                written = snprintf(text, sizeof(text), spec, (int)arg.asInt());
+                break;
+            case 'u': case 'x': case 'X': case 'o':
+                written = snprintf(text, sizeof(text), spec, (unsigned int)arg.asInt());
+                break;
+            case 'f': case 'F': case 'e': case 'E': case 'g': case 'G':
+                written = snprintf(text, sizeof(text), spec, (double)arg.asFloat());
+                break;
+            case 's':
+                if (s == 2) {
+                    out.append(arg.text);
+                    continue;
+                }
+                written = snprintf(text, sizeof(text), spec, arg.text);
+                break;
+            default:
+                out.append(spec, s);
+                continue;
+        }
+        if (written > 0) {
+            out.append(text, (size_t)written < sizeof(text) ? (size_t)written : sizeof(text) - 1);
+        }
+    }
+}
+
+/**
+ * @brief Hex dump, 16 bytes per line
+ */
+static void renderHex(LineBuffer& out, const uint8_t* payload, const uint8_t* end) {
+    static const char DIGITS[] = "0123456789abcdef";
+    if (payload >= end) return;
+
+    uint8_t labelLength = *payload++;
+    if (payload + labelLength + 2 > end) return;
+    out.append(reinterpret_cast<const char*>(payload), labelLength);
+    payload += labelLength;
+
+    uint16_t total;
+    memcpy(&total, payload, 2);
+    payload += 2;
+
+    char text[24];
+    snprintf(text, sizeof(text), " [%u bytes]: ", total);
+    out.append(text);
+
+    uint16_t kept = end - payload;
+    for (uint16_t i = 0; i < kept; i++) {
+        char hex[3] = { DIGITS[payload[i] >> 4], DIGITS[payload[i] & 0x0F], ' ' };
+        out.append(hex, 3);
+
+        // Add line break every 16 bytes for readability
+        if ((i + 1) % 16 == 0 && i < kept - 1) {
+            out.append("\r\n                           ");
+        }
+    }
+
+    if (kept < total) {
+        snprintf(text, sizeof(text), "... +%u", total - kept);
+        out.append(text);
+    }
+}
+
+void Logger::render(const uint8_t* record) {
+    RecordHeader header;
+    memcpy(&header, record, sizeof(header));
+    const uint8_t* payload = record + sizeof(header);
+    const uint8_t* end = payload + header.length;
+    Level level = (Level)header.level;
+
+    LineBuffer out;
+
+    // Add timestamp if enabled
+    if (timestampEnabled) {
+        unsigned long ms = header.time;
+        unsigned long seconds = ms / 1000;
+        unsigned long minutes = seconds / 60;
+        unsigned long hours = minutes / 60;
+
+        char stamp[24];
+        snprintf(stamp, sizeof(stamp), "[%02lu:%02lu:%02lu.%03lu] ",
+                 hours, minutes % 60, seconds % 60, ms % 1000);
+        out.append(stamp);
+    }
+
+    // Add colored level indicator
+    if (colorsEnabled) out.append(getLevelColor(level));
+    out.append("[");
+    out.append(getLevelString(level));
+    out.append("] ");
+    if (colorsEnabled) out.append(COLOR_RESET);
+
+    switch (header.kind) {
+        case KIND_FORMAT: renderFormat(out, payload, end); break;
+        case KIND_HEX:    renderHex(out, payload, end); break;
+        default:          out.append(reinterpret_cast<const char*>(payload), header.length); break;
+    }
+
+    out.append("\r\n");
+    out.flush();
+}
+
+// ============================================
+// PRODUCERS
+// ============================================
+
 /**
  * @brief Initialize the logger system
  */
@@ -21,6 +441,19 @@ void Logger::begin(Level level) {
     Serial.println("  DLMS Meter Reader v" FIRMWARE_VERSION);
     Serial.println("  Logger Initialized");
     Serial.println("========================================\n");
+
+    if (LOG_ASYNC && !draining.load()) {
+        for (uint32_t i = 0; i < LOG_RING_SLOTS; i++) {
+            ring[i].sequence.store(i, std::memory_order_relaxed);
+        }
+        ringHead.store(0, std::memory_order_relaxed);
+        ringTail = 0;
+
+        if (xTaskCreatePinnedToCore(drainTask, "logger", LOG_TASK_STACK, nullptr,
+                                    LOG_TASK_PRIORITY, nullptr, LOG_TASK_CORE)) {
+            draining.store(true, std::memory_order_release);
+        }
+    }
 }
 
 /**
@@ -28,28 +461,43 @@ void Logger::begin(Level level) {
  */
 void Logger::log(Level level, const char* message) {
     if (level > currentLevel) return;
-    
-    String output = "";
-    
-    // Add timestamp if enabled
-    if (timestampEnabled) {
-        output += "[" + getTimestamp() + "] ";
-    }
-    
-    // Add colored level indicator
-    if (colorsEnabled) {
-        output += getLevelColor(level);
-    }
-    
-    output += "[" + String(getLevelString(level)) + "] ";
-    
-    if (colorsEnabled) {
-        output += COLOR_RESET;
+
+    uint8_t record[LOG_RECORD_MAX];
+    RecordWriter writer(record);
+    writer.begin(level, KIND_TEXT);
+    writer.put(message, strlen(message));
+    writer.end();
+    submit(record, writer.length);
+}
+
+void Logger::logFormat(Level level, const char* format, const LogArg* args, uint8_t count) {
+    uint8_t record[LOG_RECORD_MAX];
+    RecordWriter writer(record);
+    writer.begin(level, KIND_FORMAT);
+    writer.put(&format, sizeof(format));
+    writer.u8(count);
+
+    for (uint8_t i = 0; i < count; i++) {
+        const LogArg& arg = args[i];
+        if (arg.type == LogArg::TEXT) {
+            // Keep room for the type, length and NUL
+            if (writer.room() < 3) break;
+            size_t length = strlen(arg.value.s);
+            if (length > writer.room() - 3) length = writer.room() - 3;
+            if (length > 255) length = 255;
+            writer.u8(arg.type);
+            writer.u8(length);
+            writer.put(arg.value.s, length);
+            writer.u8(0);
+        } else {
+            if (writer.room() < 5) break;
+            writer.u8(arg.type);
+            writer.put(&arg.value, 4);
+        }
     }
-    
-    output += message;
-    
-    Serial.println(output);
+
+    writer.end();
+    submit(record, writer.length);
 }
 
 /**
@@ -97,26 +545,25 @@ void Logger::debug(const String& message) {
 }
 
 /**
- * @brief Print hexadecimal dump of data
+ * @brief Record raw bytes; the dump is rendered by the drain task
  */
-void Logger::hexDump(const char* label, const uint8_t* data, 
+void Logger::hexDump(const char* label, const uint8_t* data,
                      uint16_t length, Level level) {
     if (level > currentLevel) return;
-    
-    String output = String(label) + " [" + String(length) + " bytes]: ";
-    
-    for (uint16_t i = 0; i < length; i++) {
-        if (data[i] < 0x10) output += "0";
-        output += String(data[i], HEX);
-        output += " ";
-        
-        // Add line break every 16 bytes for readability
-        if ((i + 1) % 16 == 0 && i < length - 1) {
-            output += "\n                           ";
-        }
-    }
-    
-    log(level, output.c_str());
+
+    size_t labelLength = strlen(label);
+    if (labelLength > 32) labelLength = 32;
+    uint16_t kept = length < LOG_HEX_BYTES ? length : LOG_HEX_BYTES;
+
+    uint8_t record[LOG_RECORD_MAX];
+    RecordWriter writer(record);
+    writer.begin(level, KIND_HEX);
+    writer.u8(labelLength);
+    writer.put(label, labelLength);
+    writer.u16(length);
+    writer.put(data, kept);
+    writer.end();
+    submit(record, writer.length);
 }
 
 /**
@@ -145,24 +592,6 @@ const char* Logger::getLevelColor(Level level) {
     }
 }
 
-/**
- * @brief Get current timestamp string
- */
-String Logger::getTimestamp() {
-    unsigned long ms = millis();
-    unsigned long seconds = ms / 1000;
-    unsigned long minutes = seconds / 60;
-    unsigned long hours = minutes / 60;
-    
-    seconds %= 60;
-    minutes %= 60;
-    ms %= 1000;
-    
-    char buffer[16];
-    sprintf(buffer, "%02lu:%02lu:%02lu.%03lu", hours, minutes, seconds, ms);
-    return String(buffer);
-}
-
 /**
  * @brief Set minimum log level
  */
@@ -1,8 +1,21 @@
- /**
+/**
  * @file Logger.h
  * @brief Multi-level logging system with timestamp and color support
  * @version 2.0
  * @date 2025-10-02
+ *
+ * Producers never format or touch the UART: a call packs a compact
+ * record (millis, level, message text or format pointer plus arguments,
+ * raw hex bytes) into a lock-free ring of fixed slots, and a
+ * low-priority task drains and renders the records to Serial. When the
+ * ring is full the record is dropped and counted. Before Logger::begin()
+ * starts the drain task (or with LOG_ASYNC false) records are rendered
+ * on the spot.
+ *
+ * Formatted records (LOG_*F) keep only the format pointer, so the
+ * format must be a string literal; %s arguments are copied into the
+ * record. Arguments are 32-bit: length modifiers (%lu, %ld) are
+ * accepted and ignored, 64-bit values and String do not compile.
  */
 
 #ifndef LOGGER_H
@@ -20,6 +33,35 @@
 #define COLOR_MAGENTA "\033[35m"
 #define COLOR_CYAN    "\033[36m"
 
+/**
+ * @class LogArg
+ * @brief One argument of a formatted record, captured by type
+ */
+class LogArg {
+public:
+    enum Type : uint8_t {
+        INT = 0,
+        UINT = 1,
+        FLOAT = 2,
+        TEXT = 3
+    };
+
+    LogArg(int v) : type(INT) { value.i = v; }
+    LogArg(long v) : type(INT) { value.i = (int32_t)v; }
+    LogArg(unsigned int v) : type(UINT) { value.u = v; }
+    LogArg(unsigned long v) : type(UINT) { value.u = (uint32_t)v; }
+    LogArg(double v) : type(FLOAT) { value.f = (float)v; }
+    LogArg(const char* v) : type(TEXT) { value.s = v ? v : "(null)"; }
+
+    Type type;
+    union {
+        int32_t i;
+        uint32_t u;
+        float f;
+        const char* s;      // Copied into the record, not kept
+    } value;
+};
+
 /**
  * @class Logger
  * @brief Provides structured logging with different severity levels
@@ -32,63 +74,87 @@ public:
         INFO = 2,
         DEBUG = 3
     };
-    
+
     /**
-     * @brief Initialize the logger
+     * @brief Initialize the logger and start the drain task
      * @param level Minimum log level to display
      */
     static void begin(Level level = INFO);
-    
+
     /**
      * @brief Log error message
-     * @param message Message to log
+     * @param message Message to log (copied)
      */
     static void error(const char* message);
     static void error(const String& message);
-    
+
     /**
      * @brief Log warning message
-     * @param message Message to log
+     * @param message Message to log (copied)
      */
     static void warn(const char* message);
     static void warn(const String& message);
-    
+
     /**
      * @brief Log info message
-     * @param message Message to log
+     * @param message Message to log (copied)
      */
     static void info(const char* message);
     static void info(const String& message);
-    
+
     /**
      * @brief Log debug message
-     * @param message Message to log
+     * @param message Message to log (copied)
      */
     static void debug(const char* message);
     static void debug(const String& message);
-    
+
+    /**
+     * @brief Log a printf-style message, formatted by the drain task
+     * @param level Log level
+     * @param format String literal (kept by pointer)
+     * @param args Integers, floats or C strings
+     */
+    template <typename... Args>
+    static void logf(Level level, const char* format, Args... args) {
+        if (!enabled(level)) return;
+        // Trailing entry keeps the array non-empty without arguments
+        const LogArg list[] = { LogArg(args)..., LogArg(0) };
+        logFormat(level, format, list, sizeof...(Args));
+    }
+
     /**
      * @brief Print hex dump of data buffer
      * @param label Label for the data
-     * @param data Pointer to data
+     * @param data Pointer to data (up to LOG_HEX_BYTES are copied)
      * @param length Length of data
      * @param level Log level for this dump
      */
-    static void hexDump(const char* label, const uint8_t* data, 
+    static void hexDump(const char* label, const uint8_t* data,
                        uint16_t length, Level level = DEBUG);
-    
+
+    /**
+     * @brief Level passes the current filter
+     */
+    static bool enabled(Level level) { return level <= currentLevel; }
+
+    /**
+     * @brief Records dropped because the ring was full (since boot)
+     */
+    static uint32_t dropped();
+
     /**
      * @brief Set minimum log level
      * @param level New minimum level
      */
     static void setLevel(Level level);
-    
+
     /**
      * @brief Enable/disable colored output
      * @param enable true to enable colors
      */
     static void enableColors(bool enable);
-    
+
     /**
      * @brief Enable/disable timestamps
      * @param enable true to enable timestamps
@@ -99,25 +165,42 @@ private:
     static Level currentLevel;
     static bool colorsEnabled;
     static bool timestampEnabled;
-    
+
     static void log(Level level, const char* message);
+    static void logFormat(Level level, const char* format, const LogArg* args, uint8_t count);
+    static void submit(uint8_t* record, size_t length);
+    static void render(const uint8_t* record);
+    static bool drainOne();
+    static void drainTask(void* parameter);
     static const char* getLevelString(Level level);
     static const char* getLevelColor(Level level);
-    static String getTimestamp();
 };
 
-// Convenience macros for conditional logging
+// Convenience macros for conditional logging. The level is checked
+// before the message is built, so a filtered String concatenation costs
+// nothing.
+#define LOG_AT(level, call) \
+    do { if (Logger::enabled(level)) { call; } } while (0)
+
 #if DEBUG_MODE
-    #define LOG_ERROR(msg)   Logger::error(msg)
-    #define LOG_WARN(msg)    Logger::warn(msg)
-    #define LOG_INFO(msg)    Logger::info(msg)
-    #define LOG_DEBUG(msg)   Logger::debug(msg)
+    #define LOG_ERROR(msg)   LOG_AT(Logger::ERROR, Logger::error(msg))
+    #define LOG_WARN(msg)    LOG_AT(Logger::WARN, Logger::warn(msg))
+    #define LOG_INFO(msg)    LOG_AT(Logger::INFO, Logger::info(msg))
+    #define LOG_DEBUG(msg)   LOG_AT(Logger::DEBUG, Logger::debug(msg))
+    #define LOG_ERRORF(...)  Logger::logf(Logger::ERROR, __VA_ARGS__)
+    #define LOG_WARNF(...)   Logger::logf(Logger::WARN, __VA_ARGS__)
+    #define LOG_INFOF(...)   Logger::logf(Logger::INFO, __VA_ARGS__)
+    #define LOG_DEBUGF(...)  Logger::logf(Logger::DEBUG, __VA_ARGS__)
     #define LOG_HEX(label, data, len) Logger::hexDump(label, data, len)
 #else
-    #define LOG_ERROR(msg)   Logger::error(msg)
-    #define LOG_WARN(msg)    Logger::warn(msg)
+    #define LOG_ERROR(msg)   LOG_AT(Logger::ERROR, Logger::error(msg))
+    #define LOG_WARN(msg)    LOG_AT(Logger::WARN, Logger::warn(msg))
     #define LOG_INFO(msg)    ((void)0)
     #define LOG_DEBUG(msg)   ((void)0)
+    #define LOG_ERRORF(...)  Logger::logf(Logger::ERROR, __VA_ARGS__)
+    #define LOG_WARNF(...)   Logger::logf(Logger::WARN, __VA_ARGS__)
+    #define LOG_INFOF(...)   ((void)0)
+    #define LOG_DEBUGF(...)  ((void)0)
     #define LOG_HEX(label, data, len) ((void)0)
 #endif
 
@@ -0,0 +1,77 @@
+/**
+ * @file SPSCQueue.h
+ * @brief Lock-free single-producer/single-consumer queue between tasks
+ * @version 2.0
+ * @date 2025-10-02
+ *
+ * Fixed ring of N slots with free-running head and tail counters. Only
+ * the producer writes head and only the consumer writes tail, so a
+ * release store after the slot copy is all the synchronisation needed:
+ * neither side ever blocks or takes a lock, and items are copied once
+ * into static storage.
+ */
+
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H
+
+#include <Arduino.h>
+#include <atomic>
+
+/**
+ * @class SPSCQueue
+ * @brief Bounded queue for exactly one producer and one consumer task
+ * @tparam T Item type (copyable)
+ * @tparam N Capacity, a power of two up to 128
+ */
+template <typename T, uint8_t N>
+class SPSCQueue {
+    static_assert(N > 0 && N <= 128 && (N & (N - 1)) == 0,
+                  "SPSCQueue capacity must be a power of two up to 128");
+
+public:
+    SPSCQueue() : head(0), tail(0) {}
+
+    /**
+     * @brief Append an item (producer only)
+     * @return false if the queue is full
+     */
+    bool push(const T& item) {
+        uint8_t h = head.load(std::memory_order_relaxed);
+        if ((uint8_t)(h - tail.load(std::memory_order_acquire)) >= N) {
+            return false;
+        }
+        slots[h & (N - 1)] = item;
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Take the oldest item (consumer only)
+     * @return false if the queue is empty
+     */
+    bool pop(T& item) {
+        uint8_t t = tail.load(std::memory_order_relaxed);
+        if (t == head.load(std::memory_order_acquire)) {
+            return false;
+        }
+        item = slots[t & (N - 1)];
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Items waiting (approximate from the other side)
+     */
+    uint8_t size() const {
+        return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire);
+    }
+
+    bool empty() const { return size() == 0; }
+
+private:
+    T slots[N];
+    std::atomic<uint8_t> head;      // Next slot to fill (producer)
+    std::atomic<uint8_t> tail;      // Next slot to drain (consumer)
+};
+
+#endif // SPSC_QUEUE_H
@@ -0,0 +1,59 @@
+/**
+ * @file SystemMetrics.cpp
+ * @brief Implementation of resource sampling
+ * @version 2.0
+ * @date 2025-10-02
+ */
+
+#include "SystemMetrics.h"
+#include "Logger.h"
+
+SystemMetrics::SystemMetrics()
+    : uptime(0), heapFree(0), heapHigh(0), heapLow(0), heapLargest(0),
+      stackMetering(0), stackNetwork(0), logDropped(0) {
+}
+
+void SystemMetrics::sample(TaskHandle_t metering, TaskHandle_t network) {
+    uptime = millis() / 1000;
+    heapFree = ESP.getFreeHeap();
+    if (heapFree > heapHigh) heapHigh = heapFree;
+    heapLow = ESP.getMinFreeHeap();
+    heapLargest = ESP.getMaxAllocHeap();
+
+    // ESP-IDF reports stack headroom in bytes
+    stackMetering = metering ? uxTaskGetStackHighWaterMark(metering) : 0;
+    stackNetwork = uxTaskGetStackHighWaterMark(network);
+    logDropped = Logger::dropped();
+}
+
+void SystemMetrics::toJson(JsonObject out) const {
+    out["heap_free"] = heapFree;
+    out["heap_high"] = heapHigh;
+    out["heap_low"] = heapLow;
+    out["heap_block"] = heapLargest;
+    out["stack_metering"] = stackMetering;
+    out["stack_network"] = stackNetwork;
+    out["log_dropped"] = logDropped;
+}
+
+void SystemMetrics::toPrometheus(MetricsTextSink& sink) const {
+    char text[768];
+    int n = snprintf(text, sizeof(text),
+                     "# TYPE device_uptime_seconds counter\n"
+                     "device_uptime_seconds %lu\n"
+                     "# TYPE device_heap_bytes gauge\n"
+                     "device_heap_bytes{kind=\"free\"} %lu\n"
+                     "device_heap_bytes{kind=\"high\"} %lu\n"
+                     "device_heap_bytes{kind=\"low\"} %lu\n"
+                     "device_heap_bytes{kind=\"largest_block\"} %lu\n"
+                     "# TYPE device_stack_free_bytes gauge\n"
+                     "device_stack_free_bytes{task=\"metering\"} %lu\n"
+                     "device_stack_free_bytes{task=\"network\"} %lu\n"
+                     "# TYPE device_log_dropped_total counter\n"
+                     "device_log_dropped_total %lu\n",
+                     (unsigned long)uptime, (unsigned long)heapFree, (unsigned long)heapHigh,
+                     (unsigned long)heapLow, (unsigned long)heapLargest,
+                     (unsigned long)stackMetering, (unsigned long)stackNetwork,
+                     (unsigned long)logDropped);
+    if (n > 0) sink.write(text, (size_t)n < sizeof(text) ? (size_t)n : sizeof(text) - 1);
+}
@@ -0,0 +1,54 @@
+/**
+ * @file SystemMetrics.h
+ * @brief Heap watermarks, task stack headroom and logger drops
+ * @version 2.0
+ * @date 2025-10-02
+ */
+
+#ifndef SYSTEM_METRICS_H
+#define SYSTEM_METRICS_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include "../config/config.h"
+#include "../dlms/LinkMetrics.h"
+
+/**
+ * @class SystemMetrics
+ * @brief Resource figures sampled by the network task
+ */
+class SystemMetrics {
+public:
+    uint32_t uptime;            // s
+    uint32_t heapFree;
+    uint32_t heapHigh;          // Most free heap seen by sample()
+    uint32_t heapLow;           // Least free heap since boot (allocator watermark)
+    uint32_t heapLargest;       // Largest allocatable block
+    uint32_t stackMetering;     // Unused stack bytes, high-water mark
+    uint32_t stackNetwork;
+    uint32_t logDropped;
+
+    /**
+     * @brief Constructor
+     */
+    SystemMetrics();
+
+    /**
+     * @brief Take current figures
+     * @param metering Metering task (nullptr if unknown)
+     * @param network Network task (nullptr for the calling task)
+     */
+    void sample(TaskHandle_t metering, TaskHandle_t network);
+
+    /**
+     * @brief Compact summary for the status message
+     */
+    void toJson(JsonObject out) const;
+
+    /**
+     * @brief Prometheus text exposition
+     */
+    void toPrometheus(MetricsTextSink& sink) const;
+};
+
+#endif // SYSTEM_METRICS_H